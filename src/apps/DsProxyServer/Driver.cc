@@ -117,7 +117,11 @@ int Driver::Run()
       return (-1);
     }
     
-    _server->waitForClients(1000);
+    if (_params.use_event_loop) {
+      _server->runEventLoop(1000);
+    } else {
+      _server->waitForClients(1000);
+    }
     
   }
   
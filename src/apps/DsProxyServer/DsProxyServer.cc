@@ -34,9 +34,12 @@
 
 #include "Params.hh"
 #include "DsProxyServer.hh"
+#include "ProxyEventLoop.hh"
 #include <toolsa/ThreadSocket.hh>
+#include <toolsa/ServerSocket.hh>
 #include <toolsa/DateTime.hh>
 #include <toolsa/TaStr.hh>
+#include <toolsa/uusleep.h>
 #include <dsserver/DsLocator.hh>
 #include <dsserver/DsLdataServerMsg.hh>
 #include <dsserver/DsFileCopyMsg.hh>
@@ -67,6 +70,82 @@ DsProxyServer::~DsProxyServer()
 {
 }
 
+//////////////////////////////////////////////////
+// Serve clients from a single thread, with an event loop.
+// See ProxyEventLoop.
+
+int DsProxyServer::runEventLoop(int timeoutMSecs /* = 1000 */)
+
+{
+
+  if (timeoutMSecs <= 0) {
+    timeoutMSecs = 1000;
+  }
+
+  int listenFd = -1;
+  if (_isOkay && _serverSocket != NULL) {
+    listenFd = _serverSocket->getSd();
+  }
+  if (listenFd < 0) {
+    _errString = "";
+    TaStr::AddStr(_errString, "ERROR - ", _executableName);
+    _errString += "  Error in DsProxyServer::runEventLoop(): ";
+    _errString += "  Server does not have a valid and/or open ServerSocket.";
+    TaStr::AddStr(_errString, "  ", DateTime::str());
+    if (_isDebug) {
+      cerr << _errString << endl;
+    }
+    umsleep(timeoutMSecs);
+    return -1;
+  }
+
+  ProxyEventLoop loop(*this, _params, listenFd);
+  if (loop.init()) {
+    _errString = loop.getErrStr();
+    if (_isDebug) {
+      cerr << _errString << endl;
+    }
+    umsleep(timeoutMSecs);
+    return -1;
+  }
+
+  while (true) {
+
+    if (loop.run(timeoutMSecs)) {
+      _errString = loop.getErrStr();
+      if (_isDebug) {
+        cerr << _errString << endl;
+      }
+      return -1;
+    }
+    _numClients = loop.getNumClients();
+
+    // give control back as for waitForClients()
+
+    if (!timeoutMethod() && exitMethod()) {
+      if (_isDebug) {
+        cerr << "DsProxyServer returning from runEventLoop() "
+             << "because timeoutMethod() indicated to do so."
+             << endl;
+        cerr << "  " << DateTime::str() << endl;
+      }
+      return 0;
+    }
+
+  }
+
+}
+
+//////////////////////////////////////////////////
+// Record that a request from the event loop is done
+
+void DsProxyServer::requestDone(double msecs)
+
+{
+  _lastActionTime = time(NULL);
+  recordLatency(msecs);
+}
+
 // Handle data commands from the client.
 //   Returning failure (-1) from this method makes the server die.
 //   So don't ever do that.
@@ -82,62 +161,15 @@ int DsProxyServer::handleDataCommand(Socket *clientSock,
   string errMsg;
   TaStr::AddStr(errMsg, "ERROR - DsProxyServer::handleDataCommand()");
 
-  // disassemble incoming message
+  // check the request, and find the target server port
 
-  DsServerMsg msg;
-  int status = msg.disassemble(data, dataSize);
-  if (status < 0) {
-    TaStr::AddStr(errMsg, "Could not disassemble DsMessage.");
-    _sendErrorReply(clientSock, errMsg, DsServerMsg::BAD_MESSAGE);
+  DsURL url;
+  int port = 0;
+  DsServerMsg::msgErr errType = DsServerMsg::BAD_MESSAGE;
+  if (checkRequest(data, dataSize, url, port, errMsg, errType)) {
+    _sendErrorReply(clientSock, errMsg, errType);
     return 0;
   }
-  
-  // Verify we have parts in the message.
-  
-  int numParts = msg.getNParts();
-  if (_isVerbose) {
-    cerr << "Data command has " << numParts << " parts." << endl;
-    msg.print(cerr, "  ");
-  }
-  if (numParts <= 0) {
-    TaStr::AddStr(errMsg, "Got data message with no parts.");
-    _sendErrorReply(clientSock, errMsg, DsServerMsg::BAD_MESSAGE);
-    return 0;
-  }
-
-  // Get the URL out of the message.
-  // first check the standard
-  
-  string urlStr = _getUrlStr(msg);
-  if (urlStr.size() == 0) {
-    TaStr::AddStr(errMsg, "Data command has no URL.");
-    _sendErrorReply(clientSock, errMsg, DsServerMsg::BAD_MESSAGE);
-    return 0;                                            
-  }
-  if (_isVerbose) {
-    cerr << "URL String: " << urlStr << endl;
-  }
-  const DsURL url(urlStr);
-  
-  // Check that this is a request/response protocol
-  // fmq connections are not supported
-
-  if (url.getProtocol().find("fmqp") != string::npos) {
-    TaStr::AddStr(errMsg, "Cannot handle FMQ protocol.");
-    TaStr::AddStr(errMsg, "  Must be a single connect/reply protocol.");
-    _sendErrorReply(clientSock, errMsg, DsServerMsg::SERVICE_DENIED);
-    return 0;                                            
-  }
-
-  // get port from URL
-  
-  int port = DsLocator.getDefaultPort(url);
-  if (_isDebug) {
-    cerr << "Forwarding on to host, port: "
-         << _params.target_host << ", " << port << endl;
-  }
-
-  // ensure the server is running by contacting the DsServerMgr
 
   // Open a socket to the target server.
   ThreadSocket serverSock;
@@ -145,32 +177,11 @@ int DsProxyServer::handleDataCommand(Socket *clientSock,
 
     // server not running
     // ping manager to start it up
-    
 
-    DsURL mgrUrl;
-    mgrUrl.setHost(_params.target_host);
-    mgrUrl.setProtocol(url.getProtocol());
-    mgrUrl.setTranslator(url.getTranslator());
-    mgrUrl.setParamFile(url.getParamFile());
-    mgrUrl.setFile(url.getFile());
-    string mgrUrlStr = mgrUrl.getURLStr();
-    if (_isDebug) {
-      cerr << "Contacting mgr, URL: " << mgrUrlStr << endl;
-      mgrUrl.print(cerr);
-    }
-    string mgrErrStr;
-    if (DsLocator.resolve(mgrUrl, NULL, true, &mgrErrStr)) {
-      TaStr::AddStr(errMsg, "Cannot contact server manager to start server");
-      TaStr::AddStr(errMsg, "  host: ", _params.target_host);
-      TaStr::AddInt(errMsg, "  port: ", port);
-      TaStr::AddStr(errMsg, mgrErrStr);
+    if (startTargetServer(url, port, errMsg)) {
       _sendErrorReply(clientSock, errMsg, DsServerMsg::BAD_MESSAGE);
       return 0;
     }
-    if (_isDebug) {
-      cerr << "Mgr started server, URL: " << endl;
-      mgrUrl.print(cerr);
-    }
     
     // try opening again
 
@@ -218,6 +229,118 @@ int DsProxyServer::handleDataCommand(Socket *clientSock,
 
 }
 
+////////////////////////////////////////
+// Check a data request, and get the URL and the port of the
+// target server.
+// Returns 0 on success, -1 on failure with errMsg and errType set.
+
+int DsProxyServer::checkRequest(const void *data, ssize_t dataSize,
+                                DsURL &url, int &port,
+                                string &errMsg,
+                                DsServerMsg::msgErr &errType)
+
+{
+
+  errType = DsServerMsg::BAD_MESSAGE;
+
+  // disassemble incoming message
+
+  DsServerMsg msg;
+  int status = msg.disassemble(data, dataSize);
+  if (status < 0) {
+    TaStr::AddStr(errMsg, "Could not disassemble DsMessage.");
+    return -1;
+  }
+  
+  // Verify we have parts in the message.
+  
+  int numParts = msg.getNParts();
+  if (_isVerbose) {
+    cerr << "Data command has " << numParts << " parts." << endl;
+    msg.print(cerr, "  ");
+  }
+  if (numParts <= 0) {
+    TaStr::AddStr(errMsg, "Got data message with no parts.");
+    return -1;
+  }
+
+  // Get the URL out of the message.
+  // first check the standard
+  
+  string urlStr = _getUrlStr(msg);
+  if (urlStr.size() == 0) {
+    TaStr::AddStr(errMsg, "Data command has no URL.");
+    return -1;
+  }
+  if (_isVerbose) {
+    cerr << "URL String: " << urlStr << endl;
+  }
+  url.setURLStr(urlStr);
+  
+  // Check that this is a request/response protocol
+  // fmq connections are not supported
+
+  if (url.getProtocol().find("fmqp") != string::npos) {
+    TaStr::AddStr(errMsg, "Cannot handle FMQ protocol.");
+    TaStr::AddStr(errMsg, "  Must be a single connect/reply protocol.");
+    errType = DsServerMsg::SERVICE_DENIED;
+    return -1;
+  }
+
+  // get port from URL
+  
+  port = DsLocator.getDefaultPort(url);
+  if (_isDebug) {
+    cerr << "Forwarding on to host, port: "
+         << _params.target_host << ", " << port << endl;
+  }
+
+  return 0;
+
+}
+
+////////////////////////////////////////
+// Ask the server manager on the target host to start the
+// server for this URL.
+// Returns 0 on success, -1 on failure with errMsg set.
+
+int DsProxyServer::startTargetServer(const DsURL &url, int port,
+                                     string &errMsg)
+
+{
+
+  DsURL mgrUrl;
+  mgrUrl.setHost(_params.target_host);
+  mgrUrl.setProtocol(url.getProtocol());
+  mgrUrl.setTranslator(url.getTranslator());
+  mgrUrl.setParamFile(url.getParamFile());
+  mgrUrl.setFile(url.getFile());
+  string mgrUrlStr = mgrUrl.getURLStr();
+  if (_isDebug) {
+    cerr << "Contacting mgr, URL: " << mgrUrlStr << endl;
+    mgrUrl.print(cerr);
+  }
+  // use a locator local to this call, since in the event loop
+  // this runs in the helper thread while the loop uses DsLocator
+
+  DsLOCATOR locator;
+  string mgrErrStr;
+  if (locator.resolve(mgrUrl, NULL, true, &mgrErrStr)) {
+    TaStr::AddStr(errMsg, "Cannot contact server manager to start server");
+    TaStr::AddStr(errMsg, "  host: ", _params.target_host);
+    TaStr::AddInt(errMsg, "  port: ", port);
+    TaStr::AddStr(errMsg, mgrErrStr);
+    return -1;
+  }
+  if (_isDebug) {
+    cerr << "Mgr started server, URL: " << endl;
+    mgrUrl.print(cerr);
+  }
+
+  return 0;
+
+}
+
 ////////////////////////////////////////
 // Send error reply to client
 
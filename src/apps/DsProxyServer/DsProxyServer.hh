@@ -50,6 +50,36 @@ public:
                 const Params &params);
   
   virtual ~DsProxyServer();
+
+  // Serve clients from a single thread, with an event loop,
+  // instead of waitForClients(). See ProxyEventLoop.
+  //
+  // Returns:  0 - the server was instructed to terminate by
+  //               the return from timeoutMethod().
+  //          -1 - something terrible happened.
+
+  int runEventLoop(int timeoutMSecs = 1000);
+
+  // Check a data request, and get the URL and the port of the
+  // target server.
+  // Returns 0 on success, -1 on failure with errMsg and errType set.
+
+  int checkRequest(const void *data, ssize_t dataSize,
+                   DsURL &url, int &port,
+                   string &errMsg, DsServerMsg::msgErr &errType);
+
+  // Ask the server manager on the target host to start the
+  // server for this URL. This blocks until the server is up, so
+  // the event loop calls it from its helper thread.
+  // Returns 0 on success, -1 on failure with errMsg set.
+
+  int startTargetServer(const DsURL &url, int port, string &errMsg);
+
+  // Used by the event loop - record that a request is done,
+  // or that a shutdown has been requested.
+
+  void requestDone(double msecs);
+  void requestShutdown() { _doShutdown = true; }
   
 protected:
 
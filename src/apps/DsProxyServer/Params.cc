@@ -697,6 +697,39 @@
     tt->single_val.b = pTRUE;
     tt++;
     
+    // Parameter 'Comment 4'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 4");
+    tt->comment_hdr = tdrpStrDup("EVENT LOOP MODE");
+    tt->comment_text = tdrpStrDup("");
+    tt++;
+    
+    // Parameter 'use_event_loop'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("use_event_loop");
+    tt->descr = tdrpStrDup("Option to serve clients from a single event loop.");
+    tt->help = tdrpStrDup("If TRUE, all clients are served from a single thread using epoll, instead of a thread or child process per client. Replies are relayed to the client as they are read from the target server, and connections to the target servers are kept open and reused if the servers allow persistent connections. If FALSE, each client is handled by a separate thread or child, as set by no_threads.");
+    tt->val_offset = (char *) &use_event_loop - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'max_idle_upstream_per_port'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("max_idle_upstream_per_port");
+    tt->descr = tdrpStrDup("Max idle connections to each target server.");
+    tt->help = tdrpStrDup("Event loop mode only. Connections to the target servers are kept open for reuse, up to this number per server port. Set to 0 to close each connection after the reply.");
+    tt->val_offset = (char *) &max_idle_upstream_per_port - &_start_;
+    tt->single_val.i = 4;
+    tt++;
+    
     // trailing entry has param_name set to NULL
     
     tt->param_name = NULL;
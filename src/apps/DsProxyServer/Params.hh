@@ -364,6 +364,10 @@ public:
 
   tdrp_bool_t allow_http;
 
+  tdrp_bool_t use_event_loop;
+
+  int max_idle_upstream_per_port;
+
   char _end_; // end of data region
               // needed for zeroing out data
 
@@ -371,7 +375,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[15];
+  mutable TDRPtable _table[18];
 
   const char *_className;
 
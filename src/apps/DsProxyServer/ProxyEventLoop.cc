@@ -0,0 +1,1651 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// ProxyEventLoop.cc
+//
+// Event loop for DsProxyServer - see ProxyEventLoop.hh
+//
+///////////////////////////////////////////////////////////////
+
+#include "Params.hh"
+#include "ProxyEventLoop.hh"
+#include "DsProxyServer.hh"
+#include <toolsa/TaStr.hh>
+#include <dataport/bigend.h>
+#include <didss/DsURL.hh>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+// socket message magic cookies - see Socket.hh
+
+#define SOCKET_MAGIC 0xf0f0f0f0
+#define SOCKET_MAGIC_64 0xf6f6f6f6
+
+// bytes per read, and max bytes held for a slow client
+// before reading from the target server is paused
+
+const size_t ProxyEventLoop::_readChunk = 65536;
+const size_t ProxyEventLoop::_maxBacklog = 1048576;
+
+// reply header for clients using http - see HttpSocket
+
+const char *ProxyEventLoop::_httpReplyHdr = "HTTP/1.1 200 OK\r\n\r\n";
+
+//////////////////////////////////////////////////
+// connection state
+
+ProxyEventLoop::Conn::Conn(int fd_, bool isUpstream_) :
+        fd(fd_),
+        isUpstream(isUpstream_),
+        events(0),
+        lastActive(time(NULL))
+{
+}
+
+ProxyEventLoop::Client::Client(int fd_) :
+        Conn(fd_, false),
+        state(CLIENT_READING),
+        httpLen(0),
+        outPos(0),
+        replyDone(false),
+        closeAfterReply(false),
+        persistent(false),
+        first(true),
+        up(NULL),
+        start(NULL)
+{
+  startTime.tv_sec = 0;
+  startTime.tv_usec = 0;
+}
+
+ProxyEventLoop::Upstream::Upstream(int fd_, int port_,
+                                   const string &urlStr_) :
+        Conn(fd_, true),
+        state(UP_CONNECTING),
+        afterSend(UP_RELAYING),
+        port(port_),
+        urlStr(urlStr_),
+        handshake(false),
+        persistent(false),
+        reused(false),
+        startTried(false),
+        client(NULL),
+        outPos(0),
+        hdrLen(0),
+        replyLen(-1),
+        nRelayed(0),
+        paused(false)
+{
+}
+
+//////////////////////////////////////////////////
+// constructor
+
+ProxyEventLoop::ProxyEventLoop(DsProxyServer &server,
+                               const Params &params,
+                               int listenFd) :
+        _server(server),
+        _params(params),
+        _isDebug(params.debug >= Params::DEBUG_NORM),
+        _isVerbose(params.debug >= Params::DEBUG_VERBOSE),
+        _listenFd(listenFd),
+        _epollFd(-1),
+        _commTimeoutMsecs(DS_DEFAULT_COMM_TIMEOUT_MSECS),
+        _nClients(0),
+        _lastCheck(0),
+        _eventFd(-1),
+        _startThreadRunning(false),
+        _startQuit(false)
+
+{
+
+  memset(&_targetAddr, 0, sizeof(_targetAddr));
+  pthread_mutex_init(&_startMutex, NULL);
+  pthread_cond_init(&_startCond, NULL);
+
+  char *DS_COMM_TIMEOUT_MSECS = getenv("DS_COMM_TIMEOUT_MSECS");
+  if (DS_COMM_TIMEOUT_MSECS != NULL) {
+    int timeout;
+    if (sscanf(DS_COMM_TIMEOUT_MSECS, "%d", &timeout) == 1) {
+      _commTimeoutMsecs = timeout;
+    }
+  }
+
+}
+
+//////////////////////////////////////////////////
+// destructor
+
+ProxyEventLoop::~ProxyEventLoop()
+
+{
+
+  // stop the helper thread, after any server start in progress
+
+  if (_startThreadRunning) {
+    pthread_mutex_lock(&_startMutex);
+    _startQuit = true;
+    pthread_cond_signal(&_startCond);
+    pthread_mutex_unlock(&_startMutex);
+    pthread_join(_startThread, NULL);
+  }
+  for (size_t ii = 0; ii < _startQueue.size(); ii++) {
+    delete _startQueue[ii];
+  }
+  for (size_t ii = 0; ii < _startDone.size(); ii++) {
+    delete _startDone[ii];
+  }
+  pthread_mutex_destroy(&_startMutex);
+  pthread_cond_destroy(&_startCond);
+
+  for (set<Conn *>::iterator ii = _conns.begin(); ii != _conns.end(); ii++) {
+    if ((*ii)->fd >= 0) {
+      ::close((*ii)->fd);
+    }
+    delete *ii;
+  }
+  for (size_t ii = 0; ii < _dead.size(); ii++) {
+    delete _dead[ii];
+  }
+  if (_epollFd >= 0) {
+    ::close(_epollFd);
+  }
+  if (_eventFd >= 0) {
+    ::close(_eventFd);
+  }
+
+}
+
+//////////////////////////////////////////////////
+// Set up the event loop.
+// Returns 0 on success, -1 on failure.
+
+int ProxyEventLoop::init()
+
+{
+
+  _errStr = "ERROR - ProxyEventLoop::init\n";
+
+  // look up the target host once
+
+  struct addrinfo hints, *res = NULL;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(_params.target_host, NULL, &hints, &res) != 0 ||
+      res == NULL) {
+    TaStr::AddStr(_errStr, "  Cannot resolve target host: ",
+                  _params.target_host);
+    return -1;
+  }
+  memcpy(&_targetAddr, res->ai_addr, sizeof(_targetAddr));
+  freeaddrinfo(res);
+
+  // clients are accepted from the loop
+
+  if (_listenFd < 0 || _setNonBlocking(_listenFd)) {
+    _errStr += "  Server socket is not open.\n";
+    return -1;
+  }
+
+  _epollFd = epoll_create1(EPOLL_CLOEXEC);
+  if (_epollFd < 0) {
+    int errNum = errno;
+    TaStr::AddStr(_errStr, "  Cannot create epoll: ", strerror(errNum));
+    return -1;
+  }
+
+  // NULL data marks the listening socket
+
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.ptr = NULL;
+  if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _listenFd, &ev)) {
+    int errNum = errno;
+    TaStr::AddStr(_errStr, "  Cannot add server socket: ", strerror(errNum));
+    return -1;
+  }
+
+  // the helper thread signals on the eventfd when a target
+  // server start is done - marked by a pointer to _eventFd
+
+  _eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (_eventFd < 0) {
+    int errNum = errno;
+    TaStr::AddStr(_errStr, "  Cannot create eventfd: ", strerror(errNum));
+    return -1;
+  }
+  ev.events = EPOLLIN;
+  ev.data.ptr = &_eventFd;
+  if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _eventFd, &ev)) {
+    int errNum = errno;
+    TaStr::AddStr(_errStr, "  Cannot add eventfd: ", strerror(errNum));
+    return -1;
+  }
+
+  if (pthread_create(&_startThread, NULL, _startThreadMain, this)) {
+    _errStr += "  Cannot create helper thread.\n";
+    return -1;
+  }
+  _startThreadRunning = true;
+
+  _errStr = "";
+  return 0;
+
+}
+
+//////////////////////////////////////////////////
+// Serve clients, returning after waitMsecs.
+// Returns 0 on success, -1 on failure.
+
+int ProxyEventLoop::run(int waitMsecs)
+
+{
+
+  struct timeval start;
+  gettimeofday(&start, NULL);
+  struct epoll_event events[64];
+
+  while (true) {
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    int elapsed = (now.tv_sec - start.tv_sec) * 1000 +
+      (now.tv_usec - start.tv_usec) / 1000;
+    int remaining = waitMsecs - elapsed;
+    if (remaining <= 0) {
+      break;
+    }
+
+    int nev = epoll_wait(_epollFd, events, 64, min(remaining, 1000));
+    if (nev < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int errNum = errno;
+      _errStr = "ERROR - ProxyEventLoop::run\n";
+      TaStr::AddStr(_errStr, "  epoll_wait failed: ", strerror(errNum));
+      return -1;
+    }
+
+    for (int ii = 0; ii < nev; ii++) {
+      if (events[ii].data.ptr == &_eventFd) {
+        _startJobsDone();
+        continue;
+      }
+      Conn *conn = (Conn *) events[ii].data.ptr;
+      if (conn == NULL) {
+        _accept();
+      } else if (conn->fd < 0) {
+        // closed earlier in this batch
+        continue;
+      } else if (conn->isUpstream) {
+        _handleUpstream((Upstream *) conn, events[ii].events);
+      } else {
+        _handleClient((Client *) conn, events[ii].events);
+      }
+    }
+
+    _checkTimeouts();
+
+    // connections are freed once no events can refer to them
+
+    for (size_t ii = 0; ii < _dead.size(); ii++) {
+      delete _dead[ii];
+    }
+    _dead.clear();
+
+  }
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////
+// Accept new clients
+
+void ProxyEventLoop::_accept()
+
+{
+
+  while (true) {
+
+    int fd = accept(_listenFd, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK && _isDebug) {
+        int errNum = errno;
+        cerr << "ERROR - ProxyEventLoop::_accept: "
+             << strerror(errNum) << endl;
+      }
+      return;
+    }
+
+    if (_setNonBlocking(fd)) {
+      ::close(fd);
+      continue;
+    }
+
+    Client *cl = new Client(fd);
+    if (_addConn(cl, EPOLLIN)) {
+      ::close(fd);
+      delete cl;
+      continue;
+    }
+    _nClients++;
+
+    if (_isVerbose) {
+      cerr << "ProxyEventLoop: accepted client, n clients: "
+           << _nClients << endl;
+    }
+
+    if (_params.max_clients > 0 && _nClients > _params.max_clients) {
+      string errMsg;
+      TaStr::AddStr(errMsg, "ERROR - DsProxyServer");
+      TaStr::AddInt(errMsg, "  Too many clients, max: ", _params.max_clients);
+      _sendErrorReply(cl, errMsg, DsServerMsg::SERVICE_DENIED);
+    }
+
+  }
+
+}
+
+//////////////////////////////////////////////////
+// Handle events on a client connection
+
+void ProxyEventLoop::_handleClient(Client *cl, unsigned int events)
+
+{
+
+  if (cl->state == CLIENT_READING) {
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+      _readClient(cl);
+    }
+    return;
+  }
+
+  if (events & (EPOLLHUP | EPOLLERR)) {
+    _closeConn(cl);
+    return;
+  }
+
+  if (events & EPOLLOUT) {
+    _writeClient(cl);
+  }
+
+}
+
+//////////////////////////////////////////////////
+// Read a request from a client
+
+void ProxyEventLoop::_readClient(Client *cl)
+
+{
+
+  while (true) {
+    size_t len = cl->inBuf.getLen();
+    char *buf = (char *) cl->inBuf.reserve(len + _readChunk);
+    ssize_t nn = read(cl->fd, buf + len, _readChunk);
+    if (nn > 0) {
+      cl->inBuf.reserve(len + nn);
+      cl->lastActive = time(NULL);
+      if ((size_t) nn < _readChunk) {
+        break;
+      }
+      continue;
+    }
+    cl->inBuf.reserve(len);
+    if (nn < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nn < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    // client closed connection, or error
+    _closeConn(cl);
+    return;
+  }
+
+  const char *buf = (const char *) cl->inBuf.getPtr();
+  size_t len = cl->inBuf.getLen();
+  if (len < 8) {
+    return;
+  }
+
+  // strip any http header - see HttpSocket
+
+  if (cl->httpLen == 0 && _params.allow_http &&
+      _msgLen(buf, len) == -2) {
+    size_t checkLen = min(len, (size_t) 2000);
+    for (size_t ii = 3; ii < checkLen; ii++) {
+      if (buf[ii - 3] == '\r' && buf[ii - 2] == '\n' &&
+          buf[ii - 1] == '\r' && buf[ii] == '\n') {
+        cl->httpLen = ii + 1;
+        break;
+      }
+    }
+    if (cl->httpLen == 0 && len < 2000) {
+      // wait for rest of http header
+      return;
+    }
+  }
+
+  const char *msg = buf + cl->httpLen;
+  size_t available = len - cl->httpLen;
+  ssize_t msgLen = _msgLen(msg, available);
+  if (msgLen == -1 || (msgLen >= 0 && available < (size_t) msgLen)) {
+    // need more
+    return;
+  }
+  if (msgLen < 0) {
+    _sendErrorReply(cl, "ERROR - DsProxyServer\n"
+                    "  Bad magic cookie on request.",
+                    DsServerMsg::BAD_MESSAGE);
+    return;
+  }
+
+  _handleRequest(cl, msg, msgLen);
+
+}
+
+//////////////////////////////////////////////////
+// Handle a complete request from a client.
+// msg is the socket message, including its header.
+
+void ProxyEventLoop::_handleRequest(Client *cl,
+                                    const char *msg, size_t msgLen)
+
+{
+
+  gettimeofday(&cl->startTime, NULL);
+  _setEvents(cl, 0);
+
+  size_t hdrLen = _hdrLen(msg);
+  const void *data = msg + hdrLen;
+  ssize_t dataSize = msgLen - hdrLen;
+
+  DsServerMsg hdrMsg;
+  if (hdrMsg.decodeHeader(data, dataSize) < 0) {
+    _sendErrorReply(cl, "Error: Message from client could not be decoded. "
+                    "Either the message is too small, or it has an "
+                    "invalid category.", DsServerMsg::BAD_MESSAGE);
+    return;
+  }
+
+  if (hdrMsg.getMessageCat() == DsServerMsg::ServerStatus) {
+    _serverCommand(cl, data, dataSize);
+    return;
+  }
+
+  // check the request, and find the target server port
+
+  string errMsg;
+  TaStr::AddStr(errMsg, "ERROR - DsProxyServer::_handleRequest()");
+  DsURL url;
+  int port = 0;
+  DsServerMsg::msgErr errType = DsServerMsg::BAD_MESSAGE;
+  if (_server.checkRequest(data, dataSize, url, port, errMsg, errType)) {
+    _sendErrorReply(cl, errMsg, errType);
+    return;
+  }
+
+  // pass the request on. If the server is not running,
+  // the server manager is asked to start it up.
+
+  Upstream *up = _getUpstream(port, url.getURLStr(), true, errMsg);
+  if (up == NULL) {
+    _queueStart(cl, port, url.getURLStr(), true, msg, msgLen, errMsg);
+    return;
+  }
+
+  _passRequest(cl, up, msg, msgLen);
+
+}
+
+//////////////////////////////////////////////////
+// Handle a server command from a client.
+// See DsProcessServer::handleServerCommand().
+
+void ProxyEventLoop::_serverCommand(Client *cl,
+                                    const void *data, ssize_t dataSize)
+
+{
+
+  DsServerMsg msg;
+  if (msg.disassemble(data, dataSize) < 0) {
+    _sendErrorReply(cl, "Error in ProxyEventLoop::_serverCommand(): "
+                    "Could not disassemble DsServerMsg.",
+                    DsServerMsg::BAD_MESSAGE);
+    return;
+  }
+
+  int command = msg.getType();
+  msg.clearParts();
+
+  bool isShutdown = false;
+  switch (command) {
+
+    case DsServerMsg::PERSISTENT_CONNECTION: {
+      if (!cl->first || !_server.allowPersistent()) {
+        _sendErrorReply(cl, "Persistent connection not supported",
+                        DsServerMsg::NOT_SUPPORTED);
+        return;
+      }
+      cl->persistent = true;
+      cl->startTime.tv_sec = 0;
+      int val = 1;
+      setsockopt(cl->fd, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val));
+      break;
+    }
+
+    case DsServerMsg::IS_ALIVE:
+      // Send back the pid and the name of the process.
+      msg.addInt(getpid());
+      msg.addString("Executable Name should go here.");
+      break;
+
+    case DsServerMsg::GET_NUM_CLIENTS:
+      msg.addInt(_nClients);
+      break;
+
+    case DsServerMsg::SHUTDOWN:
+      // Send back an empty message, and exit on the next timeout
+      isShutdown = true;
+      break;
+
+    case DsServerMsg::GET_SERVER_STATS:
+      msg.addString(_server.getLatencyReport());
+      break;
+
+    default:
+      msg.setErr(DsServerMsg::UNKNOWN_COMMAND);
+      break;
+
+  } // switch
+
+  void *msgToSend = msg.assemble();
+  _queueReply(cl, msgToSend, msg.lengthAssembled());
+
+  if (isShutdown) {
+    _server.requestShutdown();
+  }
+
+}
+
+//////////////////////////////////////////////////
+// Write pending reply bytes to a client
+
+void ProxyEventLoop::_writeClient(Client *cl)
+
+{
+
+  if (cl->fd < 0) {
+    return;
+  }
+
+  const char *buf = (const char *) cl->outBuf.getPtr();
+  size_t len = cl->outBuf.getLen();
+  while (cl->outPos < len) {
+    ssize_t nn = send(cl->fd, buf + cl->outPos, len - cl->outPos,
+                      MSG_NOSIGNAL);
+    if (nn > 0) {
+      cl->outPos += nn;
+      cl->lastActive = time(NULL);
+      continue;
+    }
+    if (nn < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nn < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      _setEvents(cl, EPOLLOUT);
+      return;
+    }
+    _closeConn(cl);
+    return;
+  }
+
+  // all written, so resume reading from the target server
+
+  cl->outBuf.reset();
+  cl->outPos = 0;
+  _setEvents(cl, 0);
+  if (cl->up != NULL && cl->up->paused) {
+    cl->up->paused = false;
+    _setEvents(cl->up, EPOLLIN);
+  }
+
+  if (cl->replyDone) {
+    _requestDone(cl);
+  }
+
+}
+
+//////////////////////////////////////////////////
+// The reply has been written to the client
+
+void ProxyEventLoop::_requestDone(Client *cl)
+
+{
+
+  if (cl->startTime.tv_sec != 0) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    double msecs = (now.tv_sec - cl->startTime.tv_sec) * 1000.0 +
+      (now.tv_usec - cl->startTime.tv_usec) / 1000.0;
+    _server.requestDone(msecs);
+  }
+
+  if (cl->closeAfterReply || !cl->persistent) {
+    _closeConn(cl);
+    return;
+  }
+
+  // persistent - wait for the next request
+
+  cl->state = CLIENT_READING;
+  cl->inBuf.reset();
+  cl->httpLen = 0;
+  cl->replyDone = false;
+  cl->first = false;
+  cl->lastActive = time(NULL);
+  _setEvents(cl, EPOLLIN);
+
+}
+
+//////////////////////////////////////////////////
+// Send an error reply to a client, then close the connection.
+// See DsProcessServer::sendReply().
+
+void ProxyEventLoop::_sendErrorReply(Client *cl,
+                                     const string &errMsg,
+                                     DsServerMsg::msgErr errType)
+
+{
+
+  if (_isDebug) {
+    cerr << errMsg << endl;
+  }
+
+  DsServerMsg msg;
+  msg.setCategory(DsServerMsg::Generic);
+  msg.setErr(errType);
+  if (errMsg.size() > 0) {
+    msg.addErrString(errMsg);
+  }
+  void *msgToSend = msg.assemble();
+
+  cl->closeAfterReply = true;
+  _queueReply(cl, msgToSend, msg.lengthAssembled());
+
+}
+
+//////////////////////////////////////////////////
+// Queue a reply from the proxy itself, and start writing it
+
+void ProxyEventLoop::_queueReply(Client *cl,
+                                 const void *data, ssize_t dataSize)
+
+{
+
+  cl->state = CLIENT_REPLYING;
+  cl->outBuf.reset();
+  cl->outPos = 0;
+  if (cl->httpLen > 0) {
+    cl->outBuf.add(_httpReplyHdr, strlen(_httpReplyHdr));
+  }
+  _addMsg(cl->outBuf, data, dataSize);
+  cl->replyDone = true;
+  _writeClient(cl);
+
+}
+
+//////////////////////////////////////////////////
+// Get a connection to the target server on this port,
+// reusing an idle one if available.
+//
+// Returns NULL on failure, with errMsg set.
+
+ProxyEventLoop::Upstream *
+  ProxyEventLoop::_getUpstream(int port, const string &urlStr,
+                               bool handshake, string &errMsg)
+
+{
+
+  vector<Upstream *> &idle = _idle[port];
+  if (idle.size() > 0) {
+    Upstream *up = idle.back();
+    idle.pop_back();
+    up->urlStr = urlStr;
+    up->reused = true;
+    return up;
+  }
+
+  int fd = _connect(port, errMsg);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  Upstream *up = new Upstream(fd, port, urlStr);
+  up->handshake = (handshake &&
+                   _refusedPorts.find(port) == _refusedPorts.end());
+  if (_addConn(up, EPOLLOUT)) {
+    ::close(fd);
+    delete up;
+    TaStr::AddStr(errMsg, "  Cannot add connection to event loop");
+    return NULL;
+  }
+
+  return up;
+
+}
+
+//////////////////////////////////////////////////
+// Pass a client's request to the target server connection
+
+void ProxyEventLoop::_passRequest(Client *cl, Upstream *up,
+                                  const void *msg, size_t msgLen)
+
+{
+
+  cl->state = CLIENT_RELAYING;
+  cl->up = up;
+  up->client = cl;
+  up->request.load(msg, msgLen);
+  up->lastActive = time(NULL);
+
+  // an idle connection is ready, otherwise the request
+  // is sent once connected
+
+  if (up->state == UP_IDLE) {
+    _startRequest(up);
+  }
+
+}
+
+//////////////////////////////////////////////////
+// Start a non-blocking connect to the target server.
+// Returns the socket, or -1 on failure with errMsg set.
+
+int ProxyEventLoop::_connect(int port, string &errMsg)
+
+{
+
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    int errNum = errno;
+    TaStr::AddStr(errMsg, "  Cannot create socket: ", strerror(errNum));
+    return -1;
+  }
+
+  // requests and replies are relayed as they arrive,
+  // so do not hold back small writes
+
+  int val = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val));
+
+  struct sockaddr_in addr = _targetAddr;
+  addr.sin_port = htons(port);
+  if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) &&
+      errno != EINPROGRESS) {
+    ::close(fd);
+    TaStr::AddStr(errMsg, "Trying to connect to true server, host: ",
+                  _params.target_host);
+    TaStr::AddInt(errMsg, "    port: ", port);
+    return -1;
+  }
+
+  return fd;
+
+}
+
+//////////////////////////////////////////////////
+// Connect to target server has completed
+
+void ProxyEventLoop::_connectDone(Upstream *up)
+
+{
+
+  int err = 0;
+  socklen_t errLen = sizeof(err);
+  if (getsockopt(up->fd, SOL_SOCKET, SO_ERROR, &err, &errLen) || err != 0) {
+    string errMsg;
+    TaStr::AddStr(errMsg, "ERROR - DsProxyServer");
+    TaStr::AddStr(errMsg, "Trying to connect to true server, host: ",
+                  _params.target_host);
+    TaStr::AddInt(errMsg, "    port: ", up->port);
+    _upstreamFailed(up, errMsg, DsServerMsg::BAD_MESSAGE,
+                    !up->startTried, true);
+    return;
+  }
+
+  up->lastActive = time(NULL);
+
+  if (!up->handshake) {
+    _startRequest(up);
+    return;
+  }
+
+  // ask the server to keep the connection open
+
+  DsServerMsg msg;
+  msg.setCategory(DsServerMsg::ServerStatus);
+  msg.setType(DsServerMsg::PERSISTENT_CONNECTION);
+  void *msgToSend = msg.assemble();
+  up->outBuf.reset();
+  up->outPos = 0;
+  _addMsg(up->outBuf, msgToSend, msg.lengthAssembled());
+  up->state = UP_SENDING;
+  up->afterSend = UP_HANDSHAKE;
+  _writeUpstream(up);
+
+}
+
+//////////////////////////////////////////////////
+// Send the client's request to the target server
+
+void ProxyEventLoop::_startRequest(Upstream *up)
+
+{
+
+  up->outBuf = up->request;
+  up->outPos = 0;
+  up->hdrLen = 0;
+  up->replyLen = -1;
+  up->nRelayed = 0;
+  up->paused = false;
+  up->lastActive = time(NULL);
+  up->state = UP_SENDING;
+  up->afterSend = UP_RELAYING;
+  _writeUpstream(up);
+
+}
+
+//////////////////////////////////////////////////
+// Handle events on a target server connection
+
+void ProxyEventLoop::_handleUpstream(Upstream *up, unsigned int events)
+
+{
+
+  // On a socket error, or a hangup while we are still sending,
+  // the connection is no use, so give up on it now.
+  // Connect errors are reported by _connectDone(), and a hangup
+  // while reading is left to the read, so that a reply sent
+  // before the server closed is still relayed.
+
+  bool failed = false;
+  if (up->state != UP_CONNECTING && up->state != UP_IDLE) {
+    if ((events & EPOLLERR) ||
+        ((events & EPOLLHUP) && up->state == UP_SENDING)) {
+      failed = true;
+    }
+  }
+  if (failed) {
+    string errMsg;
+    TaStr::AddStr(errMsg, "ERROR - DsProxyServer");
+    TaStr::AddStr(errMsg, "Lost connection to server on target host: ",
+                  _params.target_host);
+    _upstreamFailed(up, errMsg, DsServerMsg::SERVER_ERROR,
+                    up->reused && up->nRelayed == 0);
+    return;
+  }
+
+  switch (up->state) {
+    case UP_CONNECTING:
+      _connectDone(up);
+      break;
+    case UP_SENDING:
+      _writeUpstream(up);
+      break;
+    case UP_HANDSHAKE:
+      _readHandshake(up);
+      break;
+    case UP_RELAYING:
+      _relayReply(up);
+      break;
+    case UP_IDLE:
+      // server closed the idle connection
+      _closeConn(up);
+      break;
+  }
+
+}
+
+//////////////////////////////////////////////////
+// Write pending bytes to the target server
+
+void ProxyEventLoop::_writeUpstream(Upstream *up)
+
+{
+
+  const char *buf = (const char *) up->outBuf.getPtr();
+  size_t len = up->outBuf.getLen();
+  while (up->outPos < len) {
+    ssize_t nn = send(up->fd, buf + up->outPos, len - up->outPos,
+                      MSG_NOSIGNAL);
+    if (nn > 0) {
+      up->outPos += nn;
+      up->lastActive = time(NULL);
+      continue;
+    }
+    if (nn < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nn < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      _setEvents(up, EPOLLOUT);
+      return;
+    }
+    string errMsg;
+    TaStr::AddStr(errMsg, "ERROR - DsProxyServer");
+    TaStr::AddStr(errMsg,
+                  "Could not forward message to server on target host: ",
+                  _params.target_host);
+    _upstreamFailed(up, errMsg, DsServerMsg::BAD_MESSAGE, up->reused);
+    return;
+  }
+
+  up->outBuf.reset();
+  up->outPos = 0;
+  up->state = up->afterSend;
+  _setEvents(up, EPOLLIN);
+
+}
+
+//////////////////////////////////////////////////
+// Read the reply to the persistent connection request
+
+void ProxyEventLoop::_readHandshake(Upstream *up)
+
+{
+
+  bool closed = false;
+  while (true) {
+    size_t len = up->inBuf.getLen();
+    char *buf = (char *) up->inBuf.reserve(len + 1024);
+    ssize_t nn = read(up->fd, buf + len, 1024);
+    if (nn > 0) {
+      up->inBuf.reserve(len + nn);
+      continue;
+    }
+    up->inBuf.reserve(len);
+    if (nn < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nn == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+      closed = true;
+    }
+    break;
+  }
+
+  const char *buf = (const char *) up->inBuf.getPtr();
+  size_t len = up->inBuf.getLen();
+  ssize_t msgLen = _msgLen(buf, len);
+  if (!closed && (msgLen == -1 || (msgLen >= 0 && len < (size_t) msgLen))) {
+    // need more
+    return;
+  }
+
+  if (msgLen > 0 && len >= (size_t) msgLen) {
+    size_t hdrLen = _hdrLen(buf);
+    DsServerMsg reply;
+    if (reply.decodeHeader(buf + hdrLen, msgLen - hdrLen) == 0 &&
+        reply.getMessageErr() == 0 &&
+        reply.getMessageCat() == DsServerMsg::ServerStatus &&
+        reply.getType() == DsServerMsg::PERSISTENT_CONNECTION) {
+      up->persistent = true;
+      up->inBuf.reset();
+      _startRequest(up);
+      return;
+    }
+    // older servers do not know the command, so do not ask again
+    int err = reply.getMessageErr();
+    if (err == (int) DsServerMsg::UNKNOWN_COMMAND ||
+        err == (int) DsServerMsg::NOT_SUPPORTED) {
+      _refusedPorts.insert(up->port);
+    }
+  }
+
+  // not accepted - the server closes the connection, so
+  // send the request on a new one
+
+  if (_isVerbose) {
+    cerr << "ProxyEventLoop: persistent connection not accepted, port: "
+         << up->port << endl;
+  }
+  string errMsg;
+  TaStr::AddStr(errMsg, "ERROR - DsProxyServer");
+  TaStr::AddStr(errMsg, "Cannot connect to server on target host: ",
+                _params.target_host);
+  _upstreamFailed(up, errMsg, DsServerMsg::SERVER_ERROR, true);
+
+}
+
+//////////////////////////////////////////////////
+// Relay the reply from the target server to the client
+
+void ProxyEventLoop::_relayReply(Upstream *up)
+
+{
+
+  Client *cl = up->client;
+  if (cl == NULL) {
+    _closeConn(up);
+    return;
+  }
+
+  while (!up->paused) {
+
+    size_t len = cl->outBuf.getLen();
+    char *buf = (char *) cl->outBuf.reserve(len + _readChunk);
+    ssize_t nn = read(up->fd, buf + len, _readChunk);
+
+    if (nn > 0) {
+
+      // keep the start of the reply, for the message length
+
+      if (up->hdrLen < sizeof(up->hdr)) {
+        size_t ncopy = min((size_t) nn, sizeof(up->hdr) - up->hdrLen);
+        memcpy(up->hdr + up->hdrLen, buf + len, ncopy);
+        up->hdrLen += ncopy;
+      }
+
+      if (up->nRelayed == 0 && cl->httpLen > 0) {
+        // http clients get an http header first
+        MemBuf reply;
+        reply.add(_httpReplyHdr, strlen(_httpReplyHdr));
+        reply.add(buf + len, nn);
+        cl->outBuf.reserve(len);
+        cl->outBuf.add(reply.getPtr(), reply.getLen());
+      } else {
+        cl->outBuf.reserve(len + nn);
+      }
+
+      up->nRelayed += nn;
+      up->lastActive = time(NULL);
+      cl->lastActive = up->lastActive;
+
+      if (up->replyLen < 0) {
+        up->replyLen = _msgLen(up->hdr, up->hdrLen);
+        if (up->replyLen == -2) {
+          string errMsg;
+          TaStr::AddStr(errMsg, "ERROR - DsProxyServer");
+          TaStr::AddStr(errMsg, "Bad reply message from target server "
+                        "on host: ", _params.target_host);
+          _upstreamFailed(up, errMsg, DsServerMsg::SERVER_ERROR, false);
+          return;
+        }
+      }
+
+      if (up->replyLen >= 0 && up->nRelayed >= up->replyLen) {
+        cl->replyDone = true;
+        _upstreamDone(up);
+        break;
+      }
+
+      if (cl->outBuf.getLen() - cl->outPos > _maxBacklog) {
+        // client is behind - wait for it to catch up
+        up->paused = true;
+        _setEvents(up, 0);
+      }
+
+      continue;
+
+    } // if (nn > 0)
+
+    cl->outBuf.reserve(len);
+    if (nn < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nn < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+
+    // server closed connection before end of reply
+
+    string errMsg;
+    TaStr::AddStr(errMsg, "ERROR - DsProxyServer");
+    TaStr::AddStr(errMsg,
+                  "Could not read reply message from target server on host: ",
+                  _params.target_host);
+    _upstreamFailed(up, errMsg, DsServerMsg::SERVER_ERROR,
+                    up->reused && up->nRelayed == 0);
+    return;
+
+  }
+
+  _writeClient(cl);
+
+}
+
+//////////////////////////////////////////////////
+// The whole reply has been read from the target server.
+// Keep the connection for reuse if the server allows.
+
+void ProxyEventLoop::_upstreamDone(Upstream *up)
+
+{
+
+  if (up->client != NULL) {
+    up->client->up = NULL;
+    up->client = NULL;
+  }
+  up->request.reset();
+  up->paused = false;
+
+  if (!up->persistent) {
+    _closeConn(up);
+    return;
+  }
+
+  vector<Upstream *> &idle = _idle[up->port];
+  if ((int) idle.size() >= _params.max_idle_upstream_per_port) {
+    _closeConn(up);
+    return;
+  }
+
+  // watch for the server closing it
+
+  up->state = UP_IDLE;
+  up->lastActive = time(NULL);
+  _setEvents(up, EPOLLIN);
+  idle.push_back(up);
+
+}
+
+//////////////////////////////////////////////////
+// The connection to the target server failed.
+//
+// If retry is set, and no reply has been relayed, the request
+// is sent again on another connection - for example an idle
+// connection may have been closed by the server just as it
+// was reused. If startServer is also set, the server manager is
+// asked to start the server first.
+//
+// Otherwise the client gets an error reply, or is disconnected
+// if part of the reply has been relayed.
+
+void ProxyEventLoop::_upstreamFailed(Upstream *up,
+                                     const string &errMsg,
+                                     DsServerMsg::msgErr errType,
+                                     bool retry,
+                                     bool startServer /* = false */)
+
+{
+
+  Client *cl = up->client;
+  int port = up->port;
+  string urlStr = up->urlStr;
+  bool startTried = (up->startTried || startServer);
+  // do not ask for a persistent connection again if that failed
+  bool handshake = (up->state != UP_HANDSHAKE);
+  si64 nRelayed = up->nRelayed;
+  MemBuf request;
+  request = up->request;
+
+  up->client = NULL;
+  if (cl != NULL) {
+    cl->up = NULL;
+  }
+  _closeConn(up);
+
+  if (cl == NULL || cl->fd < 0) {
+    return;
+  }
+
+  string msg = errMsg;
+  if (retry && nRelayed == 0) {
+    if (!startServer) {
+      Upstream *nup = _getUpstream(port, urlStr, handshake, msg);
+      if (nup != NULL) {
+        nup->startTried = startTried;
+        _passRequest(cl, nup, request.getPtr(), request.getLen());
+        return;
+      }
+    }
+    if (startServer || !startTried) {
+      // server not running - ask the manager to start it up
+      _queueStart(cl, port, urlStr, handshake,
+                  request.getPtr(), request.getLen(), msg);
+      return;
+    }
+  }
+
+  if (nRelayed == 0) {
+    cl->outBuf.reset();
+    _sendErrorReply(cl, msg, errType);
+  } else {
+    _closeConn(cl);
+  }
+
+}
+
+//////////////////////////////////////////////////
+// Park the client while the helper thread asks the server
+// manager to start the target server. The request is passed
+// on when the start is done.
+
+void ProxyEventLoop::_queueStart(Client *cl, int port,
+                                 const string &urlStr, bool handshake,
+                                 const void *msg, size_t msgLen,
+                                 const string &errMsg)
+
+{
+
+  StartJob *job = new StartJob;
+  job->client = cl;
+  job->port = port;
+  job->urlStr = urlStr;
+  job->handshake = handshake;
+  job->request.load(msg, msgLen);
+  job->iret = 0;
+  job->errMsg = errMsg;
+
+  cl->state = CLIENT_STARTING;
+  cl->start = job;
+  cl->lastActive = time(NULL);
+  _setEvents(cl, 0);
+
+  if (_isVerbose) {
+    cerr << "Starting target server, port " << port << endl;
+  }
+
+  pthread_mutex_lock(&_startMutex);
+  _startQueue.push_back(job);
+  pthread_cond_signal(&_startCond);
+  pthread_mutex_unlock(&_startMutex);
+
+}
+
+//////////////////////////////////////////////////
+// Handle the start jobs the helper thread is done with,
+// passing the parked requests on.
+
+void ProxyEventLoop::_startJobsDone()
+
+{
+
+  uint64_t count;
+  while (read(_eventFd, &count, sizeof(count)) > 0) {
+  }
+
+  deque<StartJob *> done;
+  pthread_mutex_lock(&_startMutex);
+  done.swap(_startDone);
+  pthread_mutex_unlock(&_startMutex);
+
+  for (size_t ii = 0; ii < done.size(); ii++) {
+
+    StartJob *job = done[ii];
+    Client *cl = job->client;
+
+    if (cl != NULL) {
+      cl->start = NULL;
+      string errMsg = job->errMsg;
+      Upstream *up = NULL;
+      if (job->iret == 0) {
+        up = _getUpstream(job->port, job->urlStr, job->handshake, errMsg);
+      }
+      if (up == NULL) {
+        _sendErrorReply(cl, errMsg, DsServerMsg::BAD_MESSAGE);
+      } else {
+        up->startTried = true;
+        _passRequest(cl, up, job->request.getPtr(), job->request.getLen());
+      }
+    }
+
+    delete job;
+
+  }
+
+}
+
+//////////////////////////////////////////////////
+// Helper thread - starts target servers one at a time,
+// since the server manager calls block.
+
+void *ProxyEventLoop::_startThreadMain(void *arg)
+
+{
+  ProxyEventLoop *loop = (ProxyEventLoop *) arg;
+  loop->_runStartJobs();
+  return NULL;
+}
+
+void ProxyEventLoop::_runStartJobs()
+
+{
+
+  pthread_mutex_lock(&_startMutex);
+
+  while (true) {
+
+    while (!_startQuit && _startQueue.empty()) {
+      pthread_cond_wait(&_startCond, &_startMutex);
+    }
+    if (_startQuit) {
+      break;
+    }
+
+    StartJob *job = _startQueue.front();
+    _startQueue.pop_front();
+    int port = job->port;
+    string urlStr = job->urlStr;
+    pthread_mutex_unlock(&_startMutex);
+
+    DsURL url(urlStr);
+    string errMsg;
+    int iret = _server.startTargetServer(url, port, errMsg);
+
+    pthread_mutex_lock(&_startMutex);
+    job->iret = iret;
+    if (iret) {
+      job->errMsg += errMsg;
+    }
+    _startDone.push_back(job);
+
+    uint64_t one = 1;
+    if (write(_eventFd, &one, sizeof(one)) < 0) {
+      // counter full - the loop has not read it yet
+    }
+
+  }
+
+  pthread_mutex_unlock(&_startMutex);
+
+}
+
+//////////////////////////////////////////////////
+// Register a new connection with epoll.
+// Returns 0 on success, -1 on failure.
+
+int ProxyEventLoop::_addConn(Conn *conn, unsigned int events)
+
+{
+
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = events;
+  ev.data.ptr = conn;
+  if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, conn->fd, &ev)) {
+    return -1;
+  }
+  conn->events = events;
+  _conns.insert(conn);
+  return 0;
+
+}
+
+//////////////////////////////////////////////////
+// Change the events a connection is waiting for
+
+void ProxyEventLoop::_setEvents(Conn *conn, unsigned int events)
+
+{
+
+  if (conn->fd < 0 || conn->events == events) {
+    return;
+  }
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = events;
+  ev.data.ptr = conn;
+  epoll_ctl(_epollFd, EPOLL_CTL_MOD, conn->fd, &ev);
+  conn->events = events;
+
+}
+
+//////////////////////////////////////////////////
+// Close a connection. The object is freed at the end
+// of the current batch of events.
+
+void ProxyEventLoop::_closeConn(Conn *conn)
+
+{
+
+  if (conn->fd < 0) {
+    return;
+  }
+
+  epoll_ctl(_epollFd, EPOLL_CTL_DEL, conn->fd, NULL);
+  ::close(conn->fd);
+  conn->fd = -1;
+  _conns.erase(conn);
+  _dead.push_back(conn);
+
+  if (conn->isUpstream) {
+
+    Upstream *up = (Upstream *) conn;
+    if (up->state == UP_IDLE) {
+      vector<Upstream *> &idle = _idle[up->port];
+      idle.erase(remove(idle.begin(), idle.end(), up), idle.end());
+    }
+    if (up->client != NULL) {
+      up->client->up = NULL;
+      up->client = NULL;
+    }
+
+  } else {
+
+    Client *cl = (Client *) conn;
+    _nClients--;
+    if (cl->start != NULL) {
+      // the start job is freed when the helper is done with it
+      cl->start->client = NULL;
+      cl->start = NULL;
+    }
+    if (cl->up != NULL) {
+      // reply is only partly relayed, so the connection
+      // cannot be reused
+      Upstream *up = cl->up;
+      cl->up = NULL;
+      up->client = NULL;
+      _closeConn(up);
+    }
+    if (_isVerbose) {
+      cerr << "ProxyEventLoop: closed client, n clients: "
+           << _nClients << endl;
+    }
+
+  }
+
+}
+
+//////////////////////////////////////////////////
+// Close connections which have been idle, or waiting, too long
+
+void ProxyEventLoop::_checkTimeouts()
+
+{
+
+  time_t now = time(NULL);
+  if (now == _lastCheck) {
+    return;
+  }
+  _lastCheck = now;
+
+  int commSecs = (_commTimeoutMsecs + 999) / 1000;
+  int keepAliveSecs = DS_DEFAULT_KEEPALIVE_MSECS / 1000;
+  int idleSecs = DS_DEFAULT_CLIENT_IDLE_MSECS / 1000;
+
+  vector<Upstream *> upExpired;
+  vector<Client *> clExpired;
+  for (set<Conn *>::iterator ii = _conns.begin(); ii != _conns.end(); ii++) {
+    Conn *conn = *ii;
+    int age = now - conn->lastActive;
+    if (conn->isUpstream) {
+      Upstream *up = (Upstream *) conn;
+      int maxAge = (up->state == UP_IDLE ? idleSecs : commSecs);
+      if (age > maxAge) {
+        upExpired.push_back(up);
+      }
+    } else {
+      Client *cl = (Client *) conn;
+      if (cl->state == CLIENT_STARTING) {
+        // the helper thread bounds the wait
+        continue;
+      }
+      int maxAge = commSecs;
+      if (cl->state == CLIENT_READING && !cl->first) {
+        maxAge = keepAliveSecs;
+      }
+      if (age > maxAge) {
+        clExpired.push_back(cl);
+      }
+    }
+  }
+
+  // target servers first, so the clients get an error reply
+
+  for (size_t ii = 0; ii < upExpired.size(); ii++) {
+    Upstream *up = upExpired[ii];
+    if (up->fd < 0) {
+      continue;
+    }
+    if (up->client == NULL) {
+      _closeConn(up);
+      continue;
+    }
+    string errMsg;
+    TaStr::AddStr(errMsg, "ERROR - DsProxyServer");
+    TaStr::AddStr(errMsg, "Timed out waiting for target server on host: ",
+                  _params.target_host);
+    TaStr::AddInt(errMsg, "    port: ", up->port);
+    _upstreamFailed(up, errMsg, DsServerMsg::SERVER_ERROR, false);
+  }
+
+  for (size_t ii = 0; ii < clExpired.size(); ii++) {
+    _closeConn(clExpired[ii]);
+  }
+
+}
+
+//////////////////////////////////////////////////
+// Get the total length of a socket message, including the
+// header, from the start of the message.
+//
+// Returns the length, -1 if more bytes are needed to tell,
+// or -2 if the message does not start with a magic cookie.
+
+ssize_t ProxyEventLoop::_msgLen(const char *buf, size_t len)
+
+{
+
+  if (len < 8) {
+    return -1;
+  }
+
+  ui32 magic[2];
+  memcpy(magic, buf, 8);
+
+  if (magic[0] == SOCKET_MAGIC && magic[1] == SOCKET_MAGIC) {
+    // 8 byte cookie, then 32-bit id, len, seq_no
+    if (len < 20) {
+      return -1;
+    }
+    si32 msgLen;
+    memcpy(&msgLen, buf + 12, sizeof(msgLen));
+    msgLen = BE_to_si32(msgLen);
+    if (msgLen < 0) {
+      return -2;
+    }
+    return 20 + (ssize_t) msgLen;
+  }
+
+  if (magic[0] == SOCKET_MAGIC_64 && magic[1] == SOCKET_MAGIC_64) {
+    // 8 byte cookie, then 64-bit id, len, seq_no
+    if (len < 32) {
+      return -1;
+    }
+    si64 msgLen;
+    memcpy(&msgLen, buf + 16, sizeof(msgLen));
+    msgLen = BE_to_si64(msgLen);
+    if (msgLen < 0) {
+      return -2;
+    }
+    return 32 + (ssize_t) msgLen;
+  }
+
+  return -2;
+
+}
+
+//////////////////////////////////////////////////
+// Get the header length of a socket message
+
+size_t ProxyEventLoop::_hdrLen(const char *buf)
+
+{
+  ui32 magic;
+  memcpy(&magic, buf, sizeof(magic));
+  return (magic == SOCKET_MAGIC_64 ? 32 : 20);
+}
+
+//////////////////////////////////////////////////
+// Add a socket message, with its header, to a buffer.
+// See Socket::writeMessage().
+
+void ProxyEventLoop::_addMsg(MemBuf &buf, const void *data, size_t dataSize)
+
+{
+
+  ui32 magic[2] = {SOCKET_MAGIC, SOCKET_MAGIC};
+  buf.add(magic, sizeof(magic));
+  si32 hdr[3];
+  hdr[0] = BE_from_si32(0);
+  hdr[1] = BE_from_si32((si32) dataSize);
+  hdr[2] = BE_from_si32(0);
+  buf.add(hdr, sizeof(hdr));
+  buf.add(data, dataSize);
+
+}
+
+//////////////////////////////////////////////////
+// Set a socket to non-blocking.
+// Returns 0 on success, -1 on failure.
+
+int ProxyEventLoop::_setNonBlocking(int fd)
+
+{
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+    return -1;
+  }
+  return 0;
+}
+
@@ -0,0 +1,284 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// ProxyEventLoop.hh
+//
+// Event loop for DsProxyServer.
+//
+// Serves all clients from a single thread, using epoll to
+// multiplex the client sockets and the connections to the
+// target servers, instead of a child or thread per client.
+//
+// Requests are read in full, since the URL is needed to find
+// the target server. Replies are relayed through as they are
+// read from the target server, without buffering the whole
+// message - reading from the target server is paused if the
+// client falls behind.
+//
+// Connections to the target servers are kept open and reused,
+// per port, if the server accepts persistent connections
+// (see DsServerMsg::PERSISTENT_CONNECTION). Clients may also
+// request persistent connections to the proxy.
+//
+// If a target server is not running, the server manager is asked
+// to start it from a helper thread, since that blocks. The client
+// is parked until the helper wakes the loop through an eventfd.
+//
+///////////////////////////////////////////////////////////////
+
+#ifndef ProxyEventLoopINCLUDED
+#define ProxyEventLoopINCLUDED
+
+#include <toolsa/MemBuf.hh>
+#include <dsserver/DsServerMsg.hh>
+#include <netinet/in.h>
+#include <sys/time.h>
+#include <pthread.h>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+using namespace std;
+
+class DsProxyServer;
+class Params;
+
+class ProxyEventLoop {
+
+public:
+
+  // constructor - listenFd is the server's listening socket
+
+  ProxyEventLoop(DsProxyServer &server,
+                 const Params &params,
+                 int listenFd);
+
+  // destructor - closes all connections
+
+  ~ProxyEventLoop();
+
+  // Set up the event loop.
+  // Returns 0 on success, -1 on failure.
+
+  int init();
+
+  // Serve clients, returning after waitMsecs.
+  // Returns 0 on success, -1 on failure.
+
+  int run(int waitMsecs);
+
+  // number of clients connected
+
+  int getNumClients() const { return _nClients; }
+
+  // error string, on failure
+
+  const string &getErrStr() const { return _errStr; }
+
+private:
+
+  // connection state
+
+  typedef enum {
+    CLIENT_READING,   // reading request
+    CLIENT_RELAYING,  // request passed on, relaying reply
+    CLIENT_REPLYING,  // writing reply from the proxy itself
+    CLIENT_STARTING   // waiting for target server to be started
+  } client_state_t;
+
+  typedef enum {
+    UP_CONNECTING,    // waiting for connect to complete
+    UP_SENDING,       // writing handshake or request
+    UP_HANDSHAKE,     // reading persistent connection reply
+    UP_RELAYING,      // relaying reply to the client
+    UP_IDLE           // persistent, waiting for reuse
+  } upstream_state_t;
+
+  class Upstream;
+  class StartJob;
+
+  // base for connections - the epoll data points to one of these
+
+  class Conn {
+  public:
+    Conn(int fd_, bool isUpstream_);
+    virtual ~Conn() {}
+    int fd;             // -1 once closed
+    bool isUpstream;
+    unsigned int events; // epoll events registered
+    time_t lastActive;
+  };
+
+  // connection from a client
+
+  class Client : public Conn {
+  public:
+    Client(int fd_);
+    client_state_t state;
+    MemBuf inBuf;       // request as read
+    size_t httpLen;     // length of any http header on request
+    MemBuf outBuf;      // reply bytes not yet written
+    size_t outPos;      // bytes of outBuf already written
+    bool replyDone;     // all of reply is in outBuf
+    bool closeAfterReply;
+    bool persistent;
+    bool first;         // first request on connection
+    Upstream *up;       // connection request was passed to
+    StartJob *start;    // pending target server start, or NULL
+    struct timeval startTime;
+  };
+
+  // connection to a target server
+
+  class Upstream : public Conn {
+  public:
+    Upstream(int fd_, int port_, const string &urlStr_);
+    upstream_state_t state;
+    upstream_state_t afterSend; // state once outBuf is written
+    int port;
+    string urlStr;      // URL of request, to start server if needed
+    bool handshake;     // ask for persistent connection
+    bool persistent;    // server keeps connection open
+    bool reused;        // taken from the idle connections
+    bool startTried;    // server manager has been asked to start server
+    Client *client;
+    MemBuf request;     // request to send after connect/handshake
+    MemBuf outBuf;      // bytes not yet written
+    size_t outPos;
+    MemBuf inBuf;       // handshake reply
+    char hdr[32];       // start of reply, for the message length
+    size_t hdrLen;
+    si64 replyLen;      // total reply length, -1 until known
+    si64 nRelayed;      // reply bytes relayed so far
+    bool paused;        // reading paused, client is behind
+  };
+
+  // request to the server manager to start a target server,
+  // run by the helper thread. The thread only sets iret and
+  // errMsg, the rest belongs to the loop.
+
+  class StartJob {
+  public:
+    Client *client;     // NULL if the client has gone
+    int port;
+    string urlStr;
+    bool handshake;
+    MemBuf request;     // request to send once started
+    int iret;
+    string errMsg;
+  };
+
+  DsProxyServer &_server;
+  const Params &_params;
+  bool _isDebug;
+  bool _isVerbose;
+  int _listenFd;
+  int _epollFd;
+  string _errStr;
+
+  struct sockaddr_in _targetAddr;
+  int _commTimeoutMsecs;
+
+  int _nClients;
+  set<Conn *> _conns;
+  vector<Conn *> _dead;
+  map<int, vector<Upstream *> > _idle; // idle upstreams, by port
+  set<int> _refusedPorts; // no persistent connections to these ports
+  time_t _lastCheck;      // time of last timeout check
+
+  // helper thread for starting target servers
+
+  int _eventFd;                    // wakes the loop when a job is done
+  pthread_t _startThread;
+  bool _startThreadRunning;
+  pthread_mutex_t _startMutex;
+  pthread_cond_t _startCond;
+  bool _startQuit;
+  deque<StartJob *> _startQueue;   // waiting for the thread
+  deque<StartJob *> _startDone;    // done, waiting for the loop
+
+  static const size_t _readChunk;
+  static const size_t _maxBacklog;
+  static const char *_httpReplyHdr;
+
+  // events
+
+  void _accept();
+  void _handleClient(Client *cl, unsigned int events);
+  void _handleUpstream(Upstream *up, unsigned int events);
+
+  // clients
+
+  void _readClient(Client *cl);
+  void _handleRequest(Client *cl, const char *msg, size_t msgLen);
+  void _serverCommand(Client *cl, const void *data, ssize_t dataSize);
+  void _writeClient(Client *cl);
+  void _requestDone(Client *cl);
+  void _sendErrorReply(Client *cl, const string &errMsg,
+                       DsServerMsg::msgErr errType);
+  void _queueReply(Client *cl, const void *data, ssize_t dataSize);
+
+  // target servers
+
+  Upstream *_getUpstream(int port, const string &urlStr,
+                         bool handshake, string &errMsg);
+  void _passRequest(Client *cl, Upstream *up,
+                    const void *msg, size_t msgLen);
+  int _connect(int port, string &errMsg);
+  void _connectDone(Upstream *up);
+  void _startRequest(Upstream *up);
+  void _writeUpstream(Upstream *up);
+  void _readHandshake(Upstream *up);
+  void _relayReply(Upstream *up);
+  void _upstreamDone(Upstream *up);
+  void _upstreamFailed(Upstream *up, const string &errMsg,
+                       DsServerMsg::msgErr errType,
+                       bool retry, bool startServer = false);
+
+  // starting target servers
+
+  void _queueStart(Client *cl, int port, const string &urlStr,
+                   bool handshake, const void *msg, size_t msgLen,
+                   const string &errMsg);
+  void _startJobsDone();
+  void _runStartJobs();
+  static void *_startThreadMain(void *arg);
+
+  // connections
+
+  int _addConn(Conn *conn, unsigned int events);
+  void _setEvents(Conn *conn, unsigned int events);
+  void _closeConn(Conn *conn);
+  void _checkTimeouts();
+
+  static ssize_t _msgLen(const char *buf, size_t len);
+  static size_t _hdrLen(const char *buf);
+  static void _addMsg(MemBuf &buf, const void *data, size_t dataSize);
+  static int _setNonBlocking(int fd);
+
+};
+
+#endif
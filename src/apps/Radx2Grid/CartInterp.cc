@@ -62,7 +62,8 @@ CartInterp::CartInterp(const string &progName,
                params,
                readVol,
                interpFields,
-               interpRays)
+               interpRays),
+        _geomCache(params)
   
 {
   
@@ -79,6 +80,8 @@ CartInterp::CartInterp(const string &progName,
   _prevRadarLat = _prevRadarLon = _prevRadarAltKm = -9999.0;
   _gridLoc = NULL;
   _outputFields = NULL;
+  _nOutputFieldsAlloc = 0;
+  _nTilesSkipped = 0;
 
   _nContribDebug = NULL;
   _gridAzDebug = NULL;
@@ -166,7 +169,7 @@ int CartInterp::interpVol()
 
   _printRunTime("Cart interp - reading data");
 
-  if (_gridLoc == NULL) {
+  if (_gridLoc == NULL && !_params.use_tiled_interp) {
     _initGrid();
   }
 
@@ -226,13 +229,19 @@ int CartInterp::interpVol()
   _printRunTime("Filling search matrix");
   
   // compute grid locations relative to radar
+  // in tiled mode these are computed per tile during the interp
 
-  if (_params.debug) {
-    cerr << "  Computing grid relative to radar ... " << endl;
+  if (_params.use_tiled_interp) {
+    _setGridOrigin();
+    _initProjection();
+  } else {
+    if (_params.debug) {
+      cerr << "  Computing grid relative to radar ... " << endl;
+    }
+    _printRunTime("Cart interp - before _computeGridRelative");
+    _computeGridRelative();
+    _printRunTime("Computing grid relative to radar");
   }
-  _printRunTime("Cart interp - before _computeGridRelative");
-  _computeGridRelative();
-  _printRunTime("Computing grid relative to radar");
 
   // interpolate
 
@@ -319,6 +328,15 @@ void CartInterp::_createThreads()
     _threadPoolInterp.addThreadToMain(thread);
   }
 
+  // initialize thread pool for tiled interpolation
+
+  if (_params.use_tiled_interp) {
+    for (int ii = 0; ii < _params.n_compute_threads; ii++) {
+      PerformTile *thread = new PerformTile(this);
+      _threadPoolTiles.addThreadToMain(thread);
+    }
+  }
+
 }
 
 //////////////////////////////////////////////////
@@ -549,17 +567,11 @@ void CartInterp::_initGrid()
   _nPointsPlane = _gridNx * _gridNy;
   _nPointsVol = _nPointsPlane * _gridNz;
 
-  _freeGridLoc();
-  
-  _gridLoc = (GridLoc ****)
-    umalloc3(_gridNz, _gridNy, _gridNx, sizeof(GridLoc *));
+  // grid locations are held in the geometry lookup
+  // in tiled mode they are computed per tile instead
   
-  for (int iz = 0; iz < _gridNz; iz++) {
-    for (int iy = 0; iy < _gridNy; iy++) {
-      for (int ix = 0; ix < _gridNx; ix++) {
-        _gridLoc[iz][iy][ix] = new GridLoc;
-      }
-    }
+  if (!_params.use_tiled_interp) {
+    _gridLoc = _geomCache.allocGridLoc(_gridNz, _gridNy, _gridNx);
   }
 
   for (size_t ii = 0; ii < _derived3DFields.size(); ii++) {
@@ -590,19 +602,8 @@ void CartInterp::_freeGridLoc()
   
 {
   
-  if (_gridLoc) {
-    for (int iz = 0; iz < _gridNz; iz++) {
-      for (int iy = 0; iy < _gridNy; iy++) {
-        for (int ix = 0; ix < _gridNx; ix++) {
-          delete _gridLoc[iz][iy][ix];
-        }
-      }
-    }
-    ufree3((void ***) _gridLoc);
-  }
-
+  _geomCache.freeGridLoc();
   _gridLoc = NULL;
-
   _prevRadarLat = _prevRadarLon = _prevRadarAltKm = -9999.0;
 
 }
@@ -615,8 +616,15 @@ void CartInterp::_allocOutputArrays()
 {
 
   _freeOutputArrays();
-  _outputFields = (fl32 **) umalloc2(_interpFields.size(),
-                                     _nPointsVol, sizeof(fl32));
+
+  // allocate each field separately, so that fields can be
+  // released individually once written
+
+  _nOutputFieldsAlloc = _interpFields.size();
+  _outputFields = (fl32 **) umalloc(_nOutputFieldsAlloc * sizeof(fl32 *));
+  for (size_t ii = 0; ii < _nOutputFieldsAlloc; ii++) {
+    _outputFields[ii] = (fl32 *) umalloc(_nPointsVol * sizeof(fl32));
+  }
   
 }
 
@@ -627,9 +635,15 @@ void CartInterp::_freeOutputArrays()
   
 {
   if (_outputFields) {
-    ufree2((void **) _outputFields);
+    for (size_t ii = 0; ii < _nOutputFieldsAlloc; ii++) {
+      if (_outputFields[ii]) {
+        ufree(_outputFields[ii]);
+      }
+    }
+    ufree(_outputFields);
   }
   _outputFields = NULL;
+  _nOutputFieldsAlloc = 0;
 }
 
 ////////////////////////////////////////////////////////////
@@ -737,6 +751,21 @@ void CartInterp::_computeSearchLimits()
 
 }
 
+////////////////////////////////////////////////////////////
+// Set the grid origin
+
+void CartInterp::_setGridOrigin()
+
+{
+  if (_params.center_grid_on_radar) {
+    _gridOriginLat = _radarLat;
+    _gridOriginLon = _radarLon;
+  } else {
+    _gridOriginLat = _params.grid_origin_lat;
+    _gridOriginLon = _params.grid_origin_lon;
+  }
+}
+
 ////////////////////////////////////////////////////////////
 // Compute grid locations relative to radar
 
@@ -744,25 +773,35 @@ void CartInterp::_computeGridRelative()
 
 {
 
-  // check if radar has moved
+  _setGridOrigin();
 
-  if (fabs(_prevRadarLat - _radarLat) < 0.00001 &&
-      fabs(_prevRadarLon - _radarLon) < 0.00001 &&
-      fabs(_prevRadarAltKm - _radarAltKm) < 0.00001) {
-    return;
+  // check if the geometry has changed - radar location,
+  // grid, beam height model or gate geometry
+  // if not, the lookup from the previous volume is still valid
+
+  _geomCache.startKey("cart");
+  _geomCache.addToKey("radarLat", _radarLat);
+  _geomCache.addToKey("radarLon", _radarLon);
+  _geomCache.addToKey("radarAltKm", _radarAltKm);
+  _geomCache.addGridToKey(_gridOriginLat, _gridOriginLon,
+                          _gridNx, _gridNy,
+                          _gridMinx, _gridMiny,
+                          _gridDx, _gridDy,
+                          _gridZLevels);
+  if (_params.override_standard_pseudo_earth_radius) {
+    _geomCache.addToKey("pseudoRadiusRatio",
+                        _params.pseudo_earth_radius_ratio);
   }
+  _geomCache.addToKey("startRangeKm", _startRangeKm);
+  _geomCache.addToKey("gateSpacingKm", _gateSpacingKm);
 
+  if (!_geomCache.keyHasChanged()) {
+    return;
+  }
+  
   _prevRadarLat = _radarLat;
   _prevRadarLon = _radarLon;
   _prevRadarAltKm = _radarAltKm;
-  
-  if (_params.center_grid_on_radar) {
-    _gridOriginLat = _radarLat;
-    _gridOriginLon = _radarLon;
-  } else {
-    _gridOriginLat = _params.grid_origin_lat;
-    _gridOriginLon = _params.grid_origin_lon;
-  }
 
   if (_params.debug >= Params::DEBUG_VERBOSE) {
     cerr << "  _radarLat: " << _radarLat << endl;
@@ -775,6 +814,14 @@ void CartInterp::_computeGridRelative()
   // initialize the projection
 
   _initProjection();
+
+  // try the cache dir
+
+  if (_params.persist_grid_geom_cache) {
+    if (_geomCache.readFromCacheDir() == 0) {
+      return;
+    }
+  }
   
   if (_params.use_multiple_threads) {
     
@@ -792,6 +839,15 @@ void CartInterp::_computeGridRelative()
     
   }
 
+  // compute gate index and range weights
+
+  _geomCache.computeGateLookup(_startRangeKm, _gateSpacingKm);
+  _geomCache.setValid();
+
+  if (_params.persist_grid_geom_cache) {
+    _geomCache.writeToCacheDir();
+  }
+
 }
 
 //////////////////////////////////////////////////////
@@ -848,6 +904,17 @@ void CartInterp::_computeGridRelMultiThreaded()
 
 void CartInterp::_computeGridRow(int iz, int iy)
 
+{
+  _computeGridLocs(iz, iy, 0, _gridNx, _gridLoc[iz][iy][0]);
+}
+
+////////////////////////////////////////////////////////////
+// Compute grid locations for part of a row, starting at ix0,
+// for nx points. Locations are stored in locs.
+
+void CartInterp::_computeGridLocs(int iz, int iy, int ix0, int nx,
+                                  GridLoc *locs)
+
 {
 
   // initialize beamHeight computations
@@ -862,9 +929,9 @@ void CartInterp::_computeGridRow(int iz, int iy)
 
   double zz = _gridZLevels[iz];
   double yy = _gridMiny + iy * _gridDy;
-  double xx = _gridMinx;
+  double xx = _gridMinx + ix0 * _gridDx;
 
-  for (int ix = 0; ix < _gridNx; ix++, xx += _gridDx) {
+  for (int ix = 0; ix < nx; ix++, xx += _gridDx) {
     
     // get the latlon of the (x,y) point in the output grid
     
@@ -893,7 +960,7 @@ void CartInterp::_computeGridRow(int iz, int iy)
     double yyInstr = gndRange * cosAz;
     double zzInstr = zz - _radarAltKm;
 
-    GridLoc *loc = _gridLoc[iz][iy][ix];
+    GridLoc *loc = locs + ix;
     loc->el = elevDeg;
     loc->az = azimuth;
     loc->slantRange = beamHt.getSlantRangeKm();
@@ -1119,12 +1186,46 @@ void CartInterp::_fillSearchMatrix()
 
   }
      
+  _computeSearchActiveLimits();
+
   if (_params.debug >= Params::DEBUG_EXTRA) {
     _printSearchMatrix(stderr, 1);
   }
 
 }
 
+////////////////////////////////////////////////////////////
+// For each azimuth in the search matrix, compute the range of
+// elevation indices at which at least 2 of the 4 search rays
+// are available. A grid point whose search cell has fewer than
+// 2 rays is never interpolated.
+
+void CartInterp::_computeSearchActiveLimits()
+
+{
+
+  _searchActiveMinEl.assign(_searchNAz, -1);
+  _searchActiveMaxEl.assign(_searchNAz, -1);
+
+  for (int iaz = 0; iaz < _searchNAz; iaz++) {
+    for (int iel = 0; iel < _searchNEl; iel++) {
+      int nRays = 0;
+      if (_searchMatrixLowerLeft[iel][iaz].ray) nRays++;
+      if (_searchMatrixUpperLeft[iel][iaz].ray) nRays++;
+      if (_searchMatrixLowerRight[iel][iaz].ray) nRays++;
+      if (_searchMatrixUpperRight[iel][iaz].ray) nRays++;
+      if (nRays < 2) {
+        continue;
+      }
+      if (_searchActiveMinEl[iaz] < 0) {
+        _searchActiveMinEl[iaz] = iel;
+      }
+      _searchActiveMaxEl[iaz] = iel;
+    } // iel
+  } // iaz
+
+}
+
 ///////////////////////////////////////////////////////////
 // print search matrix
 
@@ -1652,7 +1753,9 @@ void CartInterp::_doInterp()
 
   // perform the interpolation
 
-  if (_params.use_multiple_threads) {
+  if (_params.use_tiled_interp) {
+    _interpTiled();
+  } else if (_params.use_multiple_threads) {
     _interpMultiThreaded();
   } else {
     _interpSingleThreaded();
@@ -1725,20 +1828,351 @@ void CartInterp::_interpMultiThreaded()
 
 }
 
+//////////////////////////////////////////////////////
+// interpolate volume in tiles
+// the tiles are processed in parallel if multiple threads
+// are in use
+
+void CartInterp::_interpTiled()
+{
+
+  _computeTiles();
+
+  if (!_params.use_multiple_threads) {
+    for (size_t ii = 0; ii < _tiles.size(); ii++) {
+      _interpTile(_tiles[ii]);
+    }
+  } else {
+
+    _threadPoolTiles.initForRun();
+    
+    for (int ii = 0; ii < (int) _tiles.size(); ii++) {
+      // get a thread from the pool
+      bool isDone = true;
+      PerformTile *thread = 
+        (PerformTile *) _threadPoolTiles.getNextThread(true, isDone);
+      if (thread == NULL) {
+        break;
+      }
+      if (isDone) {
+        // if it is a done thread, return thread to the available pool
+        _threadPoolTiles.addThreadToAvail(thread);
+        // reduce ii by 1 since we did not actually get a compute
+        // thread yet for this tile
+        ii--;
+      } else {
+        // available thread, set it running
+        thread->setTileIndex(ii);
+        thread->signalRunToStart();
+      }
+    } // ii
+    
+    // collect remaining done threads
+    
+    _threadPoolTiles.setReadyForDoneCheck();
+    while (!_threadPoolTiles.checkAllDone()) {
+      PerformTile *thread = 
+        (PerformTile *) _threadPoolTiles.getNextDoneThread();
+      if (thread == NULL) {
+        break;
+      } else {
+        _threadPoolTiles.addThreadToAvail(thread);
+      }
+    } // while
+
+  }
+
+  _nTilesSkipped = 0;
+  for (size_t ii = 0; ii < _tiles.size(); ii++) {
+    if (_tiles[ii].skipped) {
+      _nTilesSkipped++;
+    }
+  }
+
+  if (_params.debug) {
+    cerr << "  Tiled interp, nTiles, nSkipped outside scanned region: "
+         << _tiles.size() << ", " << _nTilesSkipped << endl;
+  }
+
+}
+
+//////////////////////////////////////////////////////
+// compute the tile layout
+
+void CartInterp::_computeTiles()
+{
+
+  _tiles.clear();
+
+  int tileNx = _params.interp_tile_nx;
+  int tileNy = _params.interp_tile_ny;
+  int tileNz = _params.interp_tile_nz;
+  
+  for (int iz0 = 0; iz0 < _gridNz; iz0 += tileNz) {
+    for (int iy0 = 0; iy0 < _gridNy; iy0 += tileNy) {
+      for (int ix0 = 0; ix0 < _gridNx; ix0 += tileNx) {
+        Tile tile;
+        tile.ix0 = ix0;
+        tile.iy0 = iy0;
+        tile.iz0 = iz0;
+        tile.nx = MIN(tileNx, _gridNx - ix0);
+        tile.ny = MIN(tileNy, _gridNy - iy0);
+        tile.nz = MIN(tileNz, _gridNz - iz0);
+        tile.skipped = false;
+        _tiles.push_back(tile);
+      } // ix0
+    } // iy0
+  } // iz0
+
+}
+
+//////////////////////////////////////////////////////
+// check if a tile lies entirely beyond the max range
+// of the radar, in which case no rays can contribute
+
+bool CartInterp::_tileIsBeyondMaxRange(const Tile &tile)
+{
+
+  // find the point in the tile closest to the radar,
+  // in grid coords
+
+  double minx = _gridMinx + tile.ix0 * _gridDx;
+  double maxx = _gridMinx + (tile.ix0 + tile.nx - 1) * _gridDx;
+  double miny = _gridMiny + tile.iy0 * _gridDy;
+  double maxy = _gridMiny + (tile.iy0 + tile.ny - 1) * _gridDy;
+
+  double xx = MAX(minx, MIN(maxx, _radarX));
+  double yy = MAX(miny, MIN(maxy, _radarY));
+  if (xx == _radarX && yy == _radarY) {
+    // radar is inside tile
+    return false;
+  }
+
+  // compute the ground range to that point
+  
+  double lat, lon;
+  _proj.xy2latlon(xx, yy, lat, lon);
+  double gndRange, azimuth;
+  PJGLatLon2RTheta(_radarLat, _radarLon, lat, lon, &gndRange, &azimuth);
+
+  // allow a margin of 2 grid cells for the distortion of the
+  // projection between grid coords and range
+
+  double lat2, lon2;
+  _proj.xy2latlon(xx + _gridDx, yy + _gridDy, lat2, lon2);
+  double cellKm, cellAz;
+  PJGLatLon2RTheta(lat, lon, lat2, lon2, &cellKm, &cellAz);
+  
+  if (gndRange - 2.0 * cellKm > _maxRangeKm) {
+    return true;
+  }
+
+  return false;
+
+}
+
+//////////////////////////////////////////////////////
+// check if a tile lies entirely outside the azimuth and
+// elevation region covered by rays in the search matrix,
+// in which case no grid point in the tile can be interpolated.
+// The az/el limits of the tile are padded, so the test is
+// conservative.
+
+bool CartInterp::_tileIsOutsideScan(const Tile &tile)
+{
+
+  double minx = _gridMinx + tile.ix0 * _gridDx;
+  double maxx = _gridMinx + (tile.ix0 + tile.nx - 1) * _gridDx;
+  double miny = _gridMiny + tile.iy0 * _gridDy;
+  double maxy = _gridMiny + (tile.iy0 + tile.ny - 1) * _gridDy;
+
+  // allow a margin of 2 grid cells for the distortion of the
+  // projection between grid coords and range/azimuth
+
+  double lat, lon, lat2, lon2;
+  _proj.xy2latlon(minx, miny, lat, lon);
+  _proj.xy2latlon(minx + _gridDx, miny + _gridDy, lat2, lon2);
+  double cellKm, cellAz;
+  PJGLatLon2RTheta(lat, lon, lat2, lon2, &cellKm, &cellAz);
+  double marginKm = 2.0 * cellKm;
+
+  // ground range to the closest point in the tile, and
+  // azimuth and range of the corners
+
+  double xx = MAX(minx, MIN(maxx, _radarX));
+  double yy = MAX(miny, MIN(maxy, _radarY));
+  double gndRange, azimuth;
+  _proj.xy2latlon(xx, yy, lat, lon);
+  PJGLatLon2RTheta(_radarLat, _radarLon, lat, lon, &gndRange, &azimuth);
+  double minRange = MAX(0.0, gndRange - marginKm);
+
+  double cornerX[4] = { minx, maxx, minx, maxx };
+  double cornerY[4] = { miny, miny, maxy, maxy };
+  double cornerAz[4];
+  double maxRange = 0.0;
+  for (int ii = 0; ii < 4; ii++) {
+    _proj.xy2latlon(cornerX[ii], cornerY[ii], lat, lon);
+    PJGLatLon2RTheta(_radarLat, _radarLon, lat, lon, &gndRange, &azimuth);
+    cornerAz[ii] = azimuth;
+    maxRange = MAX(maxRange, gndRange);
+  }
+  maxRange += marginKm;
+
+  // elevation limits
+  // Elevation increases with height. Above the radar it decreases
+  // with range. Below the radar it is negative, and lowest at one
+  // end of the range interval.
+
+  double minZ = _gridZLevels[tile.iz0];
+  double maxZ = minZ;
+  for (int iz = tile.iz0; iz < tile.iz0 + tile.nz; iz++) {
+    minZ = MIN(minZ, _gridZLevels[iz]);
+    maxZ = MAX(maxZ, _gridZLevels[iz]);
+  }
+
+  BeamHeight beamHt;
+  if (_params.override_standard_pseudo_earth_radius) {
+    beamHt.setPseudoRadiusRatio(_params.pseudo_earth_radius_ratio);
+  }
+  beamHt.setInstrumentHtKm(_radarAltKm);
+
+  double minEl = MIN(beamHt.computeElevationDeg(minZ, minRange),
+                     beamHt.computeElevationDeg(minZ, maxRange));
+  double maxEl = beamHt.computeElevationDeg(maxZ, minRange);
+  if (maxZ < _radarAltKm) {
+    maxEl = MAX(maxEl, 0.0);
+  }
+  minEl -= _searchResEl;
+  maxEl += _searchResEl;
+
+  int minIel = (int) floor((minEl - _searchMinEl) / _searchResEl + 0.5);
+  int maxIel = (int) floor((maxEl - _searchMinEl) / _searchResEl + 0.5);
+  minIel = MAX(minIel, 0);
+  maxIel = MIN(maxIel, _searchNEl - 1);
+  if (minIel > maxIel) {
+    // tile is entirely above or below the scan
+    return true;
+  }
+
+  // azimuth limits
+  // If the radar is in or close to the tile, use all azimuths.
+  // Otherwise the tile lies within the azimuths of the corners,
+  // padded by the margin.
+
+  double startAz = 0.0;
+  double endAz = 360.0;
+  if (minRange > 0.0) {
+    double minDelta = 0.0;
+    double maxDelta = 0.0;
+    for (int ii = 1; ii < 4; ii++) {
+      double delta = cornerAz[ii] - cornerAz[0];
+      if (delta > 180.0) {
+        delta -= 360.0;
+      } else if (delta <= -180.0) {
+        delta += 360.0;
+      }
+      minDelta = MIN(minDelta, delta);
+      maxDelta = MAX(maxDelta, delta);
+    }
+    double marginAz = (marginKm / minRange) * RAD_TO_DEG + _searchResAz;
+    if (maxDelta - minDelta + 2.0 * marginAz < 360.0) {
+      startAz = cornerAz[0] + minDelta - marginAz;
+      endAz = cornerAz[0] + maxDelta + marginAz;
+    }
+  }
+
+  // check the search matrix across the tile azimuths, stepping
+  // at half the search resolution so that no index is missed
+
+  double azStep = _searchResAz / 2.0;
+  for (double az = startAz; az <= endAz + azStep; az += azStep) {
+    double gridAz = fmod(az, 360.0);
+    if (gridAz < 0) {
+      gridAz += 360.0;
+    }
+    int iaz = _getSearchAzIndex(_conditionAz(gridAz));
+    if (iaz < 0 || _searchActiveMinEl[iaz] < 0) {
+      continue;
+    }
+    if (_searchActiveMinEl[iaz] <= maxIel &&
+        _searchActiveMaxEl[iaz] >= minIel) {
+      return false;
+    }
+  }
+
+  return true;
+
+}
+
+//////////////////////////////////////////////////////
+// interpolate a single tile
+// The grid locations and gate lookup are computed one row
+// at a time, so the working memory is small.
+
+void CartInterp::_interpTile(Tile &tile)
+{
+
+  // if the debug fields are active we fill all points,
+  // otherwise tiles beyond max range, or outside the
+  // scanned azimuths and elevations, are left as missing
+
+  if (!_params.output_debug_fields &&
+      (_tileIsBeyondMaxRange(tile) || _tileIsOutsideScan(tile))) {
+    tile.skipped = true;
+    return;
+  }
+
+  vector<GridLoc> locs(tile.nx);
+  vector<int> gateInner(tile.nx);
+  vector<double> wtOuter(tile.nx);
+  
+  for (int iz = tile.iz0; iz < tile.iz0 + tile.nz; iz++) {
+    for (int iy = tile.iy0; iy < tile.iy0 + tile.ny; iy++) {
+      _computeGridLocs(iz, iy, tile.ix0, tile.nx, locs.data());
+      GridGeomCache::computeGateLookup(locs.data(), tile.nx,
+                                       _startRangeKm, _gateSpacingKm,
+                                       gateInner.data(), wtOuter.data());
+      _interpRowLocs(iz, iy, tile.ix0, tile.nx, locs.data(),
+                     gateInner.data(), wtOuter.data());
+    } // iy
+  } // iz
+
+}
+
 ////////////////////////////////////////////////////////////
-// Interpolate a row at a time
+// Interpolate a row at a time, using the geometry lookup
 
 void CartInterp::_interpRow(int iz, int iy)
 
 {
 
   int ptIndex = iz * _nPointsPlane + iy * _gridNx;
+  _interpRowLocs(iz, iy, 0, _gridNx,
+                 _gridLoc[iz][iy][0],
+                 _geomCache.getGateInnerArray() + ptIndex,
+                 _geomCache.getWtOuterArray() + ptIndex);
+
+}
+
+////////////////////////////////////////////////////////////
+// Interpolate part of a row, starting at ix0, for nx points.
+// The grid locations and gate lookup are passed in for the
+// points in the row segment.
+
+void CartInterp::_interpRowLocs(int iz, int iy, int ix0, int nx,
+                                const GridLoc *locs,
+                                const int *rowGateInner,
+                                const double *rowWtOuter)
+
+{
 
-  for (int ix = 0; ix < _gridNx; ix++, ptIndex++) {
+  int ptIndex = iz * _nPointsPlane + iy * _gridNx + ix0;
+
+  for (int ix = 0; ix < nx; ix++, ptIndex++) {
 
     // get the grid location
 
-    const GridLoc *loc = _gridLoc[iz][iy][ix];
+    const GridLoc *loc = locs + ix;
     
     if (_gridAzDebug) {
       _gridAzDebug->data[ptIndex] = loc->az;
@@ -1982,11 +2416,9 @@ void CartInterp::_interpRow(int iz, int iy)
 
     // get gate indices, compute weights based on range
 
-    double rangeKm = loc->slantRange;
-    double dgate = (rangeKm - _startRangeKm) / _gateSpacingKm;
-    int igateInner = (int) floor(dgate);
+    int igateInner = rowGateInner[ix];
     int igateOuter = igateInner + 1;
-    double wtOuter = dgate - igateInner;
+    double wtOuter = rowWtOuter[ix];
     double wtInner = 1.0 - wtOuter;
     Neighbors wts;
 
@@ -2444,6 +2876,12 @@ int CartInterp::_writeOutputFile()
                  ifld.inputOffset,
                  missingFl32,
                  _outputFields[ifield]);
+    if (_params.use_tiled_interp) {
+      // the field has been copied into the output object,
+      // so release it now to limit peak memory
+      ufree(_outputFields[ifield]);
+      _outputFields[ifield] = NULL;
+    }
   } // ifield
 
   // debug (test) fields
@@ -3301,6 +3739,20 @@ void CartInterp::PerformInterp::run()
   _this->_interpRow(_zIndex, _yIndex);
 }
 
+///////////////////////////////////////////////////////////////
+// PerformTile thread
+///////////////////////////////////////////////////////////////
+// Constructor
+CartInterp::PerformTile::PerformTile(CartInterp *obj) :
+        _this(obj)
+{
+}  
+// run method
+void CartInterp::PerformTile::run()
+{
+  _this->_interpTile(_this->_tiles[_tileIndex]);
+}
+
 #ifdef JUNK
 
 ///////////////////////////////////////////////////////////////
@@ -37,6 +37,7 @@
 #define CartInterp_HH
 
 #include "Interp.hh"
+#include "GridGeomCache.hh"
 #include <toolsa/TaThread.hh>
 #include <toolsa/TaThreadPool.hh>
 #include <radar/ConvStrat.hh>
@@ -136,6 +137,14 @@ private:
   double _searchRadiusAz;
   int _searchMaxDistAz;
 
+  // for each search azimuth index, the range of elevation
+  // indices with at least 2 rays in the search matrix.
+  // Used to skip tiles outside the scanned region.
+  // Set to -1 if there are no rays at that azimuth.
+
+  vector<int> _searchActiveMinEl;
+  vector<int> _searchActiveMaxEl;
+
   // class for neighboring points
 
   class Neighbors {
@@ -188,6 +197,25 @@ private:
   ConvStrat _convStrat;
   bool _gotConvStrat;
 
+  // geometry lookup for grid relative to radar
+
+  GridGeomCache _geomCache;
+
+  // number of output fields allocated
+
+  size_t _nOutputFieldsAlloc;
+
+  // tiles for tiled interpolation
+
+  class Tile {
+  public:
+    int ix0, iy0, iz0; // start indices
+    int nx, ny, nz;    // tile dimensions
+    bool skipped;      // no rays can contribute, not interpolated
+  };
+  vector<Tile> _tiles;
+  int _nTilesSkipped;
+
 #ifdef JUNK
   typedef enum {
     CATEGORY_MISSING = 0,
@@ -241,14 +269,17 @@ private:
   
   void _computeSearchLimits();
   
+  void _setGridOrigin();
   void _computeGridRelative();
   void _computeGridRelMultiThreaded();
   void _computeGridRow(int iz, int iy);
+  void _computeGridLocs(int iz, int iy, int ix0, int nx, GridLoc *locs);
 
   void _allocSearchMatrix();
   void _freeSearchMatrix();
   void _initSearchMatrix();
   void _fillSearchMatrix();
+  void _computeSearchActiveLimits();
   void _printSearchMatrix(FILE *out, int res);
   void _printSearchMatrixPoint(FILE *out, int iel, int iaz);
 
@@ -282,6 +313,16 @@ private:
   void _interpSingleThreaded();
   void _interpMultiThreaded();
   void _interpRow(int iz, int iy);
+  void _interpRowLocs(int iz, int iy, int ix0, int nx,
+                      const GridLoc *locs,
+                      const int *rowGateInner,
+                      const double *rowWtOuter);
+
+  void _computeTiles();
+  bool _tileIsBeyondMaxRange(const Tile &tile);
+  bool _tileIsOutsideScan(const Tile &tile);
+  void _interpTiled();
+  void _interpTile(Tile &tile);
 
   void _loadWtsFor2ValidRays(const GridLoc *loc,
                              const SearchPoint &ll,
@@ -464,6 +505,25 @@ private:
   // instantiate thread pool for interpolation
   TaThreadPool _threadPoolInterp;
 
+  //////////////////////////////////////////////////////////////
+  // inner thread class for interpolating a tile
+  
+  class PerformTile : public TaThread
+  {  
+  public:
+    // constructor
+    PerformTile(CartInterp *obj);
+    // set the tile index
+    inline void setTileIndex(int tileIndex) { _tileIndex = tileIndex; }
+    // override run method
+    virtual void run();
+  private:
+    CartInterp *_this; // context
+    int _tileIndex; // index into _tiles
+  };
+  // instantiate thread pool for tiled interpolation
+  TaThreadPool _threadPoolTiles;
+
 #ifdef JUNK
 
   //////////////////////////////////////////////////////////////
@@ -0,0 +1,463 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// GridGeomCache.cc
+///////////////////////////////////////////////////////////////
+//
+// Geometry lookup for the output grid, relative to the radar.
+//
+///////////////////////////////////////////////////////////////
+
+#include "GridGeomCache.hh"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <toolsa/mem.h>
+#include <toolsa/file_io.h>
+using namespace std;
+
+const char *GridGeomCache::_magic = "Radx2GridGeomCache";
+const int GridGeomCache::_version = 1;
+const long long GridGeomCache::_maxVecLen = 1000000000LL;
+
+//////////////////////////////////////
+// constructor
+
+GridGeomCache::GridGeomCache(const Params &params) :
+        _params(params)
+{
+  _valid = false;
+  _nz = _ny = _nx = 0;
+  _gridLoc = NULL;
+}
+
+//////////////////////////////////////
+// destructor
+
+GridGeomCache::~GridGeomCache()
+{
+  freeGridLoc();
+}
+
+//////////////////////////////////////
+// build up the geometry key
+
+void GridGeomCache::startKey(const string &mode)
+{
+  _key = "mode=";
+  _key += mode;
+  _key += ";";
+}
+
+void GridGeomCache::addToKey(const string &label, double val)
+{
+  char text[128];
+  snprintf(text, sizeof(text), "%s=%.6f;", label.c_str(), val);
+  _key += text;
+}
+
+void GridGeomCache::addToKey(const string &label, int val)
+{
+  char text[128];
+  snprintf(text, sizeof(text), "%s=%d;", label.c_str(), val);
+  _key += text;
+}
+
+void GridGeomCache::addToKey(const string &label,
+                             const vector<double> &vals)
+{
+  addToKey(label + "_n", (int) vals.size());
+  for (size_t ii = 0; ii < vals.size(); ii++) {
+    char text[128];
+    snprintf(text, sizeof(text), "%.4f,", vals[ii]);
+    _key += text;
+  }
+  _key += ";";
+}
+
+//////////////////////////////////////
+// add the output grid and projection details to the key
+
+void GridGeomCache::addGridToKey(double originLat, double originLon,
+                                 int nx, int ny,
+                                 double minx, double miny,
+                                 double dx, double dy,
+                                 const vector<double> &zLevels)
+{
+
+  addToKey("proj", (int) _params.grid_projection);
+  addToKey("originLat", originLat);
+  addToKey("originLon", originLon);
+  addToKey("rotation", _params.grid_rotation);
+  addToKey("lat1", _params.grid_lat1);
+  addToKey("lat2", _params.grid_lat2);
+  addToKey("tangentLat", _params.grid_tangent_lat);
+  addToKey("tangentLon", _params.grid_tangent_lon);
+  addToKey("poleIsNorth", (int) _params.grid_pole_is_north);
+  addToKey("centralScale", _params.grid_central_scale);
+  addToKey("perspRadius", _params.grid_persp_radius);
+  if (_params.grid_set_offset_origin) {
+    addToKey("offsetOriginLat", _params.grid_offset_origin_latitude);
+    addToKey("offsetOriginLon", _params.grid_offset_origin_longitude);
+  } else {
+    addToKey("falseNorthing", _params.grid_false_northing);
+    addToKey("falseEasting", _params.grid_false_easting);
+  }
+
+  addToKey("nx", nx);
+  addToKey("ny", ny);
+  addToKey("minx", minx);
+  addToKey("miny", miny);
+  addToKey("dx", dx);
+  addToKey("dy", dy);
+  addToKey("zLevels", zLevels);
+
+}
+
+//////////////////////////////////////
+// check if the key has changed since the lookup was computed
+// if so, the lookup is marked invalid
+
+bool GridGeomCache::keyHasChanged()
+{
+  if (_valid && _key == _validKey) {
+    return false;
+  }
+  _valid = false;
+  return true;
+}
+
+//////////////////////////////////////
+// allocate the grid locations in a contiguous block
+
+GridGeomCache::GridLoc ****GridGeomCache::allocGridLoc(int nz, int ny, int nx)
+{
+
+  if (_gridLoc != NULL && nz == _nz && ny == _ny && nx == _nx) {
+    // reuse existing block
+    return _gridLoc;
+  }
+
+  freeGridLoc();
+
+  _nz = nz;
+  _ny = ny;
+  _nx = nx;
+  _locs.resize((size_t) nz * ny * nx);
+  
+  _gridLoc = (GridLoc ****) umalloc3(nz, ny, nx, sizeof(GridLoc *));
+  GridLoc *loc = _locs.data();
+  for (int iz = 0; iz < nz; iz++) {
+    for (int iy = 0; iy < ny; iy++) {
+      for (int ix = 0; ix < nx; ix++, loc++) {
+        _gridLoc[iz][iy][ix] = loc;
+      }
+    }
+  }
+
+  return _gridLoc;
+
+}
+
+//////////////////////////////////////
+// free the grid locations and invalidate the lookup
+
+void GridGeomCache::freeGridLoc()
+{
+
+  if (_gridLoc) {
+    ufree3((void ***) _gridLoc);
+    _gridLoc = NULL;
+  }
+
+  vector<GridLoc>().swap(_locs);
+  vector<int>().swap(_gateInner);
+  vector<double>().swap(_wtOuter);
+  _nz = _ny = _nx = 0;
+  _valid = false;
+  _validKey.clear();
+
+}
+
+//////////////////////////////////////
+// compute the gate lookup from the grid location slant ranges
+
+void GridGeomCache::computeGateLookup(double startRangeKm,
+                                      double gateSpacingKm)
+{
+
+  size_t nPts = _locs.size();
+  _gateInner.resize(nPts);
+  _wtOuter.resize(nPts);
+  computeGateLookup(_locs.data(), nPts, startRangeKm, gateSpacingKm,
+                    _gateInner.data(), _wtOuter.data());
+
+}
+
+//////////////////////////////////////
+// compute the gate lookup for an array of grid locations
+
+void GridGeomCache::computeGateLookup(const GridLoc *locs, size_t nPts,
+                                      double startRangeKm,
+                                      double gateSpacingKm,
+                                      int *gateInner, double *wtOuter)
+{
+  for (size_t ii = 0; ii < nPts; ii++) {
+    double dgate = (locs[ii].slantRange - startRangeKm) / gateSpacingKm;
+    int igateInner = (int) floor(dgate);
+    gateInner[ii] = igateInner;
+    wtOuter[ii] = dgate - igateInner;
+  }
+}
+
+//////////////////////////////////////
+// set the 1-D azimuth lookup
+
+void GridGeomCache::setAzLookup(const vector<double> &az,
+                                const vector<int> &searchIndex)
+{
+  _azLookup = az;
+  _azSearchIndex = searchIndex;
+}
+
+//////////////////////////////////////
+// get the path for the current key
+
+string GridGeomCache::getCachePath() const
+{
+  char name[128];
+  snprintf(name, sizeof(name), "radx2grid_geom_%016llx.cache",
+           _hashKey(_key));
+  string path(_params.grid_geom_cache_dir);
+  path += PATH_DELIM;
+  path += name;
+  return path;
+}
+
+//////////////////////////////////////
+// write the lookup to the cache dir
+// returns 0 on success, -1 on failure
+
+int GridGeomCache::writeToCacheDir()
+{
+
+  if (!_valid) {
+    return -1;
+  }
+  
+  if (ta_makedir_recurse(_params.grid_geom_cache_dir)) {
+    int errNum = errno;
+    cerr << "ERROR - GridGeomCache::writeToCacheDir" << endl;
+    cerr << "  Cannot create cache dir: " << _params.grid_geom_cache_dir << endl;
+    cerr << "  " << strerror(errNum) << endl;
+    return -1;
+  }
+
+  // write to tmp file, then rename, so that other instances never
+  // see a partial file
+
+  string path = getCachePath();
+  char tmpPath[MAX_PATH_LEN];
+  snprintf(tmpPath, sizeof(tmpPath), "%s.tmp.%d", path.c_str(), getpid());
+
+  FILE *out = fopen(tmpPath, "wb");
+  if (out == NULL) {
+    int errNum = errno;
+    cerr << "ERROR - GridGeomCache::writeToCacheDir" << endl;
+    cerr << "  Cannot open file for writing: " << tmpPath << endl;
+    cerr << "  " << strerror(errNum) << endl;
+    return -1;
+  }
+
+  int iret = 0;
+  
+  int magicLen = strlen(_magic);
+  int keyLen = _key.size();
+  int locSize = sizeof(GridLoc);
+  int dims[3] = { _nz, _ny, _nx };
+  
+  if (fwrite(_magic, 1, magicLen, out) != (size_t) magicLen ||
+      fwrite(&_version, sizeof(int), 1, out) != 1 ||
+      fwrite(&keyLen, sizeof(int), 1, out) != 1 ||
+      fwrite(_key.c_str(), 1, keyLen, out) != (size_t) keyLen ||
+      fwrite(&locSize, sizeof(int), 1, out) != 1 ||
+      fwrite(dims, sizeof(int), 3, out) != 3 ||
+      _writeVec(out, _locs) ||
+      _writeVec(out, _gateInner) ||
+      _writeVec(out, _wtOuter) ||
+      _writeVec(out, _azLookup) ||
+      _writeVec(out, _azSearchIndex)) {
+    iret = -1;
+  }
+
+  if (fclose(out)) {
+    iret = -1;
+  }
+
+  if (iret) {
+    cerr << "ERROR - GridGeomCache::writeToCacheDir" << endl;
+    cerr << "  Cannot write file: " << tmpPath << endl;
+    unlink(tmpPath);
+    return -1;
+  }
+
+  if (rename(tmpPath, path.c_str())) {
+    int errNum = errno;
+    cerr << "ERROR - GridGeomCache::writeToCacheDir" << endl;
+    cerr << "  Cannot rename tmp file: " << tmpPath << endl;
+    cerr << "                 to file: " << path << endl;
+    cerr << "  " << strerror(errNum) << endl;
+    unlink(tmpPath);
+    return -1;
+  }
+
+  if (_params.debug) {
+    cerr << "  Wrote grid geom cache file: " << path << endl;
+  }
+
+  return 0;
+
+}
+
+//////////////////////////////////////
+// read the lookup from the cache dir
+// The grid locations must already have been allocated
+// with the dimensions for the current key.
+// returns 0 on success, -1 on failure
+
+int GridGeomCache::readFromCacheDir()
+{
+
+  string path = getCachePath();
+  FILE *in = fopen(path.c_str(), "rb");
+  if (in == NULL) {
+    // not yet cached
+    return -1;
+  }
+
+  // check the header
+
+  int magicLen = strlen(_magic);
+  vector<char> magic(magicLen);
+  int version = 0, keyLen = 0, locSize = 0;
+  int dims[3] = { 0, 0, 0 };
+  
+  if (fread(magic.data(), 1, magicLen, in) != (size_t) magicLen ||
+      memcmp(magic.data(), _magic, magicLen) != 0 ||
+      fread(&version, sizeof(int), 1, in) != 1 ||
+      version != _version ||
+      fread(&keyLen, sizeof(int), 1, in) != 1 ||
+      keyLen != (int) _key.size()) {
+    fclose(in);
+    return -1;
+  }
+
+  vector<char> key(keyLen);
+  if (fread(key.data(), 1, keyLen, in) != (size_t) keyLen ||
+      memcmp(key.data(), _key.c_str(), keyLen) != 0 ||
+      fread(&locSize, sizeof(int), 1, in) != 1 ||
+      locSize != (int) sizeof(GridLoc) ||
+      fread(dims, sizeof(int), 3, in) != 3 ||
+      dims[0] != _nz || dims[1] != _ny || dims[2] != _nx) {
+    // hash collision or stale file
+    fclose(in);
+    return -1;
+  }
+
+  // read the arrays
+
+  vector<GridLoc> locs;
+  if (_readVec(in, locs) ||
+      locs.size() != _locs.size() ||
+      _readVec(in, _gateInner) ||
+      _readVec(in, _wtOuter) ||
+      _readVec(in, _azLookup) ||
+      _readVec(in, _azSearchIndex)) {
+    cerr << "WARNING - GridGeomCache::readFromCacheDir" << endl;
+    cerr << "  Bad cache file, ignoring: " << path << endl;
+    fclose(in);
+    return -1;
+  }
+  fclose(in);
+
+  // copy locs into the existing block, so that the
+  // pointer table remains valid
+
+  std::copy(locs.begin(), locs.end(), _locs.begin());
+  setValid();
+
+  if (_params.debug) {
+    cerr << "  Read grid geom cache file: " << path << endl;
+  }
+
+  return 0;
+
+}
+
+//////////////////////////////////////
+// FNV-1a hash of the key, for the file name
+
+unsigned long long GridGeomCache::_hashKey(const string &key) const
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  for (size_t ii = 0; ii < key.size(); ii++) {
+    hash ^= (unsigned char) key[ii];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+//////////////////////////////////////
+// write / read a vector, preceded by its length
+// returns 0 on success, -1 on failure
+
+template <class T>
+int GridGeomCache::_writeVec(FILE *out, const vector<T> &vec)
+{
+  long long nn = vec.size();
+  if (fwrite(&nn, sizeof(nn), 1, out) != 1) {
+    return -1;
+  }
+  if (nn > 0 && fwrite(vec.data(), sizeof(T), nn, out) != (size_t) nn) {
+    return -1;
+  }
+  return 0;
+}
+
+template <class T>
+int GridGeomCache::_readVec(FILE *in, vector<T> &vec)
+{
+  long long nn = 0;
+  if (fread(&nn, sizeof(nn), 1, in) != 1 || nn < 0 || nn > _maxVecLen) {
+    return -1;
+  }
+  vec.resize(nn);
+  if (nn > 0 && fread(vec.data(), sizeof(T), nn, in) != (size_t) nn) {
+    return -1;
+  }
+  return 0;
+}
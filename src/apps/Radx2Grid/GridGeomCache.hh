@@ -0,0 +1,195 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// GridGeomCache.hh
+//
+// Geometry lookup for the output grid, relative to the radar.
+//
+///////////////////////////////////////////////////////////////
+//
+// Holds the location of each output grid point relative to the
+// radar (az, el, slant range etc.), plus the gate index and range
+// weight derived from it. The lookup is computed once for a given
+// geometry key - radar location, output grid, sweep angles and
+// gate geometry - and reused for subsequent volumes until the key
+// changes.
+//
+// The grid locations are stored in a single contiguous block,
+// addressed through the GridLoc **** table used by the
+// interpolators.
+//
+// Optionally, the lookup is persisted to a cache directory, so that
+// a restart with the same geometry does not need to recompute it.
+// The cache files are in native byte order and are intended for
+// use on the host which wrote them.
+//
+///////////////////////////////////////////////////////////////
+
+#ifndef GridGeomCache_HH
+#define GridGeomCache_HH
+
+#include "Interp.hh"
+#include <string>
+#include <vector>
+using namespace std;
+
+class GridGeomCache {
+  
+public:
+
+  typedef Interp::GridLoc GridLoc;
+
+  // constructor
+  
+  GridGeomCache(const Params &params);
+  
+  // destructor
+  
+  ~GridGeomCache();
+
+  // build up the geometry key
+  // call startKey(), then addToKey() for each item,
+  // then keyHasChanged() to compare against the current lookup
+
+  void startKey(const string &mode);
+  void addToKey(const string &label, double val);
+  void addToKey(const string &label, int val);
+  void addToKey(const string &label, const vector<double> &vals);
+
+  // add the output grid and projection details to the key
+
+  void addGridToKey(double originLat, double originLon,
+                    int nx, int ny,
+                    double minx, double miny,
+                    double dx, double dy,
+                    const vector<double> &zLevels);
+
+  // check if the key has changed since the lookup was computed
+  // if so, the lookup is marked invalid
+
+  bool keyHasChanged();
+
+  // is the lookup valid for the current key?
+
+  bool isValid() const { return _valid; }
+  
+  // mark the lookup as valid for the current key
+
+  void setValid() { _valid = true; _validKey = _key; }
+
+  // allocate the grid locations in a contiguous block
+  // returns the [nz][ny][nx] pointer table
+  // the table remains owned by this object
+
+  GridLoc ****allocGridLoc(int nz, int ny, int nx);
+
+  // free the grid locations and invalidate the lookup
+
+  void freeGridLoc();
+
+  // compute the gate lookup from the grid location slant ranges
+
+  void computeGateLookup(double startRangeKm, double gateSpacingKm);
+
+  // get the inner gate index and outer gate weight for a point
+  // ptIndex = iz * ny * nx + iy * nx + ix
+
+  inline int getGateInner(size_t ptIndex) const {
+    return _gateInner[ptIndex];
+  }
+  inline double getWtOuter(size_t ptIndex) const {
+    return _wtOuter[ptIndex];
+  }
+  const int *getGateInnerArray() const { return _gateInner.data(); }
+  const double *getWtOuterArray() const { return _wtOuter.data(); }
+
+  // compute the gate lookup for an array of grid locations
+  // gateInner and wtOuter must have space for nPts
+
+  static void computeGateLookup(const GridLoc *locs, size_t nPts,
+                                double startRangeKm, double gateSpacingKm,
+                                int *gateInner, double *wtOuter);
+
+  // 1-D azimuth lookup, for the polar interpolation
+  // az is the conditioned azimuth, searchIndex is the index
+  // into the search matrix
+
+  void setAzLookup(const vector<double> &az,
+                   const vector<int> &searchIndex);
+  const vector<double> &getAzLookup() const { return _azLookup; }
+  const vector<int> &getAzSearchIndex() const { return _azSearchIndex; }
+
+  // read / write the lookup from / to the cache dir
+  // returns 0 on success, -1 on failure
+  
+  int readFromCacheDir();
+  int writeToCacheDir();
+
+  // get the path for the current key
+
+  string getCachePath() const;
+  
+protected:
+private:
+
+  static const char *_magic;
+  static const int _version;
+  static const long long _maxVecLen; // sanity check on read
+
+  const Params &_params;
+
+  // key
+
+  string _key;
+  string _validKey;
+  bool _valid;
+
+  // grid locations
+
+  int _nz, _ny, _nx;
+  vector<GridLoc> _locs;
+  GridLoc ****_gridLoc;
+
+  // gate lookup
+
+  vector<int> _gateInner;
+  vector<double> _wtOuter;
+
+  // azimuth lookup
+
+  vector<double> _azLookup;
+  vector<int> _azSearchIndex;
+
+  // methods
+
+  unsigned long long _hashKey(const string &key) const;
+
+  template <class T>
+  static int _writeVec(FILE *out, const vector<T> &vec);
+  template <class T>
+  static int _readVec(FILE *in, vector<T> &vec);
+
+};
+
+#endif
@@ -2838,6 +2838,102 @@
     memset(tt, 0, sizeof(TDRPtable));
     tt->ptype = COMMENT_TYPE;
     tt->param_name = tdrpStrDup("Comment 34");
+    tt->comment_hdr = tdrpStrDup("GRID GEOMETRY CACHE");
+    tt->comment_text = tdrpStrDup("For CART, PPI and POLAR interpolation, the location of each grid point relative to the radar (azimuth, elevation, range, gate index and range weight) is held in a geometry lookup. The lookup is keyed on the radar location, the output grid and projection, the sweep angles or Z levels, and the gate geometry. It is reused for successive volumes while the key does not change.");
+    tt++;
+    
+    // Parameter 'persist_grid_geom_cache'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("persist_grid_geom_cache");
+    tt->descr = tdrpStrDup("Option to persist the grid geometry lookup in a cache directory.");
+    tt->help = tdrpStrDup("If true, each geometry lookup is written to grid_geom_cache_dir, in a file named from a hash of the geometry key. On startup, or after the lookup has been freed, the lookup is read back from this file if the key matches, rather than being recomputed. This avoids the setup cost on restart for large grids. Cache files are in native byte order.");
+    tt->val_offset = (char *) &persist_grid_geom_cache - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'grid_geom_cache_dir'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("grid_geom_cache_dir");
+    tt->descr = tdrpStrDup("Directory for grid geometry cache files.");
+    tt->help = tdrpStrDup("See persist_grid_geom_cache.");
+    tt->val_offset = (char *) &grid_geom_cache_dir - &_start_;
+    tt->single_val.s = tdrpStrDup("/tmp/Radx2Grid/geom_cache");
+    tt++;
+    
+    // Parameter 'Comment 35'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 35");
+    tt->comment_hdr = tdrpStrDup("TILED INTERPOLATION FOR LARGE GRIDS");
+    tt->comment_text = tdrpStrDup("CART mode only. For very large output grids, such as national mosaics at 1 km resolution, the memory needed for the grid geometry lookup (about 80 bytes per grid point) can exceed the available memory. In tiled mode the output grid is processed in (x,y,z) tiles. The grid geometry is computed one row at a time within each tile, and is not retained, so the working memory is proportional to the tile size rather than the domain size. Tiles which lie entirely beyond the maximum range of the radar, or entirely outside the azimuths and elevations covered by the scan, are skipped unless output_debug_fields is set. Each output field is released as soon as it has been added to the output file object. When using multiple threads, the tiles are processed in parallel.");
+    tt++;
+    
+    // Parameter 'use_tiled_interp'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("use_tiled_interp");
+    tt->descr = tdrpStrDup("Option to interpolate the CART grid in tiles.");
+    tt->help = tdrpStrDup("See above. In tiled mode the grid geometry cache is not used, since the geometry is not retained between volumes.");
+    tt->val_offset = (char *) &use_tiled_interp - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'interp_tile_nx'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("interp_tile_nx");
+    tt->descr = tdrpStrDup("Number of grid points in x for each tile.");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &interp_tile_nx - &_start_;
+    tt->has_min = TRUE;
+    tt->min_val.i = 1;
+    tt->single_val.i = 256;
+    tt++;
+    
+    // Parameter 'interp_tile_ny'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("interp_tile_ny");
+    tt->descr = tdrpStrDup("Number of grid points in y for each tile.");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &interp_tile_ny - &_start_;
+    tt->has_min = TRUE;
+    tt->min_val.i = 1;
+    tt->single_val.i = 256;
+    tt++;
+    
+    // Parameter 'interp_tile_nz'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("interp_tile_nz");
+    tt->descr = tdrpStrDup("Number of grid levels in z for each tile.");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &interp_tile_nz - &_start_;
+    tt->has_min = TRUE;
+    tt->min_val.i = 1;
+    tt->single_val.i = 1;
+    tt++;
+    
+    // Parameter 'Comment 36'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 36");
     tt->comment_hdr = tdrpStrDup("THREADING FOR SPEED.");
     tt->comment_text = tdrpStrDup("");
     tt++;
@@ -2868,11 +2964,11 @@
     tt->single_val.i = 4;
     tt++;
     
-    // Parameter 'Comment 35'
+    // Parameter 'Comment 37'
     
     memset(tt, 0, sizeof(TDRPtable));
     tt->ptype = COMMENT_TYPE;
-    tt->param_name = tdrpStrDup("Comment 35");
+    tt->param_name = tdrpStrDup("Comment 37");
     tt->comment_hdr = tdrpStrDup("INTERPOLATION FOR SATELLITE DATA");
     tt->comment_text = tdrpStrDup("Satellite interpolation uses the reorder params above, plus those in this section.");
     tt++;
@@ -2901,11 +2997,11 @@
     tt->single_val.b = pFALSE;
     tt++;
     
-    // Parameter 'Comment 36'
+    // Parameter 'Comment 38'
     
     memset(tt, 0, sizeof(TDRPtable));
     tt->ptype = COMMENT_TYPE;
-    tt->param_name = tdrpStrDup("Comment 36");
+    tt->param_name = tdrpStrDup("Comment 38");
     tt->comment_hdr = tdrpStrDup("OPTION TO WRITE SEARCH MATRIX FILES");
     tt->comment_text = tdrpStrDup("This is for debugging purposes only. The search matrix data will be written to MDV files that can then be viewed in CIDD or JAZZ.");
     tt++;
@@ -2934,11 +3030,11 @@
     tt->single_val.s = tdrpStrDup("./mdv/search_matrix");
     tt++;
     
-    // Parameter 'Comment 37'
+    // Parameter 'Comment 39'
     
     memset(tt, 0, sizeof(TDRPtable));
     tt->ptype = COMMENT_TYPE;
-    tt->param_name = tdrpStrDup("Comment 37");
+    tt->param_name = tdrpStrDup("Comment 39");
     tt->comment_hdr = tdrpStrDup("OPTION TO IDENTIFY THE CONVECTIVE/STRATIFORM SPLIT");
     tt->comment_text = tdrpStrDup("Applies only to INTERP_MODE_CART.");
     tt++;
@@ -3111,11 +3207,11 @@
     tt->single_val.b = pFALSE;
     tt++;
     
-    // Parameter 'Comment 38'
+    // Parameter 'Comment 40'
     
     memset(tt, 0, sizeof(TDRPtable));
     tt->ptype = COMMENT_TYPE;
-    tt->param_name = tdrpStrDup("Comment 38");
+    tt->param_name = tdrpStrDup("Comment 40");
     tt->comment_hdr = tdrpStrDup("INTERPOLATION USING REORDER METHOD");
     tt->comment_text = tdrpStrDup("!!!!!! WARNING - IMPORTANT NOTE - this mode should only be used for mobile platforms. Use INTERP_MODE_CART for all fixed platforms - it is much more robust and gives much better results !!!!!!!");
     tt++;
@@ -3252,11 +3348,11 @@
     tt->single_val.b = pFALSE;
     tt++;
     
-    // Parameter 'Comment 39'
+    // Parameter 'Comment 41'
     
     memset(tt, 0, sizeof(TDRPtable));
     tt->ptype = COMMENT_TYPE;
-    tt->param_name = tdrpStrDup("Comment 39");
+    tt->param_name = tdrpStrDup("Comment 41");
     tt->comment_hdr = tdrpStrDup("OPTION TO SET BOUNDS ON SELECTED FIELDS");
     tt->comment_text = tdrpStrDup("");
     tt++;
@@ -754,6 +754,18 @@ public:
 
   tdrp_bool_t free_memory_between_files;
 
+  tdrp_bool_t persist_grid_geom_cache;
+
+  char* grid_geom_cache_dir;
+
+  tdrp_bool_t use_tiled_interp;
+
+  int interp_tile_nx;
+
+  int interp_tile_ny;
+
+  int interp_tile_nz;
+
   tdrp_bool_t use_multiple_threads;
 
   int n_compute_threads;
@@ -828,7 +840,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[203];
+  mutable TDRPtable _table[211];
 
   const char *_className;
 
@@ -60,7 +60,8 @@ PolarInterp::PolarInterp(const string &progName,
                params,
                readVol,
                interpFields,
-               interpRays)
+               interpRays),
+        _geomCache(params)
         
 {
 
@@ -163,6 +164,10 @@ int PolarInterp::interpVol()
   // as small as possible for efficiency
   
   _computeSearchLimits();
+
+  // compute the azimuth lookup, if the geometry has changed
+
+  _computeAzLookup();
   
   // fill the search matrix
 
@@ -309,6 +314,46 @@ void PolarInterp::_initGrid()
 
 }
   
+////////////////////////////////////////////////////////////
+// Compute the azimuth lookup for the grid.
+// In polar mode the range dimension maps directly onto the gates,
+// so only the azimuth lookup is required. Since the grid azimuths
+// are aligned with the rays in each volume, this is cheap to
+// compute and is not persisted to the cache dir.
+
+void PolarInterp::_computeAzLookup()
+
+{
+
+  _geomCache.startKey("polar");
+  _geomCache.addToKey("nAz", _nAz);
+  _geomCache.addToKey("minAz", _minAz);
+  _geomCache.addToKey("deltaAz", _deltaAz);
+  _geomCache.addToKey("isSector", (int) _isSector);
+  _geomCache.addToKey("spansNorth", (int) _spansNorth);
+  _geomCache.addToKey("sectorStartAz", _dataSectorStartAzDeg);
+  _geomCache.addToKey("searchMinAz", _searchMinAz);
+  _geomCache.addToKey("searchNAz", _searchNAz);
+  _geomCache.addToKey("startRangeKm", _gridMinx);
+  _geomCache.addToKey("gateSpacingKm", _gridDx);
+  _geomCache.addToKey("elevs", _gridZLevels);
+
+  if (!_geomCache.keyHasChanged()) {
+    return;
+  }
+
+  vector<double> condAz(_nAz);
+  vector<int> searchIndex(_nAz);
+  for (int iaz = 0; iaz < _nAz; iaz++) {
+    double az = _minAz + iaz * _deltaAz;
+    condAz[iaz] = _conditionAz(az);
+    searchIndex[iaz] = _getSearchAzIndex(condAz[iaz]);
+  }
+  _geomCache.setAzLookup(condAz, searchIndex);
+  _geomCache.setValid();
+
+}
+  
 //////////////////////////////////////////////////
 // initialize the threading objects
 
@@ -769,8 +814,8 @@ void PolarInterp::_interpAz(int elIndex, int azIndex)
   // find starting location in search vector
     
   double az = _minAz + azIndex * _deltaAz;
-  double condAz = _conditionAz(az);
-  int iaz = _getSearchAzIndex(condAz);
+  double condAz = _geomCache.getAzLookup()[azIndex];
+  int iaz = _geomCache.getAzSearchIndex()[azIndex];
   if (iaz < 0) {
     return;
   }
@@ -37,6 +37,7 @@
 #define PolarInterp_HH
 
 #include "Interp.hh"
+#include "GridGeomCache.hh"
 #include <toolsa/TaThread.hh>
 #include <toolsa/TaThreadPool.hh>
 
@@ -103,6 +104,11 @@ private:
   double _minAz, _deltaAz;
   int _nEl;
 
+  // azimuth lookup - conditioned az and search index
+  // for each grid azimuth
+
+  GridGeomCache _geomCache;
+
   // class for neighboring points
 
   class Neighbors {
@@ -130,6 +136,7 @@ private:
   void _computeSearchLimits();
   void _initZLevels();
   void _initGrid();
+  void _computeAzLookup();
   
   void _createThreads();
   void _freeThreads();
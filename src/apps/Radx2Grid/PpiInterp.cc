@@ -59,7 +59,8 @@ PpiInterp::PpiInterp(const string &progName,
                params,
                readVol,
                interpFields,
-               interpRays)
+               interpRays),
+        _geomCache(params)
         
 {
 
@@ -68,7 +69,6 @@ PpiInterp::PpiInterp(const string &progName,
 
   _prevRadarLat = _prevRadarLon = _prevRadarAltKm = -9999.0;
   _gridLoc = NULL;
-  _nzAlloc = _nyAlloc = _nxAlloc = 0;
   _outputFields = NULL;
 
   // set up thread objects
@@ -122,22 +122,14 @@ int PpiInterp::interpVol()
     cerr << "  _scanDeltaAz: " << _scanDeltaAz << endl;
   }
 
-  // initialize the output grid dimensions if things have changed
-  
-  if (_geomHasChanged() || _gridLoc == NULL) {
-
-    // initialize grid
+  // initialize the output grid dimensions
 
-    _initGrid();
+  _initGrid();
 
-    // compute grid locations relative to radar
-    
-    if (_params.debug) {
-      cerr << "  Computing grid relative to radar ... " << endl;
-    }
-    _computeGridRelative();
+  // compute grid locations relative to radar
+  // this is a no-op if the geometry has not changed
     
-  }
+  _computeGridRelative();
 
   // compute search matrix angle limits - keep the matrix
   // as small as possible for efficiency
@@ -215,59 +207,6 @@ void PpiInterp::_freeThreads()
   // thread pools free up threads in destructor
 }
 
-////////////////////////////////////////////////////////////
-// Check if radar or scan geometry has changed
-
-bool PpiInterp::_geomHasChanged()
-
-{
-
-  bool hasChanged = false;
-  
-  // check if radar has moved
-  
-  if (fabs(_prevRadarLat - _radarLat) < 0.00001 &&
-      fabs(_prevRadarLon - _radarLon) < 0.00001 &&
-      fabs(_prevRadarAltKm - _radarAltKm) < 0.00001) {
-    _prevRadarLat = _radarLat;
-    _prevRadarLon = _radarLon;
-    _prevRadarAltKm = _radarAltKm;
-    hasChanged = true;
-  }
-
-  // check elevation angles
-  
-  bool elevChanged = false;
-  if (_gridZLevels.size() == 0 || _gridZLevels.size() == 0) {
-    elevChanged = true;
-  } else if (_prevZLevels.size() != _gridZLevels.size()) {
-    elevChanged = true;
-  } else {
-    for (size_t ii = 0; ii < _gridZLevels.size(); ii++) {
-      if (fabs(_prevZLevels[ii] - _gridZLevels[ii]) > 0.001) {
-        elevChanged = true;
-        break;
-      }
-    }
-  }
-
-  if (elevChanged) {
-    _prevZLevels = _gridZLevels;
-    hasChanged = true;
-    if (_params.debug) {
-      cerr << "==>> Elevs have changed" << endl;
-    }
-  } else {
-    if (_params.debug) {
-      cerr << "==>> Elevs have NOT changed" << endl;
-    }
-  }
-
-  return hasChanged;
-  
-}
-
-  
 //////////////////////////////////////////////////
 // Compute the search matrix limits
 // keeping it as small as possible for efficiency
@@ -338,8 +277,6 @@ void PpiInterp::_initGrid()
 
 {
 
-  _freeGridLoc();
-
   _gridNx = _params.grid_xy_geom.nx;
   _gridMinx = _params.grid_xy_geom.minx;
   _gridDx = _params.grid_xy_geom.dx;
@@ -348,26 +285,16 @@ void PpiInterp::_initGrid()
   _gridMiny = _params.grid_xy_geom.miny;
   _gridDy = _params.grid_xy_geom.dy;
 
-  _gridLoc = (GridLoc ****)
-    umalloc3(_nEl, _gridNy, _gridNx, sizeof(GridLoc *));
-  
-  for (int iz = 0; iz < _nEl; iz++) {
-    for (int iy = 0; iy < _gridNy; iy++) {
-      for (int ix = 0; ix < _gridNx; ix++) {
-        _gridLoc[iz][iy][ix] = new GridLoc;
-      }
-    }
-  }
+  // grid locations are held in the geometry lookup
+  // the existing block is reused if the dimensions are unchanged
 
-  _nzAlloc = _nEl;
-  _nyAlloc = _gridNy;
-  _nxAlloc = _gridNx;
+  _gridLoc = _geomCache.allocGridLoc(_nEl, _gridNy, _gridNx);
 
   if (_params.debug >= Params::DEBUG_VERBOSE) {
     cerr << "PpiInterp::_initGrid - grid initialized" << endl;
-    cerr << "  nz: " << _nzAlloc << endl;
-    cerr << "  ny: " << _nyAlloc << endl;
-    cerr << "  nx: " << _nxAlloc << endl;
+    cerr << "  nz: " << _nEl << endl;
+    cerr << "  ny: " << _gridNy << endl;
+    cerr << "  nx: " << _gridNx << endl;
   }
 
 }
@@ -379,18 +306,8 @@ void PpiInterp::_freeGridLoc()
   
 {
   
-  if (_gridLoc) {
-    for (int iz = 0; iz < _nzAlloc; iz++) {
-      for (int iy = 0; iy < _nyAlloc; iy++) {
-        for (int ix = 0; ix < _nxAlloc; ix++) {
-          delete _gridLoc[iz][iy][ix];
-        }
-      }
-    }
-    ufree3((void ***) _gridLoc);
-    _gridLoc = NULL;
-    _nzAlloc = _nyAlloc = _nxAlloc = 0;
-  }
+  _geomCache.freeGridLoc();
+  _gridLoc = NULL;
 
 }
 
@@ -453,6 +370,38 @@ void PpiInterp::_computeGridRelative()
     _gridOriginLon = _params.grid_origin_lon;
   }
 
+  // check if the geometry has changed - radar location,
+  // grid, elevation angles or gate geometry
+  // if not, the lookup from the previous volume is still valid
+
+  _geomCache.startKey("ppi");
+  _geomCache.addToKey("radarLat", _radarLat);
+  _geomCache.addToKey("radarLon", _radarLon);
+  _geomCache.addToKey("radarAltKm", _radarAltKm);
+  _geomCache.addGridToKey(_gridOriginLat, _gridOriginLon,
+                          _gridNx, _gridNy,
+                          _gridMinx, _gridMiny,
+                          _gridDx, _gridDy,
+                          _gridZLevels);
+  _geomCache.addToKey("startRangeKm", _startRangeKm);
+  _geomCache.addToKey("gateSpacingKm", _gateSpacingKm);
+
+  if (!_geomCache.keyHasChanged()) {
+    if (_params.debug) {
+      cerr << "==>> Grid geometry has NOT changed" << endl;
+    }
+    return;
+  }
+
+  if (_params.debug) {
+    cerr << "==>> Grid geometry has changed" << endl;
+    cerr << "  Computing grid relative to radar ... " << endl;
+  }
+
+  _prevRadarLat = _radarLat;
+  _prevRadarLon = _radarLon;
+  _prevRadarAltKm = _radarAltKm;
+
   if (_params.debug >= Params::DEBUG_VERBOSE) {
     cerr << "  _radarLat: " << _radarLat << endl;
     cerr << "  _radarLon: " << _radarLon << endl;
@@ -465,6 +414,14 @@ void PpiInterp::_computeGridRelative()
 
   _initProjection();
 
+  // try the cache dir
+
+  if (_params.persist_grid_geom_cache) {
+    if (_geomCache.readFromCacheDir() == 0) {
+      return;
+    }
+  }
+
   if (_params.use_multiple_threads) {
 
     _computeGridRelMultiThreaded();
@@ -481,6 +438,15 @@ void PpiInterp::_computeGridRelative()
 
   }
 
+  // compute gate index and range weights
+
+  _geomCache.computeGateLookup(_startRangeKm, _gateSpacingKm);
+  _geomCache.setValid();
+
+  if (_params.persist_grid_geom_cache) {
+    _geomCache.writeToCacheDir();
+  }
+
 }
 
 //////////////////////////////////////////////////////
@@ -1051,11 +1017,9 @@ void PpiInterp::_interpRow(int iel, int iy)
 
     // get gate indices, compute weights based on range
 
-    double rangeKm = loc->slantRange;
-    double dgate = (rangeKm - _startRangeKm) / _gateSpacingKm;
-    int igateInner = (int) floor(dgate);
+    int igateInner = _geomCache.getGateInner(ptIndex);
     int igateOuter = igateInner + 1;
-    double wtOuter = dgate - igateInner;
+    double wtOuter = _geomCache.getWtOuter(ptIndex);
     double wtInner = 1.0 - wtOuter;
     Neighbors wts;
 
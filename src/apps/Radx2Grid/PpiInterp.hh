@@ -37,6 +37,7 @@
 #define PpiInterp_HH
 
 #include "Interp.hh"
+#include "GridGeomCache.hh"
 #include <toolsa/TaThread.hh>
 #include <toolsa/TaThreadPool.hh>
 
@@ -70,9 +71,10 @@ public:
 protected:
 private:
   
-  // previous Z levels - check on changes
+  // geometry lookup for grid relative to radar
+  // keyed on radar location, grid and sweep angles
   
-  vector<double> _prevZLevels;
+  GridGeomCache _geomCache;
 
   // class for search matrix
 
@@ -107,8 +109,6 @@ private:
   double _searchRadiusAz;
   int _searchMaxDistAz;
   int _nEl;
-  
-  int _nzAlloc, _nyAlloc, _nxAlloc;
 
   // class for neighboring points
 
@@ -142,7 +142,6 @@ private:
   void _initGrid();
   void _freeGridLoc();
   
-  bool _geomHasChanged();
   void _computeSearchLimits();
 
   void _allocOutputArrays();
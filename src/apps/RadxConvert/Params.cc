@@ -935,6 +935,20 @@
     tt->single_val.b = pFALSE;
     tt++;
     
+    // Parameter 'n_threads_for_read'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("n_threads_for_read");
+    tt->descr = tdrpStrDup("Number of threads for reading the field data.");
+    tt->help = tdrpStrDup("Applies to CfRadial2 files only. The compressed field data for each sweep is read from the file serially, and is then decompressed using this number of threads. Set to 1 for single-threaded operation.");
+    tt->val_offset = (char *) &n_threads_for_read - &_start_;
+    tt->has_min = TRUE;
+    tt->min_val.i = 1;
+    tt->single_val.i = 1;
+    tt++;
+    
     // Parameter 'clear_transition_flag_on_all_rays'
     // ctype is 'tdrp_bool_t'
     
@@ -2064,6 +2078,20 @@
     tt->single_val.e = OUTPUT_ENCODING_ASIS;
     tt++;
     
+    // Parameter 'n_threads_for_encoding_conversion'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("n_threads_for_encoding_conversion");
+    tt->descr = tdrpStrDup("Number of threads for converting the field encoding.");
+    tt->help = tdrpStrDup("Fields are converted independently, so for volumes with many fields the conversion can be spread across multiple threads. Set to 1 for single-threaded operation.");
+    tt->val_offset = (char *) &n_threads_for_encoding_conversion - &_start_;
+    tt->has_min = TRUE;
+    tt->min_val.i = 1;
+    tt->single_val.i = 1;
+    tt++;
+    
     // Parameter 'Comment 19'
     
     memset(tt, 0, sizeof(TDRPtable));
@@ -2442,6 +2470,20 @@
     tt->single_val.i = 4;
     tt++;
     
+    // Parameter 'n_threads_for_write'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("n_threads_for_write");
+    tt->descr = tdrpStrDup("Number of threads for compressing the output fields.");
+    tt->help = tdrpStrDup("Applies to CfRadial files in NETCDF4 or NETCDF4_CLASSIC format, if compressed. The fields are compressed concurrently using this number of threads, and are then written to the file. Set to 1 for single-threaded operation.");
+    tt->val_offset = (char *) &n_threads_for_write - &_start_;
+    tt->has_min = TRUE;
+    tt->min_val.i = 1;
+    tt->single_val.i = 1;
+    tt++;
+    
     // Parameter 'Comment 25'
     
     memset(tt, 0, sizeof(TDRPtable));
@@ -553,6 +553,8 @@ public:
 
   tdrp_bool_t remove_rays_with_all_data_missing;
 
+  int n_threads_for_read;
+
   tdrp_bool_t clear_transition_flag_on_all_rays;
 
   tdrp_bool_t remove_rays_with_antenna_transitions;
@@ -686,6 +688,8 @@ public:
 
   output_encoding_t output_encoding;
 
+  int n_threads_for_encoding_conversion;
+
   tdrp_bool_t apply_censoring;
 
   censoring_field_t *_censoring_fields;
@@ -715,6 +719,8 @@ public:
 
   int compression_level;
 
+  int n_threads_for_write;
+
   char* output_dir;
 
   filename_mode_t output_filename_mode;
@@ -788,7 +794,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[166];
+  mutable TDRPtable _table[169];
 
   const char *_className;
 
@@ -845,6 +845,8 @@ void RadxConvert::_setupRead(RadxFile &file)
     file.setReadRemoveRaysAllMissing(false);
   }
 
+  file.setReadNThreads(_params.n_threads_for_read);
+
   if (_params.preserve_sweeps) {
     file.setReadPreserveSweeps(true);
   } else {
@@ -1035,6 +1037,8 @@ void RadxConvert::_convertFields(RadxVol &vol)
 void RadxConvert::_convertAllFields(RadxVol &vol)
 {
 
+  vol.setNThreadsConvert(_params.n_threads_for_encoding_conversion);
+
   switch(_params.output_encoding) {
     case Params::OUTPUT_ENCODING_FLOAT32:
       vol.convertToFl32();
@@ -1079,6 +1083,7 @@ void RadxConvert::_setupWrite(RadxFile &file)
   if (_params.output_compressed) {
     file.setWriteCompressed(true);
     file.setCompressionLevel(_params.compression_level);
+    file.setWriteNThreads(_params.n_threads_for_write);
   } else {
     file.setWriteCompressed(false);
   }
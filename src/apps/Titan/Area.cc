@@ -48,22 +48,24 @@ using namespace std;
 //
 
 Area::Area(const string &prog_name, const Params &params,
-	   const InputMdv &input_mdv, TitanStormFile &storm_file) :
+	   const InputMdv &input_mdv, TitanStormFile &storm_file,
+	   Workspace &workspace) :
   Worker(prog_name, params),
   _inputMdv(input_mdv),
   _sfile(storm_file),
+  _workspace(workspace),
   _boundary(prog_name, params)
   
 {
 
   OK = TRUE;
 
-  // grids
+  // grids - borrowed from the workspace
 
-  _nGridAlloc = 0;
   _compGrid = NULL;
   _precipGrid = NULL;
   _dbzForPrecip = NULL;
+  _areaCoords = NULL;
 
   // ellipse comps
 
@@ -72,8 +74,6 @@ Area::Area(const string &prog_name, const Params &params,
     (double *) umalloc (MAX_EIG_DIM * sizeof(double));
   _eigenvectors =
     (double **) umalloc2 (MAX_EIG_DIM, MAX_EIG_DIM, sizeof(double));
-  _areaCoords = (double **) umalloc2 (1, 2, sizeof(double));
-  _nCoordsAlloc = 1;
 
   // compute number of dBZ hist intervals
   
@@ -97,22 +97,6 @@ Area::~Area()
 
 {
 
-  if (_compGrid) {
-    ufree(_compGrid);
-  }
-
-  if (_precipGrid) {
-    ufree(_precipGrid);
-  }
-
-  if (_dbzForPrecip) {
-    ufree(_dbzForPrecip);
-  }
-
-  if (_areaCoords) {
-    ufree2((void **) _areaCoords);
-  }
-
   if (_eigenvectors) {
     ufree2((void **) _eigenvectors);
   }
@@ -264,14 +248,12 @@ int Area::storeProjRuns(const GridClump &grid_clump)
 void Area::_allocGrids()
 
 {
-  if (_nPoints > _nGridAlloc) {
-    _compGrid = (ui08 *) urealloc(_compGrid, _nPoints);
-    _precipGrid = (ui08 *) urealloc(_precipGrid, _nPoints);
-    _dbzForPrecip = (fl32 *) urealloc(_dbzForPrecip, _nPoints * sizeof(fl32));
-    _nGridAlloc = _nPoints;
-  }
-  memset(_compGrid, 0, _nPoints);
-  memset(_precipGrid, 0, _nPoints);
+  _compGrid = (ui08 *)
+    _workspace.getZeroed(Workspace::AREA_COMP_GRID, _nPoints);
+  _precipGrid = (ui08 *)
+    _workspace.getZeroed(Workspace::AREA_PRECIP_GRID, _nPoints);
+  _dbzForPrecip = (fl32 *)
+    _workspace.get(Workspace::AREA_DBZ_FOR_PRECIP, _nPoints * sizeof(fl32));
 }
 
 /////////////////////////////////////////////////////////
@@ -416,15 +398,8 @@ void Area::_allocCoords(const int n_coords)
      
 {
 
-  if (n_coords > _nCoordsAlloc) {
-    // delete old
-    ufree2((void **) _areaCoords);
-    // new allocation
-    _areaCoords =
-      (double **) umalloc2 (n_coords, 2, sizeof(double));
-    // save size allocated
-    _nCoordsAlloc = n_coords;
-  }
+  _areaCoords = (double **)
+    _workspace.get2(Workspace::AREA_COORDS, n_coords, 2, sizeof(double));
 
 }
 
@@ -37,6 +37,7 @@
 
 #include "Worker.hh"
 #include "Boundary.hh"
+#include "Workspace.hh"
 #include <titan/storm.h>
 #include <titan/TitanStormFile.hh>
 using namespace std;
@@ -63,7 +64,8 @@ public:
   // constructor
 
   Area(const string &prog_name, const Params &params,
-       const InputMdv &input_mdv, TitanStormFile &storm_file);
+       const InputMdv &input_mdv, TitanStormFile &storm_file,
+       Workspace &workspace);
 
   // destructor
   
@@ -86,6 +88,7 @@ private:
 
   const InputMdv &_inputMdv;
   TitanStormFile &_sfile;
+  Workspace &_workspace;
   Boundary _boundary;
 
   double _zPInverseCoeff, _zPInverseExpon;
@@ -93,7 +96,6 @@ private:
   storm_file_global_props_t *_gProps;
 
   int _nPoints, _nX, _nY;
-  int _nGridAlloc;
   ui08 *_compGrid;
   ui08 *_precipGrid;
   fl32 *_dbzForPrecip;
@@ -103,7 +105,6 @@ private:
   double *_means, *_eigenvalues;
   double **_eigenvectors;
   double **_areaCoords;
-  int _nCoordsAlloc;
 
   void _ellipseCompute(const GridClump &grid_clump,
 		       ui08 *grid,
@@ -49,13 +49,8 @@ Clumping::Clumping(const string &prog_name) :
 
   OK = TRUE;
 
-  _rowh = NULL;
-  _nRowsAlloc = 0;
-  _intervals = NULL;
-  _nIntervalsAlloc = 0;
-  
-  _nIntOrderAlloc = 0;
-  _intervalOrder = NULL;
+  EG_init_clump_context(&_context);
+  _nThreads = 1;
 
   clumps = NULL;
   nClumps = 0;
@@ -70,9 +65,7 @@ Clumping::~Clumping()
 
 {
 
-  EG_free_clumps(&_nIntOrderAlloc, &clumps, &_intervalOrder);
-  EG_free_rowh(&_nRowsAlloc, &_rowh);
-  EG_free_intervals(&_intervals, &_nIntervalsAlloc);
+  EG_free_clump_context(&_context);
 
 }
 
@@ -92,8 +85,8 @@ int Clumping::findIntervals(int nx, int ny,
 
   _allocRowh(ny);
   int nInt = EG_find_intervals(ny, nx, data_grid,
-			       &_intervals, &_nIntervalsAlloc,
-			       _rowh, byte_threshold);
+			       &_context.intervals, &_context.n_intv_alloc,
+			       _context.row_hdr, byte_threshold);
 
   return (nInt);
 }
@@ -108,8 +101,9 @@ int Clumping::findIntervals(int nx, int ny,
 
   _allocRowh(ny);
   int nInt = EG_find_intervals_float(ny, nx, data_grid,
-                                     &_intervals, &_nIntervalsAlloc,
-                                     _rowh, threshold);
+                                     &_context.intervals,
+                                     &_context.n_intv_alloc,
+                                     _context.row_hdr, threshold);
 
   return (nInt);
 }
@@ -136,8 +130,8 @@ int Clumping::findIntervals3D(int nx, int ny, int nz,
   _allocRowh(ny * nz);
   int nInt = EG_find_intervals_3d(nplanes, nrows_per_vol, nrows_per_plane,
 				  ncols, data_grid,
-				  &_intervals, &_nIntervalsAlloc,
-				  _rowh, byte_threshold);
+				  &_context.intervals, &_context.n_intv_alloc,
+				  _context.row_hdr, byte_threshold);
 
   return (nInt);
 
@@ -160,8 +154,9 @@ int Clumping::findIntervals3D(int nx, int ny, int nz,
   int nInt = EG_find_intervals_3d_float(nplanes, 
                                         nrows_per_vol, nrows_per_plane,
                                         ncols, data_grid,
-                                        &_intervals, &_nIntervalsAlloc,
-                                        _rowh, threshold);
+                                        &_context.intervals,
+                                        &_context.n_intv_alloc,
+                                        _context.row_hdr, threshold);
 
   return (nInt);
 
@@ -179,7 +174,7 @@ void Clumping::edm2D(int nx, int ny,
 		     unsigned char *edm_grid)
   
 {
-  EG_edm_2d(_rowh, edm_grid, nx, ny, 1);
+  EG_edm_2d(_context.row_hdr, edm_grid, nx, ny, 1);
 }
 
 //////////////////////////////////////////
@@ -194,14 +189,16 @@ void Clumping::erode(int nx, int ny, unsigned char *eroded_grid,
 {
 
   if (erosion_threshold > 0) {
-    EG_erode_lesser_2d(_rowh, eroded_grid, nx, ny, erosion_threshold);
+    EG_erode_lesser_2d(_context.row_hdr, eroded_grid, nx, ny,
+                       erosion_threshold);
   }
     
   for (int value = erosion_threshold - 1; value > 0; value--) {
-    EG_erode_lesser_or_equal_2d(_rowh, eroded_grid, nx, ny, value);
+    EG_erode_lesser_or_equal_2d(_context.row_hdr, eroded_grid,
+                                nx, ny, value);
   }
   
-  EG_erode_bridges_2d(_rowh, eroded_grid, nx, ny);
+  EG_erode_bridges_2d(_context.row_hdr, eroded_grid, nx, ny);
 
 }
 
@@ -220,36 +217,28 @@ int Clumping::performClumping(int nx, int ny, int nz,
 
   int nrows_per_plane = ny;
   int nplanes = nz;
-  int nrows_per_vol = nrows_per_plane * nplanes;
   int ncols = nx;
   
-  // alloc row headers
-
-  _allocRowh(nrows_per_vol);
-  
   // find the intervals in the grid
   
-  int nInt = EG_find_intervals_3d(nplanes,
-				  nrows_per_vol,
-				  nrows_per_plane,
-				  ncols,
-				  data_grid,
-				  &_intervals, &_nIntervalsAlloc,
-				  _rowh, byte_threshold);
-  
-  // allocate space for intervals and clumps
-  
-  EG_alloc_clumps(nInt, &_nIntOrderAlloc,
-		  &clumps, &_intervalOrder);
-  
-  // set clump ids to NULL_ID
-  
-  EG_reset_clump_id(_intervals, nInt);
+  int nInt = EG_find_intervals_3d_mt(&_context, _nThreads,
+                                     nplanes, nrows_per_plane,
+                                     ncols, data_grid, byte_threshold);
+  if (nInt < 0) {
+    nClumps = 0;
+    return -1;
+  }
   
   // clump
   
-  nClumps = EG_rclump_3d(_rowh, nrows_per_plane, nplanes, TRUE,
-			 min_overlap, _intervalOrder, clumps);
+  nClumps = EG_clump_intervals_3d_mt(&_context, _nThreads,
+                                     nplanes, nrows_per_plane,
+                                     nInt, min_overlap);
+  clumps = _context.clump_order;
+  if (nClumps < 0) {
+    nClumps = 0;
+    return -1;
+  }
 
   return (nClumps);
   
@@ -270,36 +259,28 @@ int Clumping::performClumping(int nx, int ny, int nz,
 
   int nrows_per_plane = ny;
   int nplanes = nz;
-  int nrows_per_vol = nrows_per_plane * nplanes;
   int ncols = nx;
   
-  // alloc row headers
-
-  _allocRowh(nrows_per_vol);
-  
   // find the intervals in the grid
   
-  int nInt = EG_find_intervals_3d_float(nplanes,
-                                        nrows_per_vol,
-                                        nrows_per_plane,
-                                        ncols,
-                                        data_grid,
-                                        &_intervals, &_nIntervalsAlloc,
-                                        _rowh, threshold);
-  
-  // allocate space for intervals and clumps
-  
-  EG_alloc_clumps(nInt, &_nIntOrderAlloc,
-		  &clumps, &_intervalOrder);
-  
-  // set clump ids to NULL_ID
-  
-  EG_reset_clump_id(_intervals, nInt);
+  int nInt = EG_find_intervals_3d_float_mt(&_context, _nThreads,
+                                           nplanes, nrows_per_plane,
+                                           ncols, data_grid, threshold);
+  if (nInt < 0) {
+    nClumps = 0;
+    return -1;
+  }
   
   // clump
   
-  nClumps = EG_rclump_3d(_rowh, nrows_per_plane, nplanes, TRUE,
-			 min_overlap, _intervalOrder, clumps);
+  nClumps = EG_clump_intervals_3d_mt(&_context, _nThreads,
+                                     nplanes, nrows_per_plane,
+                                     nInt, min_overlap);
+  clumps = _context.clump_order;
+  if (nClumps < 0) {
+    nClumps = 0;
+    return -1;
+  }
 
   return (nClumps);
   
@@ -314,7 +295,7 @@ int Clumping::performClumping(int nx, int ny, int nz,
 void Clumping::_allocRowh(int nrows_per_vol)
 
 {
-  EG_alloc_rowh(nrows_per_vol, &_nRowsAlloc, &_rowh);
+  EG_alloc_rowh(nrows_per_vol, &_context.nrows_alloc, &_context.row_hdr);
 }
 
 
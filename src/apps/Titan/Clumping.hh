@@ -62,6 +62,12 @@ public:
   Clump_order *clumps;
   int nClumps;
 
+  // set the number of threads used by performClumping().
+  // With more than 1 thread the clumps are the same, but the
+  // intervals in each clump are in plane, row, column order.
+  // Defaults to 1.
+  void setNThreads(int n_threads) { _nThreads = n_threads; }
+
   // Find the run intervals in a 2D data grid
   int findIntervals(int nx, int ny,
 		    unsigned char *data_grid,
@@ -108,14 +114,12 @@ private:
 
   const string &_progName;
 
-  Row_hdr *_rowh;
-  int _nRowsAlloc;
+  // row headers, intervals and clumps, and the seed stack.
+  // Each object has its own, so clumping may be done in
+  // several threads at once.
 
-  Interval *_intervals;
-  int _nIntervalsAlloc;
-  
-  int _nIntOrderAlloc;
-  Interval **_intervalOrder;
+  Clump_context _context;
+  int _nThreads;
 
   // allocate row headers
   void _allocRowh(int nrows_per_vol);
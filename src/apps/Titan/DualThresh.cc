@@ -328,7 +328,7 @@ int DualThresh::compute(const GridClump &grid_clump)
 // writeOutputMdv()
 //
 
-int DualThresh::writeOutputMdv()
+int DualThresh::writeOutputMdv(OutputQueue *queue /* = NULL */)
   
 {
   
@@ -362,7 +362,7 @@ int DualThresh::writeOutputMdv()
 
   // write out file
 
-  if (out.writeVol()) {
+  if (out.writeVol(queue)) {
     cerr << "ERROR - DualThresh::writeOutputMdv" << endl;
     return -1;
   }
@@ -42,6 +42,7 @@
 
 class InputMdv;
 class GridClump;
+class OutputQueue;
 
 #include <dataport/port_types.h>
 #include <rapformats/titan_grid.h>
@@ -74,7 +75,7 @@ public:
 
   // write out MDV file for debugging
 
-  int writeOutputMdv();
+  int writeOutputMdv(OutputQueue *queue = NULL);
 
   // sub clumps to be returned to calling class
 
@@ -49,10 +49,12 @@ using namespace std;
 //
 
 Identify::Identify(const string &prog_name, const Params &params,
-		   const InputMdv &input_mdv, TitanStormFile &storm_file):
+		   const InputMdv &input_mdv, TitanStormFile &storm_file,
+		   Workspace &workspace):
   Worker(prog_name, params),
   _inputMdv(input_mdv),
   _sfile(storm_file),
+  _workspace(workspace),
   _clumping(prog_name)
 
 {
@@ -60,12 +62,17 @@ Identify::Identify(const string &prog_name, const Params &params,
   _props = NULL;
   _verify = NULL;
   _dualT = NULL;
+  _outputQueue = NULL;
+  _writeOutput = true;
+
+  _clumping.setNThreads(_params.n_clumping_threads);
   
   if (_params.create_verification_files) {
     _verify = new Verify(_progName, _params, _inputMdv);
   }
 
-  _props = new Props(_progName, _params, _inputMdv, _sfile, _verify);
+  _props = new Props(_progName, _params, _inputMdv, _sfile, _verify,
+                     _workspace);
 
   // dual threshold takes precedence over morphology
 
@@ -168,12 +175,12 @@ int Identify::run(int scan_num)
     return(-1);
   }
 
-  if (_verify) {
-    _verify->writeOutputMdv();
+  if (_verify && _writeOutput) {
+    _verify->writeOutputMdv(_outputQueue);
   }
   
-  if (_dualT && _params.create_dual_threshold_files) {
-    _dualT->writeOutputMdv();
+  if (_dualT && _params.create_dual_threshold_files && _writeOutput) {
+    _dualT->writeOutputMdv(_outputQueue);
   }
 
   return (0);
@@ -254,7 +261,7 @@ int Identify::_processClumps(int scan_num)
   scan_hdr.nbytes_char = TITAN_N_GRID_LABELS * TITAN_GRID_UNITS_LEN;
   scan_hdr.scan_num = scan_num;
   scan_hdr.nstorms = _nStorms;
-  scan_hdr.time = _inputMdv.mdvx.getMasterHeader().time_centroid;
+  scan_hdr.time = _inputMdv.mdvx->getMasterHeader().time_centroid;
   scan_hdr.min_z = _props->getMinValidZ();
   scan_hdr.delta_z = _inputMdv.grid.dz;
   scan_hdr.grid = _inputMdv.grid;
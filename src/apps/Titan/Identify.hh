@@ -38,6 +38,7 @@
 #include "Worker.hh"
 #include "InputMdv.hh"
 #include "Clumping.hh"
+#include "Workspace.hh"
 #include <euclid/clump.h>
 #include <titan/TitanStormFile.hh>
 using namespace std;
@@ -45,6 +46,7 @@ using namespace std;
 class Verify;
 class Props;
 class DualThresh;
+class OutputQueue;
 class GridClump;
 
 ////////////////////////////////
@@ -57,12 +59,22 @@ public:
   // constructor
   
   Identify(const string &prog_name, const Params &params,
-           const InputMdv &input_mdv, TitanStormFile &storm_file);
+           const InputMdv &input_mdv, TitanStormFile &storm_file,
+           Workspace &workspace);
 
   // destructor
   
   virtual ~Identify();
 
+  // set the queue for writing the MDV output - if not set,
+  // the output is written directly
+
+  void setOutputQueue(OutputQueue *queue) { _outputQueue = queue; }
+
+  // set whether the MDV output is written for the next scan
+
+  void setWriteOutput(bool state) { _writeOutput = state; }
+
   // perform identification
 
   int run(int scan_num);
@@ -73,6 +85,7 @@ private:
 
   const InputMdv &_inputMdv;
   TitanStormFile &_sfile;
+  Workspace &_workspace;
   Clumping _clumping;
 
   int _nClumps;
@@ -81,6 +94,8 @@ private:
   Props *_props;
   Verify *_verify;
   DualThresh *_dualT;
+  OutputQueue *_outputQueue;
+  bool _writeOutput;
 
   int _processClumps(int scan_num);
   int _processThisClump(const GridClump &grid_clump);
@@ -49,6 +49,7 @@ InputMdv::InputMdv(const string &prog_name, const Params &params) :
 
 {
 
+  mdvx = new DsMdvx;
   dbzField = NULL;
   velField = NULL;
   dbzVol = NULL;
@@ -68,6 +69,7 @@ InputMdv::~InputMdv()
   if (compDbz) {
     delete[] compDbz;
   }
+  delete mdvx;
 }
 
 ///////////////////////////////////////
@@ -84,60 +86,109 @@ int InputMdv::read(time_t data_time)
 
   // set up ther read
 
-  mdvx.clearRead();
+  setReadRequest(_params, *mdvx, data_time);
+  
+  if (_params.debug >= Params::DEBUG_EXTRA) {
+    mdvx->printReadRequest(cerr);
+  }
+  
+  // perform the read
+  
+  if (mdvx->readVolume()) {
+    cerr << "ERROR - " << _progName << ": InputMdv::read" << endl;
+    cerr << mdvx->getErrStr();
+    return -1;
+  }
 
-  mdvx.setReadTime(Mdvx::READ_FIRST_BEFORE,
-		    _params.input_url,
-		    0, data_time);
+  return _load();
 
-  bool useFieldNames;
-  if (strlen(_params.dbz_field.name) > 0) {
-    useFieldNames = true;
-    mdvx.addReadField(_params.dbz_field.name);
-    if (_params.vel_available) {
-      mdvx.addReadField(_params.vel_field.name);
+}
+
+///////////////////////////////////////
+// adopt()
+//
+// Load a volume which has already been read.
+// This object takes ownership of the volume, and the
+// previous volume is deleted.
+//
+// returns 0 on success, -1 on failure
+//
+
+int InputMdv::adopt(DsMdvx *vol)
+
+{
+  delete mdvx;
+  mdvx = vol;
+  return _load();
+}
+
+///////////////////////////////////////
+// setReadRequest()
+//
+// Set up the read request for the given time.
+// Static, so that volumes can be read outside this object.
+//
+
+void InputMdv::setReadRequest(const Params &params,
+                              DsMdvx &mdvx_in, time_t data_time)
+
+{
+
+  mdvx_in.clearRead();
+
+  mdvx_in.setReadTime(Mdvx::READ_FIRST_BEFORE,
+                      params.input_url,
+                      0, data_time);
+
+  if (strlen(params.dbz_field.name) > 0) {
+    mdvx_in.addReadField(params.dbz_field.name);
+    if (params.vel_available) {
+      mdvx_in.addReadField(params.vel_field.name);
     }
   } else {
-    useFieldNames = false;
-    mdvx.addReadField(_params.dbz_field.num);
-    if (_params.vel_available) {
-      mdvx.addReadField(_params.vel_field.num);
+    mdvx_in.addReadField(params.dbz_field.num);
+    if (params.vel_available) {
+      mdvx_in.addReadField(params.vel_field.num);
     }
   }
 
-  mdvx.setReadEncodingType(Mdvx::ENCODING_FLOAT32);
-  mdvx.setReadCompressionType(Mdvx::COMPRESSION_NONE);
+  mdvx_in.setReadEncodingType(Mdvx::ENCODING_FLOAT32);
+  mdvx_in.setReadCompressionType(Mdvx::COMPRESSION_NONE);
 
-  if (_params.use_column_max_dbz) {
-    mdvx.setReadVlevelLimits(_params.column_min_ht_km, _params.column_max_ht_km);
-    mdvx.setReadComposite();
+  if (params.use_column_max_dbz) {
+    mdvx_in.setReadVlevelLimits(params.column_min_ht_km,
+                                params.column_max_ht_km);
+    mdvx_in.setReadComposite();
   }
   
-  if (_params.debug >= Params::DEBUG_EXTRA) {
-    mdvx.printReadRequest(cerr);
-  }
-  
-  // perform the read
-  
-  if (mdvx.readVolume()) {
-    cerr << "ERROR - " << _progName << ": InputMdv::read" << endl;
-    cerr << mdvx.getErrStr();
-    return -1;
-  }
+}
+
+///////////////////////////////////////
+// _load()
+//
+// Set up the fields and grid from the volume in mdvx.
+//
+// returns 0 on success, -1 on failure
+//
+
+int InputMdv::_load()
+
+{
 
   // set headers, fields etc
   
-  const Mdvx::master_header_t &mhdr = mdvx.getMasterHeader();
+  const Mdvx::master_header_t &mhdr = mdvx->getMasterHeader();
 
+  bool useFieldNames = (strlen(_params.dbz_field.name) > 0);
   if (useFieldNames) {
-    dbzField = mdvx.getField(_params.dbz_field.name);
+    dbzField = mdvx->getField(_params.dbz_field.name);
     if (_params.vel_available) {
-      velField = mdvx.getField(_params.vel_field.name);
+      velField = mdvx->getField(_params.vel_field.name);
     }
   } else {
-    dbzField = mdvx.getField(0);
+    dbzField = mdvx->getField(0);
     if (_params.vel_available) {
-      velField = mdvx.getField(1);
+      velField = mdvx->getField(1);
     }
   }
   if (_params.negate_dbz_field) {
@@ -156,7 +207,7 @@ int InputMdv::read(time_t data_time)
   // if required, find the convective regions
   
   if (_params.identify_convective_regions) {
-    if (_convFinder.run(mdvx, *dbzField)) {
+    if (_convFinder.run(*mdvx, *dbzField)) {
       cerr << "WARNING - InputMdv" << endl;
       cerr << "  Cannot identify convective regions - this will be disabled" << endl;
     } else {
@@ -168,8 +219,8 @@ int InputMdv::read(time_t data_time)
   // requires that
 
   if (_params.remap_z_to_constant_grid) {
-    for (int ii = 0; ii < mdvx.getNFields(); ii++) {
-      MdvxField *field = mdvx.getField(ii);
+    for (int ii = 0; ii < mdvx->getNFields(); ii++) {
+      MdvxField *field = mdvx->getField(ii);
       if (field) {
         field->remapVlevels(_params.remap_z_grid.nz,
                             _params.remap_z_grid.minz,
@@ -182,14 +233,14 @@ int InputMdv::read(time_t data_time)
   if (!dbzField->isDzConstant()) {
     cerr << "WARNING - InputMdv::read()" << endl;
     cerr << "  DBZ field does not have constant delta Z in height" << endl;
-    cerr << "  File: " << mdvx.getPathInUse() << endl;
+    cerr << "  File: " << mdvx->getPathInUse() << endl;
     cerr << "  Vertical levels will not be properly handled." << endl;
     cerr << "  Please set the 'remap_z_to_constant_grid' parameter" << endl;
   }
 
   // set up the projection coordinate grid
 
-  proj.init(mdvx);
+  proj.init(*mdvx);
   coord = proj.getCoord();
   
   // make sure dz is not zero - if it is, set to 1.0
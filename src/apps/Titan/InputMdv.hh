@@ -60,9 +60,9 @@ public:
   
   virtual ~InputMdv();
 
-  // mdvx object
+  // mdvx object - replaced by adopt()
 
-  DsMdvx mdvx;
+  DsMdvx *mdvx;
   Mdvx::coord_t coord;
 
   MdvxField *dbzField;
@@ -90,18 +90,32 @@ public:
   // read file for given time
   int read(time_t data_time);
 
+  // load a volume which has already been read, for example
+  // by the InputQueue - takes ownership of the volume
+  int adopt(DsMdvx *vol);
+
+  // set up the read request for the given time
+  static void setReadRequest(const Params &params,
+                             DsMdvx &mdvx_in, time_t data_time);
+
 protected:
   
 private:
 
   ConvectionFinder _convFinder;
 
+  int _load();
   void _copyCoord2Grid(const Mdvx::coord_t &coord,
 		       titan_grid_t &grid);
 
   void _computeComposite();
   void _removeStratiform();
 
+  // no copying
+
+  InputMdv(const InputMdv &);
+  InputMdv &operator=(const InputMdv &);
+
 };
 
 #endif
@@ -0,0 +1,361 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// InputQueue.cc
+//
+// InputQueue class - reads input MDV volumes ahead of the
+// scan being processed, in a separate thread.
+//
+///////////////////////////////////////////////////////////////
+
+#include "InputQueue.hh"
+#include "InputMdv.hh"
+#include <toolsa/DateTime.hh>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+using namespace std;
+
+//////////////
+// constructor
+//
+
+InputQueue::InputQueue(const string &prog_name, const Params &params,
+                       int max_ready) :
+  Worker(prog_name, params)
+
+{
+
+  _maxReady = (max_ready < 1 ? 1 : max_ready);
+  _lastGot = -1;
+  _readingTime = -1;
+  _wantedTime = -1;
+  _exitFlag = false;
+  _threadRunning = false;
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_cond, NULL);
+
+  // non-blocking - the reader thread polls when idle
+
+  _latestTimes.setRealtime(_params.input_url,
+                           _params.max_realtime_valid_age,
+                           NULL, -1);
+  _watchMsecs = _params.input_search_sleep_msecs;
+  if (_watchMsecs < 100) {
+    _watchMsecs = 100;
+  }
+
+}
+
+/////////////
+// destructor
+//
+
+InputQueue::~InputQueue()
+
+{
+
+  // stop the reader - a read in progress is completed first
+
+  if (_threadRunning) {
+    pthread_mutex_lock(&_mutex);
+    _exitFlag = true;
+    pthread_cond_broadcast(&_cond);
+    pthread_mutex_unlock(&_mutex);
+    pthread_join(_thread, NULL);
+  }
+
+  for (size_t ii = 0; ii < _ready.size(); ii++) {
+    delete _ready[ii].mdvx;
+  }
+
+  pthread_cond_destroy(&_cond);
+  pthread_mutex_destroy(&_mutex);
+
+}
+
+/////////////////////////
+// start the reader thread
+// returns 0 on success, -1 on failure
+
+int InputQueue::start()
+
+{
+
+  if (_threadRunning) {
+    return 0;
+  }
+
+  int iret = pthread_create(&_thread, NULL, _run, this);
+  if (iret) {
+    cerr << "ERROR - InputQueue::start" << endl;
+    cerr << "  Cannot create reader thread: " << strerror(iret) << endl;
+    return -1;
+  }
+  _threadRunning = true;
+  return 0;
+
+}
+
+/////////////////////////
+// request a volume
+
+void InputQueue::request(time_t data_time)
+
+{
+
+  pthread_mutex_lock(&_mutex);
+  _addRequest(data_time);
+  pthread_mutex_unlock(&_mutex);
+
+}
+
+/////////////////////////////////////////
+// get the volume for the given time,
+// blocking until it has been read
+
+DsMdvx *InputQueue::get(time_t data_time)
+
+{
+
+  pthread_mutex_lock(&_mutex);
+
+  // discard requests for earlier times
+
+  while (!_requests.empty() && _requests.front() < data_time) {
+    _requests.pop_front();
+  }
+
+  // if not yet requested, read it next
+
+  if (!_isPending(data_time)) {
+    _requests.push_front(data_time);
+  }
+  if (data_time > _lastGot) {
+    _lastGot = data_time;
+  }
+
+  vol_t vol;
+  vol.mdvx = NULL;
+  vol.ok = false;
+  
+  while (true) {
+    
+    // discard volumes for earlier times, look for this one
+    
+    bool found = false;
+    for (deque<vol_t>::iterator it = _ready.begin(); it != _ready.end(); ) {
+      if (it->dataTime < data_time) {
+        delete it->mdvx;
+        it = _ready.erase(it);
+      } else if (it->dataTime == data_time) {
+        vol = *it;
+        _ready.erase(it);
+        found = true;
+        break;
+      } else {
+        ++it;
+      }
+    }
+    pthread_cond_broadcast(&_cond);
+
+    if (found) {
+      break;
+    }
+
+    _wantedTime = data_time;
+    pthread_cond_wait(&_cond, &_mutex);
+
+  }
+
+  _wantedTime = -1;
+  pthread_mutex_unlock(&_mutex);
+
+  if (!vol.ok) {
+    cerr << "ERROR - " << _progName << ": InputQueue::get" << endl;
+    cerr << "  Cannot read data for time: "
+         << DateTime::strm(data_time) << endl;
+    cerr << vol.mdvx->getErrStr();
+    delete vol.mdvx;
+    return NULL;
+  }
+
+  return vol.mdvx;
+
+}
+
+///////////////////////////////////
+// thread entry point
+
+void *InputQueue::_run(void *arg)
+
+{
+  InputQueue *queue = (InputQueue *) arg;
+  queue->_readLoop();
+  return NULL;
+}
+
+///////////////////////////////////
+// read the requested volumes in turn
+
+void InputQueue::_readLoop()
+
+{
+
+  pthread_mutex_lock(&_mutex);
+
+  while (true) {
+
+    // wait for a request, and for space in the queue - unless
+    // get() is waiting for the next request. If there is space,
+    // watch for new data meanwhile.
+    
+    while (!_exitFlag &&
+           (_requests.empty() ||
+            ((int) _ready.size() >= _maxReady &&
+             _requests.front() != _wantedTime))) {
+      if (_requests.empty() && (int) _ready.size() < _maxReady) {
+        _watchLatest();
+      } else {
+        pthread_cond_wait(&_cond, &_mutex);
+      }
+    }
+    if (_exitFlag) {
+      break;
+    }
+
+    _readingTime = _requests.front();
+    _requests.pop_front();
+    pthread_mutex_unlock(&_mutex);
+
+    // read, with the mutex unlocked
+
+    vol_t vol;
+    vol.dataTime = _readingTime;
+    vol.mdvx = new DsMdvx;
+    InputMdv::setReadRequest(_params, *vol.mdvx, vol.dataTime);
+    vol.ok = (vol.mdvx->readVolume() == 0);
+
+    // add to the queue, in time order
+
+    pthread_mutex_lock(&_mutex);
+    deque<vol_t>::iterator it = _ready.begin();
+    while (it != _ready.end() && it->dataTime < vol.dataTime) {
+      ++it;
+    }
+    _ready.insert(it, vol);
+    _readingTime = -1;
+    pthread_cond_broadcast(&_cond);
+
+  }
+
+  pthread_mutex_unlock(&_mutex);
+
+}
+
+///////////////////////////////////////////////////
+// add a request, in time order.
+// Call with the mutex locked.
+
+void InputQueue::_addRequest(time_t data_time)
+
+{
+
+  if (data_time <= _lastGot || _isPending(data_time)) {
+    return;
+  }
+
+  deque<time_t>::iterator it = _requests.begin();
+  while (it != _requests.end() && *it < data_time) {
+    ++it;
+  }
+  _requests.insert(it, data_time);
+  pthread_cond_broadcast(&_cond);
+
+}
+
+///////////////////////////////////////////////////
+// wait for a request, for up to input_search_sleep_msecs,
+// then check for new data, and request it if found.
+// Call with the mutex locked.
+
+void InputQueue::_watchLatest()
+
+{
+
+  struct timespec wakeTime;
+  clock_gettime(CLOCK_REALTIME, &wakeTime);
+  wakeTime.tv_sec += _watchMsecs / 1000;
+  wakeTime.tv_nsec += (_watchMsecs % 1000) * 1000000L;
+  if (wakeTime.tv_nsec >= 1000000000L) {
+    wakeTime.tv_sec++;
+    wakeTime.tv_nsec -= 1000000000L;
+  }
+  if (pthread_cond_timedwait(&_cond, &_mutex, &wakeTime) != ETIMEDOUT) {
+    return;
+  }
+
+  // check with the mutex unlocked
+
+  pthread_mutex_unlock(&_mutex);
+  time_t latestTime;
+  bool found = (_latestTimes.getNext(latestTime) == 0 &&
+                _latestTimes.getNextSuccess());
+  pthread_mutex_lock(&_mutex);
+
+  if (found && !_exitFlag) {
+    if (_params.debug >= Params::DEBUG_VERBOSE) {
+      cerr << "InputQueue - new data, reading ahead: "
+           << DateTime::strm(latestTime) << endl;
+    }
+    _addRequest(latestTime);
+  }
+
+}
+
+///////////////////////////////////////////////////
+// is the time waiting to be read, being read,
+// or read? Call with the mutex locked.
+
+bool InputQueue::_isPending(time_t data_time) const
+
+{
+
+  if (_readingTime == data_time) {
+    return true;
+  }
+  for (size_t ii = 0; ii < _requests.size(); ii++) {
+    if (_requests[ii] == data_time) {
+      return true;
+    }
+  }
+  for (size_t ii = 0; ii < _ready.size(); ii++) {
+    if (_ready[ii].dataTime == data_time) {
+      return true;
+    }
+  }
+  return false;
+
+}
+
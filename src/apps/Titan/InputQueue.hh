@@ -0,0 +1,131 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// InputQueue.hh
+//
+// InputQueue class - reads input MDV volumes ahead of the
+// scan being processed, in a separate thread.
+//
+// Used in REALTIME mode if realtime_pipeline is set. The data
+// times are requested as they become known, and the reader
+// thread reads and decompresses the volumes in order, while the
+// main thread identifies and tracks the previous scan. The
+// number of volumes read ahead is limited to max_ready - the
+// reader waits for get() once this many are waiting.
+//
+// While it has nothing to read, the reader thread also watches
+// the input latest_data_info, so that a new volume is read as
+// soon as it arrives rather than when the main thread gets to it.
+//
+// Reading into the InputMdv object, and all of the other
+// processing, is still done in the main thread.
+//
+///////////////////////////////////////////////////////////////
+
+#ifndef InputQueue_HH
+#define InputQueue_HH
+
+#include "Worker.hh"
+#include <Mdv/DsMdvx.hh>
+#include <Mdv/DsMdvxTimes.hh>
+#include <pthread.h>
+#include <deque>
+using namespace std;
+
+////////////////////////////////
+// InputQueue
+
+class InputQueue : public Worker {
+  
+public:
+
+  // constructor
+
+  InputQueue(const string &prog_name, const Params &params,
+             int max_ready);
+
+  // destructor - stops the reader thread
+  
+  virtual ~InputQueue();
+
+  // start the reader thread
+  // returns 0 on success, -1 on failure
+
+  int start();
+
+  // request a volume - requests for times at or before the
+  // last time passed to get() are ignored
+
+  void request(time_t data_time);
+
+  // get the volume for the given time, blocking until it has
+  // been read. Volumes for earlier times are discarded. If the
+  // time has not been requested, it is read next.
+  //
+  // Returns the volume on success, NULL on failure.
+  // The caller must delete the volume.
+
+  DsMdvx *get(time_t data_time);
+
+protected:
+  
+private:
+
+  typedef struct {
+    time_t dataTime;
+    DsMdvx *mdvx;
+    bool ok;
+  } vol_t;
+
+  int _maxReady;
+  deque<time_t> _requests;  // times waiting to be read
+  deque<vol_t> _ready;      // volumes read, in time order
+  time_t _lastGot;          // latest time passed to get()
+  time_t _readingTime;      // time being read, -1 if none
+  time_t _wantedTime;       // time get() is waiting for, -1 if none
+  bool _exitFlag;
+
+  bool _threadRunning;
+  pthread_t _thread;
+  pthread_mutex_t _mutex;
+  pthread_cond_t _cond;
+
+  DsMdvxTimes _latestTimes; // for watching for new data
+  int _watchMsecs;
+
+  static void *_run(void *arg);
+  void _readLoop();
+  void _addRequest(time_t data_time);
+  void _watchLatest();
+  bool _isPending(time_t data_time) const;
+
+  // no copying
+
+  InputQueue(const InputQueue &);
+  InputQueue &operator=(const InputQueue &);
+
+};
+
+#endif
+
@@ -34,6 +34,7 @@
 ///////////////////////////////////////////////////////////////
 
 #include "OutputMdv.hh"
+#include "OutputQueue.hh"
 #include "InputMdv.hh"
 
 #include <toolsa/mem.h>
@@ -62,7 +63,7 @@ OutputMdv::OutputMdv(const string &prog_name,
   
   // set master header
 
-  Mdvx::master_header_t mhdr = _inputMdv.mdvx.getMasterHeader();
+  Mdvx::master_header_t mhdr = _inputMdv.mdvx->getMasterHeader();
 
   mhdr.time_gen = time(NULL);
   mhdr.data_dimension = 2;
@@ -227,7 +228,7 @@ void OutputMdv::addField(const char *field_name_long,
 // Write out merged volume in MDV format.
 //
 
-int OutputMdv::writeVol()
+int OutputMdv::writeVol(OutputQueue *queue /* = NULL */)
 
 {
 
@@ -238,6 +239,12 @@ int OutputMdv::writeVol()
 	   << " to URL: " << _url << endl;
   }
   
+  // queue for writing
+
+  if (queue != NULL) {
+    return queue->write(_mdvx, _url);
+  }
+
   // write out file
   
   if (_mdvx.writeToDir(_url.c_str())) {
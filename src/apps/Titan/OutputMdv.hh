@@ -42,6 +42,7 @@ using namespace std;
 
 // forward declarations
 class InputMdv;
+class OutputQueue;
 
 class OutputMdv : public Worker {
   
@@ -79,8 +80,10 @@ public:
                 const fl32 *data);
   
   // write out merged volume
+  // If queue is not NULL, the volume is written by the
+  // queue's writer thread instead.
 
-  int writeVol();
+  int writeVol(OutputQueue *queue = NULL);
 
   // data members
   static const float missingVal;
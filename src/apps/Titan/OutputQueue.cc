@@ -0,0 +1,201 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// OutputQueue.cc
+//
+// OutputQueue class - writes output MDV volumes in a separate
+// thread.
+//
+///////////////////////////////////////////////////////////////
+
+#include "OutputQueue.hh"
+#include <cstring>
+using namespace std;
+
+//////////////
+// constructor
+//
+
+OutputQueue::OutputQueue(const string &prog_name, const Params &params,
+                         int max_queued) :
+  Worker(prog_name, params)
+
+{
+
+  _maxQueued = (max_queued < 1 ? 1 : max_queued);
+  _writing = false;
+  _exitFlag = false;
+  _threadRunning = false;
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_cond, NULL);
+
+}
+
+/////////////
+// destructor
+//
+
+OutputQueue::~OutputQueue()
+
+{
+
+  if (_threadRunning) {
+    flush();
+    pthread_mutex_lock(&_mutex);
+    _exitFlag = true;
+    pthread_cond_broadcast(&_cond);
+    pthread_mutex_unlock(&_mutex);
+    pthread_join(_thread, NULL);
+  }
+
+  for (size_t ii = 0; ii < _queue.size(); ii++) {
+    delete _queue[ii].mdvx;
+  }
+
+  pthread_cond_destroy(&_cond);
+  pthread_mutex_destroy(&_mutex);
+
+}
+
+/////////////////////////
+// start the writer thread
+// returns 0 on success, -1 on failure
+
+int OutputQueue::start()
+
+{
+
+  if (_threadRunning) {
+    return 0;
+  }
+
+  int iret = pthread_create(&_thread, NULL, _run, this);
+  if (iret) {
+    cerr << "ERROR - OutputQueue::start" << endl;
+    cerr << "  Cannot create writer thread: " << strerror(iret) << endl;
+    return -1;
+  }
+  _threadRunning = true;
+  return 0;
+
+}
+
+/////////////////////////
+// queue a volume
+
+int OutputQueue::write(const DsMdvx &mdvx, const string &url)
+
+{
+
+  if (!_threadRunning) {
+    cerr << "ERROR - OutputQueue::write" << endl;
+    cerr << "  Writer thread not running, url: " << url << endl;
+    return -1;
+  }
+
+  vol_t vol;
+  vol.mdvx = new DsMdvx(mdvx);
+  vol.url = url;
+
+  pthread_mutex_lock(&_mutex);
+  while ((int) _queue.size() >= _maxQueued) {
+    pthread_cond_wait(&_cond, &_mutex);
+  }
+  _queue.push_back(vol);
+  pthread_cond_broadcast(&_cond);
+  pthread_mutex_unlock(&_mutex);
+
+  return 0;
+
+}
+
+///////////////////////////////////////////
+// wait until all queued volumes are written
+
+void OutputQueue::flush()
+
+{
+
+  pthread_mutex_lock(&_mutex);
+  while (_threadRunning && (!_queue.empty() || _writing)) {
+    pthread_cond_wait(&_cond, &_mutex);
+  }
+  pthread_mutex_unlock(&_mutex);
+
+}
+
+///////////////////////////////////
+// thread entry point
+
+void *OutputQueue::_run(void *arg)
+
+{
+  OutputQueue *queue = (OutputQueue *) arg;
+  queue->_writeLoop();
+  return NULL;
+}
+
+///////////////////////////////////
+// write the queued volumes in turn
+
+void OutputQueue::_writeLoop()
+
+{
+
+  pthread_mutex_lock(&_mutex);
+
+  while (true) {
+
+    while (!_exitFlag && _queue.empty()) {
+      pthread_cond_wait(&_cond, &_mutex);
+    }
+    if (_queue.empty()) {
+      break;
+    }
+
+    vol_t vol = _queue.front();
+    _queue.pop_front();
+    _writing = true;
+    pthread_cond_broadcast(&_cond);
+    pthread_mutex_unlock(&_mutex);
+
+    // write, with the mutex unlocked
+
+    if (vol.mdvx->writeToDir(vol.url.c_str())) {
+      cerr << "ERROR - OutputQueue" << endl;
+      cerr << "  Cannot write to url: " << vol.url << endl;
+      cerr << vol.mdvx->getErrStr();
+    }
+    delete vol.mdvx;
+
+    pthread_mutex_lock(&_mutex);
+    _writing = false;
+    pthread_cond_broadcast(&_cond);
+
+  }
+
+  pthread_mutex_unlock(&_mutex);
+
+}
+
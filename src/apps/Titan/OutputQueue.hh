@@ -0,0 +1,110 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// OutputQueue.hh
+//
+// OutputQueue class - writes output MDV volumes in a separate
+// thread.
+//
+// Used in REALTIME mode if realtime_pipeline is set, so that
+// writing the MDV output for one scan overlaps with processing
+// the next. At most max_queued volumes wait to be written -
+// write() blocks once the queue is full. The volumes are written
+// in the order queued.
+//
+///////////////////////////////////////////////////////////////
+
+#ifndef OutputQueue_HH
+#define OutputQueue_HH
+
+#include "Worker.hh"
+#include <Mdv/DsMdvx.hh>
+#include <pthread.h>
+#include <deque>
+using namespace std;
+
+////////////////////////////////
+// OutputQueue
+
+class OutputQueue : public Worker {
+  
+public:
+
+  // constructor
+
+  OutputQueue(const string &prog_name, const Params &params,
+              int max_queued);
+
+  // destructor - writes any queued volumes,
+  // then stops the writer thread
+  
+  virtual ~OutputQueue();
+
+  // start the writer thread
+  // returns 0 on success, -1 on failure
+
+  int start();
+
+  // queue a volume to be written to the url
+  // The volume is copied.
+  // Blocks while the queue is full.
+  // Returns 0 on success, -1 on failure.
+
+  int write(const DsMdvx &mdvx, const string &url);
+
+  // wait until all queued volumes have been written
+
+  void flush();
+
+protected:
+  
+private:
+
+  typedef struct {
+    DsMdvx *mdvx;
+    string url;
+  } vol_t;
+
+  int _maxQueued;
+  deque<vol_t> _queue;
+  bool _writing;
+  bool _exitFlag;
+
+  bool _threadRunning;
+  pthread_t _thread;
+  pthread_mutex_t _mutex;
+  pthread_cond_t _cond;
+
+  static void *_run(void *arg);
+  void _writeLoop();
+
+  // no copying
+
+  OutputQueue(const OutputQueue &);
+  OutputQueue &operator=(const OutputQueue &);
+
+};
+
+#endif
+
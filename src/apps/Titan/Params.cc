@@ -694,6 +694,20 @@
     tt->single_val.i = 3600;
     tt++;
     
+    // Parameter 'n_archive_processes'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("n_archive_processes");
+    tt->descr = tdrpStrDup("Number of days processed at once in ARCHIVE and RETRACK modes.");
+    tt->help = tdrpStrDup("The storm and track files are written one per day, and with auto_restart set the days are independent - the restart_overlap_period at the start of each day is computed from the input data, not from the previous day's file. If this is greater than 1, a child process is started for each day, and up to this number of days are processed at once. In RETRACK mode, each storm file in the time range is retracked in its own child process. Each day has its own tracking state file while running - when all days are done, the state file for the last day is kept, if that day succeeded. In ARCHIVE mode, the MDV output files (verify_url, dual_threshold_url) for the overlap period at the start of a day are written only by the previous day, and _latest_data_info is not updated as the scans are processed - it is written once, for the last day, when all days are done. In ARCHIVE mode without auto_restart there is a single storm file, so this has no effect.");
+    tt->val_offset = (char *) &n_archive_processes - &_start_;
+    tt->has_min = TRUE;
+    tt->min_val.i = 1;
+    tt->single_val.i = 1;
+    tt++;
+    
     // Parameter 'Comment 4'
     
     memset(tt, 0, sizeof(TDRPtable));
@@ -743,6 +757,32 @@
     tt->single_val.i = 1000;
     tt++;
     
+    // Parameter 'realtime_pipeline'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("realtime_pipeline");
+    tt->descr = tdrpStrDup("Option to pipeline the processing in REALTIME mode.");
+    tt->help = tdrpStrDup("If set, the input MDV volumes are read in a separate thread, ahead of the scan being processed, and the MDV output files (verify_url, dual_threshold_url) are written in another thread, while the main thread identifies and tracks storms. While it has nothing to read, the reader thread watches for new input data, so that a new volume is read as soon as it arrives, while the main thread may still be busy with the previous scan. When the program falls behind, for example on startup or if the data arrives faster than it can be processed, the time per scan is then set by the slowest stage rather than the sum of the stages. The storm and track files are still written in the main thread. The results are the same as in sequential mode.");
+    tt->val_offset = (char *) &realtime_pipeline - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'realtime_pipeline_queue_len'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("realtime_pipeline_queue_len");
+    tt->descr = tdrpStrDup("Queue length for the realtime pipeline.");
+    tt->help = tdrpStrDup("See 'realtime_pipeline'. This is the maximum number of input volumes read ahead, and the maximum number of output volumes waiting to be written. It limits the memory used by the pipeline.");
+    tt->val_offset = (char *) &realtime_pipeline_queue_len - &_start_;
+    tt->has_min = TRUE;
+    tt->min_val.i = 1;
+    tt->single_val.i = 2;
+    tt++;
+    
     // Parameter 'Comment 5'
     
     memset(tt, 0, sizeof(TDRPtable));
@@ -1012,6 +1052,20 @@
     tt->single_val.d = 18;
     tt++;
     
+    // Parameter 'n_clumping_threads'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("n_clumping_threads");
+    tt->descr = tdrpStrDup("Number of threads for clumping.");
+    tt->help = tdrpStrDup("The storms are identified by finding the runs of data above the low_dbz_threshold, and clumping the runs which overlap. If this is greater than 1, the volume is split into blocks of rows and these steps are performed for each block in its own thread. The storms found are the same as in single-threaded mode. Only worth setting on large grids, and no more than the number of cores available.");
+    tt->val_offset = (char *) &n_clumping_threads - &_start_;
+    tt->has_min = TRUE;
+    tt->min_val.i = 1;
+    tt->single_val.i = 1;
+    tt++;
+    
     // Parameter 'Comment 8'
     
     memset(tt, 0, sizeof(TDRPtable));
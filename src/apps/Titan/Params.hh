@@ -445,12 +445,18 @@ public:
 
   int restart_overlap_period;
 
+  int n_archive_processes;
+
   char* input_url;
 
   int max_realtime_valid_age;
 
   int input_search_sleep_msecs;
 
+  tdrp_bool_t realtime_pipeline;
+
+  int realtime_pipeline_queue_len;
+
   field_t dbz_field;
 
   tdrp_bool_t use_column_max_dbz;
@@ -481,6 +487,8 @@ public:
 
   double tops_dbz_threshold;
 
+  int n_clumping_threads;
+
   tdrp_bool_t use_dual_threshold;
 
   dual_threshold_t dual_threshold;
@@ -682,7 +690,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[149];
+  mutable TDRPtable _table[153];
 
   const char *_className;
 
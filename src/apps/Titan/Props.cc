@@ -55,28 +55,22 @@ using namespace std;
 
 Props::Props(const string &prog_name, const Params &params,
 	     const InputMdv &input_mdv, TitanStormFile &storm_file,
-	     Verify *verify) :
+	     Verify *verify, Workspace &workspace) :
         Worker(prog_name, params),
         _inputMdv(input_mdv),
         _sfile(storm_file),
         _verify(verify),
-        _area(_progName, _params, _inputMdv, _sfile)
+        _workspace(workspace),
+        _area(_progName, _params, _inputMdv, _sfile, workspace)
 
 {
   
-  // alloc arrays to initial sizes
+  // layer arrays are borrowed from the workspace, see _alloc()
   
-  _nZAlloc = 1;
-  _nHistAlloc = 1;
-  
-  _layer =
-    (layer_stats_t *) umalloc (_nZAlloc * sizeof(layer_stats_t));
-  _dbzHist =
-    (dbz_hist_entry_t *) umalloc (_nHistAlloc * sizeof(dbz_hist_entry_t));
-  _tiltData =
-    (double **) umalloc2 (_nZAlloc, MAX_EIG_DIM, sizeof(double));
-  _dbzGradientData =
-    (double **) umalloc2 (_nZAlloc, MAX_EIG_DIM, sizeof(double));
+  _layer = NULL;
+  _dbzHist = NULL;
+  _tiltData = NULL;
+  _dbzGradientData = NULL;
 
   _means = (double *) umalloc (MAX_EIG_DIM * sizeof(double));
   _eigenvalues =
@@ -104,22 +98,6 @@ Props::~Props()
 
 {
 
-  if (_layer) {
-    ufree(_layer);
-  }
-
-  if (_dbzHist) {
-    ufree(_dbzHist);
-  }
-
-  if (_tiltData) {
-    ufree2((void **) _tiltData);
-  }
-
-  if (_dbzGradientData) {
-    ufree2((void **) _dbzGradientData);
-  }
-
   if (_means) {
     ufree(_means);
   }
@@ -157,7 +135,7 @@ void Props::init()
   DsRadarParams *radar = NULL;
   DsRadarElev *elevs = NULL;
   MdvxRadar mdvxRadar;
-  if (mdvxRadar.loadFromMdvx(_inputMdv.mdvx) == 0) {
+  if (mdvxRadar.loadFromMdvx(*_inputMdv.mdvx) == 0) {
     radar = &mdvxRadar.getRadarParams();
     elevs = &mdvxRadar.getRadarElev();
   }
@@ -346,29 +324,20 @@ void Props::_alloc(int nz, int nhist)
 
 {
 
-  if (nz > _nZAlloc) {
+  _layer = (layer_stats_t *)
+    _workspace.get(Workspace::PROPS_LAYER, nz * sizeof(layer_stats_t));
 
-    _layer = (layer_stats_t *) urealloc
-      (_layer, nz * sizeof(layer_stats_t));
+  _tiltData = (double **)
+    _workspace.get2(Workspace::PROPS_TILT_DATA, nz, MAX_EIG_DIM,
+                    sizeof(double));
 
-    ufree2((void **) _tiltData);
-    _tiltData = (double **) umalloc2 (nz, MAX_EIG_DIM, sizeof(double));
-    
-    ufree2((void **) _dbzGradientData);
-    _dbzGradientData = (double **) umalloc2 (nz, MAX_EIG_DIM, sizeof(double));
-    
-    _nZAlloc = nz;
-
-  }
+  _dbzGradientData = (double **)
+    _workspace.get2(Workspace::PROPS_DBZ_GRADIENT_DATA, nz, MAX_EIG_DIM,
+                    sizeof(double));
 
-  if (nhist > _nHistAlloc) {
-
-    _dbzHist = (dbz_hist_entry_t *) urealloc
-      (_dbzHist, nhist * sizeof(dbz_hist_entry_t));
-    
-    _nHistAlloc = nhist;
-
-  }
+  _dbzHist = (dbz_hist_entry_t *)
+    _workspace.get(Workspace::PROPS_DBZ_HIST,
+                   nhist * sizeof(dbz_hist_entry_t));
     
   _sfile.AllocLayers(_inputMdv.grid.nz);
   _sfile.AllocHist(_nDbzHistIntervals);
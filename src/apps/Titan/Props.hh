@@ -105,7 +105,7 @@ public:
 
   Props(const string &prog_name, const Params &params,
 	const InputMdv &input_mdv, TitanStormFile &storm_file,
-	Verify *verify);
+	Verify *verify, Workspace &workspace);
 
   // destructor
   
@@ -127,6 +127,7 @@ private:
   const InputMdv &_inputMdv;
   TitanStormFile &_sfile;
   Verify *_verify;
+  Workspace &_workspace;
   Area _area;
 
   int _rangeLimited;
@@ -158,8 +159,6 @@ private:
   double **_dbzGradientData;
   layer_stats_t *_layer;
   dbz_hist_entry_t *_dbzHist;
-  int _nZAlloc;
-  int _nHistAlloc;
 
   // hail mass relationship
 
@@ -56,14 +56,21 @@ const float StormIdent::missingVal = -9999.0;
 // Constructor
 
 StormIdent::StormIdent(const string &prog_name,
-		       const Params &params) :
+		       const Params &params,
+		       Workspace &workspace) :
   Worker(prog_name, params),
+  _workspace(workspace),
   _inputMdv(_progName, _params),
-  _identify(_progName, _params, _inputMdv, _sfile)
+  _identify(_progName, _params, _inputMdv, _sfile, _workspace)
   
 {
 
   _fatalError = false;
+  _inputQueue = NULL;
+  _outputQueue = NULL;
+  _parallelDay = false;
+  _outputStartTime = 0;
+  _outputEndTime = 0;
 
 }
 
@@ -73,6 +80,13 @@ StormIdent::~StormIdent()
 
 {
 
+  if (_inputQueue) {
+    delete _inputQueue;
+  }
+  if (_outputQueue) {
+    delete _outputQueue;
+  }
+
 }
 
 //////////////////////////////////////////////////
@@ -85,6 +99,12 @@ int StormIdent::runRealtime()
   
   PMU_auto_register("StormIdent::runRealtime");
 
+  // in pipelined mode, start the reader and writer threads
+  
+  if (_params.realtime_pipeline) {
+    _startPipeline();
+  }
+
   // get the latest available data time
   
   DataTimes dataTimes(_progName, _params);
@@ -157,7 +177,7 @@ int StormIdent::runRealtime()
 
   // Prepare track file.
   
-  StormTrack tracking(_progName, _params, _headerFilePath);
+  StormTrack tracking(_progName, _params, _headerFilePath, _workspace);
   if (_params.perform_tracking && currentScan >= 0) {
     if (tracking.PrepareForAppend()) {
       _prepareNew(_headerFilePath, &sparams);
@@ -170,6 +190,12 @@ int StormIdent::runRealtime()
   int scanNum = currentScan;
   time_t prevTime = latestTime;
 
+  if (_inputQueue) {
+    for (int itime = currentScan + 1; itime < (int) times.size(); itime++) {
+      _inputQueue->request(times[itime]);
+    }
+  }
+
   for (int itime = currentScan + 1; itime < (int) times.size(); itime++) {
     if (_processScan(scanNum + 1, times[itime], tracking)) {
       cerr << "ERROR - StormIdent::runRealtime" << endl;
@@ -230,6 +256,16 @@ int StormIdent::runRealtime()
     // the new list will contain only a single entry
     
     mdvTimes.setArchive(_params.input_url, prevTime + 1, latestTime);
+
+    // in pipelined mode, the reader thread reads ahead through the list
+
+    if (_inputQueue) {
+      for (int itime = 0; itime < (int) times.size(); itime++) {
+        if (times[itime] <= restartTime) {
+          _inputQueue->request(times[itime]);
+        }
+      }
+    }
     
     // process the times list
     
@@ -301,6 +337,18 @@ int StormIdent::runRealtime()
 }
 
       
+//////////////////////////////////////////////////
+// setParallelDay
+
+void StormIdent::setParallelDay(time_t output_start_time,
+                                time_t output_end_time)
+
+{
+  _parallelDay = true;
+  _outputStartTime = output_start_time;
+  _outputEndTime = output_end_time;
+}
+
 //////////////////////////////////////////////////
 // runArchive
 
@@ -347,7 +395,7 @@ int StormIdent::runArchive(time_t overlap_start_time,
 
   // create storm track object in case we need it
   
-  StormTrack tracking(_progName, _params, _headerFilePath);
+  StormTrack tracking(_progName, _params, _headerFilePath, _workspace);
   
   // loop through the input radar MDV files
   
@@ -425,7 +473,7 @@ int StormIdent::runForecast(time_t gen_time)
   
   // create storm track object in case we need it
   
-  StormTrack tracking(_progName, _params, _headerFilePath);
+  StormTrack tracking(_progName, _params, _headerFilePath, _workspace);
   
   // loop through the input radar MDV files
   
@@ -473,10 +521,11 @@ int StormIdent::_processScan(int scan_num, time_t scan_time,
   PMU_auto_register(pmu_message);
   
   _fatalError = false;
+  _workspace.startScan();
     
   // read in MDV data
   
-  if (_inputMdv.read(scan_time)) {
+  if (_readScan(scan_time)) {
     cerr << "ERROR - StormIdent::_identAndTrack" << endl;
     cerr << "  Cannot read data for time: " << utimstr(scan_time) << endl;
     return -1;
@@ -489,6 +538,10 @@ int StormIdent::_processScan(int scan_num, time_t scan_time,
 
   // identify storms
   
+  if (_parallelDay) {
+    _identify.setWriteOutput(scan_time >= _outputStartTime &&
+                             scan_time < _outputEndTime);
+  }
   if (_identify.run(scan_num)) {
     _fatalError = false;
     return -1;
@@ -518,26 +571,107 @@ int StormIdent::_processScan(int scan_num, time_t scan_time,
     }
   }
 
+  if (_params.debug) {
+    _workspace.printStats(cerr);
+  }
+
   return 0;
   
 }
     
+//////////////////////////////////////////////////
+// read in the MDV data for a scan - from the reader
+// thread in pipelined mode
+
+int StormIdent::_readScan(time_t scan_time)
+
+{
+
+  if (!_inputQueue) {
+    return _inputMdv.read(scan_time);
+  }
+
+  DsMdvx *vol = _inputQueue->get(scan_time);
+  if (vol == NULL) {
+    return -1;
+  }
+  return _inputMdv.adopt(vol);
+
+}
+
+//////////////////////////////////////////////////
+// start the realtime pipeline
+//
+// The input volumes are read ahead, and the MDV output
+// written, in separate threads. The storm and track files
+// are still written in the main thread, since tracking
+// depends on them.
+//
+// If the threads cannot be started, processing is sequential.
+
+void StormIdent::_startPipeline()
+
+{
+
+  _inputQueue = new InputQueue(_progName, _params,
+                               _params.realtime_pipeline_queue_len);
+  if (_inputQueue->start()) {
+    delete _inputQueue;
+    _inputQueue = NULL;
+  }
+
+  _outputQueue = new OutputQueue(_progName, _params,
+                                 _params.realtime_pipeline_queue_len);
+  if (_outputQueue->start()) {
+    delete _outputQueue;
+    _outputQueue = NULL;
+  }
+  _identify.setOutputQueue(_outputQueue);
+
+  if (_params.debug) {
+    cerr << "Realtime pipeline - reader thread: "
+         << (_inputQueue ? "running" : "not running")
+         << ", writer thread: "
+         << (_outputQueue ? "running" : "not running") << endl;
+  }
+
+}
+
 /////////////////////////////////////////
 // _loadHeaderFilePath()
 
 void StormIdent::_loadHeaderFilePath(const time_t file_date)
 
+{
+
+  STRncopy(_headerFilePath,
+           getHeaderFilePath(_params, file_date).c_str(),
+           MAX_PATH_LEN);
+  
+}
+
+/////////////////////////////////////////
+// getHeaderFilePath()
+//
+// Static - get the storm header file path for a given date
+
+string StormIdent::getHeaderFilePath(const Params &params,
+                                     time_t file_date)
+
 {
 
   date_time_t path_time;
   path_time.unix_time = file_date;
   uconvert_from_utime(&path_time);
 
-  sprintf(_headerFilePath, "%s%s%.4d%.2d%.2d.%s",
-	  _params.storm_data_dir,
-	  PATH_DELIM,
-	  path_time.year, path_time.month, path_time.day,
-	  STORM_HEADER_FILE_EXT);
+  char path[MAX_PATH_LEN];
+  snprintf(path, MAX_PATH_LEN, "%s%s%.4d%.2d%.2d.%s",
+           params.storm_data_dir,
+           PATH_DELIM,
+           path_time.year, path_time.month, path_time.day,
+           STORM_HEADER_FILE_EXT);
+
+  return path;
   
 }
 
@@ -934,35 +1068,53 @@ int StormIdent::_prepareOld(const char *header_file_path,
 
 int StormIdent::_writeLdataInfo()
 
+{
+  
+  if (_parallelDay) {
+    // written by the parent when all days are done
+    return 0;
+  }
+
+  return writeLdataInfo(_progName, _params,
+                        _sfile._header_file_path,
+                        _sfile._header.end_time);
+
+}
+
+int StormIdent::writeLdataInfo(const string &prog_name,
+                               const Params &params,
+                               const string &header_file_path,
+                               time_t end_time)
+
 {
   
   // parse storm file path to get base part of path
   // (i.e. name without extension)
 
-  Path path(_sfile._header_file_path);
+  Path path(header_file_path);
 
   // write info
 
-  string outputDir = _params.storm_data_dir;
+  string outputDir = params.storm_data_dir;
   if (outputDir[0] != '/' && outputDir[0] != '.') {
     outputDir = "./";
-    outputDir += _params.storm_data_dir;
+    outputDir += params.storm_data_dir;
     cerr << "WARNING - _writeLdataInfo" << endl;
     cerr << "  storm_data_dir is not absolute path: "
-         << _params.storm_data_dir << endl;
+         << params.storm_data_dir << endl;
     cerr << "  Generally this should start with '.' or '/'" << endl;
     cerr << "  Writing _latest_data_info to: " << outputDir << endl;
   }
   DsLdataInfo ldata(outputDir,
-		    _params.debug >= Params::DEBUG_EXTRA);
+		    params.debug >= Params::DEBUG_EXTRA);
   
   ldata.setDataFileExt(STORM_HEADER_FILE_EXT);
-  ldata.setWriter(_progName.c_str());
+  ldata.setWriter(prog_name.c_str());
   ldata.setRelDataPath(path.getFile().c_str());
   ldata.setUserInfo1(path.getBase().c_str());
 
-  if (ldata.write(_sfile._header.end_time, "titan")) {
-    cerr << "ERROR - " << _progName << "StormIdent::_writeLdataInfo" << endl;
+  if (ldata.write(end_time, "titan")) {
+    cerr << "ERROR - " << prog_name << "StormIdent::_writeLdataInfo" << endl;
     cerr << "Cannot write index file to dir: "
 	 << outputDir << endl;
     return -1;
@@ -40,6 +40,9 @@
 #include "InputMdv.hh"
 #include "StormTrack.hh"
 #include "Identify.hh"
+#include "Workspace.hh"
+#include "InputQueue.hh"
+#include "OutputQueue.hh"
 using namespace std;
 class DsMdvxTimes;
 
@@ -53,7 +56,8 @@ public:
   // constructor
 
   StormIdent (const string &prog_name,
-	      const Params &params);
+	      const Params &params,
+	      Workspace &workspace);
 
   // destructor
   
@@ -69,6 +73,25 @@ public:
 
   int runForecast(time_t gen_time);
 
+  // Set up for running a day in ARCHIVE mode alongside other days.
+  // _latest_data_info is not written, and the MDV output is only
+  // written for scans from output_start_time up to, but not
+  // including, output_end_time - the other scans are written by
+  // the neighbouring days.
+
+  void setParallelDay(time_t output_start_time, time_t output_end_time);
+
+  // write _latest_data_info for the given storm file
+
+  static int writeLdataInfo(const string &prog_name,
+                            const Params &params,
+                            const string &header_file_path,
+                            time_t end_time);
+
+  // get the storm header file path for a given date
+
+  static string getHeaderFilePath(const Params &params, time_t file_date);
+
   // data members
   
   bool OK;
@@ -82,15 +105,29 @@ private:
   char _headerFilePath[MAX_PATH_LEN];
 
   TitanStormFile _sfile;
+  Workspace &_workspace;
   InputMdv _inputMdv;
   Identify _identify;
 
+  // realtime pipeline - NULL unless realtime_pipeline is set
+
+  InputQueue *_inputQueue;
+  OutputQueue *_outputQueue;
+
   bool _fatalError;
 
+  // parallel day - see setParallelDay()
+
+  bool _parallelDay;
+  time_t _outputStartTime;
+  time_t _outputEndTime;
+
   void _loadHeaderFilePath(const time_t ftime);
   void _loadStormParams(storm_file_params_t *sparams);
   int _processScan(int scan_num, time_t scan_time,
 		   StormTrack &tracking);
+  int _readScan(time_t scan_time);
+  void _startPipeline();
 
   void _getLastMatch(int initial_scan_match,
 		     int *last_scan_match_p,
@@ -45,15 +45,15 @@ using namespace std;
 // Constructor
 
 StormTrack::StormTrack(const string &prog_name, const Params &params,
-		       const string &storm_header_path) :
-  Worker(prog_name, params)
+		       const string &storm_header_path,
+		       Workspace &workspace) :
+  Worker(prog_name, params),
+  _workspace(workspace)
   
 {
 
   _stormHeaderPath = storm_header_path;
-  _stateFilePath = _params.storm_data_dir;
-  _stateFilePath += PATH_DELIM;
-  _stateFilePath += "_tracking.state";
+  _stateFilePath = getStateFilePath(_params, _stormHeaderPath);
 
   _filePrepared = false;
   
@@ -72,6 +72,31 @@ StormTrack::~StormTrack()
   _closeFiles();
 }
 
+//////////////////////////////////////////////////
+// Get the path of the tracking state file
+
+string StormTrack::getStateFilePath(const Params &params,
+                                    const string &storm_header_path)
+
+{
+
+  string path = params.storm_data_dir;
+  path += PATH_DELIM;
+
+  if (params.n_archive_processes > 1 &&
+      (params.mode == Params::ARCHIVE || params.mode == Params::RETRACK)) {
+    Path header(storm_header_path);
+    path += "_tracking.";
+    path += header.getBase();
+    path += ".state";
+  } else {
+    path += "_tracking.state";
+  }
+
+  return path;
+
+}
+
 ///////////////////////
 // clear storms1 vector
 
@@ -153,6 +178,8 @@ int StormTrack::ReTrack ()
   int nScans = _sfile.header().n_scans;
   for (int iscan = 1; iscan < nScans; iscan++) {
     
+    _workspace.startScan();
+
     // set up this scan
 
     if (_setupScan(iscan)) {
@@ -188,6 +215,10 @@ int StormTrack::ReTrack ()
     // _storms1, freeing the rest
 
     _transferStorms();
+
+    if (_params.debug) {
+      _workspace.printStats(cerr);
+    }
     
   } // iscan
 
@@ -667,7 +698,7 @@ int StormTrack::_track(int scan_num)
     // load up overlap areas between polygons from time 1 and
     // polygons at time 2
     
-    TrOverlaps overlaps(_progName, _params);
+    TrOverlaps overlaps(_progName, _params, _workspace);
     overlaps.find(_sfile, _storms1, _storms2, d_hours);
 
     // check overlap matches for max number of parents and children
@@ -38,6 +38,7 @@
 
 #include "Worker.hh"
 #include "TrStorm.hh"
+#include "Workspace.hh"
 #include <toolsa/MemBuf.hh>
 #include <euclid/point.h>
 using namespace std;
@@ -52,7 +53,8 @@ public:
   // constructor
 
   StormTrack (const string &prog_name, const Params &params,
-	      const string &storm_header_path);
+	      const string &storm_header_path,
+	      Workspace &workspace);
 
   // destructor
   
@@ -78,6 +80,14 @@ public:
 
   bool fatalError() { return _fatalError; }
 
+  // Get the path of the tracking state file for a storm file.
+  // In parallel ARCHIVE and RETRACK runs (n_archive_processes > 1),
+  // several storm files are tracked at once, so each one has its
+  // own state file, named from the storm file.
+
+  static string getStateFilePath(const Params &params,
+                                 const string &storm_header_path);
+
 protected:
   
 private:
@@ -86,6 +96,7 @@ private:
   string _stormHeaderPath;
   string _stateFilePath;
   time_t _stateTag;
+  Workspace &_workspace;
   TitanStormFile _sfile;
   TitanTrackFile _tfile;
   vector<TrStorm*> _storms1;
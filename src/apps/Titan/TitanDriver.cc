@@ -17,7 +17,14 @@
 #include "Sounding.hh"
 #include <toolsa/pmu.h>
 #include <titan/track.h>
+#include <titan/TitanStormFile.hh>
 #include <didss/DsInputPath.hh>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <map>
 using namespace std;
 
 // Constructor
@@ -181,7 +188,7 @@ int TitanDriver::_runRealtime ()
     
     // run StormIdent
     
-    StormIdent ident(_progName, _params);
+    StormIdent ident(_progName, _params, _workspace);
     if (ident.runRealtime()) {
       cerr << "ERROR - TitanDriver::_runRealtime" << endl;
       umsleep (1000);
@@ -200,50 +207,59 @@ int TitanDriver::_runRealtime ()
 int TitanDriver::_runArchive ()
 {
 
+  // load up the days - with auto restart there is one storm
+  // file per day, otherwise a single file for the whole period
+
+  vector<day_t> days;
+
   if (_params.auto_restart) {
     
     // compute the restart time
     
-    time_t overlapStartTime;
-    time_t startTime;
-    time_t restartTime;
+    day_t day;
 
     DataTimes::computeRestartTime(_args.startTime,
 				  _params.restart_time.hour,
 				  _params.restart_time.min,
 				  _params.restart_overlap_period,
-				  overlapStartTime,
-				  startTime,
-				  restartTime);
+				  day.overlapStartTime,
+				  day.startTime,
+				  day.endTime);
     
-    while (startTime < _args.endTime) {
-      
-      // register with procmap
-      
-      PMU_auto_register("TitanDriver::_runArchive");
-      
-      // run
-
-      StormIdent ident(_progName, _params);
-      if (ident.runArchive(overlapStartTime, startTime, restartTime)) {
-	cerr << "ERROR - TitanDriver::_runArchive" << endl;
-	return -1;
-      }
-
-      // update time range
-
-      overlapStartTime += SECS_IN_DAY;
-      startTime += SECS_IN_DAY;
-      restartTime += SECS_IN_DAY;
-
+    while (day.startTime < _args.endTime) {
+      day.stormPath = StormIdent::getHeaderFilePath(_params, day.startTime);
+      days.push_back(day);
+      day.overlapStartTime += SECS_IN_DAY;
+      day.startTime += SECS_IN_DAY;
+      day.endTime += SECS_IN_DAY;
     } // while
 
   } else {
 
     // no auto restart
 
-    StormIdent ident(_progName, _params);
-    if (ident.runArchive(_args.startTime, _args.startTime, _args.endTime)) {
+    day_t day;
+    day.overlapStartTime = _args.startTime;
+    day.startTime = _args.startTime;
+    day.endTime = _args.endTime;
+    day.stormPath = StormIdent::getHeaderFilePath(_params, day.startTime);
+    days.push_back(day);
+
+  }
+
+  if (_params.n_archive_processes > 1) {
+    return _runDaysParallel(days);
+  }
+
+  for (size_t ii = 0; ii < days.size(); ii++) {
+    
+    // register with procmap
+    
+    PMU_auto_register("TitanDriver::_runArchive");
+    
+    // run
+    
+    if (_runDay(days[ii])) {
       cerr << "ERROR - TitanDriver::_runArchive" << endl;
       return -1;
     }
@@ -261,7 +277,7 @@ int TitanDriver::_runArchive ()
 int TitanDriver::_runForecast()
 {
 
-  StormIdent ident(_progName, _params);
+  StormIdent ident(_progName, _params, _workspace);
   if (ident.runForecast(_args.genTime)) {
     cerr << "ERROR - TitanDriver::_runForecast" << endl;
     return -1;
@@ -292,22 +308,298 @@ int TitanDriver::_runRetrack ()
 
   input.setSearchExt(STORM_HEADER_FILE_EXT);
 
+  if (_params.n_archive_processes > 1) {
+    vector<day_t> days;
+    const vector<string> &stormPaths = input.getPathList();
+    for (size_t ii = 0; ii < stormPaths.size(); ii++) {
+      day_t day;
+      day.overlapStartTime = day.startTime = day.endTime = 0;
+      day.stormPath = stormPaths[ii];
+      days.push_back(day);
+    }
+    return _runDaysParallel(days);
+  }
+
   char *stormPath;
 
   while ((stormPath = input.next()) != NULL) {
     
+    day_t day;
+    day.overlapStartTime = day.startTime = day.endTime = 0;
+    day.stormPath = stormPath;
+    _runDay(day);
+
+  }
+  
+  return 0;
+
+}
+
+//////////////////////////////////////////////////
+// _runDay
+//
+// Run a single day (storm file) in ARCHIVE or RETRACK mode.
+// Returns 0 on success, -1 on failure.
+
+int TitanDriver::_runDay(const day_t &day)
+
+{
+
+  if (_params.mode == Params::RETRACK) {
+
     if (_params.debug) {
-      cerr << "Retracking file: " << stormPath << endl;
+      cerr << "Retracking file: " << day.stormPath << endl;
     }
+    
+    StormTrack strack(_progName, _params, day.stormPath, _workspace);
+    return strack.ReTrack();
+
+  }
+
+  StormIdent ident(_progName, _params, _workspace);
+  return ident.runArchive(day.overlapStartTime, day.startTime, day.endTime);
+
+}
+
+//////////////////////////////////////////////////
+// _runParallelDay
+//
+// Run a day alongside the others in ARCHIVE or RETRACK mode.
+//
+// In ARCHIVE mode the overlap period at the start of each day is
+// also processed by the previous day, so the MDV output for those
+// scans is left to the previous day, except on the first day.
+// The children do not write _latest_data_info - that is done by
+// the parent once all days are done.
+//
+// Returns 0 on success, -1 on failure.
+
+int TitanDriver::_runParallelDay(const vector<day_t> &days, size_t iday)
+
+{
 
-    StormTrack strack(_progName, _params, stormPath);
-    strack.ReTrack();
+  const day_t &day = days[iday];
 
+  if (_params.mode == Params::RETRACK) {
+    return _runDay(day);
+  }
+
+  time_t outputStartTime = day.startTime;
+  if (iday == 0) {
+    outputStartTime = day.overlapStartTime;
+  }
+  time_t outputEndTime = day.endTime;
+  if (iday == days.size() - 1) {
+    outputEndTime = day.endTime + 1;
   }
-  
-  return 0;
+
+  StormIdent ident(_progName, _params, _workspace);
+  ident.setParallelDay(outputStartTime, outputEndTime);
+  return ident.runArchive(day.overlapStartTime, day.startTime, day.endTime);
 
 }
 
+//////////////////////////////////////////////////
+// _runDaysParallel
+//
+// Run the days in child processes, with up to
+// n_archive_processes running at once.
+//
+// The children do not register with procmap, and exit
+// without running the destructors, so that the file lock
+// stays with this process.
+//
+// Returns 0 on success, -1 if any day failed.
+
+int TitanDriver::_runDaysParallel(const vector<day_t> &days)
+
+{
+
+  int iret = 0;
+  int nRunning = 0;
+  size_t nextDay = 0;
+  map<pid_t, size_t> children; // day index by child pid
+  vector<bool> dayOk(days.size(), false);
+
+  while (nextDay < days.size() || nRunning > 0) {
+
+    // start children, up to the max number
+    
+    while (nextDay < days.size() &&
+           nRunning < _params.n_archive_processes) {
+
+      const day_t &day = days[nextDay];
+      fflush(stdout);
+      fflush(stderr);
+      
+      pid_t pid = fork();
+      
+      if (pid < 0) {
+        
+        // cannot fork - run in this process instead
+
+        int errNum = errno;
+        cerr << "WARNING - TitanDriver::_runDaysParallel" << endl;
+        cerr << "  Cannot fork: " << strerror(errNum) << endl;
+        cerr << "  Running in main process: " << day.stormPath << endl;
+        if (_runParallelDay(days, nextDay)) {
+          iret = -1;
+        } else {
+          dayOk[nextDay] = true;
+        }
+
+      } else if (pid == 0) {
+
+        // child
+        
+        PMU_clear_init();
+        int childRet = _runParallelDay(days, nextDay);
+        fflush(stdout);
+        fflush(stderr);
+        _exit(childRet == 0 ? 0 : 1);
+
+      } else {
+
+        // parent
+        
+        if (_params.debug) {
+          cerr << "Started child pid " << pid
+               << " for: " << day.stormPath << endl;
+        }
+        children[pid] = nextDay;
+        nRunning++;
+
+      }
+
+      nextDay++;
+
+    } // while (nextDay ...
+
+    if (nRunning == 0) {
+      continue;
+    }
+
+    // wait for a child to finish
+
+    PMU_auto_register("TitanDriver - waiting for days");
+    
+    int status;
+    pid_t pid = waitpid(-1, &status, WNOHANG);
+    if (pid == 0) {
+      umsleep(100);
+      continue;
+    }
+    if (pid < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int errNum = errno;
+      cerr << "ERROR - TitanDriver::_runDaysParallel" << endl;
+      cerr << "  waitpid failed: " << strerror(errNum) << endl;
+      return -1;
+    }
+
+    nRunning--;
+    size_t iday = children[pid];
+    children.erase(pid);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      cerr << "ERROR - TitanDriver::_runDaysParallel" << endl;
+      cerr << "  Child pid " << pid << " failed" << endl;
+      cerr << "  Storm file: " << days[iday].stormPath << endl;
+      iret = -1;
+    } else {
+      dayOk[iday] = true;
+      if (_params.debug) {
+        cerr << "Child pid " << pid << " done" << endl;
+      }
+    }
+
+  } // while
+
+  if (days.size() == 0) {
+    return iret;
+  }
   
+  _keepLastStateFile(days, dayOk.back());
+
+  if (_params.mode == Params::ARCHIVE && dayOk.back()) {
+    if (_writeLdataInfo(days.back())) {
+      iret = -1;
+    }
+  }
 
+  return iret;
+
+}
+
+//////////////////////////////////////////////////
+// _keepLastStateFile
+//
+// In a parallel run each day has its own tracking state file.
+// Keep the state for the last day as the tracking state,
+// as in a sequential run, and remove the rest. If the last
+// day failed, its state file is removed too.
+
+void TitanDriver::_keepLastStateFile(const vector<day_t> &days,
+                                     bool lastDayOk)
+
+{
+
+  if (days.size() == 0) {
+    return;
+  }
+
+  // the days are in time order
+
+  string statePath = _params.storm_data_dir;
+  statePath += PATH_DELIM;
+  statePath += "_tracking.state";
+
+  for (size_t ii = 0; ii < days.size(); ii++) {
+    string dayPath =
+      StormTrack::getStateFilePath(_params, days[ii].stormPath);
+    if (ii == days.size() - 1 && lastDayOk) {
+      if (rename(dayPath.c_str(), statePath.c_str())) {
+        int errNum = errno;
+        cerr << "WARNING - TitanDriver::_keepLastStateFile" << endl;
+        cerr << "  Cannot rename state file: " << dayPath << endl;
+        cerr << "  to: " << statePath << endl;
+        cerr << "  " << strerror(errNum) << endl;
+      }
+    } else {
+      unlink(dayPath.c_str());
+    }
+  }
+
+}
+
+//////////////////////////////////////////////////
+// _writeLdataInfo
+//
+// Write _latest_data_info for the day's storm file, from its
+// header, after a parallel run in ARCHIVE mode.
+// Returns 0 on success, -1 on failure.
+
+int TitanDriver::_writeLdataInfo(const day_t &day)
+
+{
+
+  TitanStormFile sfile;
+  if (sfile.OpenFiles("r", day.stormPath.c_str())) {
+    cerr << "ERROR - TitanDriver::_writeLdataInfo" << endl;
+    cerr << sfile.getErrStr();
+    return -1;
+  }
+  if (sfile.LockHeaderFile("r") || sfile.ReadHeader()) {
+    cerr << "ERROR - TitanDriver::_writeLdataInfo" << endl;
+    cerr << sfile.getErrStr();
+    sfile.CloseFiles();
+    return -1;
+  }
+  time_t endTime = sfile.header().end_time;
+  sfile.CloseFiles();
+
+  return StormIdent::writeLdataInfo(_progName, _params,
+                                    day.stormPath, endTime);
+
+}
@@ -37,7 +37,10 @@
 
 #include "Args.hh"
 #include "Params.hh"
+#include "Workspace.hh"
 #include <toolsa/umisc.h>
+#include <string>
+#include <vector>
 using namespace std;
 
 // forward declatations
@@ -77,11 +80,30 @@ private:
   Params _params;
   FileLock *_fileLock;
 
+  // scratch arrays, reused from scan to scan
+
+  Workspace _workspace;
+
+  // a day (storm file) to be processed in ARCHIVE or RETRACK mode
+
+  typedef struct {
+    time_t overlapStartTime;
+    time_t startTime;
+    time_t endTime;
+    string stormPath;
+  } day_t;
+
   int _runRealtime();
   int _runArchive();
   int _runForecast();
   int _runRetrack();
 
+  int _runDay(const day_t &day);
+  int _runDaysParallel(const vector<day_t> &days);
+  int _runParallelDay(const vector<day_t> &days, size_t iday);
+  void _keepLastStateFile(const vector<day_t> &days, bool lastDayOk);
+  int _writeLdataInfo(const day_t &day);
+
 };
 
 #endif
@@ -40,6 +40,7 @@
 #include <vector>
 #include <algorithm>
 #include <toolsa/pmu.h>
+#include <kd/kd.hh>
 using namespace std;
 
 #define KM_PER_DEG_AT_EQUATOR 111.12
@@ -226,21 +227,11 @@ void TrForecast::_smooth_spatial_forecasts(TitanStormFile &sfile,
 {
   
   /*
-   * allocate the distance array. This is a 2-d array indicating
-   * which storms are within the smoothing_radius of each other.
-   * If storms are within the radius, the value is set to the 
-   * distance between them in km. If not, the value is set to -1.
+   * load up the neighbor lists, i.e. the storms within the
+   * smoothing_radius of each storm
    */
   
-  fl32 **distance_array = (fl32 **) umalloc2
-    (storms.size(), storms.size(), sizeof(fl32));
-  
-  /*
-   * load up the distance array. This is a 2-d array indicating
-   * which storms are within the smoothing_radius of each other
-   */
-  
-  _load_distance_array(sfile, storms, distance_array);
+  _load_neighbors(sfile, storms);
   
   /*
    * loop through the storms, computing the smoothed stats
@@ -280,7 +271,7 @@ void TrForecast::_smooth_spatial_forecasts(TitanStormFile &sfile,
 	}
 	
 	_smooth_motion(storms, istorm, this_track,
-		       distance_array, true, true, false);
+		       true, true, false);
 	continue;
 	
       }
@@ -292,7 +283,7 @@ void TrForecast::_smooth_spatial_forecasts(TitanStormFile &sfile,
     if (_params.tracking_smooth_invalid_forecasts &&
 	!this_track.status.forecast_valid) {
       _smooth_motion(storms, istorm, this_track,
-		     distance_array, true, false, false);
+		     true, false, false);
       continue;
     } // invalid forecast
     
@@ -301,7 +292,7 @@ void TrForecast::_smooth_spatial_forecasts(TitanStormFile &sfile,
     if (_params.tracking_spatial_smoothing &&
 	this_track.status.forecast_valid) {
       _smooth_motion(storms, istorm, this_track,
-		     distance_array, false, false,
+		     false, false,
 		     _params.tracking_smooth_erratic_only);
       continue;
     } // invalid forecast
@@ -322,12 +313,6 @@ void TrForecast::_smooth_spatial_forecasts(TitanStormFile &sfile,
       (si32) (this_track.status.smoothed_history_in_secs + 0.5);
   } // i
   
-  /*
-   * free up
-   */
-
-  ufree2((void **) distance_array);
-  
 }
 
 
@@ -911,34 +896,35 @@ void TrForecast::_get_extreme_coords(vector<TrStorm*> &storms,
 }
 
 /*********************************************************************
- * load_distance_array()
+ * load_neighbors()
+ *
+ * Load up the list of storms within the smoothing radius of each
+ * storm, with the distance between them in km. Storms with less
+ * than the min history for a valid forecast are not included.
+ * Each storm is included in its own list, with a distance of 0,
+ * or -1 if its history is too short.
  *
+ * The candidates for each storm are found from a kd tree of the
+ * storm centroids, so the cost does not grow with the square of
+ * the number of storms. The distances are computed as before,
+ * so the results are the same as for a search over all pairs.
  */
 
-void TrForecast::_load_distance_array(const TitanStormFile &sfile,
-				      vector<TrStorm*> &storms,
-				      fl32 **distance_array)
+void TrForecast::_load_neighbors(const TitanStormFile &sfile,
+				 vector<TrStorm*> &storms)
   
 {
 
   int min_history = _params.tracking_min_history_for_valid_forecast;
-  
-  double this_centroid_x, this_centroid_y;
-  double other_centroid_x, other_centroid_y;
-  double distance;
-  double dx, dy;
-  double theta;
+  double radius = _params.tracking_smoothing_radius;
+  int nStorms = (int) storms.size();
 
-  /*
-   * Initialize the array to -1.0.
-   * The -1's will be overwritten by the actual distance
-   * for storms which are closer than the smoothing distance.
-   */
-  
-  for (size_t i = 0; i < storms.size(); i++) {
-    for (size_t j = 0; j < storms.size(); j++) {
-      distance_array[i][j] = -1.0;
-    }
+  _neighbors.resize(nStorms);
+  for (int i = 0; i < nStorms; i++) {
+    _neighbors[i].clear();
+  }
+  if (nStorms == 0) {
+    return;
   }
   
   /*
@@ -953,58 +939,143 @@ void TrForecast::_load_distance_array(const TitanStormFile &sfile,
   }
 
   /*
-   * load array
+   * kd tree of the centroids
    */
+
+  vector<KD_real> coords(nStorms * 2);
+  vector<const KD_real *> points(nStorms);
+  double min_x = LARGE_DOUBLE, max_x = -LARGE_DOUBLE;
+  for (int i = 0; i < nStorms; i++) {
+    const TrTrack::props_t &current = storms[i]->current;
+    coords[i * 2] = current.proj_area_centroid_x;
+    coords[i * 2 + 1] = current.proj_area_centroid_y;
+    points[i] = &coords[i * 2];
+    min_x = MIN(min_x, current.proj_area_centroid_x);
+    max_x = MAX(max_x, current.proj_area_centroid_x);
+  }
+  KD_tree tree(&points[0], nStorms, 2);
+
+  // in latlon, the search box is in degrees. Allow a margin
+  // for rounding, since the box only selects the candidates.
+
+  double dlat = 0.0;
+  if (!flat_proj) {
+    dlat = (radius / PJG_get_earth_radius()) * RAD_TO_DEG * 1.01 + 1.0e-6;
+  }
+
+  vector<int> candidates;
   
-  for (size_t i = 0; i < storms.size(); i++) {
+  for (int i = 0; i < nStorms; i++) {
     
     TrStorm &this_storm = *storms[i];
     
     /*
-     * On the diagonal (i.e. for this_storm) set to 0.0 if
-     * the history_in_secs exceeds min_history.
+     * For this_storm, set the distance to 0.0 if
+     * the history_in_secs exceeds min_history, -1 otherwise.
      */
     
+    neighbor_t self;
+    self.index = i;
+    self.distance = -1.0;
     if (this_storm.track.status.history_in_secs >= min_history) {
-      distance_array[i][i] = 0.0;
+      self.distance = 0.0;
     }
+    _neighbors[i].push_back(self);
     
-    this_centroid_x = this_storm.current.proj_area_centroid_x;
-    this_centroid_y = this_storm.current.proj_area_centroid_y;
+    double this_centroid_x = this_storm.current.proj_area_centroid_x;
+    double this_centroid_y = this_storm.current.proj_area_centroid_y;
+
+    /*
+     * find the candidates within a box around the storm.
+     * In latlon, search all storms if the box reaches the pole
+     * or may wrap in longitude.
+     */
+
+    bool search_all = false;
+    KD_real xlimits[2], ylimits[2];
+    if (flat_proj) {
+      xlimits[0] = this_centroid_x - radius;
+      xlimits[1] = this_centroid_x + radius;
+      ylimits[0] = this_centroid_y - radius;
+      ylimits[1] = this_centroid_y + radius;
+    } else {
+      double max_lat = fabs(this_centroid_y) + dlat;
+      if (max_lat >= 89.0) {
+        search_all = true;
+      } else {
+        double sin_dist = sin(dlat * DEG_TO_RAD);
+        double cos_lat = cos(fabs(this_centroid_y) * DEG_TO_RAD);
+        double dlon = asin(MIN(1.0, sin_dist / cos_lat)) * RAD_TO_DEG;
+        dlon = dlon * 1.01 + 1.0e-6;
+        xlimits[0] = this_centroid_x - dlon;
+        xlimits[1] = this_centroid_x + dlon;
+        ylimits[0] = this_centroid_y - dlat;
+        ylimits[1] = this_centroid_y + dlat;
+        if (xlimits[0] < max_x - 360.0 || xlimits[1] > min_x + 360.0) {
+          search_all = true;
+        }
+      }
+    }
+
+    candidates.clear();
+    if (search_all) {
+      for (int j = i + 1; j < nStorms; j++) {
+        candidates.push_back(j);
+      }
+    } else {
+      const KD_real *rect[2] = { xlimits, ylimits };
+      tree.rectquery(rect, candidates);
+    }
     
-    for (size_t j = i + 1; j < storms.size(); j++) {
+    /*
+     * candidates are in index order - pairs are loaded from
+     * the lower index, so that each list stays in order
+     */
+
+    for (size_t ic = 0; ic < candidates.size(); ic++) {
+
+      int j = candidates[ic];
+      if (j <= i) {
+        continue;
+      }
       
       TrStorm &other_storm = *storms[j];
       
-      other_centroid_x = other_storm.current.proj_area_centroid_x;
-      other_centroid_y = other_storm.current.proj_area_centroid_y;
+      double other_centroid_x = other_storm.current.proj_area_centroid_x;
+      double other_centroid_y = other_storm.current.proj_area_centroid_y;
+      double distance;
       
       if (flat_proj) {
 	
-	dx = this_centroid_x - other_centroid_x;
-	dy = this_centroid_y - other_centroid_y;
+	double dx = this_centroid_x - other_centroid_x;
+	double dy = this_centroid_y - other_centroid_y;
 	distance = sqrt(dx * dx + dy * dy);
 	
       } else {
 	
+        double theta;
 	PJGLatLon2RTheta(this_centroid_y, this_centroid_x,
 			 other_centroid_y, other_centroid_x,
 			 &distance, &theta);
 	
       } /* if (flat_proj) */
 
-      if (distance < _params.tracking_smoothing_radius) {
+      if (distance < radius) {
 
+        neighbor_t neighbor;
+        neighbor.distance = distance;
 	if (other_storm.track.status.history_in_secs >= min_history) {
-	  distance_array[i][j] = distance;
+          neighbor.index = j;
+          _neighbors[i].push_back(neighbor);
 	}
 	if (this_storm.track.status.history_in_secs >= min_history) {
-	  distance_array[j][i] = distance;
+          neighbor.index = i;
+          _neighbors[j].push_back(neighbor);
 	}
 
       } /* if (distance < smoothing_radius) */
 	
-    } /* j */
+    } /* ic */
     
   } /* i */
 
@@ -1019,7 +1090,6 @@ void TrForecast::_load_distance_array(const TitanStormFile &sfile,
 void TrForecast::_smooth_motion(vector<TrStorm*> &storms,
 				size_t istorm,
 				TrTrack &this_track,
-				fl32 **distance_array,
 				bool ignore_this_storm,
 				bool history_override,
 				bool erratic_only)
@@ -1038,11 +1108,13 @@ void TrForecast::_smooth_motion(vector<TrStorm*> &storms,
   double this_storm_dirn = 0.0;
   int nClose = 0;
 
-  for (size_t jstorm = 0; jstorm < storms.size(); jstorm++) {
+  const vector<neighbor_t> &neighbors = _neighbors[istorm];
+  for (size_t ii = 0; ii < neighbors.size(); ii++) {
 
+    size_t jstorm = neighbors[ii].index;
     const TrTrack::props_t &current = storms[jstorm]->current;
     TrTrack &track = storms[jstorm]->track;
-    double distance = distance_array[istorm][jstorm];
+    double distance = neighbors[ii].distance;
     
     if (istorm != jstorm && distance < 0) {
       continue;
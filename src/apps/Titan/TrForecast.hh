@@ -57,6 +57,14 @@ public:
     double x, y;
   } xypair_t;
 
+  // storm within the smoothing radius of another
+
+  typedef struct {
+    int index;        // storm index
+    fl32 distance;    // km, -1 for the storm itself if its
+                      // history is too short
+  } neighbor_t;
+
   // constructor
 
   TrForecast(const string &prog_name, const Params &params);
@@ -83,6 +91,10 @@ private:
   bool _projIsLatLon;
   bool _useFieldTracker;
 
+  // neighbors for each storm, in storm index order
+
+  vector< vector<neighbor_t> > _neighbors;
+
   void _smooth_spatial_forecasts(TitanStormFile &sfile,
 				 vector<TrStorm*> &storms);
 
@@ -123,14 +135,12 @@ private:
 			   xypair_t *max_coord,
 			   xypair_t *min_coord);
   
-  void _load_distance_array(const TitanStormFile &sfile,
-			    vector<TrStorm*> &storms,
-			    fl32 **distance_array);
+  void _load_neighbors(const TitanStormFile &sfile,
+		       vector<TrStorm*> &storms);
   
   void _smooth_motion(vector<TrStorm*> &storms,
 		      size_t istorm,
 		      TrTrack &this_track,
-		      fl32 **distance_array,
 		      bool ignore_this_storm,
 		      bool history_override,
 		      bool erratic_only);
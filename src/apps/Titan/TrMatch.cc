@@ -96,29 +96,31 @@ void StormTrack::_matchStorms(double d_hours)
   }
 
   /*
-   * allocate mem for cost arrays and match arrray
+   * get cost arrays and match arrray from the workspace
    */
 
-  dcost = (double **) ucalloc2
-    (_storms1.size(), _storms2.size(), sizeof(double));
+  dcost = (double **) _workspace.get2
+    (Workspace::MATCH_DCOST, _storms1.size(), _storms2.size(),
+     sizeof(double), true);
 
-  icost = (long **) ucalloc2
-    (dim1, dim2, sizeof(long));
+  icost = (long **) _workspace.get2
+    (Workspace::MATCH_ICOST, dim1, dim2, sizeof(long), true);
 
-  match = (long *) ucalloc
-    ((_storms1.size() + _storms2.size()), sizeof(long));
+  match = (long *) _workspace.getZeroed
+    (Workspace::MATCH_MATCH,
+     (_storms1.size() + _storms2.size()) * sizeof(long));
 
-  xx1 = (double *) umalloc
-    ((_storms1.size() * sizeof(double)));
+  xx1 = (double *) _workspace.get
+    (Workspace::MATCH_XX1, _storms1.size() * sizeof(double));
 
-  yy1 = (double *) umalloc
-    ((_storms1.size() * sizeof(double)));
+  yy1 = (double *) _workspace.get
+    (Workspace::MATCH_YY1, _storms1.size() * sizeof(double));
 
-  xx2 = (double *) umalloc
-    ((_storms2.size() * sizeof(double)));
+  xx2 = (double *) _workspace.get
+    (Workspace::MATCH_XX2, _storms2.size() * sizeof(double));
 
-  yy2 = (double *) umalloc
-    ((_storms2.size() * sizeof(double)));
+  yy2 = (double *) _workspace.get
+    (Workspace::MATCH_YY2, _storms2.size() * sizeof(double));
   
   /*
    * load up storm coordinates
@@ -421,18 +423,6 @@ void StormTrack::_matchStorms(double d_hours)
     
   } /* if (nvalid_edges > 0) */
 
-  /*
-   * free up arrays
-   */
-
-  ufree2((void **) dcost);
-  ufree2((void **) icost);
-  ufree(match);
-  ufree(xx1);
-  ufree(yy1);
-  ufree(xx2);
-  ufree(yy2);
-
 }
 
 /********************************************************************
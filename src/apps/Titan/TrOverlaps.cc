@@ -38,23 +38,28 @@
 #include <euclid/geometry.h>
 #include <rapmath/math_macros.h>
 #include <rapmath/trig.h>
+#include <algorithm>
+#include <climits>
 using namespace std;
 
 //////////////
 // constructor
 //
 
-TrOverlaps::TrOverlaps(const string &prog_name, const Params &params) :
-  Worker(prog_name, params)
+TrOverlaps::TrOverlaps(const string &prog_name, const Params &params,
+                       Workspace &workspace) :
+  Worker(prog_name, params),
+  _workspace(workspace)
 
 {
 
-  _n_tmp_grid_alloc = 0;
-  _tmp_grid_array = NULL;
-
-  _n_overlap_grid_alloc = 0;
   _overlap_grid_array = NULL;
 
+  _index_cell_size = 1;
+  _index_min_ix = _index_min_iy = 0;
+  _index_max_ix = _index_max_iy = 0;
+  _index_nx = _index_ny = 0;
+
 }
 
 /////////////
@@ -65,14 +70,6 @@ TrOverlaps::~TrOverlaps()
 
 {
 
-  if (_tmp_grid_array) {
-    ufree(_tmp_grid_array);
-  }
-
-  if (_overlap_grid_array) {
-    ufree(_overlap_grid_array);
-  }
-
 }
 
 ////////////////
@@ -90,13 +87,40 @@ void TrOverlaps::find(const TitanStormFile &sfile,
 
   TrTrack::bounding_box_t *box2;
   TrTrack::bounding_box_t *box1;
+
+  if (storms1.size() == 0 || storms2.size() == 0) {
+    return;
+  }
+
+  /*
+   * index the time2 storms by bounding box, so that each time1
+   * storm is only checked against the storms near it
+   */
+
+  build_box_index(storms2);
+
+  /*
+   * for run overlaps, load the time2 storm runs
+   */
+
+  bool useRuns = _params.tracking_use_runs_for_overlaps;
+  if (useRuns) {
+    _current_runs.resize(storms2.size());
+    for (size_t jstorm = 0; jstorm < storms2.size(); jstorm++) {
+      load_run_list(*storms2[jstorm], _current_runs[jstorm]);
+    }
+  }
   
   for (size_t istorm = 0; istorm < storms1.size(); istorm++) {
     
     TrStorm &storm1 = *storms1[istorm];
+    bool fcastLoaded = false;
 
-    for (size_t jstorm = 0; jstorm < storms2.size(); jstorm++) {
+    find_candidates(istorm, storm1.box_for_overlap);
+
+    for (size_t icand = 0; icand < _candidates.size(); icand++) {
 	
+      int jstorm = _candidates[icand];
       TrStorm &storm2 = *storms2[jstorm];
 	
       /*
@@ -170,13 +194,22 @@ void TrOverlaps::find(const TitanStormFile &sfile,
 	  
 	} /* if (_params.debug >= Params::DEBUG_EXTRA) */
 
+	/*
+	 * the forecast runs for storm1 are only loaded once
+	 */
+
+	if (useRuns && !fcastLoaded) {
+	  load_forecast_run_list(sfile.scan().grid, storm1, _fcast_runs);
+	  fcastLoaded = true;
+	}
+
 	load_overlaps(sfile, storm1, storm2,
 		      istorm, jstorm,
 		      box1, box2);
 
       } /* if (bounds_overlap) */
       
-    } /* jstorm */
+    } /* icand */
 
   } /* istorm */
 
@@ -205,29 +238,6 @@ int TrOverlaps::compute_overlap(ui08 *overlap_grid, int npoints_grid)
   
 }
 
-/**********************
- * init_tmp_grid()
- *
- * alloc and init the tmp grid
- */
-
-void TrOverlaps::init_tmp_grid(int nbytes)
-
-{
-
-  if (nbytes > _n_tmp_grid_alloc) {
-    if (_tmp_grid_array == NULL) {
-      _tmp_grid_array = (ui08 *) umalloc(nbytes);
-    } else {
-      _tmp_grid_array = (ui08 *) urealloc(_tmp_grid_array, nbytes);
-    }
-    _n_tmp_grid_alloc = nbytes;
-  }
-
-  memset(_tmp_grid_array, 0, nbytes);
-  
-}
-
 /**********************
  * init_overlap_grid()
  *
@@ -238,16 +248,8 @@ void TrOverlaps::init_overlap_grid(int nbytes)
 
 {
 
-  if (nbytes > _n_overlap_grid_alloc) {
-    if (_overlap_grid_array == NULL) {
-      _overlap_grid_array = (ui08 *) umalloc(nbytes);
-    } else {
-      _overlap_grid_array = (ui08 *) urealloc(_overlap_grid_array, nbytes);
-    }
-    _n_overlap_grid_alloc = nbytes;
-  }
-
-  memset(_overlap_grid_array, 0, nbytes);
+  _overlap_grid_array = (ui08 *)
+    _workspace.getZeroed(Workspace::OVERLAP_GRID, nbytes);
   
 }
 
@@ -314,47 +316,6 @@ int TrOverlaps::load_current_poly(const TitanStormFile &sfile,
 
 }
 
-/**************************************************
- * load_current_runs()
- *
- * Load up grid with runs in their current position
- *
- * Returns number of points touched in grid
- */
-
-int TrOverlaps::load_current_runs(TrStorm &storm,
-				  TrTrack::bounding_box_t *both,
-				  int nx,
-				  ui08 *data_grid,
-				  int val)
-
-{
-
-  ui08 *gp;
-  int i, irun;
-  int index;
-  int count = 0;
-  storm_file_run_t *run;
-
-  run = storm.proj_runs;
-  for (irun = 0; irun < storm.status.n_proj_runs; irun++, run++) {
-
-    index = (((run->iy - both->min_iy) * nx) +
-	     (run->ix - both->min_ix));
-
-    gp = data_grid + index;
-
-    for (i = 0; i < run->n; i++, gp++) {
-      *gp += val;
-      count++;
-    } /* i */
-
-  } /* irun */
-  
-  return (count);
-  
-}
-
 /*****************************************************
  * load_forecast_poly()
  *
@@ -418,35 +379,174 @@ int TrOverlaps::load_forecast_poly(const TitanStormFile &sfile,
 
 }
 
-/***********************
- * load_forecast_runs()
+/*********************************************************
+ * build_box_index()
  *
- * Load up overlap grid with storm runs from tmp grid,
- * taking into account storm motion and growth
+ * Index the time2 storms by bounding box. The index is a uniform
+ * grid of cells, each with a list of the storms whose box touches
+ * it. The cell size is the mean box size, so a box touches only a
+ * few cells.
+ */
+
+void TrOverlaps::build_box_index(const vector<TrStorm*> &storms2)
+
+{
+
+  int min_ix = 0, min_iy = 0, max_ix = 0, max_iy = 0;
+  double sum_size = 0.0;
+
+  for (size_t jstorm = 0; jstorm < storms2.size(); jstorm++) {
+    const TrTrack::bounding_box_t &box = storms2[jstorm]->box_for_overlap;
+    if (jstorm == 0) {
+      min_ix = box.min_ix;
+      min_iy = box.min_iy;
+      max_ix = box.max_ix;
+      max_iy = box.max_iy;
+    } else {
+      min_ix = MIN(min_ix, box.min_ix);
+      min_iy = MIN(min_iy, box.min_iy);
+      max_ix = MAX(max_ix, box.max_ix);
+      max_iy = MAX(max_iy, box.max_iy);
+    }
+    sum_size += MAX(box.max_ix - box.min_ix, box.max_iy - box.min_iy) + 1;
+  }
+
+  /*
+   * limit the number of cells for sparse, widely spread storms
+   */
+
+  int max_cells = MAX(64, (int) storms2.size() * 4);
+  int cell_size = MAX(4, (int) (sum_size / storms2.size() + 0.5));
+  int nx, ny;
+  while (true) {
+    nx = (max_ix - min_ix) / cell_size + 1;
+    ny = (max_iy - min_iy) / cell_size + 1;
+    if (nx * ny <= max_cells) {
+      break;
+    }
+    cell_size *= 2;
+  }
+
+  _index_cell_size = cell_size;
+  _index_min_ix = min_ix;
+  _index_min_iy = min_iy;
+  _index_max_ix = max_ix;
+  _index_max_iy = max_iy;
+  _index_nx = nx;
+  _index_ny = ny;
+
+  _index_cells.resize(nx * ny);
+  for (size_t ii = 0; ii < _index_cells.size(); ii++) {
+    _index_cells[ii].clear();
+  }
+
+  for (size_t jstorm = 0; jstorm < storms2.size(); jstorm++) {
+    const TrTrack::bounding_box_t &box = storms2[jstorm]->box_for_overlap;
+    int cx1 = (box.min_ix - min_ix) / cell_size;
+    int cx2 = (box.max_ix - min_ix) / cell_size;
+    int cy1 = (box.min_iy - min_iy) / cell_size;
+    int cy2 = (box.max_iy - min_iy) / cell_size;
+    for (int cy = cy1; cy <= cy2; cy++) {
+      for (int cx = cx1; cx <= cx2; cx++) {
+        _index_cells[cy * nx + cx].push_back(jstorm);
+      }
+    }
+  }
+
+  _index_stamp.assign(storms2.size(), -1);
+
+}
+
+/*********************************************************
+ * find_candidates()
  *
- * Returns number of points touched in overlap grid.
+ * Load _candidates with the time2 storms in the index cells
+ * touched by the box, in storm order.
  */
 
-int TrOverlaps::load_forecast_runs(TrStorm &storm,
-				   TrTrack::bounding_box_t *both,
-				   int nx, int ny,
-				   const titan_grid_t &grid,
-				   ui08 *overlap_grid,
-				   ui08 *tmp_grid)
-     
+void TrOverlaps::find_candidates(int istorm,
+                                 const TrTrack::bounding_box_t &box)
+
 {
 
-  si32 ix, jx, iy, jy;
-  si32 index, jndex;
-  int count = 0;
-  ui08 val;
+  _candidates.clear();
 
-  double x, y;
-  double grid_ix, grid_iy;
-  double xratio, yratio;
-  double forecast_ix, forecast_iy;
+  int min_ix = MAX(box.min_ix, _index_min_ix);
+  int min_iy = MAX(box.min_iy, _index_min_iy);
+  int max_ix = MIN(box.max_ix, _index_max_ix);
+  int max_iy = MIN(box.max_iy, _index_max_iy);
+  if (min_ix > max_ix || min_iy > max_iy) {
+    return;
+  }
+
+  int cx1 = (min_ix - _index_min_ix) / _index_cell_size;
+  int cx2 = (max_ix - _index_min_ix) / _index_cell_size;
+  int cy1 = (min_iy - _index_min_iy) / _index_cell_size;
+  int cy2 = (max_iy - _index_min_iy) / _index_cell_size;
+
+  for (int cy = cy1; cy <= cy2; cy++) {
+    for (int cx = cx1; cx <= cx2; cx++) {
+      const vector<int> &cell = _index_cells[cy * _index_nx + cx];
+      for (size_t ii = 0; ii < cell.size(); ii++) {
+        int jstorm = cell[ii];
+        if (_index_stamp[jstorm] != istorm) {
+          _index_stamp[jstorm] = istorm;
+          _candidates.push_back(jstorm);
+        }
+      }
+    }
+  }
+
+  sort(_candidates.begin(), _candidates.end());
+
+}
+
+/*********************************************************
+ * load_run_list()
+ *
+ * Load the storm runs, sorted by row and column.
+ */
+
+void TrOverlaps::load_run_list(const TrStorm &storm,
+                               vector<run_t> &runs)
+
+{
+
+  runs.resize(storm.status.n_proj_runs);
+  const storm_file_run_t *srun = storm.proj_runs;
+  for (int irun = 0; irun < storm.status.n_proj_runs; irun++, srun++) {
+    run_t &run = runs[irun];
+    run.iy = srun->iy;
+    run.start_ix = srun->ix;
+    run.end_ix = srun->ix + srun->n - 1;
+  }
+
+  sort(runs.begin(), runs.end(), run_less);
+
+}
+
+/*********************************************************
+ * load_forecast_run_list()
+ *
+ * Load the runs for the storm in its forecast position, taking
+ * into account storm motion and growth. Each point in the
+ * forecast bounding box is mapped back to the nearest point in
+ * the current position, and is set if that point is in a run.
+ */
+
+void TrOverlaps::load_forecast_run_list(const titan_grid_t &grid,
+                                        TrStorm &storm,
+                                        vector<run_t> &fcast)
+
+{
+
+  fcast.clear();
+
+  load_run_list(storm, _storm1_runs);
+  if (_storm1_runs.size() == 0) {
+    return;
+  }
 
-  titan_grid_t fcast_grid;
   TrTrack::props_t *current = &storm.current;
   TrTrack &track = storm.track;
 
@@ -454,8 +554,8 @@ int TrOverlaps::load_forecast_runs(TrStorm &storm,
    * compute current posn in terms of the grid
    */
   
-  grid_ix = (current->proj_area_centroid_x - grid.minx) / grid.dx;
-  grid_iy = (current->proj_area_centroid_y - grid.miny) / grid.dy;
+  double grid_ix = (current->proj_area_centroid_x - grid.minx) / grid.dx;
+  double grid_iy = (current->proj_area_centroid_y - grid.miny) / grid.dy;
   
   /*
    * Compute the cartesian grid parameters for the forecast time.
@@ -464,64 +564,187 @@ int TrOverlaps::load_forecast_runs(TrStorm &storm,
    * tool to compute the position of each grid forecast point
    */
       
+  titan_grid_t fcast_grid;
   fcast_grid.dx = grid.dx * track.status.forecast_length_ratio;
   fcast_grid.dy = grid.dy * track.status.forecast_length_ratio;
   
   fcast_grid.minx = track.status.forecast_x - grid_ix * fcast_grid.dx;
   fcast_grid.miny = track.status.forecast_y - grid_iy * fcast_grid.dy;
 
-  y = storm.box_for_overlap.min_iy * grid.dy + grid.miny;
-  yratio = grid.dy / fcast_grid.dy;
-  forecast_iy = (y - fcast_grid.miny) / fcast_grid.dy;
+  double y = storm.box_for_overlap.min_iy * grid.dy + grid.miny;
+  double yratio = grid.dy / fcast_grid.dy;
+  double forecast_iy = (y - fcast_grid.miny) / fcast_grid.dy;
   
-  for (iy = storm.box_for_overlap.min_iy;
+  for (int iy = storm.box_for_overlap.min_iy;
        iy <= storm.box_for_overlap.max_iy;
        iy++, forecast_iy += yratio) {
     
-    jy = (int) (forecast_iy + 0.5);
+    int jy = (int) (forecast_iy + 0.5);
 
-    if (jy > both->min_iy + ny - 1) {
-      jy = both->min_iy + ny - 1;
-    }
-    if (jy < both->min_iy) {
-      jy = both->min_iy;
+    /*
+     * find the current runs in row jy
+     */
+
+    run_t key;
+    key.iy = jy;
+    key.start_ix = INT_MIN;
+    key.end_ix = INT_MIN;
+    vector<run_t>::const_iterator run =
+      lower_bound(_storm1_runs.begin(), _storm1_runs.end(), key, run_less);
+    if (run == _storm1_runs.end() || run->iy != jy) {
+      continue;
     }
 
-    x = storm.box_for_overlap.min_ix * grid.dx + grid.minx;
-    xratio = grid.dx / fcast_grid.dx;
-    forecast_ix = (x - fcast_grid.minx) / fcast_grid.dx;
+    /*
+     * jx increases with ix, so step through the runs in the row
+     */
     
-    for (ix = storm.box_for_overlap.min_ix;
+    double x = storm.box_for_overlap.min_ix * grid.dx + grid.minx;
+    double xratio = grid.dx / fcast_grid.dx;
+    double forecast_ix = (x - fcast_grid.minx) / fcast_grid.dx;
+    bool in_run = false;
+    
+    for (int ix = storm.box_for_overlap.min_ix;
 	 ix <= storm.box_for_overlap.max_ix;
 	 ix++, forecast_ix += xratio) {
       
-      jx = (int) (forecast_ix + 0.5);
+      int jx = (int) (forecast_ix + 0.5);
 
-      if (jx > both->min_ix + nx - 1) {
-	jx = both->min_ix + nx - 1;
+      while (run != _storm1_runs.end() && run->iy == jy &&
+             run->end_ix < jx) {
+        run++;
       }
-      if (jx < both->min_ix) {
-	jx = both->min_ix;
-      }
-
-      jndex = (jy - both->min_iy) * nx + (jx - both->min_ix);
-
-      val = tmp_grid[jndex];
-
-      if (val) {
-	index = (iy - both->min_iy) * nx + (ix - both->min_ix);
-	overlap_grid[index] = val;
-	count++;
+      bool set = (run != _storm1_runs.end() && run->iy == jy &&
+                  run->start_ix <= jx);
+
+      if (set && in_run) {
+        fcast.back().end_ix = ix;
+      } else if (set) {
+        run_t frun;
+        frun.iy = iy;
+        frun.start_ix = ix;
+        frun.end_ix = ix;
+        fcast.push_back(frun);
       }
+      in_run = set;
       
     } /* ix */
     
   } /* iy */
 
-  return (count);
+}
+
+/*********************************************************
+ * count_points()
+ *
+ * Returns the number of grid points in the runs
+ */
+
+int TrOverlaps::count_points(const vector<run_t> &runs)
+
+{
+
+  int count = 0;
+  for (size_t ii = 0; ii < runs.size(); ii++) {
+    count += runs[ii].end_ix - runs[ii].start_ix + 1;
+  }
+  return count;
+
+}
+
+/*********************************************************
+ * intersect_runs()
+ *
+ * Returns the number of grid points common to two sorted
+ * run lists.
+ */
+
+int TrOverlaps::intersect_runs(const vector<run_t> &runs1,
+                               const vector<run_t> &runs2)
+
+{
+
+  int count = 0;
+  size_t ii = 0, jj = 0;
+
+  while (ii < runs1.size() && jj < runs2.size()) {
+
+    const run_t &run1 = runs1[ii];
+    const run_t &run2 = runs2[jj];
+
+    if (run1.iy != run2.iy) {
+      if (run1.iy < run2.iy) {
+        ii++;
+      } else {
+        jj++;
+      }
+      continue;
+    }
+
+    int start_ix = MAX(run1.start_ix, run2.start_ix);
+    int end_ix = MIN(run1.end_ix, run2.end_ix);
+    if (end_ix >= start_ix) {
+      count += end_ix - start_ix + 1;
+    }
+
+    if (run1.end_ix < run2.end_ix) {
+      ii++;
+    } else {
+      jj++;
+    }
+
+  }
+
+  return count;
 
 }
 
+/*********************************************************
+ * load_run_grid()
+ *
+ * Add val to the grid for the points in the runs.
+ * Used for debug printing.
+ */
+
+void TrOverlaps::load_run_grid(const vector<run_t> &runs,
+                               TrTrack::bounding_box_t *both,
+                               int nx, int ny,
+                               ui08 *data_grid,
+                               int val)
+
+{
+
+  for (size_t irun = 0; irun < runs.size(); irun++) {
+    const run_t &run = runs[irun];
+    int iy = run.iy - both->min_iy;
+    if (iy < 0 || iy >= ny) {
+      continue;
+    }
+    for (int ix = run.start_ix; ix <= run.end_ix; ix++) {
+      int jx = ix - both->min_ix;
+      if (jx >= 0 && jx < nx) {
+        data_grid[iy * nx + jx] += val;
+      }
+    }
+  }
+
+}
+
+/*********************************************************
+ * run_less()
+ *
+ * Run ordering - by row, then column
+ */
+
+bool TrOverlaps::run_less(const run_t &a, const run_t &b)
+
+{
+  if (a.iy != b.iy) {
+    return (a.iy < b.iy);
+  }
+  return (a.start_ix < b.start_ix);
+}
+
 void TrOverlaps::load_overlaps(const TitanStormFile &sfile,
 			       TrStorm &storm1,
 			       TrStorm &storm2,
@@ -591,28 +814,14 @@ void TrOverlaps::load_overlaps(const TitanStormFile &sfile,
   if (_params.tracking_use_runs_for_overlaps) {
 
     /*
-     * load tmp grid with storm1 runs
-     */
-    
-    init_tmp_grid(npoints_grid);
-    init_overlap_grid(npoints_grid);
-    
-    load_current_runs(storm1, &both, nx, _tmp_grid_array, 1);
-    
-    /*
-     * copy this storm onto the overlap grid, taking account of
-     * movement and growth
-     */
-    
-    npoints_1 = load_forecast_runs(storm1, &both, nx, ny, grid,
-				   _overlap_grid_array,
-				   _tmp_grid_array);
-    
-    /*
-     * add points for storm2 runs
+     * intersect the storm1 runs, moved to the forecast position,
+     * with the storm2 runs
      */
-    
-    npoints_2 = load_current_runs(storm2, &both, nx, _overlap_grid_array, 2);
+
+    const vector<run_t> &runs2 = _current_runs[jstorm];
+    npoints_1 = count_points(_fcast_runs);
+    npoints_2 = count_points(runs2);
+    npoints_overlap = intersect_runs(_fcast_runs, runs2);
 
   } else {
 
@@ -624,13 +833,13 @@ void TrOverlaps::load_overlaps(const TitanStormFile &sfile,
     npoints_2 = load_current_poly(sfile, storm2, &both,
 				  nx, ny, _overlap_grid_array, 2);
 
-  }
-  
-  /*
-   * compute overlap
-   */
+    /*
+     * compute overlap
+     */
   
-  npoints_overlap = compute_overlap(_overlap_grid_array, npoints_grid);
+    npoints_overlap = compute_overlap(_overlap_grid_array, npoints_grid);
+
+  }
   
   /*
    * compute areas
@@ -656,6 +865,12 @@ void TrOverlaps::load_overlaps(const TitanStormFile &sfile,
       fprintf(stderr, "fraction_1, fraction_2, sum_fraction: "
 	      "%g, %g, %g\n",
 	      fraction_1, fraction_2, sum_fraction);
+      if (_params.tracking_use_runs_for_overlaps) {
+        init_overlap_grid(npoints_grid);
+        load_run_grid(_fcast_runs, &both, nx, ny, _overlap_grid_array, 1);
+        load_run_grid(_current_runs[jstorm], &both, nx, ny,
+                      _overlap_grid_array, 2);
+      }
       print_overlap(_overlap_grid_array, nx, ny);
       fprintf(stderr, "-------------------------\n");
 	    
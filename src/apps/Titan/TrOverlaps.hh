@@ -39,6 +39,7 @@
 #include <vector>
 #include "Worker.hh"
 #include "TrStorm.hh"
+#include "Workspace.hh"
 using namespace std;
 
 ////////////////////////////////
@@ -50,7 +51,8 @@ public:
 
   // constructor
 
-  TrOverlaps(const string &prog_name, const Params &params);
+  TrOverlaps(const string &prog_name, const Params &params,
+             Workspace &workspace);
 
   // destructor
   
@@ -68,18 +70,38 @@ protected:
   
 private:
 
-  int _n_tmp_grid_alloc;
-  ui08 *_tmp_grid_array;
+  // a run of grid points in a row
 
-  int _n_overlap_grid_alloc;
+  typedef struct {
+    int iy;
+    int start_ix;
+    int end_ix;
+  } run_t;
+
+  Workspace &_workspace;
   ui08 *_overlap_grid_array;
 
+  // bounding box index for the time2 storms - a uniform grid
+  // of cells, each listing the storms whose boxes touch it
+
+  int _index_cell_size;
+  int _index_min_ix, _index_min_iy;
+  int _index_max_ix, _index_max_iy;
+  int _index_nx, _index_ny;
+  vector< vector<int> > _index_cells;
+  vector<int> _index_stamp;
+  vector<int> _candidates;
+
+  // sorted runs, for run overlaps
+
+  vector< vector<run_t> > _current_runs; // time2 storms
+  vector<run_t> _storm1_runs;            // time1 storm, current posn
+  vector<run_t> _fcast_runs;             // time1 storm, forecast posn
+
   // functions
 
   int compute_overlap(ui08 *overlap_grid, int npoints_grid);
   
-  void init_tmp_grid(int nbytes);
-  
   void init_overlap_grid(int nbytes);
   
   int load_current_poly(const TitanStormFile &sfile,
@@ -89,12 +111,6 @@ private:
 			ui08 *data_grid,
 			int val);
   
-  int load_current_runs(TrStorm &storm,
-			TrTrack::bounding_box_t *both,
-			int nx,
-			ui08 *data_grid,
-			int val);
-  
   int load_forecast_poly(const TitanStormFile &sfile,
 			 TrStorm &storm,
 			 TrTrack::bounding_box_t *both,
@@ -102,12 +118,30 @@ private:
 			 ui08 *data_grid,
 			 int val);
   
-  int load_forecast_runs(TrStorm &storm,
-			 TrTrack::bounding_box_t *both,
-			 int nx, int ny,
-			 const titan_grid_t &grid,
-			 ui08 *overlap_grid,
-			 ui08 *tmp_grid);
+  void build_box_index(const vector<TrStorm*> &storms2);
+
+  void find_candidates(int istorm,
+                       const TrTrack::bounding_box_t &box);
+
+  void load_run_list(const TrStorm &storm,
+                     vector<run_t> &runs);
+
+  void load_forecast_run_list(const titan_grid_t &grid,
+                              TrStorm &storm,
+                              vector<run_t> &fcast);
+
+  static int count_points(const vector<run_t> &runs);
+
+  static int intersect_runs(const vector<run_t> &runs1,
+                            const vector<run_t> &runs2);
+
+  void load_run_grid(const vector<run_t> &runs,
+                     TrTrack::bounding_box_t *both,
+                     int nx, int ny,
+                     ui08 *data_grid,
+                     int val);
+
+  static bool run_less(const run_t &a, const run_t &b);
   
   void load_overlaps(const TitanStormFile &sfile,
 		     TrStorm &storm1,
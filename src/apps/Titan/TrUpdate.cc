@@ -272,7 +272,8 @@ int StormTrack::_handleCombined(date_time_t *dtime,
    * forecast position and the combined centroid
    */
 
-  pos_corr = (Point_d *) umalloc (storm2.status.n_match * sizeof(Point_d));
+  pos_corr = (Point_d *) _workspace.get
+    (Workspace::UPDATE_POS_CORR, storm2.status.n_match * sizeof(Point_d));
   
   if (storm2.status.has_split && !storm2.status.has_merger) {
 
@@ -392,12 +393,6 @@ int StormTrack::_handleCombined(date_time_t *dtime,
 	
   } /* ihist */
   
-  /*
-   * free up resources
-   */
-  
-  ufree(pos_corr);
-
   return (0);
 
 }
@@ -160,7 +160,7 @@ void Verify::updateValidStormsGrid(const GridClump &grid_clump)
 // writeOutputMdv()
 //
 
-int Verify::writeOutputMdv()
+int Verify::writeOutputMdv(OutputQueue *queue /* = NULL */)
   
 {
 
@@ -189,7 +189,7 @@ int Verify::writeOutputMdv()
   
   // write out
 
-  if (out.writeVol()) {
+  if (out.writeVol(queue)) {
     cerr << "ERROR - Verify::writeOutputMdv" << endl;
     return -1;
   }
@@ -42,6 +42,7 @@
 using namespace std;
 class InputMdv;
 class GridClump;
+class OutputQueue;
 
 ////////////////////////////////
 // Verify
@@ -73,7 +74,7 @@ public:
 
   // write out MDV file
 
-  int writeOutputMdv();
+  int writeOutputMdv(OutputQueue *queue = NULL);
 
 protected:
   
@@ -0,0 +1,181 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// Workspace.cc
+//
+// Workspace class - scratch arrays for identification and
+// tracking, reused from scan to scan.
+//
+///////////////////////////////////////////////////////////////
+
+#include "Workspace.hh"
+#include <toolsa/umisc.h>
+#include <cstring>
+using namespace std;
+
+//////////////
+// constructor
+//
+
+Workspace::Workspace()
+
+{
+
+  memset(_bufs, 0, sizeof(_bufs));
+  memset(_rows, 0, sizeof(_rows));
+  _nScans = 0;
+  _nRequestsScan = 0;
+  _nAllocsScan = 0;
+  _nAllocsTotal = 0;
+
+}
+
+/////////////
+// destructor
+//
+
+Workspace::~Workspace()
+
+{
+
+  for (int ii = 0; ii < N_BUFS; ii++) {
+    if (_bufs[ii].ptr) {
+      ufree(_bufs[ii].ptr);
+    }
+    if (_rows[ii].ptr) {
+      ufree(_rows[ii].ptr);
+    }
+  }
+
+}
+
+//////////////////////////////
+// Get a 1-D array of at least nbytes.
+// The contents are undefined.
+
+void *Workspace::get(buf_id_t id, size_t nbytes)
+
+{
+  _nRequestsScan++;
+  return _grow(_bufs[id], nbytes);
+}
+
+//////////////////////////////
+// Get a 1-D array of nbytes, set to 0.
+
+void *Workspace::getZeroed(buf_id_t id, size_t nbytes)
+
+{
+  void *ptr = get(id, nbytes);
+  memset(ptr, 0, nbytes);
+  return ptr;
+}
+
+//////////////////////////////////////////////////////
+// Get a 2-D array of n1 rows of n2 items, in the same
+// form as umalloc2(). Set to 0 if zero is true.
+
+void **Workspace::get2(buf_id_t id, size_t n1, size_t n2,
+                       size_t item_size, bool zero)
+
+{
+
+  _nRequestsScan++;
+
+  size_t rowBytes = n2 * item_size;
+  char *data = (char *) _grow(_bufs[id], n1 * rowBytes);
+  void **rows = (void **) _grow(_rows[id], n1 * sizeof(void *));
+  
+  for (size_t ii = 0; ii < n1; ii++) {
+    rows[ii] = data + ii * rowBytes;
+  }
+  if (zero) {
+    memset(data, 0, n1 * rowBytes);
+  }
+
+  return rows;
+
+}
+
+//////////////////////////////////////////
+// Start a scan - reset the per-scan counters
+
+void Workspace::startScan()
+
+{
+  _nScans++;
+  _nRequestsScan = 0;
+  _nAllocsScan = 0;
+}
+
+//////////////////////
+// Print the counters
+
+void Workspace::printStats(ostream &out) const
+
+{
+
+  out << "Workspace - scan " << _nScans
+      << ", requests: " << _nRequestsScan
+      << ", allocs: " << _nAllocsScan
+      << ", total allocs: " << _nAllocsTotal
+      << ", nbytes: " << _nbytesTotal() << endl;
+
+}
+
+////////////////////////////////////////
+// grow array to the requested size
+
+void *Workspace::_grow(buf_t &buf, size_t nbytes)
+
+{
+
+  if (nbytes > buf.nbytes || buf.ptr == NULL) {
+    size_t nalloc = (nbytes > 0 ? nbytes : 1);
+    if (buf.ptr == NULL) {
+      buf.ptr = umalloc(nalloc);
+    } else {
+      buf.ptr = urealloc(buf.ptr, nalloc);
+    }
+    buf.nbytes = nalloc;
+    _nAllocsScan++;
+    _nAllocsTotal++;
+  }
+
+  return buf.ptr;
+
+}
+
+////////////////////////////////////////
+// total size of the arrays
+
+size_t Workspace::_nbytesTotal() const
+
+{
+  size_t nbytes = 0;
+  for (int ii = 0; ii < N_BUFS; ii++) {
+    nbytes += _bufs[ii].nbytes + _rows[ii].nbytes;
+  }
+  return nbytes;
+}
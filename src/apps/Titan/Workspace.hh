@@ -0,0 +1,145 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// Workspace.hh
+//
+// Workspace class - scratch arrays for identification and
+// tracking, reused from scan to scan.
+//
+// The Workspace is owned by TitanDriver, and is passed down to
+// the per-scan classes, which borrow their working arrays from
+// it instead of allocating and freeing them for each scan or
+// storm. Each array is identified by a buf_id_t, and grows to
+// the high-water mark of the requests made for it - memory is
+// only allocated when a request is larger than any before.
+//
+// The contents of an array, and pointers into it, are only valid
+// until the next request for the same id. A Workspace is not
+// thread-safe.
+//
+// The counters for each scan show how many requests needed a new
+// allocation - in steady state this should be 0.
+//
+///////////////////////////////////////////////////////////////
+
+#ifndef Workspace_HH
+#define Workspace_HH
+
+#include <cstddef>
+#include <iostream>
+using namespace std;
+
+////////////////////////////////
+// Workspace
+
+class Workspace {
+  
+public:
+
+  // array ids
+
+  typedef enum {
+    PROPS_LAYER,
+    PROPS_DBZ_HIST,
+    PROPS_TILT_DATA,
+    PROPS_DBZ_GRADIENT_DATA,
+    AREA_COMP_GRID,
+    AREA_PRECIP_GRID,
+    AREA_DBZ_FOR_PRECIP,
+    AREA_COORDS,
+    OVERLAP_GRID,
+    MATCH_DCOST,
+    MATCH_ICOST,
+    MATCH_MATCH,
+    MATCH_XX1,
+    MATCH_YY1,
+    MATCH_XX2,
+    MATCH_YY2,
+    UPDATE_POS_CORR,
+    N_BUFS
+  } buf_id_t;
+
+  // constructor
+
+  Workspace();
+
+  // destructor
+  
+  ~Workspace();
+
+  // Get a 1-D array of at least nbytes.
+  // The contents are undefined.
+
+  void *get(buf_id_t id, size_t nbytes);
+
+  // Get a 1-D array of nbytes, set to 0.
+
+  void *getZeroed(buf_id_t id, size_t nbytes);
+
+  // Get a 2-D array of n1 rows of n2 items, in the same
+  // form as umalloc2(). Set to 0 if zero is true.
+
+  void **get2(buf_id_t id, size_t n1, size_t n2,
+              size_t item_size, bool zero = false);
+
+  // Start a scan - reset the per-scan counters
+
+  void startScan();
+
+  // Print the counters
+
+  void printStats(ostream &out) const;
+
+protected:
+  
+private:
+
+  // a growable array
+
+  typedef struct {
+    void *ptr;
+    size_t nbytes;
+  } buf_t;
+
+  buf_t _bufs[N_BUFS];
+  buf_t _rows[N_BUFS]; // row pointers for 2-D arrays
+
+  // counters
+
+  int _nScans;
+  int _nRequestsScan;  // requests this scan
+  int _nAllocsScan;    // requests this scan which allocated
+  int _nAllocsTotal;   // allocations since the start
+
+  void *_grow(buf_t &buf, size_t nbytes);
+  size_t _nbytesTotal() const;
+
+  // no copying
+
+  Workspace(const Workspace &);
+  Workspace &operator=(const Workspace &);
+
+};
+
+#endif
@@ -0,0 +1,280 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+////////////////////////////////////////////////////////////////////////
+// Tstorms2Columns.cc
+//
+// Tstorms2Columns object
+//
+///////////////////////////////////////////////////////////////
+//
+// Tstorms2Columns reads native TITAN storm and track files, and
+// converts them into a columnar store of storm properties - see
+// titan/TitanColumnStore.hh.
+//
+////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <toolsa/ucopyright.h>
+#include <toolsa/pmu.h>
+#include <toolsa/str.h>
+#include <toolsa/Path.hh>
+#include <didss/RapDataDir.hh>
+#include <titan/TitanColumnStore.hh>
+#include "Tstorms2Columns.hh"
+using namespace std;
+
+// Constructor
+
+Tstorms2Columns::Tstorms2Columns(int argc, char **argv)
+
+{
+
+  isOK = true;
+  _input = NULL;
+
+  // set programe name
+
+  _progName = "Tstorms2Columns";
+  ucopyright((char *) _progName.c_str());
+
+  // get command line args
+
+  if (_args.parse(argc, argv, _progName)) {
+    cerr << "ERROR: " << _progName << endl;
+    cerr << "Problem with command line args" << endl;
+    isOK = FALSE;
+    return;
+  }
+
+  // get TDRP params
+  
+  _paramsPath = const_cast<char*>(string("unknown").c_str());
+  if (_params.loadFromArgs(argc, argv, _args.override.list,
+			   &_paramsPath)) {
+    cerr << "ERROR: " << _progName << endl;
+    cerr << "Problem with TDRP parameters" << endl;
+    isOK = FALSE;
+  }
+
+  // check args in ARCHIVE mode
+  
+  if (_params.mode == Params::ARCHIVE) {
+    if (_args.inputFileList.size() == 0) {
+      if ((_args.startTime == 0 || _args.endTime == 0)) {
+	cerr << "ERROR: " << _progName << endl;
+	cerr << "In ARCHIVE mode, you must specify a file list" << endl
+	     << "  or start and end times." << endl;
+	isOK = FALSE;
+	return;
+      }
+    }
+  }
+
+  // init process mapper registration
+
+  PMU_auto_init((char *) _progName.c_str(),
+		_params.instance,
+		PROCMAP_REGISTER_INTERVAL);
+
+  // output dir
+
+  RapDataDir.fillPath(_params.output_dir, _outputDir);
+  if (_params.debug) {
+    cerr << "Output dir: " << _outputDir << endl;
+  }
+
+  // set up input object
+
+  if (_params.mode == Params::ARCHIVE) {
+    if (_args.inputFileList.size() > 0) {
+      _input = new DsInputPath(_progName,
+			       _params.debug >= Params::DEBUG_VERBOSE,
+			       _args.inputFileList);
+      _input->setSearchExt("th5");
+    } else if (_args.startTime != 0 && _args.endTime != 0) {
+      string inDir;
+      RapDataDir.fillPath(_params.input_dir, inDir);
+      if (_params.debug) {
+	cerr << "Input dir: " << inDir << endl;
+      }
+      _input = new DsInputPath(_progName,
+			       _params.debug >= Params::DEBUG_VERBOSE,
+			       inDir,
+			       _args.startTime,
+			       _args.endTime);
+      _input->setSearchExt("th5");
+    }
+  } else {
+    string inDir;
+    RapDataDir.fillPath(_params.input_dir, inDir);
+    if (_params.debug) {
+      cerr << "Input dir: " << inDir << endl;
+    }
+    _input = new DsInputPath(_progName,
+			     _params.debug >= Params::DEBUG_VERBOSE,
+			     inDir,
+			     _params.max_realtime_valid_age,
+			     PMU_auto_register);
+  }
+
+  return;
+
+}
+
+// destructor
+
+Tstorms2Columns::~Tstorms2Columns()
+
+{
+
+  if (_input) {
+    delete _input;
+  }
+
+  // unregister process
+
+  PMU_auto_unregister();
+
+}
+
+//////////////////////////////////////////////////
+// Run
+
+int Tstorms2Columns::Run ()
+{
+
+  // register with procmap
+  
+  PMU_auto_register("Run");
+
+  if (_params.mode == Params::ARCHIVE) {
+    _input->reset();
+  }
+
+  char *inputFilePath;
+  while ((inputFilePath = _input->next()) != NULL) {
+  
+    if (_params.debug) {
+      cerr << "Processing input file: " << inputFilePath << endl;
+    }
+
+    _processTrackFile(inputFilePath);
+    
+  }
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////
+// process track file
+
+int Tstorms2Columns::_processTrackFile (const char *input_file_path)
+
+{
+
+  TitanTrackFile tFile;
+  TitanStormFile sFile;
+
+  // open files
+
+  if (_openFiles(input_file_path, tFile, sFile)) {
+    return -1;
+  }
+
+  // write the segment for this day file. In REALTIME mode
+  // the segment is rewritten as each scan is added to the day.
+
+  TitanColumnStore store;
+  store.setDir(_outputDir);
+  store.setDebug(_params.debug >= Params::DEBUG_VERBOSE);
+
+  if (store.writeSegment(sFile, tFile)) {
+    cerr << "ERROR - Tstorms2Columns::_processTrackFile" << endl;
+    cerr << "  " << store.getErrStr() << endl;
+    return -1;
+  }
+
+  if (_params.debug) {
+    cerr << "  Wrote columns for " << sFile.header().n_scans
+         << " scans to dir: " << _outputDir << endl;
+  }
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////
+// open track and storm files
+
+int Tstorms2Columns::_openFiles(const char *input_file_path,
+			     TitanTrackFile &tFile,
+			     TitanStormFile &sFile)
+
+{
+
+  char track_file_path[MAX_PATH_LEN];
+  STRncopy(track_file_path, input_file_path, MAX_PATH_LEN);
+  if (_params.mode == Params::REALTIME) {
+    // In Realtime mode the latest data info file has
+    // the storm file in it instead of the track file so
+    // we need to change the 'sh' to a 'th'.
+    char *sh = strstr(track_file_path, "sh");
+    if (sh) {
+      *sh = 't';
+    }
+  }
+
+  if (tFile.OpenFiles("r", track_file_path)) {
+    cerr << "ERROR - Tstorms2Columns::_openFiles" << endl;
+    cerr << "  " << tFile.getErrStr() << endl;
+    return -1;
+  }
+
+  Path stormPath(track_file_path);
+  stormPath.setFile(tFile.header().storm_header_file_name);
+
+  if (sFile.OpenFiles("r", stormPath.getPath().c_str())) {
+    cerr << "ERROR - Tstorms2Columns::_openFiles" << endl;
+    cerr << "  " << sFile.getErrStr() << endl;
+    return -1;
+  }
+  
+  // lock files
+
+  if (tFile.LockHeaderFile("r")) {
+    cerr << "ERROR - Tstorms2Columns::_openFiles" << endl;
+    cerr << "  " << tFile.getErrStr() << endl;
+    return -1;
+  }
+  if (sFile.LockHeaderFile("r")) {
+    cerr << "ERROR - Tstorms2Columns::_openFiles" << endl;
+    cerr << "  " << sFile.getErrStr() << endl;
+    return -1;
+  }
+  
+  return 0;
+
+}
+
@@ -0,0 +1,91 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// Tstorms2Columns.hh
+//
+// Tstorms2Columns object
+//
+///////////////////////////////////////////////////////////////
+//
+// Tstorms2Columns reads native TITAN storm and track files, and
+// converts them into a columnar store of storm properties - see
+// titan/TitanColumnStore.hh.
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef Tstorms2Columns_H
+#define Tstorms2Columns_H
+
+#include <string>
+#include "Args.hh"
+#include "Params.hh"
+#include <didss/DsInputPath.hh>
+#include <titan/TitanStormFile.hh>
+#include <titan/TitanTrackFile.hh>
+using namespace std;
+
+////////////////////////
+// This class
+
+class Tstorms2Columns {
+  
+public:
+
+  // constructor
+
+  Tstorms2Columns (int argc, char **argv);
+
+  // destructor
+  
+  ~Tstorms2Columns();
+
+  // run 
+
+  int Run();
+
+  // data members
+
+  bool isOK;
+
+protected:
+  
+private:
+
+  string _progName;
+  char *_paramsPath;
+  Args _args;
+  Params _params;
+
+  DsInputPath *_input;
+  string _outputDir;
+
+  int _processTrackFile (const char *input_file_path);
+
+  int _openFiles(const char *input_file_path,
+		 TitanTrackFile &tFile,
+		 TitanStormFile &sFile);
+
+};
+
+#endif
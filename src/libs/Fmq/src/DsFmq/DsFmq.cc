@@ -34,6 +34,8 @@
 ////////////////////////////////////////////////////////////////////////////////
                                  
 #include <cassert>
+#include <cerrno>
+#include <sys/time.h>
 #include <toolsa/MsgLog.hh>
 #include <toolsa/Socket.hh>
 #include <toolsa/TaStr.hh>
@@ -42,6 +44,20 @@
 #include <Fmq/DsFmq.hh>
 using namespace std;
 
+// holds the write cache mutex for the life of the object
+
+class WriteCacheLock {
+public:
+  WriteCacheLock(pthread_mutex_t *mutex) : _mutex(mutex) {
+    pthread_mutex_lock(_mutex);
+  }
+  ~WriteCacheLock() {
+    pthread_mutex_unlock(_mutex);
+  }
+private:
+  pthread_mutex_t *_mutex;
+};
+
 // initialize static consts
 
 const char* DsFmq::FMQ_PROTOCOL = "fmqp";
@@ -54,16 +70,33 @@ DsFmq::DsFmq() : Fmq()
   _isServed = false;
   _socket = NULL;
   _nMessagesPerWrite = 1;
+  _maxWriteCacheMsecs = DEFAULT_MAX_WRITE_CACHE_MSECS;
+  _writeCacheStart.tv_sec = 0;
+  _writeCacheStart.tv_usec = 0;
+
+  _flushOnTimer = false;
+  _flushThreadStarted = false;
+  _flushThreadExit = false;
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&_writeCacheMutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+  pthread_cond_init(&_writeCacheCond, NULL);
 
 }
 
 // destructor
+// closing flushes any cached writes
 
 DsFmq::~DsFmq()
 {
+  _stopFlushThread();
+  closeMsgQueue();
   _clearReadQueue();
   _clearWriteQueue();
-  closeMsgQueue();
+  pthread_cond_destroy(&_writeCacheCond);
+  pthread_mutex_destroy(&_writeCacheMutex);
 }
 
 /////////////////////////////////////////////////////////////
@@ -318,12 +351,23 @@ int DsFmq::init(const char* fmqURL,
 int DsFmq::closeMsgQueue()
 {
   
+  WriteCacheLock lock(&_writeCacheMutex);
+
   if (!_isServed) {
-    // local
+    // local - flush any cached writes first
+    if (_dev != NULL && _writeQueue.size() > 0) {
+      writeTheCache();
+    }
     Fmq::closeMsgQueue();
     return 0;
   }
 
+  // flush any cached writes first
+
+  if (_socket != NULL && _writeQueue.size() > 0) {
+    writeTheCache();
+  }
+
   _socketMsg.assembleRequestClose();
   _printDebugLabel("closeMsgQueue");
 
@@ -697,9 +741,27 @@ int DsFmq::readMsgBlocking(int type)
 int DsFmq::writeMsg(int type, int subType, const void *msg, int msgLen)
 { 
 
+  WriteCacheLock lock(&_writeCacheMutex);
+
+  if (_nMessagesPerWrite < 2 && _writeQueue.size() > 0) {
+    // caching has been turned off - write the cache first,
+    // to keep the messages in order
+    addToWriteCache(type, subType, msg, msgLen);
+    return writeTheCache();
+  }
+
   if (!_isServed) {
     // local
-    return Fmq::writeMsg(type, subType, msg, msgLen);
+    if (_nMessagesPerWrite < 2) {
+      return Fmq::writeMsg(type, subType, msg, msgLen);
+    }
+    // cached - write the batch under a single lock when full,
+    // or when the oldest message has been held too long
+    addToWriteCache(type, subType, msg, msgLen);
+    if (!_writeCacheDue()) {
+      return 0;
+    }
+    return writeTheCache();
   }
 
   // assemble write message
@@ -715,8 +777,8 @@ int DsFmq::writeMsg(int type, int subType, const void *msg, int msgLen)
     // cached write
     
     addToWriteCache(type, subType, msg, msgLen);
-    if ((int) _writeQueue.size() < _nMessagesPerWrite) {
-      // not enough messages yet
+    if (!_writeCacheDue()) {
+      // not enough messages yet, and none held too long
       return 0;
     }
 
@@ -759,9 +821,19 @@ int DsFmq::writeMsg(int type, int subType, const void *msg, int msgLen)
 
 void DsFmq::clearWriteCache()
 {
+  WriteCacheLock lock(&_writeCacheMutex);
   _clearWriteQueue();
 }
 
+//////////////////////////////////////////////////////
+// get the number of messages in the write cache
+
+int DsFmq::getWriteCacheSize()
+{
+  WriteCacheLock lock(&_writeCacheMutex);
+  return (int) _writeQueue.size();
+}
+
 //////////////////////////////////////////////////////
 // Add a message to the write cache,
 // in preparation for a later write
@@ -770,6 +842,8 @@ void DsFmq::addToWriteCache(int type, int subType,
 			    const void *msg, int msgLen)
 { 
 
+  WriteCacheLock lock(&_writeCacheMutex);
+
   writeData *wdata = new writeData();
   wdata->type = type;
   wdata->subType = subType;
@@ -777,6 +851,14 @@ void DsFmq::addToWriteCache(int type, int subType,
   wdata->compress = _compress;
   wdata->compressMethod = _compressMethod;
   wdata->buf.add(msg, msgLen);
+  if (_writeQueue.size() == 0) {
+    gettimeofday(&_writeCacheStart, NULL);
+    if (_flushOnTimer) {
+      // wake the flush thread, to time the new cache
+      _startFlushThread();
+      pthread_cond_signal(&_writeCacheCond);
+    }
+  }
   _writeQueue.push_back(wdata);
 
 }
@@ -784,29 +866,34 @@ void DsFmq::addToWriteCache(int type, int subType,
 //////////////////////////////////////////////////////
 // Writes all data in the cache to the fmq.
 // For remote writes, this is performed in a single action.
-// For local writes, these are written one at a time.
+// For local writes, the messages are written as a batch,
+// see Fmq::writeMsgs().
 // Returns 0 on success, -1 on error
   
 int DsFmq::writeTheCache()
 { 
   
+  WriteCacheLock lock(&_writeCacheMutex);
+
   if (!_isServed) {
-    // local
-    int iret = 0;
-    while (_writeQueue.size() > 0) {
-      if (_debug) {
-        cerr << "writing cache, size: " << _writeQueue.size() << endl;
-      }
-      writeData *wdata = _writeQueue.front();
-      if (Fmq::writeMsg(wdata->type,
-			wdata->subType,
-			wdata->buf.getPtr(),
-			wdata->buf.getLen())) {
-	iret = -1;
-      }
-      delete wdata;
-      _writeQueue.pop_front();
+    // local - write as a batch, under a single lock
+    if (_debug) {
+      cerr << "writing cache, size: " << _writeQueue.size() << endl;
+    }
+    vector<batch_msg_t> msgs;
+    for (size_t ii = 0; ii < _writeQueue.size(); ii++) {
+      const writeData *wdata = _writeQueue[ii];
+      batch_msg_t bmsg;
+      bmsg.type = wdata->type;
+      bmsg.subType = wdata->subType;
+      bmsg.msg = wdata->buf.getPtr();
+      bmsg.len = wdata->buf.getLen();
+      bmsg.id = -1;
+      bmsg.time = 0;
+      msgs.push_back(bmsg);
     }
+    int iret = Fmq::writeMsgs(msgs);
+    _clearWriteQueue();
     return iret;
   }
 
@@ -841,6 +928,75 @@ int DsFmq::writeTheCache()
   return 0;
 }
 
+//////////////////////////////////////////////////////
+// Write a batch of messages to the fmq.
+// For remote writes, this is performed in a single action,
+// along with anything already in the write cache.
+// Returns 0 on success, -1 on error
+
+int DsFmq::writeMsgs(const vector<batch_msg_t> &msgs)
+{
+
+  WriteCacheLock lock(&_writeCacheMutex);
+
+  if (!_isServed && _writeQueue.size() == 0) {
+    // local
+    return Fmq::writeMsgs(msgs);
+  }
+
+  for (size_t ii = 0; ii < msgs.size(); ii++) {
+    addToWriteCache(msgs[ii].type, msgs[ii].subType,
+                    msgs[ii].msg, msgs[ii].len);
+  }
+  return writeTheCache();
+
+}
+
+////////////////////////////////////////////////////////////////////
+// Read a batch of messages from the fmq.
+// For remote reads, returns the messages available from a single
+// server request.
+// Returns 0 on success, -1 on error
+
+int DsFmq::readMsgs(vector<batch_msg_t> &msgs, int maxMsgs, int type)
+{
+
+  if (!_isServed) {
+    // local
+    return Fmq::readMsgs(msgs, maxMsgs, type);
+  }
+
+  msgs.clear();
+  _batchBuf.free();
+  _batchOffsets.clear();
+
+  // the first read contacts the server if nothing is queued,
+  // after that only use what the server has already sent
+
+  int iret = 0;
+  while ((int) msgs.size() < maxMsgs) {
+    if (msgs.size() > 0 && _readQueue.size() == 0) {
+      break;
+    }
+    bool gotOne = false;
+    if (readMsg(&gotOne, type)) {
+      iret = -1;
+      break;
+    }
+    if (!gotOne) {
+      break;
+    }
+    _add_batch_msg(msgs);
+  }
+  _set_batch_ptrs(msgs);
+
+  if (msgs.size() > 0) {
+    return 0;
+  }
+  return iret;
+
+}
+
 
 /////////////////////////////////////////////////////////////
 // resolve the URL
@@ -1101,6 +1257,131 @@ void DsFmq::_clearWriteQueue()
   }
 }
 
+/////////////////////////////////////////////
+// Flush the write cache if the oldest message
+// has been held longer than the max age.
+// Returns 0 on success, -1 on error
+
+int DsFmq::checkWriteCache()
+
+{
+  WriteCacheLock lock(&_writeCacheMutex);
+  if (_nMessagesPerWrite < 2 || _writeQueue.size() == 0) {
+    return 0;
+  }
+  if (!_writeCacheDue()) {
+    return 0;
+  }
+  return writeTheCache();
+}
+
+/////////////////////////////////////////////
+// Is the write cache due to be written?
+// True if it is full, or the oldest message in it
+// is older than the max age.
+
+bool DsFmq::_writeCacheDue()
+
+{
+  if ((int) _writeQueue.size() >= _nMessagesPerWrite) {
+    return true;
+  }
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  long ageMsecs = (now.tv_sec - _writeCacheStart.tv_sec) * 1000L +
+    (now.tv_usec - _writeCacheStart.tv_usec) / 1000L;
+  return (ageMsecs >= _maxWriteCacheMsecs);
+}
+
+/////////////////////////////////////////////
+// Start the write cache flush thread, if not
+// already running. Called with the mutex held.
+// If the thread cannot be started, the cache is
+// flushed by writes and checkWriteCache() only.
+
+void DsFmq::_startFlushThread()
+
+{
+  if (_flushThreadStarted) {
+    return;
+  }
+  _flushThreadExit = false;
+  if (pthread_create(&_flushThread, NULL, _flushThreadMain, this) == 0) {
+    _flushThreadStarted = true;
+  } else {
+    _flushOnTimer = false;
+    if (_debug) {
+      cerr << "WARNING - DsFmq: cannot start write cache flush thread" << endl;
+    }
+  }
+}
+
+/////////////////////////////////////////////
+// Stop the write cache flush thread
+
+void DsFmq::_stopFlushThread()
+
+{
+  pthread_mutex_lock(&_writeCacheMutex);
+  if (!_flushThreadStarted) {
+    pthread_mutex_unlock(&_writeCacheMutex);
+    return;
+  }
+  _flushThreadExit = true;
+  pthread_cond_signal(&_writeCacheCond);
+  pthread_mutex_unlock(&_writeCacheMutex);
+  pthread_join(_flushThread, NULL);
+  _flushThreadStarted = false;
+}
+
+void *DsFmq::_flushThreadMain(void *arg)
+
+{
+  DsFmq *fmq = (DsFmq *) arg;
+  fmq->_runFlushThread();
+  return NULL;
+}
+
+/////////////////////////////////////////////
+// Flush thread - waits until the oldest cached
+// message reaches the max age, and writes the
+// cache if it has not been written meanwhile.
+
+void DsFmq::_runFlushThread()
+
+{
+
+  pthread_mutex_lock(&_writeCacheMutex);
+
+  while (!_flushThreadExit) {
+
+    if (_writeQueue.size() == 0) {
+      pthread_cond_wait(&_writeCacheCond, &_writeCacheMutex);
+      continue;
+    }
+
+    long usecs = _writeCacheStart.tv_usec + _maxWriteCacheMsecs * 1000L;
+    struct timespec due;
+    due.tv_sec = _writeCacheStart.tv_sec + usecs / 1000000L;
+    due.tv_nsec = (usecs % 1000000L) * 1000L;
+    if (pthread_cond_timedwait(&_writeCacheCond, &_writeCacheMutex,
+                               &due) != ETIMEDOUT) {
+      continue;
+    }
+    
+    if (!_flushThreadExit && _writeQueue.size() > 0 && _writeCacheDue()) {
+      if (writeTheCache() && _debug) {
+        cerr << "ERROR - DsFmq flush thread" << endl;
+        cerr << getErrStr();
+      }
+    }
+
+  } // while
+
+  pthread_mutex_unlock(&_writeCacheMutex);
+
+}
+
 /////////////////////////////////////////////
 // check for error
 // if error, add in error string from client
@@ -30,6 +30,7 @@
                                  
 #include <cassert>
 #include <iostream>
+#include <sys/time.h>
 
 #include <dataport/bigend.h>                    
 #include <Fmq/DsRadarQueue.hh>                    
@@ -40,6 +41,51 @@ using namespace std;
 DsRadarQueue::DsRadarQueue()
              :DsFmq()
 {
+  _nMessagesPerRead = 1;
+  _readBatchPos = 0;
+  _autoBatchWrites = true;
+  _lastBeamPut.tv_sec = 0;
+  _lastBeamPut.tv_usec = 0;
+  setMaxWriteCacheMsecs(AUTO_BATCH_MAX_MSECS);
+  setFlushWriteCacheOnTimer(true);
+}
+
+/////////////////////////////////////////////////////////////
+// Batched writes - see DsRadarQueue.hh
+
+void DsRadarQueue::setAutoBatchWrites(bool state)
+{
+  _autoBatchWrites = state;
+  if (!state) {
+    // the next write flushes the cache
+    DsFmq::setNMessagesPerWrite(1);
+  }
+}
+
+void DsRadarQueue::setNMessagesPerWrite(int n)
+{
+  _autoBatchWrites = false;
+  DsFmq::setNMessagesPerWrite(n);
+}
+
+/////////////////////////////////////////////////////////////
+// Set the batch size from the time since the last beam.
+// Beams put close together are backed up, and are batched.
+// Otherwise they are written as they come - if the cache is
+// not empty, the next write flushes it first.
+
+void DsRadarQueue::_setAutoBatch()
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  long gapUsecs = ((now.tv_sec - _lastBeamPut.tv_sec) * 1000000L +
+                   (now.tv_usec - _lastBeamPut.tv_usec));
+  _lastBeamPut = now;
+  if (gapUsecs >= 0 && gapUsecs < AUTO_BATCH_GAP_USECS) {
+    DsFmq::setNMessagesPerWrite(AUTO_BATCH_SIZE);
+  } else {
+    DsFmq::setNMessagesPerWrite(1);
+  }
 }
 
 /////////////////////////////////////////////////////////////
@@ -53,7 +99,15 @@ int
 DsRadarQueue::getDsMsg( DsRadarMsg &dsRadarMsg, int *content )
 {
    PMU_auto_register("In DsRadarQueue::getDsBeam");
-   
+
+   bool gotOne = false;
+   if ( _getFromBatch( dsRadarMsg, content, &gotOne ) ) {
+      return( -1 );
+   }
+   if ( gotOne ) {
+      return( 0 );
+   }
+
    if ( readMsgBlocking( DS_MESSAGE_TYPE_DSRADAR ) ||
         getMsgLen() == 0 ) {
       return( -1 );
@@ -78,6 +132,13 @@ DsRadarQueue::getDsMsg( DsRadarMsg &dsRadarMsg, int *content, bool *gotOne )
 {
    PMU_auto_register("In DsRadarQueue::getDsBeam");
 
+   if ( _getFromBatch( dsRadarMsg, content, gotOne ) ) {
+      return( -1 );
+   }
+   if ( *gotOne ) {
+      return( 0 );
+   }
+
    if ( readMsg( gotOne, DS_MESSAGE_TYPE_DSRADAR ) ) {
       return( -1 );
    }
@@ -100,6 +161,51 @@ DsRadarQueue::getDsMsg( DsRadarMsg &dsRadarMsg, int *content, bool *gotOne )
    return (iret);
 }
 
+////////////////////////////////////////////////////////////
+// _getFromBatch()
+//
+// If batched reads are enabled, returns the next message from the
+// current batch, reading a new batch from the queue if it is used up.
+// Sets gotOne if a message was available.
+// Returns 0 on success, -1 on error
+//
+
+int
+DsRadarQueue::_getFromBatch( DsRadarMsg &dsRadarMsg, int *content,
+                             bool *gotOne )
+{
+
+   *gotOne = false;
+   if ( _nMessagesPerRead < 2 ) {
+      return( 0 );
+   }
+
+   if ( _readBatchPos >= _readBatch.size() ) {
+      _clearReadBatch();
+      if ( readMsgs( _readBatch, _nMessagesPerRead,
+                     DS_MESSAGE_TYPE_DSRADAR ) ) {
+         return( -1 );
+      }
+      if ( _readBatch.size() == 0 ) {
+         return( 0 );
+      }
+   }
+
+   const batch_msg_t &bmsg = _readBatch[_readBatchPos];
+   _readBatchPos++;
+   *gotOne = true;
+
+   if ( bmsg.len == 0 ) {
+      return( -1 );
+   }
+
+   int thisMsgContent;
+   int iret = dsRadarMsg.disassemble( bmsg.msg, bmsg.len, &thisMsgContent );
+   *content = thisMsgContent;
+
+   return (iret);
+}
+
 ///////////////////////////////////////////////////////////////////
 // getDsBeam()
 //
@@ -147,6 +253,13 @@ DsRadarQueue::putDsMsg( DsRadarMsg &dsRadarMsg, int content )
   msg =  dsRadarMsg.assemble( content );
   int msgLength = dsRadarMsg.lengthAssembled();
   
+  //
+  // Batch the beams while they are backed up
+  //
+  if (_autoBatchWrites && !(content & DsRadarMsg::RADAR_FLAGS)) {
+    _setAutoBatch();
+  }
+
   if (msgLength > 0) {
     if (writeMsg( DS_MESSAGE_TYPE_DSRADAR, 0, msg, msgLength )) {
       return( -1 );
@@ -155,6 +268,15 @@ DsRadarQueue::putDsMsg( DsRadarMsg &dsRadarMsg, int content )
     return (-1);
   }
 
+  //
+  // If writes are batched, flags are not held back behind the beams
+  //
+  if ((content & DsRadarMsg::RADAR_FLAGS) && getWriteCacheSize() > 0) {
+    if (writeTheCache()) {
+      return( -1 );
+    }
+  }
+
   return (0);
 
 }
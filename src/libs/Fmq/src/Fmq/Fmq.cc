@@ -82,6 +82,11 @@ Fmq::Fmq()
   _blockingWrite = false;
   _singleWriter = false;
   _lastSlotWritten = 0;
+  _readSeq = 0;
+  _readSeqValid = false;
+  _zeroCopyRead = false;
+  _viewPtr = NULL;
+  _viewLen = 0;
 
   setHeartbeat(PMU_auto_register);
 
@@ -596,6 +601,175 @@ int Fmq::readMsgBlocking(int type)
 
 }
 
+//////////////////////////////////////////////////////////////
+// Zero-copy read - see readMsg().
+// Returns 0 on success, -1 on error
+
+int Fmq::readMsgView(msg_view_t &view, bool *gotOne,
+                     int type /* = -1*/, int msecs_sleep /* = -1 */)
+
+{
+
+  _zeroCopyRead = true;
+  _viewPtr = NULL;
+  int iret = readMsg(gotOne, type, msecs_sleep);
+  _zeroCopyRead = false;
+
+  if (iret == 0 && *gotOne) {
+    _load_view(view);
+  }
+  return iret;
+
+}
+
+//////////////////////////////////////////////////////////////
+// Zero-copy blocking read - see readMsgBlocking().
+// Returns 0 on success, -1 on error
+
+int Fmq::readMsgViewBlocking(msg_view_t &view, int type /* = -1*/)
+
+{
+
+  _zeroCopyRead = true;
+  _viewPtr = NULL;
+  int iret = readMsgBlocking(type);
+  _zeroCopyRead = false;
+
+  if (iret == 0) {
+    _load_view(view);
+  }
+  return iret;
+
+}
+
+//////////////////////////////////////////////////////////////
+// Check that the message in a view has not been overwritten.
+//
+// The writer always frees a slot before reusing its buffer space,
+// so the message is intact if the slot still holds it. In
+// single-writer mode, if the writer has made no updates at all
+// since the read, the slot need not be re-read.
+//
+// Returns true if the message is still intact.
+
+bool Fmq::msgViewIsValid(const msg_view_t &view)
+
+{
+
+  if (!view.zeroCopy) {
+    return true;
+  }
+
+  if (view.seqValid && _read_validate_device(view.seq)) {
+    return true;
+  }
+
+  if (view.slot < 0 || view.slot >= _stat.nslots) {
+    return false;
+  }
+  if (_read_slot(view.slot)) {
+    return false;
+  }
+  const q_slot_t &slot = _slots[view.slot];
+  if (!slot.active || slot.id != view.id ||
+      slot.offset != view.offset ||
+      slot.stored_len != view.storedLen) {
+    return false;
+  }
+
+  return true;
+
+}
+
+//////////////////////////////////////////////////////////////
+// Load up view after a read
+
+void Fmq::_load_view(msg_view_t &view)
+
+{
+
+  view.id = _slot.id;
+  view.slot = _lastSlotRead;
+  view.offset = _slot.offset;
+  view.storedLen = _slot.stored_len;
+  view.seq = _readSeq;
+  view.seqValid = _readSeqValid;
+
+  if (_viewPtr != NULL) {
+    view.msg = _viewPtr;
+    view.len = _viewLen;
+    view.zeroCopy = true;
+  } else {
+    view.msg = _msgBuf.getPtr();
+    view.len = _msgBuf.getLen();
+    view.zeroCopy = false;
+  }
+
+}
+
+////////////////////////////////////////////////////////////////////
+// Read a batch of messages from the fmq.
+// Reads all available messages, up to maxMsgs, from a single
+// snapshot of the status struct. Does not wait.
+// The msg pointers are valid until the next call.
+// Returns 0 on success, -1 on error
+
+int Fmq::readMsgs(vector<batch_msg_t> &msgs, int maxMsgs, int type)
+{
+
+  initErrStr();
+  msgs.clear();
+  _batchBuf.free();
+  _batchOffsets.clear();
+
+  if (!_dev) {
+    cerr << "ERROR - Fmq::readMsgs" << endl;
+    cerr << "  Fmq path: " << _fmqPath << endl;
+    cerr << "  Queue not open, must call init functions" << endl;
+    return -1;
+  }
+
+  if (_read_stat()) {
+    return -1;
+  }
+
+  int iret = 0;
+  int nConsumed = 0;
+  while ((int) msgs.size() < maxMsgs) {
+    int msg_read;
+    if (_read_next(&msg_read, true)) {
+      iret = -1;
+      break;
+    }
+    if (!msg_read) {
+      break;
+    }
+    nConsumed++;
+    if (type < 0 || type == _slot.type) {
+      _add_batch_msg(msgs);
+    }
+  }
+
+  // in the case of blocking writes, update the last_id_read
+  // once for the batch
+
+  if (_stat.blocking_write && nConsumed > 0) {
+    if (_update_last_id_read()) {
+      iret = -1;
+    }
+  }
+
+  _set_batch_ptrs(msgs);
+
+  // messages read before an error are still returned
+
+  if (msgs.size() > 0) {
+    return 0;
+  }
+  return iret;
+
+}
+
 //////////////////////////////////////////////////////
 // Writes a message to the fmq
 // Returns 0 on success, -1 on error
@@ -644,6 +818,72 @@ int Fmq::writeMsgPreCompressed(int type, int subType,
 			       uncompressedLen));
 }
 
+/////////////////////////////////////////////////////////
+// Write a batch of messages to the fmq, under a single
+// lock and status update.
+// Returns 0 on success, -1 on error
+
+int Fmq::writeMsgs(const vector<batch_msg_t> &msgs)
+{
+
+  initErrStr();
+
+  if (!_dev) {
+    cerr << "ERROR - Fmq::writeMsgs" << endl;
+    cerr << "  Fmq path: " << _fmqPath << endl;
+    cerr << "  Queue not open, must call init functions" << endl;
+    return -1;
+  }
+
+  if (msgs.size() == 0) {
+    return 0;
+  }
+
+  _set_single_writer_device();
+
+  if (_lock_device() != 0) {
+    _print_error("writeMsgs", "Error locking for read/write");
+    return -1;
+  }
+
+  // the status is read before the first message and written after
+  // the last one - in blocking-write mode it must be kept current
+  // for each message, since the write may wait for the reader
+
+  int iret = 0;
+  size_t nWritten = 0;
+  for (size_t ii = 0; ii < msgs.size(); ii++) {
+    const batch_msg_t &bmsg = msgs[ii];
+    bool readStat = (ii == 0 || _blockingWrite);
+    bool writeStat = (ii == msgs.size() - 1 || _blockingWrite);
+    if (_write_msg((void *) bmsg.msg, bmsg.len,
+                   bmsg.type, bmsg.subType,
+                   false, bmsg.len, readStat, writeStat)) {
+      iret = -1;
+      break;
+    }
+    nWritten++;
+  }
+
+  // on error, commit the messages already written
+
+  if (iret && nWritten > 0 && !_blockingWrite) {
+    _write_stat();
+  }
+
+  _unlock_device();
+
+  if (nWritten > 0) {
+    _notify_device();
+  }
+
+  if (iret == 0) {
+    _doRegisterWithDmap();
+  }
+  return iret;
+
+}
+
 //////////////////////////////////////////////////////////////
 // Is this a shared-memory-based queue?
 // inspect fmqPath to find out.
@@ -1597,11 +1837,15 @@ int Fmq::_read(int *msg_read, int type)
 //    msecs_sleep - number of millisecs to sleep between reads
 //                  while waiting for a message to arrive.
 //    If set to -1, default of 10 msecs will be used.
+//    Only used if the device does not support write notification.
 //
 //    type - if type is non-negative, read until the correct message
 //           type is found.
 //           A type of -1 indicates all types are accepted.
 //
+//  If the device supports write notification, the reader blocks
+//  until the writer commits a slot, instead of sleep polling.
+//
 //  Return value:
 //    0 on success, -1 on failure.
 ///
@@ -1618,6 +1862,11 @@ int Fmq::_read_blocking (int msecs_sleep, int type)
 
   while (true) {
 
+    // snapshot the notification state before checking the queue,
+    // so that a write between the check and the wait is not missed
+
+    _prepare_wait_device();
+
     if(_read_next(&msg_read)) {
       return -1; // error
     }
@@ -1637,8 +1886,28 @@ int Fmq::_read_blocking (int msecs_sleep, int type)
 
     } else {
 
-      umsleep(msecs_sleep);
-      sleepTotalMsecs += msecs_sleep;
+      // wait for a notification - if the writer may not signal,
+      // no longer than the poll interval, so that its writes are
+      // picked up as quickly as when polling
+      
+      int msecsWait = _max_wait_device(msecs_sleep);
+      if (_msecBlockingReadTimeout > 0) {
+        int msecsLeft = _msecBlockingReadTimeout - sleepTotalMsecs + 1;
+        if (msecsLeft < msecsWait) {
+          msecsWait = msecsLeft;
+        }
+      }
+
+      struct timeval tv;
+      gettimeofday(&tv, NULL);
+      double waitStart = tv.tv_sec + (double) tv.tv_usec / 1.0e6;
+      if (_wait_device(msecsWait)) {
+        // no notification support - poll
+        umsleep(msecs_sleep);
+      }
+      gettimeofday(&tv, NULL);
+      double waitEnd = tv.tv_sec + (double) tv.tv_usec / 1.0e6;
+      sleepTotalMsecs += (int) ((waitEnd - waitStart) * 1000.0 + 0.5);
 
       if (_msecBlockingReadTimeout > 0 && 
           sleepTotalMsecs > _msecBlockingReadTimeout) {
@@ -1695,9 +1964,9 @@ int Fmq::_read_non_blocking (int *msg_read, int type, int msecs_sleep)
   
   while (true) {
     
+    gettimeofday(&tv, NULL);
+    double now = tv.tv_sec + (double) tv.tv_usec / 1.0e6;
     if (count > 0) {
-      gettimeofday(&tv, NULL);
-      double now = tv.tv_sec + (double) tv.tv_usec / 1.0e6;
       if (now > endTime) {
         return 0;
       }
@@ -1705,6 +1974,7 @@ int Fmq::_read_non_blocking (int *msg_read, int type, int msecs_sleep)
     count++;
 
     *msg_read = 0;
+    _prepare_wait_device();
     if(_read_next(msg_read)) {
       return -1; // error
     }
@@ -1729,7 +1999,15 @@ int Fmq::_read_non_blocking (int *msg_read, int type, int msecs_sleep)
 
     } else {
       
-      umsleep(10);
+      int msecsLeft = (int) ((endTime - now) * 1000.0) + 1;
+      int msecsMax = _max_wait_device(Q_NON_BLOCKING_POLL_MSECS);
+      if (msecsLeft > msecsMax) {
+        msecsLeft = msecsMax;
+      }
+      if (_wait_device(msecsLeft)) {
+        // no notification support - poll
+        umsleep(Q_NON_BLOCKING_POLL_MSECS);
+      }
       
       if (_heartbeatFunc != NULL) {
         _heartbeatFunc("In FMQ::_read_blocking()");
@@ -1766,6 +2044,11 @@ int Fmq::_read_stat ()
 
   for (ii = 0; ii < 5; ii++) {
 
+    // in single-writer mode, note the update sequence number
+    
+    ui32 seq = 0;
+    bool seqValid = _read_begin_device(seq);
+
     // seek to start of status file
     
     if (_seek_device(FmqDevice::STAT_IDENT, 0)) {
@@ -1782,6 +2065,13 @@ int Fmq::_read_stat ()
       return -1;
     }
 
+    // in single-writer mode, retry if the writer updated the
+    // struct while it was being read
+
+    if (seqValid && !_read_validate_device(seq)) {
+      continue;
+    }
+
     // swap
     
     be_to_stat(&status);
@@ -1887,6 +2177,11 @@ int Fmq::_read_slot ( int slot_num)
 
   for (ii = 0; ii < 5; ii++) {
     
+    // in single-writer mode, note the update sequence number
+    
+    ui32 seq = 0;
+    bool seqValid = _read_begin_device(seq);
+
     // seek to given slot
     
     offset = sizeof(q_stat_t) + slot_num * sizeof(q_slot_t);
@@ -1908,6 +2203,15 @@ int Fmq::_read_slot ( int slot_num)
       return -1;
     }
     
+    // in single-writer mode, retry if the writer updated the
+    // slot while it was being read
+
+    if (seqValid && !_read_validate_device(seq)) {
+      continue;
+    }
+    _readSeq = seq;
+    _readSeqValid = seqValid;
+
     // swap slot byte order
     
     be_to_slot(slot);
@@ -1947,7 +2251,7 @@ int Fmq::_read_slot ( int slot_num)
 //  Returns 0 on success, -1 on failure.
 ///
 
-int Fmq::_read_next(int *msg_read)
+int Fmq::_read_next(int *msg_read, bool batch /* = false */)
      
 {
   static int num_calls = 0;
@@ -1958,8 +2262,12 @@ int Fmq::_read_next(int *msg_read)
   
   *msg_read = false;
 
-  if (_read_stat()) {
-    return -1;
+  // in batch mode the caller reads the status once for the batch
+
+  if (!batch) {
+    if (_read_stat()) {
+      return -1;
+    }
   }
 
   // special case - no messages written yet
@@ -1987,7 +2295,20 @@ int Fmq::_read_next(int *msg_read)
     // probably overflowed. The best option is to move ahead to
     // the youngest slot and start reading from there
 
-    if (_read_msg_for_slot(_stat.youngest_slot)) {
+    int iret = _read_msg_for_slot(_stat.youngest_slot);
+
+    // in single-writer mode, a fast writer may also have reused the
+    // youngest slot while it was being read - this is an overflow,
+    // not an error, so try again with the new youngest slot
+
+    for (int ii = 0; iret && _readSeqValid && _lastIdRead == -1 && ii < 5;
+         ii++) {
+      if (_read_stat()) {
+        return -1;
+      }
+      iret = _read_msg_for_slot(_stat.youngest_slot);
+    }
+    if (iret) {
       return -1;
     }
 
@@ -2024,7 +2345,7 @@ int Fmq::_read_next(int *msg_read)
   // in the case of blocking writes, update the last_id_read
   // in the file status block
 
-  if (_stat.blocking_write) {
+  if (_stat.blocking_write && !batch) {
     if (_update_last_id_read()) {
       return -1;
     }
@@ -2062,10 +2383,17 @@ int Fmq::_read_msg_for_slot( int slot_num)
 
     // read in message
     
+    int id = slot->id;
     if (_read_msg(slot_num)) {
       // failed
       _lastSlotRead = slot_num;
-      _lastIdRead = slot->id;
+      if (!slot->active || slot->id != id) {
+        // slot reused by the writer during the read - treat as
+        // an inactive slot
+        _lastIdRead = -1;
+      } else {
+        _lastIdRead = slot->id;
+      }
       return -1;
     }
 
@@ -2115,26 +2443,52 @@ int Fmq::_read_msg (int slot_num)
   
   slot = _slots + slot_num;
 
-  // seek to start of message
+  // for zero-copy reads of uncompressed messages, use the entry
+  // in place if the device allows it
 
-  if (_seek_device(FmqDevice::BUF_IDENT, slot->offset)) {
-    _print_error("_read_msg",
-		 "Cannot seek to msg in buf file.");
-    return -1;
+  const ui08 *entry = NULL;
+  _viewPtr = NULL;
+  if (_zeroCopyRead && !slot->compress) {
+    entry = (const ui08 *)
+      _get_device_ptr(FmqDevice::BUF_IDENT,
+                      slot->offset, slot->stored_len);
   }
 
-  // alloc space for entry
+  if (entry == NULL) {
 
-  _alloc_entry(slot->stored_len);
-     
-  // read in message
+    // seek to start of message
+    
+    if (_seek_device(FmqDevice::BUF_IDENT, slot->offset)) {
+      _print_error("_read_msg",
+                   "Cannot seek to msg in buf file.");
+      return -1;
+    }
+    
+    // alloc space for entry
+    
+    _alloc_entry(slot->stored_len);
+    
+    // read in message
+    
+    if (_read_device(FmqDevice::BUF_IDENT, _entry, slot->stored_len)) {
+      _print_error("read_msg",
+                   "Cannot read message from buf file, "
+                   "slot, len, offset: %d, %d, %d",
+                   slot_num, slot->stored_len, slot->offset);
+      return -1;
+    }
 
-  if (_read_device(FmqDevice::BUF_IDENT, _entry, slot->stored_len)) {
-    _print_error("read_msg",
-		 "Cannot read message from buf file, "
-		 "slot, len, offset: %d, %d, %d",
-		 slot_num, slot->stored_len, slot->offset);
-    return -1;
+    entry = _entry;
+    
+  }
+
+  // in single-writer mode, check that the writer did not free the
+  // slot, and overwrite the message, while it was being read
+
+  if (_readSeqValid && !_read_validate_device(_readSeq)) {
+    if (_slot_reused(slot_num)) {
+      return -1;
+    }
   }
   
   // check the magic cookie and slot number fields.
@@ -2149,7 +2503,7 @@ int Fmq::_read_msg (int slot_num)
 
   // check magic cookie
   
-  iptr = (si32 *) _entry;
+  iptr = (si32 *) entry;
 
   magic_cookie = BE_to_si32(iptr[0]);
 
@@ -2230,6 +2584,11 @@ int Fmq::_read_msg (int slot_num)
       }
       ta_compress_free(umsg);
     }
+  } else if (entry != _entry) {
+    // zero-copy read - point into device buffer
+    _msgBuf.free();
+    _viewPtr = iptr + 2;
+    _viewLen = slot->msg_len;
   } else {
     // data not compressed
     _msgBuf.free();
@@ -2327,6 +2686,35 @@ int Fmq::_add_read_msg(void *msg, int msg_size)
   return 0;
 }
 
+////////////////////////////////////////////////////////////
+// add the message just read to a batch
+//
+// The data is copied to _batchBuf - the msg pointers are set
+// by _set_batch_ptrs() once the batch is complete, since
+// _batchBuf may be reallocated as it grows.
+
+void Fmq::_add_batch_msg(vector<batch_msg_t> &msgs)
+{
+  batch_msg_t bmsg;
+  bmsg.type = _slot.type;
+  bmsg.subType = _slot.subtype;
+  bmsg.msg = NULL;
+  bmsg.len = _msgBuf.getLen();
+  bmsg.id = _slot.id;
+  bmsg.time = _slot.time;
+  _batchOffsets.push_back(_batchBuf.getLen());
+  _batchBuf.add(_msgBuf.getPtr(), _msgBuf.getLen());
+  msgs.push_back(bmsg);
+}
+
+void Fmq::_set_batch_ptrs(vector<batch_msg_t> &msgs)
+{
+  char *start = (char *) _batchBuf.getPtr();
+  for (size_t ii = 0; ii < msgs.size(); ii++) {
+    msgs[ii].msg = start + _batchOffsets[ii];
+  }
+}
+
 ////////////////////////////////////////////////////////////
 // WRITE
 ////////////////////////////////////////////////////////////
@@ -2435,6 +2823,8 @@ int Fmq::_write(void *msg, int msg_len,
 
   int iret;
   
+  _set_single_writer_device();
+
   if (_lock_device() != 0) {
     _print_error("_write", "Error locking for read/write");
     return -1;
@@ -2443,6 +2833,10 @@ int Fmq::_write(void *msg, int msg_len,
   iret = _write_msg(msg, msg_len, msg_type, msg_subtype,
 		    false, msg_len);
   _unlock_device();
+
+  if (iret == 0) {
+    _notify_device();
+  }
   
   return (iret);
   
@@ -2467,6 +2861,8 @@ int Fmq::_write_precompressed(void *msg, int msg_len,
 
   int iret;
 
+  _set_single_writer_device();
+
   if (_lock_device() != 0) {
     _print_error("_write_precompressed",
 		 "Error locking for read/write");
@@ -2476,6 +2872,10 @@ int Fmq::_write_precompressed(void *msg, int msg_len,
   iret = _write_msg(msg, msg_len, msg_type, msg_subtype,
 		    true, uncompressed_len);
   _unlock_device();
+
+  if (iret == 0) {
+    _notify_device();
+  }
   
   return (iret);
 
@@ -2512,10 +2912,13 @@ int Fmq::_write_stat()
   
   // write
   
+  _begin_update_device();
   if (_write_device(FmqDevice::STAT_IDENT, &stat, sizeof(q_stat_t))) {
+    _end_update_device();
     _print_error("_write_stat", "Cannot write stat info.");
     return -1;
   }
+  _end_update_device();
 
   return 0;
 
@@ -2572,7 +2975,10 @@ int Fmq::_write_slot ( int slot_num)
 
   // write slot
 
-  if (_write_device(FmqDevice::STAT_IDENT, &slot, sizeof(q_slot_t))) {
+  _begin_update_device();
+  int iret = _write_device(FmqDevice::STAT_IDENT, &slot, sizeof(q_slot_t));
+  _end_update_device();
+  if (iret) {
     _print_error("_write_slot",
 		 "Cannot write slot info, slot num %d.",
 		 (int) slot_num);
@@ -2605,7 +3011,9 @@ int Fmq::_write_slot ( int slot_num)
 
 int Fmq::_write_msg(void *msg, int msg_len, 
 		    int msg_type, int msg_subtype,
-		    int pre_compressed, int uncompressed_len)
+		    int pre_compressed, int uncompressed_len,
+		    bool read_stat /* = true */,
+		    bool write_stat /* = true */)
 
 {
 
@@ -2620,9 +3028,10 @@ int Fmq::_write_msg(void *msg, int msg_len,
   void *cmsg;
   q_slot_t *slot;
   
-  // read in status struct 
+  // read in status struct - batched writes use the copy
+  // left by the previous message
   
-  if (_read_stat()) {
+  if (read_stat && _read_stat()) {
     return -1;
   }
 
@@ -2791,7 +3200,7 @@ int Fmq::_write_msg(void *msg, int msg_len,
   }
   _stat.youngest_id = write_id;
   
-  if (_write_stat()) {
+  if (write_stat && _write_stat()) {
     return -1;
   }
 
@@ -2937,6 +3346,18 @@ int Fmq::_read_device(FmqDevice::ident_t id, void *mess, size_t len)
 
 }
 
+// get pointer into device buffer, for zero-copy reads
+// returns NULL if not supported
+
+const void *Fmq::_get_device_ptr(FmqDevice::ident_t id,
+                                 off_t offset, size_t len)
+{
+  if (_dev == NULL) {
+    return NULL;
+  }
+  return _dev->get_ptr(id, offset, len);
+}
+
 // write at the device level
 // returns 0 on success, -1 on failure
 
@@ -2999,6 +3420,112 @@ int Fmq::_unlock_device()
 
 }
 
+// single-writer lock-free mode at the device level
+
+void Fmq::_set_single_writer_device()
+{
+  if (_dev != NULL) {
+    _dev->set_single_writer(_singleWriter);
+  }
+}
+
+void Fmq::_begin_update_device()
+{
+  if (_dev != NULL) {
+    _dev->begin_update();
+  }
+}
+
+void Fmq::_end_update_device()
+{
+  if (_dev != NULL) {
+    _dev->end_update();
+  }
+}
+
+// returns true if lock-free reads are active, and sets seq
+
+bool Fmq::_read_begin_device(ui32 &seq)
+{
+  if (_dev == NULL) {
+    return false;
+  }
+  return _dev->read_begin(seq);
+}
+
+// returns true if no update has started since seq was read
+
+bool Fmq::_read_validate_device(ui32 seq)
+{
+  if (_dev == NULL) {
+    return true;
+  }
+  return _dev->read_validate(seq);
+}
+
+// Check whether a slot has been freed or reused since it was
+// last read. The writer always frees a slot before overwriting
+// its message, so if the slot still holds the same message the
+// message data is intact.
+// Returns true if reused, false if unchanged.
+
+bool Fmq::_slot_reused(int slot_num)
+{
+
+  q_slot_t prev = _slots[slot_num];
+  if (_read_slot(slot_num)) {
+    return true;
+  }
+  const q_slot_t &slot = _slots[slot_num];
+  if (!slot.active || slot.id != prev.id ||
+      slot.offset != prev.offset ||
+      slot.stored_len != prev.stored_len) {
+    return true;
+  }
+  return false;
+
+}
+
+// write notification at the device level
+
+void Fmq::_notify_device()
+{
+  if (_dev != NULL) {
+    _dev->notify_write();
+  }
+}
+
+void Fmq::_prepare_wait_device()
+{
+  if (_dev != NULL) {
+    _dev->prepare_wait();
+  }
+}
+
+// wait for a write notification
+// returns 0 if woken or timed out, -1 if notification not supported
+
+int Fmq::_wait_device(int msecs)
+{
+  if (_dev == NULL || msecs <= 0) {
+    return -1;
+  }
+  return _dev->wait_for_write(msecs);
+}
+
+// max time to wait for a write notification before re-checking
+// the queue: the heartbeat interval if every write is known to
+// signal, otherwise the poll interval
+
+int Fmq::_max_wait_device(int msecs_poll)
+{
+  if (_dev != NULL && _dev->writer_signals() &&
+      msecs_poll < Q_MAX_NOTIFY_WAIT_MSECS) {
+    return Q_MAX_NOTIFY_WAIT_MSECS;
+  }
+  return msecs_poll;
+}
+
 // checking at the device level
 // returns 0 on success, -1 on failure
 
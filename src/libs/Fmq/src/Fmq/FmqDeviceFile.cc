@@ -42,6 +42,11 @@
 #include <toolsa/uusleep.h>
 #include <Fmq/FmqDeviceFile.hh>
 #include <Fmq/Fmq.hh>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#endif
 using namespace std;
 
 FmqDeviceFile::FmqDeviceFile(const string &fmqPath, 
@@ -67,6 +72,10 @@ FmqDeviceFile::FmqDeviceFile(const string &fmqPath,
   _stat_fd = 0;
   _buf_fd = 0;
 
+  _notify_fd = -1;
+  _notify_failed = false;
+  _notify_local = false;
+
 }
 
 FmqDeviceFile::~FmqDeviceFile()
@@ -182,6 +191,12 @@ void FmqDeviceFile::do_close()
     _buf_file = NULL;
   }
 
+  // close inotify - the queue may be recreated before it is reopened,
+  // so the watch is set up again on the next wait
+
+  _close_notify();
+  _notify_failed = false;
+
 }
 
 /////////////////////////////////////////////////////////////////
@@ -516,3 +531,177 @@ int FmqDeviceFile::update_last_id_read(int lastIdRead)
 
 }
 
+////////////////////////////////////////////////////////////
+// Write notification
+//
+// The writer rewrites the stat file for every message, so a
+// reader can block on an inotify watch on that file instead of
+// polling. Spurious wakeups (e.g. other readers updating
+// last_id_read) are harmless - the reader re-checks the queue.
+//
+// prepare_wait() sets up the watch if needed, and discards any
+// events already queued, since the caller is about to check the
+// queue anyway.
+
+void FmqDeviceFile::prepare_wait()
+
+{
+  if (_notify_fd < 0) {
+    if (_notify_failed || _open_notify()) {
+      return;
+    }
+  }
+  _drain_notify();
+}
+
+////////////////////////////////////////////////////////////
+// Wait for the writer to update the stat file.
+//
+// Returns 0 if woken or timed out,
+//        -1 if notification is not available.
+
+int FmqDeviceFile::wait_for_write(int msecs)
+
+{
+
+#ifdef __linux__
+
+  if (_notify_fd < 0) {
+    return -1;
+  }
+
+  struct pollfd pfd;
+  pfd.fd = _notify_fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  poll(&pfd, 1, msecs);
+  return 0;
+
+#else
+
+  return -1;
+
+#endif
+
+}
+
+////////////////////////////////////////////////////////////
+// Is every write known to raise an inotify event?
+// All writers update the stat file, but events are only raised
+// for writes made on this host, so not on a network filesystem.
+
+bool FmqDeviceFile::writer_signals()
+
+{
+  return (_notify_fd >= 0 && _notify_local);
+}
+
+////////////////////////////////////////////////////////////
+// Set up inotify watch on the stat file.
+// Returns 0 on success, -1 on failure.
+// On failure, readers fall back to polling until the device
+// is reopened.
+
+int FmqDeviceFile::_open_notify()
+
+{
+
+#ifdef __linux__
+
+  _notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (_notify_fd < 0) {
+    _notify_failed = true;
+    return -1;
+  }
+
+  if (inotify_add_watch(_notify_fd, _stat_path.c_str(),
+                        IN_MODIFY | IN_CLOSE_WRITE |
+                        IN_DELETE_SELF | IN_MOVE_SELF) < 0) {
+    _close_notify();
+    _notify_failed = true;
+    return -1;
+  }
+
+  // writes from other hosts do not raise events on network
+  // filesystems - check the filesystem type
+
+  _notify_local = false;
+  struct statfs fsInfo;
+  if (statfs(_stat_path.c_str(), &fsInfo) == 0) {
+    switch ((unsigned long) fsInfo.f_type) {
+      case 0x6969UL:     // NFS
+      case 0xFF534D42UL: // CIFS
+      case 0xFE534D42UL: // SMB2
+      case 0x517BUL:     // SMB
+      case 0x65735546UL: // FUSE
+      case 0x47504653UL: // GPFS
+      case 0x0BD00BD0UL: // Lustre
+      case 0x564CUL:     // NCP
+      case 0x6B414653UL: // AFS
+        break;
+      default:
+        _notify_local = true;
+    }
+  }
+
+  return 0;
+
+#else
+
+  _notify_failed = true;
+  return -1;
+
+#endif
+
+}
+
+////////////////////////////////////////////////////////////
+// Close inotify
+
+void FmqDeviceFile::_close_notify()
+
+{
+  if (_notify_fd >= 0) {
+    close(_notify_fd);
+    _notify_fd = -1;
+  }
+}
+
+////////////////////////////////////////////////////////////
+// Read and discard pending inotify events.
+// If the stat file has been removed or replaced, the watch is
+// closed so that it is set up again on the next prepare_wait().
+
+void FmqDeviceFile::_drain_notify()
+
+{
+
+#ifdef __linux__
+
+  char buf[4096]
+    __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  bool watchGone = false;
+
+  while (_notify_fd >= 0) {
+    ssize_t len = read(_notify_fd, buf, sizeof(buf));
+    if (len <= 0) {
+      break;
+    }
+    const char *ptr = buf;
+    while (ptr < buf + len) {
+      const struct inotify_event *event =
+        (const struct inotify_event *) ptr;
+      if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) {
+        watchGone = true;
+      }
+      ptr += sizeof(struct inotify_event) + event->len;
+    }
+  }
+
+  if (watchGone) {
+    _close_notify();
+  }
+
+#endif
+
+}
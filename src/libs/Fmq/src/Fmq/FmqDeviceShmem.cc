@@ -46,6 +46,16 @@
 #include <sys/shm.h>
 #include <sys/fcntl.h>
 #include <semaphore.h>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <csignal>
+#include <sched.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
 using namespace std;
 
 FmqDeviceShmem::FmqDeviceShmem(const string &fmqPath,
@@ -64,6 +74,15 @@ FmqDeviceShmem::FmqDeviceShmem(const string &fmqPath,
 
   _statPtr = NULL;
   _bufPtr = NULL;
+  _ptr[STAT_IDENT] = NULL;
+  _ptr[BUF_IDENT] = NULL;
+
+  _notify = NULL;
+  _notifySeq = 0;
+  _singleWriter = false;
+  _writerWarned = false;
+  _stuckSeqValid = false;
+  _stuckSeq = 0;
 
   _offset[STAT_IDENT] = 0;
   _offset[BUF_IDENT] = 0;
@@ -211,15 +230,27 @@ int FmqDeviceShmem::_open_create()
     }
   }
   
+  // if the stat segment exists but was created without the write
+  // notification block, reuse it as-is so that attached readers
+  // are not orphaned - readers will fall back to polling
+
+  bool withNotify = true;
+  if (_ushmCheck(_statKey, 0) &&
+      !_ushmCheck(_statKey, _statSegSize(true))) {
+    withNotify = false;
+  }
+  
   // create shmem segments
   
-  if ((_statPtr = (char *) _ushmCreate(_statKey, _nbytes[STAT_IDENT], 0666)) == NULL) {
+  if ((_statPtr = (char *) _ushmCreate(_statKey, _statSegSize(withNotify),
+                                       0666)) == NULL) {
     _errStr += "ERROR - FmqDeviceShmem::_open_create\n";
     TaStr::AddInt(_errStr, "Cannot create shmem for stat, key: ", _statKey);
     TaStr::AddInt(_errStr, "size: ", _nbytes[STAT_IDENT]);
     return -1;
   }
   _ptr[STAT_IDENT] = _statPtr;
+  _initNotify(withNotify, true);
   
   if ((_bufPtr = (char *) _ushmCreate(_bufKey, _nbytes[BUF_IDENT], 0666)) == NULL) {
     _errStr += "ERROR - FmqDeviceShmem::_open_create\n";
@@ -250,11 +281,15 @@ int FmqDeviceShmem::_open_rdwr()
   }
 
   // read-write mode
+  // attach the write notification block if the writer created one
   
-  if ((_statPtr = (char *) _ushmGet(_statKey, _nbytes[STAT_IDENT])) == NULL) {
+  bool withNotify = _ushmCheck(_statKey, _statSegSize(true));
+  if ((_statPtr = (char *) _ushmGet(_statKey,
+                                    _statSegSize(withNotify))) == NULL) {
     return -1;
   }
   _ptr[STAT_IDENT] = _statPtr;
+  _initNotify(withNotify, false);
   
   if ((_bufPtr = (char *) _ushmGet(_bufKey, _nbytes[BUF_IDENT])) == NULL) {
     return -1;
@@ -312,10 +347,19 @@ void FmqDeviceShmem::do_close()
 
   // detach stat segment
   
+  if (_notify != NULL && _singleWriter) {
+    ui32 pid = (ui32) getpid();
+    __atomic_compare_exchange_n(&_notify->writer_pid, &pid, 0, false,
+                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  }
   if (_statPtr != NULL) {
     _ushmDetach(_statPtr);
     _statPtr = NULL;
   }
+  _ptr[STAT_IDENT] = NULL;
+  _notify = NULL;
+  _singleWriter = false;
+  _stuckSeqValid = false;
 
   //  detach buf segment
   
@@ -323,6 +367,7 @@ void FmqDeviceShmem::do_close()
     _ushmDetach(_bufPtr);
     _bufPtr = NULL;
   }
+  _ptr[BUF_IDENT] = NULL;
 
   // close lock file
   
@@ -523,6 +568,20 @@ int FmqDeviceShmem::get_size(ident_t id)
   return _nbytes[id];
 }
 
+////////////////////////////////////////////////////
+//  Get pointer into segment, for zero-copy reads.
+//  Returns NULL if out of range.
+
+const void *FmqDeviceShmem::get_ptr(ident_t id, off_t offset, size_t len)
+
+{
+  if (_ptr[id] == NULL || offset < 0 ||
+      (size_t) offset + len > _nbytes[id]) {
+    return NULL;
+  }
+  return _ptr[id] + offset;
+}
+
 ////////////////////////////////////////////////////////////
 //  Update the last_id_read in the status struct if the
 //  write mode is blocking.
@@ -547,6 +606,338 @@ int FmqDeviceShmem::update_last_id_read(int lastIdRead)
 
 }
 
+////////////////////////////////////////////////////////////
+// Size of the stat segment.
+// If withNotify is true, the write notification block is appended
+// after the slots, aligned to 8 bytes.
+
+size_t FmqDeviceShmem::_statSegSize(bool withNotify)
+
+{
+  size_t nbytes = _nbytes[STAT_IDENT];
+  if (!withNotify) {
+    return nbytes;
+  }
+  size_t notifyOffset = (nbytes + 7) & ~((size_t) 7);
+  return notifyOffset + sizeof(notify_t);
+}
+
+////////////////////////////////////////////////////////////
+// Set the pointer to the write notification block.
+// The creator initializes the block if it is not already set up.
+// Readers only use the block if it has been initialized.
+
+void FmqDeviceShmem::_initNotify(bool withNotify, bool isCreator)
+
+{
+
+  _notify = NULL;
+  _notifySeq = 0;
+  _singleWriter = false;
+  _stuckSeqValid = false;
+  _stuckSeq = 0;
+
+  if (!withNotify || _statPtr == NULL) {
+    return;
+  }
+
+  size_t notifyOffset = (_nbytes[STAT_IDENT] + 7) & ~((size_t) 7);
+  notify_t *notify = (notify_t *) (_statPtr + notifyOffset);
+
+  if (__atomic_load_n(&notify->magic, __ATOMIC_ACQUIRE) != NOTIFY_MAGIC) {
+    if (!isCreator) {
+      return;
+    }
+    notify->seq = 0;
+    notify->nwaiters = 0;
+    notify->single_writer = 0;
+    notify->update_seq = 0;
+    notify->writer_pid = 0;
+    notify->writer_signals = 0;
+    memset(notify->spare, 0, sizeof(notify->spare));
+    __atomic_store_n(&notify->magic, NOTIFY_MAGIC, __ATOMIC_RELEASE);
+  }
+
+  _notify = notify;
+
+}
+
+////////////////////////////////////////////////////////////
+// Write notification
+//
+// The writer increments seq, and wakes blocked readers if there
+// are any. Readers snapshot seq in prepare_wait(), and block on
+// it as a futex in wait_for_write(). Both sides use sequentially
+// consistent operations on seq and nwaiters, so either the writer
+// sees the waiter, or the waiter sees the new seq - no lost wakeups.
+//
+// Futexes are Linux-specific - elsewhere the reader polls.
+
+void FmqDeviceShmem::notify_write()
+
+{
+
+  if (_notify == NULL) {
+    return;
+  }
+
+  __atomic_add_fetch(&_notify->seq, 1, __ATOMIC_SEQ_CST);
+
+#ifdef __linux__
+  if (__atomic_load_n(&_notify->writer_signals, __ATOMIC_RELAXED) == 0) {
+    __atomic_store_n(&_notify->writer_signals, 1, __ATOMIC_RELAXED);
+  }
+  if (__atomic_load_n(&_notify->nwaiters, __ATOMIC_SEQ_CST) > 0) {
+    syscall(SYS_futex, &_notify->seq, FUTEX_WAKE, INT_MAX,
+            NULL, NULL, 0);
+  }
+#endif
+
+}
+
+void FmqDeviceShmem::prepare_wait()
+
+{
+  if (_notify != NULL) {
+    _notifySeq = __atomic_load_n(&_notify->seq, __ATOMIC_SEQ_CST);
+  }
+}
+
+////////////////////////////////////////////////////////////
+// Wait for the writer to commit a message after prepare_wait().
+//
+// Returns 0 if woken or timed out,
+//        -1 if notification is not available.
+
+int FmqDeviceShmem::wait_for_write(int msecs)
+
+{
+
+#ifdef __linux__
+
+  if (_notify == NULL) {
+    return -1;
+  }
+
+  __atomic_add_fetch(&_notify->nwaiters, 1, __ATOMIC_SEQ_CST);
+  
+  if (__atomic_load_n(&_notify->seq, __ATOMIC_SEQ_CST) == _notifySeq) {
+    struct timespec timeout;
+    timeout.tv_sec = msecs / 1000;
+    timeout.tv_nsec = (long) (msecs % 1000) * 1000000L;
+    // returns on wake, timeout, signal, or if seq has already changed
+    syscall(SYS_futex, &_notify->seq, FUTEX_WAIT, _notifySeq,
+            &timeout, NULL, 0);
+  }
+
+  __atomic_sub_fetch(&_notify->nwaiters, 1, __ATOMIC_SEQ_CST);
+
+  return 0;
+
+#else
+
+  return -1;
+
+#endif
+
+}
+
+////////////////////////////////////////////////////////////
+// Has a writer signalled this queue?
+// Writers from before the notification block was added do not
+// call notify_write(), so until one does readers keep polling.
+
+bool FmqDeviceShmem::writer_signals()
+
+{
+#ifdef __linux__
+  return (_notify != NULL &&
+          __atomic_load_n(&_notify->writer_signals, __ATOMIC_RELAXED) != 0);
+#else
+  return false;
+#endif
+}
+
+////////////////////////////////////////////////////////////
+// Single-writer lock-free mode
+//
+// The writer is the only process modifying the queue, so it needs
+// no lock. It keeps update_seq odd while it rewrites the stat
+// struct or a slot. A reader notes update_seq before reading, and
+// checks it is unchanged afterwards - if not, it read a partial
+// update and must retry (a seqlock). The fences order the data
+// accesses with respect to update_seq.
+//
+// Requires the notification block - without it the queue is used
+// in the normal way, relying on the checksums.
+//
+// A writer which died during an update leaves update_seq odd, which
+// would invert the parity for the next writer. So when a writer
+// attaches as the single writer it rounds update_seq up to even,
+// once it has checked that no other single writer is live.
+
+void FmqDeviceShmem::set_single_writer(bool state)
+
+{
+
+  if (_notify == NULL) {
+    _singleWriter = false;
+    return;
+  }
+
+  if (state && !_singleWriter) {
+    if (!_attachSingleWriter()) {
+      return;
+    }
+  } else if (!state && _singleWriter) {
+    ui32 pid = (ui32) getpid();
+    __atomic_compare_exchange_n(&_notify->writer_pid, &pid, 0, false,
+                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  }
+
+  _singleWriter = state;
+  ui32 flag = (state ? 1 : 0);
+  if (__atomic_load_n(&_notify->single_writer, __ATOMIC_RELAXED) != flag) {
+    __atomic_store_n(&_notify->single_writer, flag, __ATOMIC_SEQ_CST);
+  }
+
+}
+
+void FmqDeviceShmem::begin_update()
+
+{
+  if (!_singleWriter) {
+    return;
+  }
+  ui32 seq = __atomic_load_n(&_notify->update_seq, __ATOMIC_RELAXED);
+  __atomic_store_n(&_notify->update_seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void FmqDeviceShmem::end_update()
+
+{
+  if (!_singleWriter) {
+    return;
+  }
+  ui32 seq = __atomic_load_n(&_notify->update_seq, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  __atomic_store_n(&_notify->update_seq, seq + 1, __ATOMIC_RELAXED);
+}
+
+////////////////////////////////////////////////////////////
+// Start a lock-free read.
+//
+// Waits for any update in progress to complete.
+// Returns true and sets seq if the writer is in single-writer mode.
+// Returns false otherwise, or if the writer appears to have died
+// during an update, in which case the checksums must be used.
+// The wait is limited to READ_BEGIN_MAX_USECS. If it times out the
+// odd update_seq is recorded, and later reads fall back at once
+// until the writer moves the sequence on.
+
+bool FmqDeviceShmem::read_begin(ui32 &seq)
+
+{
+
+  if (_notify == NULL ||
+      __atomic_load_n(&_notify->single_writer, __ATOMIC_RELAXED) == 0) {
+    return false;
+  }
+
+  seq = __atomic_load_n(&_notify->update_seq, __ATOMIC_ACQUIRE);
+  if ((seq & 1) == 0) {
+    _stuckSeqValid = false;
+    return true;
+  }
+  if (_stuckSeqValid && seq == _stuckSeq) {
+    return false;
+  }
+
+  struct timespec start, now;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int ii = 0; ; ii++) {
+    seq = __atomic_load_n(&_notify->update_seq, __ATOMIC_ACQUIRE);
+    if ((seq & 1) == 0) {
+      _stuckSeqValid = false;
+      return true;
+    }
+    if (ii < 100) {
+      continue;
+    }
+    sched_yield();
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long usecs = (now.tv_sec - start.tv_sec) * 1000000L +
+      (now.tv_nsec - start.tv_nsec) / 1000L;
+    if (usecs > READ_BEGIN_MAX_USECS) {
+      break;
+    }
+  }
+
+  // writer has not completed the update - assume it died
+
+  _stuckSeqValid = true;
+  _stuckSeq = seq;
+  return false;
+
+}
+
+////////////////////////////////////////////////////////////
+// Check that no update has started since read_begin().
+
+bool FmqDeviceShmem::read_validate(ui32 seq)
+
+{
+  if (_notify == NULL) {
+    return true;
+  }
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return (__atomic_load_n(&_notify->update_seq, __ATOMIC_RELAXED) == seq);
+}
+
+////////////////////////////////////////////////////////////
+// Attach as the single writer.
+//
+// Holds the write lock, so that no locked writer is part way
+// through an update. Returns false if another single writer
+// is live, in which case the checksums are used.
+
+bool FmqDeviceShmem::_attachSingleWriter()
+
+{
+
+  if (lock()) {
+    return false;
+  }
+
+  ui32 myPid = (ui32) getpid();
+  ui32 pid = __atomic_load_n(&_notify->writer_pid, __ATOMIC_SEQ_CST);
+  if (pid != 0 && pid != myPid &&
+      (kill((pid_t) pid, 0) == 0 || errno == EPERM)) {
+    unlock();
+    if (!_writerWarned) {
+      cerr << "WARNING - FmqDeviceShmem::set_single_writer" << endl;
+      cerr << "  Queue: " << _fmqPath << endl;
+      cerr << "  Another single writer is running, pid: " << pid << endl;
+      cerr << "  Not using lock-free mode" << endl;
+      _writerWarned = true;
+    }
+    return false;
+  }
+  __atomic_store_n(&_notify->writer_pid, myPid, __ATOMIC_SEQ_CST);
+
+  // a previous writer died during an update - round up to even
+
+  ui32 seq = __atomic_load_n(&_notify->update_seq, __ATOMIC_RELAXED);
+  if (seq & 1) {
+    __atomic_store_n(&_notify->update_seq, seq + 1, __ATOMIC_RELEASE);
+  }
+
+  unlock();
+  return true;
+
+}
+
 ////////////////////////////////////////////////////////////
 // Get the segment name
 
@@ -0,0 +1,202 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// test_fmq_single_writer.cc
+//
+// Test for the single-writer lock-free mode of shared memory
+// FMQs, when a writer dies part way through an update.
+//
+// A child process attaches as the single writer, starts an
+// update and is killed. A restarted writer then attaches, and
+// the test checks that readers reject its updates while they
+// are in progress, and accept the data once they are done. It
+// also checks that a second writer cannot attach as the single
+// writer while the first is live.
+//
+// Usage: test_fmq_single_writer [shmemKey]
+//
+// Exits with 0 if all checks pass, 1 otherwise.
+//
+///////////////////////////////////////////////////////////////
+
+#include <Fmq/Fmq.hh>
+#include <Fmq/FmqDeviceShmem.hh>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <string>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/wait.h>
+using namespace std;
+
+static const size_t N_SLOTS = 100;
+static const size_t BUF_SIZE = 100000;
+
+static int _nFailed = 0;
+
+static void _check(bool ok, const char *label)
+{
+  fprintf(stdout, "  %-60s %s\n", label, ok ? "OK" : "FAILED");
+  if (!ok) {
+    _nFailed++;
+  }
+}
+
+static void _removeShmem(key_t key)
+{
+  for (int ii = 0; ii < 2; ii++) {
+    int shmid = shmget(key + ii, 0, 0666);
+    if (shmid >= 0) {
+      shmctl(shmid, IPC_RMID, NULL);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+
+{
+
+  key_t key = 47700;
+  if (argc > 1) {
+    key = atoi(argv[1]);
+  }
+  char path[1024];
+  snprintf(path, sizeof(path), "/tmp/test_fmq_single_writer/shmem_%d",
+           (int) key);
+  _removeShmem(key);
+
+  fprintf(stdout, "test_fmq_single_writer: %s\n", path);
+
+  // create the queue
+
+  Fmq creator;
+  if (creator.initCreate(path, "test_fmq_single_writer",
+                         false, false, N_SLOTS, BUF_SIZE)) {
+    fprintf(stderr, "ERROR - cannot create queue\n");
+    fprintf(stderr, "%s", creator.getErrStr().c_str());
+    return 1;
+  }
+
+  // first writer starts an update, and is killed part way through
+
+  int readyPipe[2];
+  if (pipe(readyPipe)) {
+    perror("pipe");
+    return 1;
+  }
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    return 1;
+  }
+  if (pid == 0) {
+    FmqDeviceShmem writer(path, N_SLOTS, BUF_SIZE, NULL);
+    if (writer.do_open("r+")) {
+      _exit(1);
+    }
+    writer.set_single_writer(true);
+    writer.begin_update();
+    char ready = 1;
+    if (write(readyPipe[1], &ready, 1) != 1) {
+      _exit(1);
+    }
+    while (true) {
+      pause();
+    }
+  }
+  char ready = 0;
+  if (read(readyPipe[0], &ready, 1) != 1) {
+    fprintf(stderr, "ERROR - first writer did not start\n");
+    return 1;
+  }
+  kill(pid, SIGKILL);
+  waitpid(pid, NULL, 0);
+
+  FmqDeviceShmem reader(path, N_SLOTS, BUF_SIZE, NULL);
+  if (reader.do_open("r")) {
+    fprintf(stderr, "ERROR - cannot open reader\n");
+    return 1;
+  }
+
+  ui32 seq;
+  _check(!reader.read_begin(seq),
+         "reader falls back after writer died during update");
+
+  // restarted writer
+
+  FmqDeviceShmem writer(path, N_SLOTS, BUF_SIZE, NULL);
+  if (writer.do_open("r+")) {
+    fprintf(stderr, "ERROR - cannot open restarted writer\n");
+    return 1;
+  }
+  writer.set_single_writer(true);
+  _check(reader.read_begin(seq),
+         "reader accepts data after writer restarted");
+  _check(reader.read_validate(seq),
+         "read validates with no update in progress");
+
+  ui32 seqBefore;
+  reader.read_begin(seqBefore);
+  writer.begin_update();
+  _check(!reader.read_validate(seqBefore),
+         "read started before update fails validation");
+  _check(!reader.read_begin(seq),
+         "read started during update is rejected");
+  writer.end_update();
+  _check(reader.read_begin(seq) && reader.read_validate(seq),
+         "read after update is accepted");
+
+  // a second writer cannot attach while the first is live
+
+  fflush(stdout);
+  pid = fork();
+  if (pid == 0) {
+    FmqDeviceShmem second(path, N_SLOTS, BUF_SIZE, NULL);
+    if (second.do_open("r+")) {
+      _exit(1);
+    }
+    second.set_single_writer(true);
+    second.begin_update();
+    _exit(0);
+  }
+  waitpid(pid, NULL, 0);
+  _check(reader.read_begin(seq),
+         "second writer did not attach as single writer");
+
+  writer.do_close();
+  reader.do_close();
+  creator.closeMsgQueue();
+  _removeShmem(key);
+
+  if (_nFailed > 0) {
+    fprintf(stdout, "%d checks FAILED\n", _nFailed);
+    return 1;
+  }
+  fprintf(stdout, "All checks passed\n");
+  return 0;
+
+}
@@ -0,0 +1,326 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// time_test_fmq.cc
+///////////////////////////////////////////////////////////////
+//
+// Benchmark for shared memory FMQs, comparing the normal locked
+// writer with the single-writer lock-free mode, and copying reads
+// with zero-copy reads.
+//
+// For message sizes of 1 KB and 64 KB, a writer floods the queue
+// while a forked reader reads it, to measure throughput. Then the
+// writer sends paced messages, to measure the reader latency.
+// Every message is filled with a pattern which the reader checks,
+// so that torn reads are counted. Zero-copy reads which fail
+// the view validity check are counted as errors, and discarded.
+//
+// Usage: time_test_fmq [nMsgs shmemKey]
+//
+///////////////////////////////////////////////////////////////
+
+#include <Fmq/Fmq.hh>
+#include <toolsa/uusleep.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+using namespace std;
+
+// message types
+
+static const int TYPE_FLOOD = 0;
+static const int TYPE_PACED = 1;
+static const int TYPE_END = 2;
+
+static const int N_PACED = 200;
+
+// message header, followed by fill pattern
+
+typedef struct {
+  si64 count;
+  double sentTime;
+} msg_hdr_t;
+
+// results from reader
+
+typedef struct {
+  int nRead;
+  int nCorrupt;
+  int nErrors;
+  double meanLatencyUsecs;
+  double maxLatencyUsecs;
+} reader_results_t;
+
+static double _now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1.0e6;
+}
+
+static void _fillMsg(vector<ui08> &buf, si64 count)
+{
+  msg_hdr_t hdr;
+  hdr.count = count;
+  hdr.sentTime = _now();
+  memcpy(buf.data(), &hdr, sizeof(hdr));
+  memset(buf.data() + sizeof(hdr), (int) (count & 0xff),
+         buf.size() - sizeof(hdr));
+}
+
+static bool _checkMsg(const ui08 *msg, size_t len, msg_hdr_t &hdr)
+{
+  memcpy(&hdr, msg, sizeof(hdr));
+  ui08 fill = (ui08) (hdr.count & 0xff);
+  for (size_t ii = sizeof(hdr); ii < len; ii++) {
+    if (msg[ii] != fill) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void _removeShmem(key_t key)
+{
+  for (int ii = 0; ii < 2; ii++) {
+    int shmid = shmget(key + ii, 0, 0666);
+    if (shmid >= 0) {
+      shmctl(shmid, IPC_RMID, NULL);
+    }
+  }
+}
+
+// reader - runs in child process
+
+static void _runReader(const string &path, size_t msgLen, bool zeroCopy,
+                       int readyFd, int resultsFd)
+{
+
+  Fmq fmq;
+  if (fmq.initReadBlocking(path.c_str(), "time_test_fmq",
+                           false, Fmq::END, 1)) {
+    fprintf(stderr, "ERROR - reader cannot open: %s\n", path.c_str());
+    _exit(1);
+  }
+  char ready = 1;
+  if (write(readyFd, &ready, 1) != 1) {
+    _exit(1);
+  }
+
+  reader_results_t results[2];
+  memset(results, 0, sizeof(results));
+  double sumLatency = 0.0;
+
+  while (true) {
+    Fmq::msg_view_t view;
+    int iret;
+    if (zeroCopy) {
+      iret = fmq.readMsgViewBlocking(view);
+    } else {
+      iret = fmq.readMsgBlocking();
+      view.msg = fmq.getMsg();
+      view.len = fmq.getMsgLen();
+    }
+    if (iret) {
+      // message overwritten while being read
+      results[TYPE_FLOOD].nErrors++;
+      continue;
+    }
+    int type = fmq.getMsgType();
+    if (type == TYPE_END) {
+      break;
+    }
+    reader_results_t &res = results[type];
+    msg_hdr_t hdr;
+    bool ok = ((size_t) view.len == msgLen &&
+               _checkMsg((const ui08 *) view.msg, msgLen, hdr));
+    if (zeroCopy && !fmq.msgViewIsValid(view)) {
+      // overwritten while in use
+      res.nErrors++;
+      continue;
+    }
+    if (!ok) {
+      res.nCorrupt++;
+      continue;
+    }
+    res.nRead++;
+    if (type == TYPE_PACED) {
+      double latency = (_now() - hdr.sentTime) * 1.0e6;
+      sumLatency += latency;
+      if (latency > res.maxLatencyUsecs) {
+        res.maxLatencyUsecs = latency;
+      }
+    }
+  }
+
+  if (results[TYPE_PACED].nRead > 0) {
+    results[TYPE_PACED].meanLatencyUsecs =
+      sumLatency / results[TYPE_PACED].nRead;
+  }
+  if (write(resultsFd, results, sizeof(results)) != sizeof(results)) {
+    _exit(1);
+  }
+  _exit(0);
+
+}
+
+// run one case, returns 0 on success, -1 on failure
+
+static int _runCase(key_t key, bool singleWriter, bool zeroCopy,
+                    size_t msgLen, int nMsgs)
+{
+
+  char path[1024];
+  snprintf(path, sizeof(path), "/tmp/time_test_fmq/shmem_%d", (int) key);
+  _removeShmem(key);
+
+  int nSlots = 1024;
+  size_t bufSize = 256 * (msgLen + 64);
+
+  Fmq writer;
+  if (writer.initCreate(path, "time_test_fmq", false, false,
+                        nSlots, bufSize)) {
+    fprintf(stderr, "ERROR - cannot create: %s\n", path);
+    fprintf(stderr, "%s\n", writer.getErrStr().c_str());
+    return -1;
+  }
+  if (singleWriter) {
+    writer.setSingleWriter();
+  }
+
+  int readyPipe[2], resultsPipe[2];
+  if (pipe(readyPipe) || pipe(resultsPipe)) {
+    perror("pipe");
+    return -1;
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    _runReader(path, msgLen, zeroCopy, readyPipe[1], resultsPipe[1]);
+  }
+  close(readyPipe[1]);
+  close(resultsPipe[1]);
+  char ready;
+  if (read(readyPipe[0], &ready, 1) != 1) {
+    fprintf(stderr, "ERROR - reader failed to start\n");
+    return -1;
+  }
+
+  // flood
+
+  vector<ui08> buf(msgLen);
+  double start = _now();
+  for (int ii = 0; ii < nMsgs; ii++) {
+    _fillMsg(buf, ii);
+    if (writer.writeMsg(TYPE_FLOOD, 0, buf.data(), msgLen)) {
+      fprintf(stderr, "ERROR - write failed\n");
+      return -1;
+    }
+  }
+  double floodSecs = _now() - start;
+
+  // paced - give the reader time to catch up first
+
+  umsleep(200);
+  for (int ii = 0; ii < N_PACED; ii++) {
+    _fillMsg(buf, ii);
+    writer.writeMsg(TYPE_PACED, 0, buf.data(), msgLen);
+    uusleep(500);
+  }
+  writer.writeMsg(TYPE_END, 0, buf.data(), msgLen);
+
+  reader_results_t results[2];
+  if (read(resultsPipe[0], results, sizeof(results)) != sizeof(results)) {
+    fprintf(stderr, "ERROR - no results from reader\n");
+    return -1;
+  }
+  int status;
+  waitpid(pid, &status, 0);
+  close(readyPipe[0]);
+  close(resultsPipe[0]);
+  writer.closeMsgQueue();
+  _removeShmem(key);
+
+  double rate = nMsgs / floodSecs;
+  string label = singleWriter ? "single-writer" : "locked";
+  if (zeroCopy) {
+    label += "/view";
+  }
+  fprintf(stdout,
+          "  %-18s %3d KB  %10.0f msg/s %8.1f MB/s"
+          "  read %6d corrupt %4d errors %4d"
+          "  latency mean %7.1f max %8.1f usecs\n",
+          label.c_str(),
+          (int) (msgLen / 1024), rate, rate * msgLen / 1.0e6,
+          results[TYPE_FLOOD].nRead, results[TYPE_FLOOD].nCorrupt,
+          results[TYPE_FLOOD].nErrors,
+          results[TYPE_PACED].meanLatencyUsecs,
+          results[TYPE_PACED].maxLatencyUsecs);
+  fflush(stdout);
+
+  return 0;
+
+}
+
+int main(int argc, char **argv)
+
+{
+
+  int nMsgs = 100000;
+  key_t key = 47600;
+  if (argc > 1) {
+    nMsgs = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    key = atoi(argv[2]);
+  }
+
+  fprintf(stdout, "time_test_fmq: %d messages per case\n", nMsgs);
+
+  size_t sizes[2] = { 1024, 65536 };
+  int iret = 0;
+  for (int isize = 0; isize < 2; isize++) {
+    int nn = nMsgs;
+    if (sizes[isize] > 1024) {
+      nn = nMsgs / 10;
+    }
+    for (int mode = 0; mode < 3; mode++) {
+      bool singleWriter = (mode > 0);
+      bool zeroCopy = (mode == 2);
+      if (_runCase(key, singleWriter, zeroCopy, sizes[isize], nn)) {
+        iret = -1;
+      }
+    }
+  }
+
+  return iret;
+
+}
@@ -37,6 +37,8 @@
 #define _DS_FMQ_INC_
 
 #include <deque>
+#include <pthread.h>
+#include <sys/time.h>
 #include <Fmq/Fmq.hh>
 #include <Fmq/DsFmqMsg.hh>
 #include <didss/DsURL.hh>
@@ -228,10 +230,42 @@ public:
   virtual int setSingleWriter();
  
   // set the number of messages to buffer up per write
-  // this allows for efficiency in write to a server
+  // this allows for efficiency in write to a server,
+  // and for local queues the buffered messages are written
+  // as a batch under a single lock - see writeMsgs().
+  // Call writeTheCache() to flush a partial batch.
   // this defaults to 1
 
   void setNMessagesPerWrite(int n) { _nMessagesPerWrite = n; }
+
+  // set the max age of the write cache, in msecs.
+  // When buffering writes, the cache is flushed on the next write
+  // or call to checkWriteCache() once the oldest message in it
+  // is older than this, so a quiet queue does not hold back data.
+  // this defaults to DEFAULT_MAX_WRITE_CACHE_MSECS
+
+  static const int DEFAULT_MAX_WRITE_CACHE_MSECS = 500;
+
+  void setMaxWriteCacheMsecs(int msecs) { _maxWriteCacheMsecs = msecs; }
+
+  // Flush the write cache if the oldest message in it is older
+  // than the max age. Call this periodically, e.g. from the
+  // heartbeat, when buffering writes to a queue which may go quiet,
+  // unless the cache is flushed on a timer - see below.
+  // Returns 0 on success, -1 on error
+
+  int checkWriteCache();
+
+  // Flush the write cache on a timer, from a helper thread, so
+  // that cached messages are written within the max cache age
+  // even if no further writes or checkWriteCache() calls are made.
+  // The thread is started when the first message is cached.
+  // The cache and the writes are then protected by a mutex, but
+  // reads are not, so a queue object which caches writes with the
+  // timer on should only be used for writing.
+  // Off by default.
+
+  void setFlushWriteCacheOnTimer(bool state) { _flushOnTimer = state; }
   
   // set data mapper registration - this is off by default
   // specify the registration interval in seconds
@@ -285,6 +319,20 @@ public:
   
   virtual int writeMsg(int type, int subType=0, const void *msg=NULL, int msgLen=0);
 
+  // Write a batch of messages to the fmq.
+  // See Fmq::writeMsgs().
+  // Returns 0 on success, -1 on error
+
+  virtual int writeMsgs(const vector<batch_msg_t> &msgs);
+
+  // Read a batch of messages from the fmq.
+  // See Fmq::readMsgs(). For remote queues, returns the messages
+  // available from a single server request.
+  // Returns 0 on success, -1 on error
+
+  virtual int readMsgs(vector<batch_msg_t> &msgs,
+                       int maxMsgs, int type = -1);
+
   ////////////////////////
   // using the write cache
 
@@ -299,11 +347,11 @@ public:
 
   // get the number of messages in the write cache
   
-  int getWriteCacheSize() { return (int) _writeQueue.size(); }
+  int getWriteCacheSize();
 
   // Writes all data in the cache to the fmq.
   // For remote writes, this is performed in a single action.
-  // For local writes, these are written one at a time.
+  // For local writes, these are written as a batch.
   // Returns 0 on success, -1 on error
   
   int writeTheCache();
@@ -379,6 +427,19 @@ protected:
   deque<writeData *> _writeQueue;
 
   int _nMessagesPerWrite;
+  int _maxWriteCacheMsecs;
+  struct timeval _writeCacheStart; // time of oldest cached message
+
+  // timer flush of the write cache - see setFlushWriteCacheOnTimer()
+  // _writeCacheMutex is recursive, since the write functions
+  // call each other
+
+  bool _flushOnTimer;
+  bool _flushThreadStarted;
+  bool _flushThreadExit;
+  pthread_t _flushThread;
+  pthread_mutex_t _writeCacheMutex;
+  pthread_cond_t _writeCacheCond;
   
 private:
 
@@ -399,6 +460,12 @@ private:
 
   void _clearReadQueue();
   void _clearWriteQueue();
+  bool _writeCacheDue();
+
+  void _startFlushThread();
+  void _stopFlushThread();
+  void _runFlushThread();
+  static void *_flushThreadMain(void *arg);
 
   int _checkError();
  
@@ -45,6 +45,54 @@ public:
 
   DsRadarQueue();
   virtual ~DsRadarQueue(){};
+
+  // Batching.
+  //
+  // By default, writes are batched while the beams are backed up,
+  // i.e. while the writer puts beams less than AUTO_BATCH_GAP_USECS
+  // apart. The beams are then cached and written AUTO_BATCH_SIZE at
+  // a time under a single queue lock. Once the beams arrive further
+  // apart, the cache is written with the next beam, and each beam
+  // is then written as it is put. Call setAutoBatchWrites(false)
+  // to write every beam as it is put.
+  //
+  // To batch all writes, call setNMessagesPerWrite(n). Beams are
+  // then cached and written n at a time. This turns off the
+  // automatic batching.
+  //
+  // Flag messages (start/end of tilt etc.) flush the cache, so
+  // readers see them in order and without delay. Cached beams are
+  // flushed on a timer, from a helper thread, once they are older
+  // than the max cache age - AUTO_BATCH_MAX_MSECS by default, see
+  // setMaxWriteCacheMsecs(). So the last beams before the writer
+  // stops are not held back, and the caller does not need to call
+  // checkWriteCache(). A queue object which writes beams should
+  // therefore not also be used for reading.
+  //
+  // To batch reads, call setNMessagesPerRead(n). getDsMsg() then
+  // reads all queued beams, up to n, in a single pass and returns
+  // them one at a time. The details of the last message read from
+  // the queue itself (getMsgTime() etc.) refer to the end of the
+  // batch, not the message returned.
+  // Defaults to 1 - no batching.
+
+  void setNMessagesPerRead(int n) { _nMessagesPerRead = n; }
+
+  static const int AUTO_BATCH_GAP_USECS = 1000;
+  static const int AUTO_BATCH_SIZE = 50;
+  static const int AUTO_BATCH_MAX_MSECS = 100;
+
+  void setAutoBatchWrites(bool state);
+  void setNMessagesPerWrite(int n);
+
+  virtual int seek(seekPosition position) {
+    _clearReadBatch();
+    return DsFmq::seek(position);
+  }
+  virtual int seekToId(int id) {
+    _clearReadBatch();
+    return DsFmq::seekToId(id);
+  }
   
   // Reads a DS_MESSAGE_TYPE_DSRADAR message with any contents
   // Reads a DS_MESSAGE_TYPE_DSRADAR message with any contents
@@ -81,6 +129,21 @@ private:
 
   DsRadarMsg _dsRadarMsg; // used for flag messages
 
+  // batched writes
+
+  bool _autoBatchWrites;
+  struct timeval _lastBeamPut;
+  void _setAutoBatch();
+
+  // batched reads
+
+  int _nMessagesPerRead;
+  vector<batch_msg_t> _readBatch;
+  size_t _readBatchPos;
+
+  int _getFromBatch(DsRadarMsg &dsRadarMsg, int *content, bool *gotOne);
+  void _clearReadBatch() { _readBatch.clear(); _readBatchPos = 0; }
+
 };
 
 #endif
@@ -43,6 +43,7 @@
 #include <toolsa/MemBuf.hh>
 #include <Fmq/FmqDeviceFile.hh>
 #include <Fmq/FmqDeviceShmem.hh>
+#include <vector>
 using namespace std;
 
 // Forward class declarations
@@ -79,6 +80,56 @@ public:
   static const int Q_MAX_ID = 1000000000;
   static const int Q_NBYTES_EXTRA = 12;
 
+  // max time a read waits for a write notification before
+  // re-checking the queue, if every write is known to signal -
+  // bounds the heartbeat interval
+
+  static const int Q_MAX_NOTIFY_WAIT_MSECS = 1000;
+
+  // poll interval for non-blocking reads with a timeout. If the
+  // writer may not signal (older writers, or remote writers on
+  // NFS/CIFS), a read waits at most this long for a notification
+  // before re-checking the queue, so that those writes are picked
+  // up as quickly as when polling.
+
+  static const int Q_NON_BLOCKING_POLL_MSECS = 10;
+
+  // Message view, for zero-copy reads - see readMsgView().
+
+  typedef struct {
+
+    const void *msg;  /* pointer to the message */
+    int len;          /* message length */
+    int id;           /* message id */
+    int slot;         /* slot number */
+    bool zeroCopy;    /* true if msg points into the queue buffer */
+
+    // for msgViewIsValid() - do not modify
+
+    int offset;       /* offset of entry in buffer */
+    int storedLen;    /* stored length of entry */
+    ui32 seq;         /* device update sequence number */
+    bool seqValid;    /* true if seq is valid */
+
+  } msg_view_t;
+
+  // Message entry for batched writes and reads - see writeMsgs()
+  // and readMsgs().
+
+  typedef struct {
+
+    int type;         /* message type */
+    int subType;      /* message subtype */
+    const void *msg;  /* pointer to the message */
+    int len;          /* message length */
+
+    // set by readMsgs() only
+
+    int id;           /* message id */
+    time_t time;      /* time message was written */
+
+  } batch_msg_t;
+
   // FMQ status struct
   
   typedef struct {
@@ -331,7 +382,11 @@ public:
   virtual int setBlockingWrite();
  
   // Set flag to indicate that there is only a single writer
-  // so the locking is not necessary
+  // so the locking is not necessary.
+  // For shared memory queues this also enables lock-free reads:
+  // the writer maintains a sequence number around its updates so
+  // that readers can detect partial updates and overwritten
+  // messages without taking a lock.
   // Returns 0 on success, -1 on error
 
   virtual int setSingleWriter();
@@ -383,6 +438,36 @@ public:
 
   virtual int readMsgBlocking(int type = -1);
 
+  // Zero-copy reads.
+  //
+  // These work like readMsg() and readMsgBlocking(), but return a
+  // view of the message instead of copying it into the object.
+  //
+  // For uncompressed messages in a shared memory queue, view.msg
+  // points directly into the shared memory buffer, and view.zeroCopy
+  // is true. The writer may overwrite the message at any time, so
+  // after using the data the reader must call msgViewIsValid(). If
+  // that returns false, the data may have been overwritten while in
+  // use and must be discarded.
+  //
+  // Otherwise - compressed messages, file-based or remote queues -
+  // the message is copied as in readMsg(), view.zeroCopy is false,
+  // and view.msg is valid until the next read.
+  //
+  // getMsg() and getMsgLen() should not be used after a zero-copy read.
+  // The other message details (type, time etc.) are set as usual.
+  //
+  // Returns 0 on success, -1 on error
+
+  int readMsgView(msg_view_t &view, bool *gotOne,
+                  int type = -1, int msecs_sleep = -1);
+  int readMsgViewBlocking(msg_view_t &view, int type = -1);
+
+  // Check that the message in a view has not been overwritten.
+  // Returns true if the message is still intact.
+
+  bool msgViewIsValid(const msg_view_t &view);
+
   // Writes a message to the fmq
   // Returns 0 on success, -1 on error
   
@@ -398,6 +483,36 @@ public:
 				    const void *msg, int msgLen,
 				    int uncompressedLen);
   
+  // Write a batch of messages to the fmq.
+  //
+  // The messages are written in order, under a single lock, and the
+  // status struct is read and written once for the batch rather than
+  // once per message. Readers are notified once, after the whole
+  // batch has been committed.
+  //
+  // In blocking-write mode the status is still checked for each
+  // message, so that the writer can wait for the reader.
+  //
+  // The type, subType, msg and len members of each entry are used.
+  // Returns 0 on success, -1 on error
+  
+  virtual int writeMsgs(const vector<batch_msg_t> &msgs);
+
+  // Read a batch of messages from the fmq.
+  //
+  // Reads all messages currently available, up to maxMsgs, from a
+  // single snapshot of the status struct. Does not wait.
+  // If type is specified, only messages of that type are returned.
+  //
+  // On return, msgs holds the messages read, possibly none. The msg
+  // pointers are valid until the next call to readMsgs().
+  // getMsg() etc. refer to the last message in the batch.
+  //
+  // Returns 0 on success, -1 on error
+  
+  virtual int readMsgs(vector<batch_msg_t> &msgs,
+                       int maxMsgs, int type = -1);
+
   ///////////////////////////////////////////////////////////
   // get methods
 
@@ -617,6 +732,17 @@ protected:
   // buffer for message
   
   MemBuf _msgBuf;      /* buffer for message */
+
+  // zero-copy reads
+  
+  bool _zeroCopyRead;     /* zero-copy read in progress */
+  const void *_viewPtr;   /* pointer into device buffer, if zero-copy */
+  int _viewLen;           /* message length, if zero-copy */
+
+  // batched reads
+
+  MemBuf _batchBuf;               /* message data for readMsgs() */
+  vector<size_t> _batchOffsets;   /* offsets of messages in _batchBuf */
   
   // copy of latest stat and slot read
 
@@ -634,6 +760,9 @@ protected:
   int _singleWriter;   /* flag to indicate that only a single writer is running
 			* so that locking is not necessary */
 
+  ui32 _readSeq;       /* device update sequence number at last slot read */
+  bool _readSeqValid;  /* true if _readSeq is valid, i.e. lock-free mode */
+
   // memory allocation
 
   int _nslotsAlloc;    /* Number of slots allocated */
@@ -696,6 +825,22 @@ protected:
   int _lock_device();
   int _unlock_device();
 
+  // single-writer lock-free mode
+
+  void _set_single_writer_device();
+  void _begin_update_device();
+  void _end_update_device();
+  bool _read_begin_device(ui32 &seq);
+  bool _read_validate_device(ui32 seq);
+  bool _slot_reused(int slot_num);
+
+  // write notification
+
+  void _notify_device();
+  void _prepare_wait_device();
+  int _wait_device(int msecs);
+  int _max_wait_device(int msecs_poll);
+
   // seek
 
   int _seek_end();
@@ -712,7 +857,7 @@ protected:
   int _read_stat();
   int _read_slots();
   int _read_slot(int slot_num);
-  int _read_next(int *msg_read);
+  int _read_next(int *msg_read, bool batch = false);
   int _read_msg_for_slot(int slot_num);
   int _read_msg(int slot_num);
 
@@ -726,8 +871,13 @@ protected:
 		     int uncompressed_len);
   
   int _read_device(FmqDevice::ident_t id, void *mess, size_t len);
+  const void *_get_device_ptr(FmqDevice::ident_t id,
+                              off_t offset, size_t len);
+  void _load_view(msg_view_t &view);
   int _update_last_id_read();
   int _add_read_msg(void *msg, int msg_size);
+  void _add_batch_msg(vector<batch_msg_t> &msgs);
+  void _set_batch_ptrs(vector<batch_msg_t> &msgs);
   
   // write
 
@@ -745,7 +895,8 @@ protected:
   
   int _write_msg(void *msg, int msg_len,
 		 int msg_type, int msg_subtype,
-		 int pre_compressed, int uncompressed_len);
+		 int pre_compressed, int uncompressed_len,
+		 bool read_stat = true, bool write_stat = true);
   
   int _write_msg_to_slot(int write_slot, int write_id,
 			 void *msg, int msg_len, int stored_len, int offset);
@@ -36,6 +36,7 @@
 #define _FMQ_DEVICE_HH_INCLUDED_
 
 #include <string>
+#include <dataport/port_types.h>
 #include <toolsa/heartbeat.h>
 using namespace std;
 
@@ -107,6 +108,62 @@ public:
 
   virtual int get_size(ident_t id) = 0;
   
+  // Get a pointer directly into the device buffer, for zero-copy
+  // reads. Returns NULL if the device does not support this, or if
+  // the requested region is out of range.
+
+  virtual const void *get_ptr(ident_t id, off_t offset, size_t len)
+  {
+    return NULL;
+  }
+
+  // Write notification, for event-driven blocking reads.
+  //
+  // notify_write() is called by the writer after a slot has been
+  // committed and the lock released.
+  //
+  // prepare_wait() is called by a reader before it checks the queue,
+  // to snapshot the notification state. wait_for_write() then blocks
+  // until notify_write() is called after the snapshot, or until msecs
+  // have elapsed.
+  //
+  // wait_for_write() returns 0 if woken or timed out, -1 if the
+  // device does not support notification, in which case the caller
+  // should fall back to sleep polling.
+  //
+  // writer_signals() returns true if every write is known to wake
+  // wait_for_write(). The reader may then block for longer between
+  // checks of the queue. If false, a writer may not signal (e.g. an
+  // older writer, or a remote writer on a network filesystem), so
+  // the reader must keep re-checking at the poll interval.
+  //
+  // The defaults do nothing, so devices without support poll.
+
+  virtual void notify_write() {}
+  virtual void prepare_wait() {}
+  virtual int wait_for_write(int msecs) { return -1; }
+  virtual bool writer_signals() { return false; }
+
+  // Single-writer lock-free mode.
+  //
+  // set_single_writer() is called by a writer which has been told it
+  // is the only writer. If the device supports it, the writer then
+  // brackets each stat and slot update with begin_update() and
+  // end_update(), which maintain a sequence number that is odd while
+  // an update is in progress.
+  //
+  // Readers call read_begin() before reading stat or slot data. It
+  // returns false if the writer is not in single-writer mode, in
+  // which case readers rely on the checksums as before. Otherwise it
+  // sets seq, and read_validate(seq) returns true if no update
+  // started since then, i.e. the data read is consistent.
+
+  virtual void set_single_writer(bool state) {}
+  virtual void begin_update() {}
+  virtual void end_update() {}
+  virtual bool read_begin(ui32 &seq) { return false; }
+  virtual bool read_validate(ui32 seq) { return true; }
+
   ///////////////////////////////////////////////////////////////////
   // error string is set during open/read/write operations
   // get error string is an error is returned
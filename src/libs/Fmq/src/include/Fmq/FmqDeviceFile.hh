@@ -104,6 +104,14 @@ public:
 
   virtual int get_size(ident_t id);
   
+  // write notification - see FmqDevice.hh
+  // The writer updates the stat file for every message, so readers
+  // watch it with inotify. No explicit notify_write() is needed.
+
+  virtual void prepare_wait();
+  virtual int wait_for_write(int msecs);
+  virtual bool writer_signals();
+
 protected:
 
 private:
@@ -124,6 +132,19 @@ private:
   int _buf_fd;
   int _fd[N_IDENT];
 
+  // inotify on the stat file, for blocking reads
+  // -1 if not yet set up or not available
+  // _notify_local is false if the stat file is on a network
+  // filesystem, where writes from other hosts do not raise events
+
+  int _notify_fd;
+  bool _notify_failed;
+  bool _notify_local;
+
+  int _open_notify();
+  void _close_notify();
+  void _drain_notify();
+
 };
 
 #endif
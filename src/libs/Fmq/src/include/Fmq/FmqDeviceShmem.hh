@@ -36,6 +36,7 @@
 #define _FMQ_DEVICE_SHMEM_HH_INCLUDED_
 
 #include <sys/types.h>
+#include <dataport/port_types.h>
 #include <Fmq/FmqDevice.hh>
 using namespace std;
 
@@ -101,6 +102,25 @@ public:
 
   virtual int get_size(ident_t id);
   
+  // pointer into segment, for zero-copy reads
+
+  virtual const void *get_ptr(ident_t id, off_t offset, size_t len);
+
+  // write notification - see FmqDevice.hh
+
+  virtual void notify_write();
+  virtual void prepare_wait();
+  virtual int wait_for_write(int msecs);
+  virtual bool writer_signals();
+
+  // single-writer lock-free mode - see FmqDevice.hh
+
+  virtual void set_single_writer(bool state);
+  virtual void begin_update();
+  virtual void end_update();
+  virtual bool read_begin(ui32 &seq);
+  virtual bool read_validate(ui32 seq);
+
 protected:
 
 private:
@@ -123,16 +143,55 @@ private:
   // off_t _bufOffset; // current offset in buf segment
   off_t _offset[N_IDENT];
 
+  // Write notification and synchronization block.
+  // This is appended to the stat segment, after the slots, so the
+  // queue layout seen by older readers and writers is unchanged.
+  // Stored in native byte order - shmem is host-local.
+  // seq is incremented by the writer for each message, and is used
+  // as a futex word by blocked readers.
+  // update_seq is the single-writer sequence number, odd while the
+  // writer is updating the stat or slot data. writer_pid is the
+  // pid of the single writer, 0 if there is none.
+  // writer_signals is set to 1 by writers which call notify_write(),
+  // so that readers know a futex wait will be woken by a write.
+
+  static const ui32 NOTIFY_MAGIC = 88008803;
+
+  typedef struct {
+    ui32 magic;
+    ui32 seq;           // incremented on each write
+    ui32 nwaiters;      // number of readers blocked in wait
+    ui32 single_writer; // 1 if writer is in single-writer mode
+    ui32 update_seq;    // single-writer update sequence number
+    ui32 writer_pid;    // pid of single writer, 0 if none
+    ui32 writer_signals; // 1 once a writer has called notify_write()
+    ui32 spare[1];
+  } notify_t;
+
+  notify_t *_notify; // NULL if segment has no notification block
+  ui32 _notifySeq;   // seq at last prepare_wait()
+  bool _singleWriter; // this process is the single writer
+  bool _writerWarned;  // warned that another single writer is live
+  bool _stuckSeqValid; // an update was seen not to complete
+  ui32 _stuckSeq;      // update_seq left odd by a dead writer
+
+  // max time for read_begin() to wait for an update to complete
+
+  static const int READ_BEGIN_MAX_USECS = 10000;
+
   // lock file for synchronization
   
   string _lock_path;
   FILE *_lock_file;
   
   const char *_getSegName(ident_t id);
+  bool _attachSingleWriter();
   
   int _open_create();
   int _open_rdwr();
   int _set_sizes_from_existing_queue();
+  size_t _statSegSize(bool withNotify);
+  void _initNotify(bool withNotify, bool isCreator);
 
   int _getShmemKeys();
   
@@ -0,0 +1,499 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+///////////////////////////////////////////////////////////////
+// Cf2ChunkReader.cc
+///////////////////////////////////////////////////////////////
+//
+// Multi-threaded reading of compressed 2-D field variables from
+// a NetCDF4/HDF5 file. See Cf2ChunkReader.hh.
+//
+///////////////////////////////////////////////////////////////
+
+#include <Radx/Cf2ChunkReader.hh>
+#include <hdf5.h>
+#include <zlib.h>
+#include <pthread.h>
+#include <cstring>
+
+// direct chunk reads need HDF5 1.10.5 or later
+
+#if H5_VERSION_GE(1,10,5)
+#define CF2_DIRECT_CHUNK_READ
+#endif
+
+//////////////////////////////////////////////////
+// Constructor
+
+Cf2ChunkReader::Cf2ChunkReader()
+{
+  _fileId = -1;
+}
+
+//////////////////////////////////////////////////
+// Destructor
+
+Cf2ChunkReader::~Cf2ChunkReader()
+{
+  close();
+  clear();
+}
+
+//////////////////////////////////////////////////
+// open file for raw reads
+
+int Cf2ChunkReader::open(const string &path)
+{
+
+  close();
+
+#ifdef CF2_DIRECT_CHUNK_READ
+  hid_t fileId = -1;
+  H5E_BEGIN_TRY {
+    fileId = H5Fopen(path.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  } H5E_END_TRY;
+  if (fileId < 0) {
+    return -1;
+  }
+  _fileId = fileId;
+  return 0;
+#else
+  return -1;
+#endif
+
+}
+
+//////////////////////////////////////////////////
+// close file
+
+void Cf2ChunkReader::close()
+{
+  if (_fileId >= 0) {
+    H5E_BEGIN_TRY {
+      H5Fclose((hid_t) _fileId);
+    } H5E_END_TRY;
+    _fileId = -1;
+  }
+}
+
+//////////////////////////////////////////////////
+// free all data
+
+void Cf2ChunkReader::clear()
+{
+  for (size_t ii = 0; ii < _vars.size(); ii++) {
+    delete _vars[ii];
+  }
+  _vars.clear();
+  _varMap.clear();
+}
+
+//////////////////////////////////////////////////
+// read raw chunks for a variable
+// returns 0 on success, -1 if it cannot be handled
+
+int Cf2ChunkReader::readRawVar(const string &name,
+                               const string &datasetPath,
+                               size_t elemSize,
+                               size_t nRows, size_t nCols)
+{
+
+  if (_fileId < 0 || nRows == 0 || nCols == 0) {
+    return -1;
+  }
+
+#ifdef CF2_DIRECT_CHUNK_READ
+
+  Var *var = new Var;
+  var->name = name;
+  var->elemSize = elemSize;
+  var->nRows = nRows;
+  var->nCols = nCols;
+  var->chunkRows = 0;
+  var->chunkCols = 0;
+  var->decoded = false;
+
+  bool ok = true;
+  hid_t dsetId = -1, typeId = -1, spaceId = -1, plistId = -1;
+
+  H5E_BEGIN_TRY {
+
+    dsetId = H5Dopen2((hid_t) _fileId, datasetPath.c_str(), H5P_DEFAULT);
+    if (dsetId < 0) {
+      ok = false;
+    }
+
+    // check type size and byte order
+
+    if (ok) {
+      typeId = H5Dget_type(dsetId);
+      if (typeId < 0 || H5Tget_size(typeId) != elemSize) {
+        ok = false;
+      } else if (elemSize > 1 &&
+                 H5Tget_order(typeId) != H5Tget_order(H5T_NATIVE_INT)) {
+        ok = false;
+      }
+    }
+
+    // check dimensions
+
+    if (ok) {
+      spaceId = H5Dget_space(dsetId);
+      hsize_t dims[2];
+      if (spaceId < 0 ||
+          H5Sget_simple_extent_ndims(spaceId) != 2 ||
+          H5Sget_simple_extent_dims(spaceId, dims, NULL) != 2 ||
+          dims[0] != nRows || dims[1] != nCols) {
+        ok = false;
+      }
+    }
+
+    // check chunking and filters
+
+    if (ok) {
+      plistId = H5Dget_create_plist(dsetId);
+      hsize_t chunkDims[2];
+      if (plistId < 0 ||
+          H5Pget_layout(plistId) != H5D_CHUNKED ||
+          H5Pget_chunk(plistId, 2, chunkDims) != 2) {
+        ok = false;
+      } else {
+        var->chunkRows = chunkDims[0];
+        var->chunkCols = chunkDims[1];
+        int nFilters = H5Pget_nfilters(plistId);
+        for (int ii = 0; ii < nFilters; ii++) {
+          unsigned int flags;
+          size_t nElements = 0;
+          unsigned int filterConfig;
+          H5Z_filter_t filter =
+            H5Pget_filter2(plistId, ii, &flags, &nElements, NULL,
+                           0, NULL, &filterConfig);
+          if (filter != H5Z_FILTER_DEFLATE && filter != H5Z_FILTER_SHUFFLE) {
+            ok = false;
+            break;
+          }
+          var->filters.push_back(filter);
+        }
+      }
+    }
+
+    // read the raw chunks - all chunks must be allocated
+
+    if (ok) {
+      size_t nChunkRows = (nRows + var->chunkRows - 1) / var->chunkRows;
+      size_t nChunkCols = (nCols + var->chunkCols - 1) / var->chunkCols;
+      hsize_t nChunks = 0;
+      if (H5Dget_num_chunks(dsetId, spaceId, &nChunks) < 0 ||
+          nChunks != nChunkRows * nChunkCols) {
+        ok = false;
+      } else {
+        var->chunks.resize(nChunks);
+        for (hsize_t ii = 0; ii < nChunks; ii++) {
+          Chunk &chunk = var->chunks[ii];
+          hsize_t offset[2];
+          unsigned int filterMask = 0;
+          haddr_t addr;
+          hsize_t size = 0;
+          if (H5Dget_chunk_info(dsetId, spaceId, ii, offset,
+                                &filterMask, &addr, &size) < 0) {
+            ok = false;
+            break;
+          }
+          chunk.row0 = offset[0];
+          chunk.col0 = offset[1];
+          chunk.ok = false;
+          chunk.raw.resize(size);
+          if (H5Dread_chunk(dsetId, H5P_DEFAULT, offset,
+                            &filterMask, chunk.raw.data()) < 0) {
+            ok = false;
+            break;
+          }
+          chunk.filterMask = filterMask;
+        } // ii
+      }
+    }
+
+    if (plistId >= 0) H5Pclose(plistId);
+    if (spaceId >= 0) H5Sclose(spaceId);
+    if (typeId >= 0) H5Tclose(typeId);
+    if (dsetId >= 0) H5Dclose(dsetId);
+
+  } H5E_END_TRY;
+
+  if (!ok) {
+    delete var;
+    return -1;
+  }
+
+  // replace any previous entry for this name
+
+  map<string, Var *>::iterator it = _varMap.find(name);
+  if (it != _varMap.end()) {
+    for (size_t ii = 0; ii < _vars.size(); ii++) {
+      if (_vars[ii] == it->second) {
+        _vars.erase(_vars.begin() + ii);
+        break;
+      }
+    }
+    delete it->second;
+  }
+  _vars.push_back(var);
+  _varMap[name] = var;
+
+  return 0;
+
+#else
+
+  return -1;
+
+#endif
+
+}
+
+//////////////////////////////////////////////////
+// decode all variables
+
+void Cf2ChunkReader::decode(int nThreads)
+{
+
+  // allocate the output arrays
+
+  size_t nChunksTotal = 0;
+  for (size_t ii = 0; ii < _vars.size(); ii++) {
+    Var *var = _vars[ii];
+    if (!var->decoded) {
+      var->data.resize(var->nRows * var->nCols * var->elemSize);
+      nChunksTotal += var->chunks.size();
+    }
+  }
+
+  if (nThreads < 1) {
+    nThreads = 1;
+  }
+  if ((size_t) nThreads > nChunksTotal) {
+    nThreads = (int) nChunksTotal;
+  }
+
+  if (nThreads <= 1) {
+    _decodeShare(0, 1);
+  } else {
+    vector<Task> tasks(nThreads);
+    vector<pthread_t> threads(nThreads);
+    vector<bool> started(nThreads, false);
+    for (int ii = 0; ii < nThreads; ii++) {
+      tasks[ii].reader = this;
+      tasks[ii].threadNum = ii;
+      tasks[ii].nThreads = nThreads;
+    }
+    for (int ii = 1; ii < nThreads; ii++) {
+      if (pthread_create(&threads[ii], NULL,
+                         _decodeThreadEntry, &tasks[ii]) == 0) {
+        started[ii] = true;
+      }
+    }
+    _decodeShare(0, nThreads);
+    for (int ii = 1; ii < nThreads; ii++) {
+      if (started[ii]) {
+        pthread_join(threads[ii], NULL);
+      } else {
+        _decodeShare(ii, nThreads);
+      }
+    }
+  }
+
+  // check for success, free the raw chunks
+  
+  for (size_t ii = 0; ii < _vars.size(); ii++) {
+    Var *var = _vars[ii];
+    if (var->decoded) {
+      continue;
+    }
+    bool allOk = true;
+    for (size_t jj = 0; jj < var->chunks.size(); jj++) {
+      if (!var->chunks[jj].ok) {
+        allOk = false;
+      }
+    }
+    var->chunks.clear();
+    var->decoded = allOk;
+    if (!allOk) {
+      var->data.clear();
+    }
+  }
+
+}
+
+//////////////////////////////////////////////////
+// thread entry point for decoding
+
+void *Cf2ChunkReader::_decodeThreadEntry(void *args)
+{
+  Task *task = (Task *) args;
+  task->reader->_decodeShare(task->threadNum, task->nThreads);
+  return NULL;
+}
+
+//////////////////////////////////////////////////
+// decode this thread's share of the chunks
+// chunks are numbered across all variables, and each thread
+// takes every nth chunk
+
+void Cf2ChunkReader::_decodeShare(int threadNum, int nThreads)
+{
+  size_t chunkNum = 0;
+  for (size_t ii = 0; ii < _vars.size(); ii++) {
+    Var &var = *_vars[ii];
+    if (var.decoded) {
+      continue;
+    }
+    for (size_t jj = 0; jj < var.chunks.size(); jj++, chunkNum++) {
+      if ((int) (chunkNum % nThreads) == threadNum) {
+        Chunk &chunk = var.chunks[jj];
+        chunk.ok = _decodeChunk(var, chunk);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+// decode a chunk, copying it into the output array
+// returns true on success
+
+bool Cf2ChunkReader::_decodeChunk(Var &var, Chunk &chunk)
+{
+
+  size_t chunkBytes = var.chunkRows * var.chunkCols * var.elemSize;
+  vector<unsigned char> work;
+  vector<unsigned char> decoded(chunk.raw);
+
+  // undo the filters in reverse order
+  // a set bit in the filter mask means the filter was skipped
+
+  for (int ii = (int) var.filters.size() - 1; ii >= 0; ii--) {
+
+    if (chunk.filterMask & (1u << ii)) {
+      continue;
+    }
+
+    if (var.filters[ii] == H5Z_FILTER_DEFLATE) {
+
+      work.resize(chunkBytes);
+      uLongf destLen = chunkBytes;
+      if (uncompress(work.data(), &destLen,
+                     decoded.data(), decoded.size()) != Z_OK) {
+        return false;
+      }
+      work.resize(destLen);
+      decoded.swap(work);
+
+    } else if (var.filters[ii] == H5Z_FILTER_SHUFFLE) {
+      
+      // byte j of element i is stored at j * nElem + i
+      
+      size_t elemSize = var.elemSize;
+      if (elemSize > 1) {
+        size_t nElem = decoded.size() / elemSize;
+        work.resize(decoded.size());
+        for (size_t jj = 0; jj < elemSize; jj++) {
+          const unsigned char *src = decoded.data() + jj * nElem;
+          unsigned char *dest = work.data() + jj;
+          for (size_t kk = 0; kk < nElem; kk++, dest += elemSize) {
+            *dest = src[kk];
+          }
+        }
+        // any trailing bytes are not shuffled
+        size_t nShuffled = nElem * elemSize;
+        memcpy(work.data() + nShuffled, decoded.data() + nShuffled,
+               decoded.size() - nShuffled);
+        decoded.swap(work);
+      }
+
+    }
+
+  } // ii
+
+  if (decoded.size() != chunkBytes) {
+    return false;
+  }
+
+  // copy into output array - edge chunks are stored full size
+  
+  if (chunk.row0 >= var.nRows || chunk.col0 >= var.nCols) {
+    return false;
+  }
+  size_t nRowsCopy = var.chunkRows;
+  if (chunk.row0 + nRowsCopy > var.nRows) {
+    nRowsCopy = var.nRows - chunk.row0;
+  }
+  size_t nColsCopy = var.chunkCols;
+  if (chunk.col0 + nColsCopy > var.nCols) {
+    nColsCopy = var.nCols - chunk.col0;
+  }
+  for (size_t irow = 0; irow < nRowsCopy; irow++) {
+    const unsigned char *src =
+      decoded.data() + irow * var.chunkCols * var.elemSize;
+    unsigned char *dest =
+      var.data.data() +
+      ((chunk.row0 + irow) * var.nCols + chunk.col0) * var.elemSize;
+    memcpy(dest, src, nColsCopy * var.elemSize);
+  }
+
+  // free raw data
+
+  vector<unsigned char>().swap(chunk.raw);
+
+  return true;
+
+}
+
+//////////////////////////////////////////////////
+// copy decoded data into buffer
+// returns 0 on success, -1 if not available
+
+int Cf2ChunkReader::copyData(const string &name,
+                             void *buf, size_t nBytes) const
+{
+  map<string, Var *>::const_iterator it = _varMap.find(name);
+  if (it == _varMap.end()) {
+    return -1;
+  }
+  const Var *var = it->second;
+  if (!var->decoded || var->data.size() != nBytes) {
+    return -1;
+  }
+  memcpy(buf, var->data.data(), nBytes);
+  return 0;
+}
+
+//////////////////////////////////////////////////
+// get number of variables successfully decoded
+
+size_t Cf2ChunkReader::getNDecoded() const
+{
+  size_t count = 0;
+  for (size_t ii = 0; ii < _vars.size(); ii++) {
+    if (_vars[ii]->decoded) {
+      count++;
+    }
+  }
+  return count;
+}
@@ -65,6 +65,8 @@ Cf2RadxFile::Cf2RadxFile() : RadxFile(), RadxNcfStr()
   _ncFormat = NETCDF4;
 
   _writeVol = NULL;
+  _writeStartTimeSecs = 0;
+  _streamVol = NULL;
   _readVol = NULL;
 
   clear();
@@ -77,6 +79,7 @@ Cf2RadxFile::Cf2RadxFile() : RadxFile(), RadxNcfStr()
 Cf2RadxFile::~Cf2RadxFile()
 
 {
+  _abortStreamWrite();
   clear();
 }
 
@@ -1872,9 +1872,17 @@ void Cf2RadxFile::_readFrequency(NcxxGroup &group)
 
      _createSweepRays(sweep);
 
+     // if multi-threaded, read and decompress the field data
+     // for the sweep ahead of time
+
+     if (_readNThreads > 1) {
+       _prefetchFieldData();
+     }
+
      // add field variables to the rays
 
      _readFieldVariables(false);
+     _chunkReader.clear();
 
    }
 
@@ -2674,6 +2682,90 @@ void Cf2RadxFile::_readFrequency(NcxxGroup &group)
 
  }
 
+ ////////////////////////////////////////////////////////
+ // Read and decompress the field data for the sweep, using
+ // multiple threads.
+ //
+ // The compressed chunks are read serially, since the NetCDF
+ // and HDF5 libraries are not thread safe, and are then
+ // decompressed concurrently. The results are held in
+ // _chunkReader, and used by the _addXxxFieldToRays() methods.
+ // Fields which cannot be handled this way are read through
+ // NetCDF as usual.
+
+ void Cf2RadxFile::_prefetchFieldData()
+
+ {
+
+   _chunkReader.clear();
+   if (_chunkReader.open(_pathInUse)) {
+     if (_verbose) {
+       cerr << "DEBUG - Cf2RadxFile::_prefetchFieldData" << endl;
+       cerr << "  Cannot open file for chunk reads: " << _pathInUse << endl;
+     }
+     return;
+   }
+
+   size_t nTimes = _timeDimSweep.getSize();
+   size_t nGates = _rangeDimSweep.getSize();
+   string groupPath = _sweepGroup.getName(true);
+
+   const multimap<string, NcxxVar> &vars = _sweepGroup.getVars();
+   for (multimap<string, NcxxVar>::const_iterator iter = vars.begin();
+        iter != vars.end(); iter++) {
+
+     // select field variables, as in _readFieldVariables()
+
+     NcxxVar var = iter->second;
+     if (var.isNull() || var.getDimCount() != 2) {
+       continue;
+     }
+     if (var.getDim(0) != _timeDimSweep || var.getDim(1) != _rangeDimSweep) {
+       continue;
+     }
+     string name = var.getName();
+     if (name == "range" || !isFieldRequiredOnRead(name)) {
+       continue;
+     }
+     NcxxType ftype = var.getType();
+     size_t elemSize = 0;
+     if (ftype == ncxxDouble) {
+       elemSize = sizeof(Radx::fl64);
+     } else if (ftype == ncxxFloat) {
+       elemSize = sizeof(Radx::fl32);
+     } else if (ftype == ncxxInt) {
+       elemSize = sizeof(Radx::si32);
+     } else if (ftype == ncxxShort) {
+       elemSize = sizeof(Radx::si16);
+     } else if (ftype == ncxxByte) {
+       elemSize = sizeof(Radx::si08);
+     } else {
+       continue;
+     }
+
+     string datasetPath = groupPath + "/" + name;
+     if (_chunkReader.readRawVar(name, datasetPath,
+                                 elemSize, nTimes, nGates)) {
+       if (_verbose) {
+         cerr << "DEBUG - Cf2RadxFile::_prefetchFieldData" << endl;
+         cerr << "  -->> will read field through NetCDF: " << name << endl;
+       }
+     }
+
+   } // iter
+
+   _chunkReader.close();
+   _chunkReader.decode(_readNThreads);
+
+   if (_verbose) {
+     cerr << "DEBUG - Cf2RadxFile::_prefetchFieldData" << endl;
+     cerr << "  sweep group: " << groupPath << endl;
+     cerr << "  n fields decoded, nThreads: "
+          << _chunkReader.getNDecoded() << ", " << _readNThreads << endl;
+   }
+
+ }
+
  ////////////////////////////////////////////////////////
  // read a ray variable from a sweep - double
  // side effect: sets vals
@@ -2962,7 +3054,10 @@ void Cf2RadxFile::_readFrequency(NcxxGroup &group)
    Radx::fl64 *data = data_.alloc(nVals);
 
    try {
-     var.getVal(data);
+     if (_chunkReader.copyData(name, data,
+                                 nVals * sizeof(Radx::fl64)) != 0) {
+       var.getVal(data);
+     }
    } catch (NcxxException& e) {
      NcxxErrStr err;
      err.addErrStr("ERROR - Cf2RadxFile::_addFl64FieldToRays");
@@ -3059,7 +3154,10 @@ void Cf2RadxFile::_addFl32FieldToRays(NcxxVar &var,
   Radx::fl32 *data = data_.alloc(nVals);
   
   try {
-    var.getVal(data);
+    if (_chunkReader.copyData(name, data,
+                                nVals * sizeof(Radx::fl32)) != 0) {
+      var.getVal(data);
+    }
   } catch (NcxxException& e) {
     NcxxErrStr err;
     err.addErrStr("ERROR - Cf2RadxFile::_addFl32FieldToRays");
@@ -3157,7 +3255,10 @@ void Cf2RadxFile::_addSi32FieldToRays(NcxxVar &var,
   Radx::si32 *data = data_.alloc(nVals);
   
   try {
-    var.getVal(data);
+    if (_chunkReader.copyData(name, data,
+                                nVals * sizeof(Radx::si32)) != 0) {
+      var.getVal(data);
+    }
   } catch (NcxxException& e) {
     NcxxErrStr err;
     err.addErrStr("ERROR - Cf2RadxFile::_addSi32FieldToRays");
@@ -3248,7 +3349,10 @@ void Cf2RadxFile::_addSi16FieldToRays(NcxxVar &var,
   Radx::si16 *data = data_.alloc(nVals);
   
   try {
-    var.getVal(data);
+    if (_chunkReader.copyData(name, data,
+                                nVals * sizeof(Radx::si16)) != 0) {
+      var.getVal(data);
+    }
   } catch (NcxxException& e) {
     NcxxErrStr err;
     err.addErrStr("ERROR - Cf2RadxFile::_addSi16FieldToRays");
@@ -3339,7 +3443,10 @@ void Cf2RadxFile::_addSi08FieldToRays(NcxxVar &var,
   Radx::si08 *data = data_.alloc(nVals);
   
   try {
-    var.getVal(data);
+    if (_chunkReader.copyData(name, data,
+                                nVals * sizeof(Radx::si08)) != 0) {
+      var.getVal(data);
+    }
   } catch (NcxxException& e) {
     NcxxErrStr err;
     err.addErrStr("ERROR - Cf2RadxFile::_addSi08FieldToRays");
@@ -338,6 +338,7 @@ int Cf2RadxFile::writeToPath(const RadxVol &vol,
 
   clearErrStr();
   _writeVol = &vol;
+  _writeStartTimeSecs = vol.getStartTimeSecs();
   _pathInUse = path;
   vol.setPathInUse(_pathInUse);
   _writePaths.clear();
@@ -387,8 +388,267 @@ int Cf2RadxFile::writeToPath(const RadxVol &vol,
     cerr << "===================================================" << endl;
   }
 
-  // add attributes, dimensions and variables
+  // add root group attributes, dimensions and variables
+
+  if (_addRootGroup()) {
+    return -1;
+  }
+
+  // add sweep groups
+
+  try {
+    _addSweeps();
+  } catch (NcxxException e) {
+    return _closeOnError("_addSweeps");
+  }
+
+  // close output file
+
+  _file.close();
+
+  // rename the tmp to final output file path
+  
+  if (rename(_tmpPath.c_str(), _pathInUse.c_str())) {
+    int errNum = errno;
+    _addErrStr("ERROR - Cf2RadxFile::writeToPath");
+    _addErrStr("  Cannot rename tmp file: ", _tmpPath);
+    _addErrStr("  to: ", _pathInUse);
+    _addErrStr(strerror(errNum));
+    return -1;
+  }
+
+  if (_debug) {
+    cerr << "DEBUG - Cf2RadxFile::writeToPath" << endl;
+    cerr << "  Renamed tmp path: " << _tmpPath << endl;
+    cerr << "     to final path: " << path << endl;
+  }
+
+  _writePaths.push_back(path);
+  _writeDataTimes.push_back(vol.getStartTimeSecs());
+  
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////////
+// Open a file for streaming write.
+// The sweeps are appended as they are completed, using
+// writeSweepsToStream(), and the root-level metadata is
+// written by closeStreamWrite().
+// Returns 0 on success, -1 on failure
+
+int Cf2RadxFile::openStreamWrite(const RadxVol &vol,
+                                 const string &path)
+  
+{
+
+  clearErrStr();
+  if (_streamVol != NULL) {
+    // previous stream not closed - discard it
+    _abortStreamWrite();
+  }
+
+  // keep a copy of the metadata, without rays
+
+  _streamVol = new RadxVol;
+  _streamVol->copyMeta(vol);
+  _streamVol->clearSweeps();
+
+  _pathInUse = path;
+  _writePaths.clear();
+  _writeDataTimes.clear();
+  _sweepGroupNames.clear();
+  _sweepGroupFixedAngles.clear();
+  _sweepGroups.clear();
+
+  // open the output Ncxx file
+
+  _tmpPath = tmpPathFromFilePath(path, "");
+
+  if (_debug) {
+    cerr << "DEBUG - Cf2RadxFile::openStreamWrite" << endl;
+    cerr << "  Streaming to path: " << path << endl;
+    cerr << "  Tmp path is: " << _tmpPath << endl;
+  }
+
+  try {
+    _file.open(_tmpPath, NcxxFile::replace, NcxxFile::nc4);
+  } catch (NcxxException& e) {
+    _addErrStr("ERROR - Cf2RadxFile::openStreamWrite");
+    _addErrStr("  Cannot open tmp Ncxx file for writing: ", _tmpPath);
+    _addErrStr("  exception: ", e.what());
+    delete _streamVol;
+    _streamVol = NULL;
+    return -1;
+  }
+  if (_writeProposedStdNameInNcf) {
+    _file.setUsedProposedStandardName(true);
+  }
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////////
+// Append the sweeps in a volume to the open stream,
+// one sweep group per sweep.
+// Returns 0 on success, -1 on failure
+
+int Cf2RadxFile::writeSweepsToStream(const RadxVol &vol)
+  
+{
+
+  clearErrStr();
+  if (_streamVol == NULL) {
+    _addErrStr("ERROR - Cf2RadxFile::writeSweepsToStream");
+    _addErrStr("  Stream not open, call openStreamWrite() first");
+    return -1;
+  }
+
+  // times in the sweep groups are relative to the start
+  // of the first sweep in the stream
+
+  if (_sweepGroupNames.size() == 0) {
+    _streamVol->setStartTime(vol.getStartTimeSecs(),
+                             vol.getStartNanoSecs());
+  }
+  _streamVol->setEndTime(vol.getEndTimeSecs(), vol.getEndNanoSecs());
+  _writeStartTimeSecs = _streamVol->getStartTimeSecs();
+
+  _writeVol = &vol;
+  _writeVol->computeMaxNGates();
+  _uniqueFieldNames = _writeVol->getUniqueFieldNameList();
+  _checkGeorefsActiveOnWrite();
+  _checkCorrectionsActiveOnWrite();
+  _writeVol->countGeorefsNotMissing(_geoCount);
+
+  const vector<RadxSweep *> &sweeps = _writeVol->getSweeps();
+  for (size_t isweep = 0; isweep < sweeps.size(); isweep++) {
+    try {
+      _addSweepGroup(sweeps[isweep], _sweepGroupNames.size());
+    } catch (NcxxException e) {
+      _addErrStr("ERROR - Cf2RadxFile::writeSweepsToStream");
+      _abortStreamWrite();
+      return -1;
+    }
+    _streamVol->addSweep(new RadxSweep(*sweeps[isweep]));
+  }
+
+  // flush to disk, so that the sweep data need not be held
+
+  try {
+    _file.sync();
+  } catch (NcxxException e) {
+    _addErrStr("ERROR - Cf2RadxFile::writeSweepsToStream");
+    _addErrStr("  Cannot sync file: ", _tmpPath);
+    _abortStreamWrite();
+    return -1;
+  }
+
+  if (_debug) {
+    cerr << "DEBUG - Cf2RadxFile::writeSweepsToStream" << endl;
+    cerr << "  n sweeps written so far: " << _sweepGroupNames.size() << endl;
+  }
+
+  _writeVol = NULL;
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////////
+// Complete the stream: add the root-level metadata, close
+// the file and rename the tmp file to the final path.
+// Returns 0 on success, -1 on failure
+
+int Cf2RadxFile::closeStreamWrite()
+  
+{
+
+  clearErrStr();
+  if (_streamVol == NULL) {
+    _addErrStr("ERROR - Cf2RadxFile::closeStreamWrite");
+    _addErrStr("  Stream not open");
+    return -1;
+  }
+
+  _writeVol = _streamVol;
+  _writeStartTimeSecs = _streamVol->getStartTimeSecs();
+  _streamVol->setPathInUse(_pathInUse);
+  _georefsActive = false;
+  _checkCorrectionsActiveOnWrite();
+
+  // add root group, and the index of the sweep groups
+
+  int iret = _addRootGroup();
+  if (iret == 0) {
+    try {
+      _addSweepGroupIndex();
+    } catch (NcxxException e) {
+      iret = _closeOnError("_addSweepGroupIndex");
+    }
+  }
+
+  if (iret) {
+    _writeVol = NULL;
+    delete _streamVol;
+    _streamVol = NULL;
+    return -1;
+  }
+
+  // close output file
+
+  _file.close();
+
+  // rename the tmp to final output file path
+  
+  if (rename(_tmpPath.c_str(), _pathInUse.c_str())) {
+    int errNum = errno;
+    _addErrStr("ERROR - Cf2RadxFile::closeStreamWrite");
+    _addErrStr("  Cannot rename tmp file: ", _tmpPath);
+    _addErrStr("  to: ", _pathInUse);
+    _addErrStr(strerror(errNum));
+    iret = -1;
+  } else {
+    if (_debug) {
+      cerr << "DEBUG - Cf2RadxFile::closeStreamWrite" << endl;
+      cerr << "  Renamed tmp path: " << _tmpPath << endl;
+      cerr << "     to final path: " << _pathInUse << endl;
+    }
+    _writePaths.push_back(_pathInUse);
+    _writeDataTimes.push_back(_streamVol->getStartTimeSecs());
+  }
+
+  _writeVol = NULL;
+  delete _streamVol;
+  _streamVol = NULL;
+
+  return iret;
+
+}
+
+//////////////////////////////////////////////////////////////
+// Abort a streaming write, removing the tmp file
+
+void Cf2RadxFile::_abortStreamWrite()
   
+{
+  if (_streamVol != NULL) {
+    _file.close();
+    unlink(_tmpPath.c_str());
+    delete _streamVol;
+    _streamVol = NULL;
+  }
+  _writeVol = NULL;
+}
+
+/////////////////////////////////////////////////
+// add root group attributes, dimensions and variables,
+// from the metadata in _writeVol
+// Returns 0 on success, -1 on failure
+
+int Cf2RadxFile::_addRootGroup()
+{
+
   try {
     _addGlobalAttributes();
   } catch (NcxxException e) {
@@ -447,38 +707,6 @@ int Cf2RadxFile::writeToPath(const RadxVol &vol,
     return _closeOnError("_addProjection");
   }
 
-  // add sweep groups
-
-  try {
-    _addSweeps();
-  } catch (NcxxException e) {
-    return _closeOnError("_addSweeps");
-  }
-
-  // close output file
-
-  _file.close();
-
-  // rename the tmp to final output file path
-  
-  if (rename(_tmpPath.c_str(), _pathInUse.c_str())) {
-    int errNum = errno;
-    _addErrStr("ERROR - Cf2RadxFile::writeToPath");
-    _addErrStr("  Cannot rename tmp file: ", _tmpPath);
-    _addErrStr("  to: ", _pathInUse);
-    _addErrStr(strerror(errNum));
-    return -1;
-  }
-
-  if (_debug) {
-    cerr << "DEBUG - Cf2RadxFile::writeToPath" << endl;
-    cerr << "  Renamed tmp path: " << _tmpPath << endl;
-    cerr << "     to final path: " << path << endl;
-  }
-
-  _writePaths.push_back(path);
-  _writeDataTimes.push_back(vol.getStartTimeSecs());
-  
   return 0;
 
 }
@@ -1372,114 +1600,137 @@ void Cf2RadxFile::_addSweeps()
   }
   
   _sweepGroupNames.clear();
+  _sweepGroupFixedAngles.clear();
   _sweepGroups.clear();
 
-  // loop through the sweeps
+  // loop through the sweeps, adding a group for each
   
   const vector<RadxSweep *> &sweeps = _writeVol->getSweeps();
-  int nSweeps = (int) sweeps.size();
+  for (size_t isweep = 0; isweep < sweeps.size(); isweep++) {
+    _addSweepGroup(sweeps[isweep], isweep);
+  }
 
-  for (int isweep = 0; isweep < nSweeps; isweep++) {
+  // add the sweep group index at root level
 
-    // create a volume with just this sweep
-    
-    RadxSweep *sweep = sweeps[isweep];
-    RadxVol sweepVol(*_writeVol, sweep->getSweepNumber());
+  _addSweepGroupIndex();
 
-    // convert fields from rays to 2-D arrays
-    sweepVol.loadFieldsFromRays(true);
-    
-    // create name
+}
+
+//////////////////////////////////////////////
+// add a sweep group for a sweep in _writeVol
+// throws exception on error
+
+void Cf2RadxFile::_addSweepGroup(const RadxSweep *sweep, size_t groupIndex)
+{
+
+  // create a volume with just this sweep
   
-    char name[128];
-    sprintf(name, "sweep_%.4d", isweep + 1);
-    _sweepGroupNames.push_back(name);
+  RadxVol sweepVol(*_writeVol, sweep->getSweepNumber());
 
-    if (_debug) {
-      cerr << "adding sweep: " << name << endl;
-    }
+  // convert fields from rays to 2-D arrays
+  sweepVol.loadFieldsFromRays(true);
+  
+  // create name
+
+  char name[128];
+  sprintf(name, "sweep_%.4d", (int) groupIndex + 1);
+  _sweepGroupNames.push_back(name);
+  _sweepGroupFixedAngles.push_back(sweep->getFixedAngleDeg());
+
+  if (_debug) {
+    cerr << "adding sweep: " << name << endl;
+  }
+
+  // add group
+
+  NcxxGroup sweepGroup;
+  try {
+    sweepGroup = _file.addGroup(name);
+    _sweepGroups.push_back(sweepGroup);
+  } catch (NcxxException& e) {
+    _addErrStr("ERROR - Cf2RadxFile::_addSweepGroup");
+    _addErrStr("  Cannot add sweep group: ", name);
+    _addErrStr("  Exception: ", e.what());
+    throw(NcxxException(getErrStr(), __FILE__, __LINE__));
+  }
 
-    // add group
+  // add dimensions
   
-    NcxxGroup sweepGroup;
-    try {
-      sweepGroup = _file.addGroup(name);
-      _sweepGroups.push_back(sweepGroup);
-    } catch (NcxxException& e) {
-      _addErrStr("ERROR - Cf2RadxFile::_addSweeps");
-      _addErrStr("  Cannot add sweep group: ", name);
-      _addErrStr("  Exception: ", e.what());
-      throw(NcxxException(getErrStr(), __FILE__, __LINE__));
-    }
+  size_t nRays = sweepVol.getNRays();
+  NcxxDim timeDim = sweepGroup.addDim(TIME, nRays);
+  
+  size_t nGates = sweepVol.getMaxNGates();
+  NcxxDim rangeDim = sweepGroup.addDim(RANGE, nGates);
+  
+  // add sweep group attributes
 
-    // add dimensions
-    
-    size_t nRays = sweepVol.getNRays();
-    NcxxDim timeDim = sweepGroup.addDim(TIME, nRays);
-    
-    size_t nGates = sweepVol.getMaxNGates();
-    NcxxDim rangeDim = sweepGroup.addDim(RANGE, nGates);
-    
-    // add sweep group attributes
+  try {
+    _addSweepAttributes(sweep, sweepGroup);
+  } catch (NcxxException& e) {
+    _addErrStr("ERROR - Cf2RadxFile::_addSweepGroup");
+    _addErrStr("  Adding sweep group attributes");
+    _addErrStr("  Exception: ", e.what());
+    throw(NcxxException(getErrStr(), __FILE__, __LINE__));
+  }
+  
+  // add sweep group variables
 
-    try {
-      _addSweepAttributes(sweeps[isweep], sweepGroup);
-    } catch (NcxxException& e) {
-      _addErrStr("ERROR - Cf2RadxFile::_addSweeps");
-      _addErrStr("  Adding sweep group attributes");
-      _addErrStr("  Exception: ", e.what());
-      throw(NcxxException(getErrStr(), __FILE__, __LINE__));
-    }
-    
-    // add sweep group variables
+  try {
+    _addSweepVariables(sweep, sweepVol, 
+                       sweepGroup, timeDim, rangeDim);
+  } catch (NcxxException& e) {
+    _addErrStr("ERROR - Cf2RadxFile::_addSweepGroup");
+    _addErrStr("  Adding sweep group variables");
+    _addErrStr("  Exception: ", e.what());
+    throw(NcxxException(getErrStr(), __FILE__, __LINE__));
+  }
 
-    try {
-      _addSweepVariables(sweeps[isweep], sweepVol, 
-                         sweepGroup, timeDim, rangeDim);
-    } catch (NcxxException& e) {
-      _addErrStr("ERROR - Cf2RadxFile::_addSweeps");
-      _addErrStr("  Adding sweep group variables");
-      _addErrStr("  Exception: ", e.what());
-      throw(NcxxException(getErrStr(), __FILE__, __LINE__));
-    }
+  // add monitoring
 
-    // add monitoring
+  try {
+    _addSweepMon(sweepVol, sweepGroup, timeDim);
+  } catch (NcxxException& e) {
+    _addErrStr("ERROR - Cf2RadxFile::_addSweepGroup");
+    _addErrStr("  Adding sweep group monitoring");
+    _addErrStr("  Exception: ", e.what());
+    throw(NcxxException(getErrStr(), __FILE__, __LINE__));
+  }
+
+  // add georefs as needed
 
+  if (_georefsActive) {
     try {
-      _addSweepMon(sweepVol, sweepGroup, timeDim);
+      _addSweepGeorefs(sweepVol, sweepGroup, timeDim);
     } catch (NcxxException& e) {
-      _addErrStr("ERROR - Cf2RadxFile::_addSweeps");
-      _addErrStr("  Adding sweep group monitoring");
+      _addErrStr("ERROR - Cf2RadxFile::_addSweepGroup");
+      _addErrStr("  Adding sweep group georefs");
       _addErrStr("  Exception: ", e.what());
       throw(NcxxException(getErrStr(), __FILE__, __LINE__));
     }
+  }
 
-    // add georefs as needed
+  // add sweep group fields
 
-    if (_georefsActive) {
-      try {
-        _addSweepGeorefs(sweepVol, sweepGroup, timeDim);
-      } catch (NcxxException& e) {
-        _addErrStr("ERROR - Cf2RadxFile::_addSweeps");
-        _addErrStr("  Adding sweep group georefs");
-        _addErrStr("  Exception: ", e.what());
-        throw(NcxxException(getErrStr(), __FILE__, __LINE__));
-      }
-    }
+  try {
+    _addSweepFields(sweep, sweepVol, 
+                    sweepGroup, timeDim, rangeDim);
+  } catch (NcxxException& e) {
+    _addErrStr("ERROR - Cf2RadxFile::_addSweepGroup");
+    _addErrStr("  Adding sweep group fields");
+    _addErrStr("  Exception: ", e.what());
+    throw(NcxxException(getErrStr(), __FILE__, __LINE__));
+  }
 
-    // add sweep group fields
+}
 
-    try {
-      _addSweepFields(sweeps[isweep], sweepVol, 
-                      sweepGroup, timeDim, rangeDim);
-    } catch (NcxxException& e) {
-      _addErrStr("ERROR - Cf2RadxFile::_addSweeps");
-      _addErrStr("  Adding sweep group fields");
-      _addErrStr("  Exception: ", e.what());
-      throw(NcxxException(getErrStr(), __FILE__, __LINE__));
-    }
+//////////////////////////////////////////////
+// add the sweep group names and fixed angles at root level
+// throws exception on error
+
+void Cf2RadxFile::_addSweepGroupIndex()
+{
 
-  } // isweep
+  int nSweeps = (int) _sweepGroupNames.size();
   
   // save sweep names at root level
   
@@ -1493,7 +1744,7 @@ void Cf2RadxFile::_addSweeps()
     var.putVal(sweepNames);
     delete[] sweepNames;
   } catch (NcxxException& e) {
-    _addErrStr("ERROR - Cf2RadxFile::_addSweeps");
+    _addErrStr("ERROR - Cf2RadxFile::_addSweepGroupIndex");
     _addErrStr("  Cannot add root group var: ", SWEEP_GROUP_NAME);
     _addErrStr("  Exception: ", e.what());
     throw(NcxxException(getErrStr(), __FILE__, __LINE__));
@@ -1507,11 +1758,11 @@ void Cf2RadxFile::_addSweeps()
     RadxArray<float> fvals_;
     float *fvals = fvals_.alloc(nSweeps);
     for (int isweep = 0; isweep < nSweeps; isweep++) {
-      fvals[isweep] = sweeps[isweep]->getFixedAngleDeg();
+      fvals[isweep] = _sweepGroupFixedAngles[isweep];
     }
     var.putVal(fvals);
   } catch (NcxxException& e) {
-    _addErrStr("ERROR - Cf2RadxFile::_addSweeps");
+    _addErrStr("ERROR - Cf2RadxFile::_addSweepGroupIndex");
     _addErrStr("  Cannot add root group var: ", SWEEP_FIXED_ANGLE);
     _addErrStr("  Exception: ", e.what());
     throw(NcxxException(getErrStr(), __FILE__, __LINE__));
@@ -1621,7 +1872,7 @@ void Cf2RadxFile::_addSweepVariables(const RadxSweep *sweep,
   timeVar.putAtt(CALENDAR, GREGORIAN);
   
   char timeUnitsStr[256];
-  RadxTime stime(_writeVol->getStartTimeSecs());
+  RadxTime stime(_writeStartTimeSecs);
   sprintf(timeUnitsStr, "seconds since %.4d-%.2d-%.2dT%.2d:%.2d:%.2dZ",
           stime.getYear(), stime.getMonth(), stime.getDay(),
           stime.getHour(), stime.getMin(), stime.getSec());
@@ -1963,7 +2214,7 @@ void Cf2RadxFile::_addSweepGeorefs(RadxVol &sweepVol,
     NcxxVar georefTimeVar = 
       georefGroup.addVar(GEOREF_TIME, "", GEOREF_TIME_LONG,
                          ncxxDouble, timeDim, SECONDS, true);
-    RadxTime volStartSecs(_writeVol->getStartTimeSecs());
+    RadxTime volStartSecs(_writeStartTimeSecs);
     for (size_t iray = 0; iray < rays.size(); iray++) {
       const RadxGeoref *geo = rays[iray]->getGeoreference();
       if (geo) {
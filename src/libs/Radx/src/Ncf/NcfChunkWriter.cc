@@ -0,0 +1,344 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+///////////////////////////////////////////////////////////////
+// NcfChunkWriter.cc
+///////////////////////////////////////////////////////////////
+//
+// Multi-threaded compression of field variables for NetCDF4
+// files. See NcfChunkWriter.hh.
+//
+///////////////////////////////////////////////////////////////
+
+#include <Radx/NcfChunkWriter.hh>
+#include <hdf5.h>
+#include <zlib.h>
+#include <pthread.h>
+#include <cstring>
+
+// direct chunk writes need HDF5 1.10.3 or later
+
+#if H5_VERSION_GE(1,10,3)
+#define NCF_DIRECT_CHUNK_WRITE
+#endif
+
+//////////////////////////////////////////////////
+// Constructor
+
+NcfChunkWriter::NcfChunkWriter()
+{
+  _compressionLevel = 5;
+}
+
+//////////////////////////////////////////////////
+// Destructor
+
+NcfChunkWriter::~NcfChunkWriter()
+{
+  clear();
+}
+
+//////////////////////////////////////////////////
+// is direct chunk writing supported?
+
+bool NcfChunkWriter::isSupported()
+{
+#ifdef NCF_DIRECT_CHUNK_WRITE
+  return true;
+#else
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////
+// compute chunk dimensions
+
+void NcfChunkWriter::computeChunkDims(size_t nRows, size_t nCols,
+                                      size_t elemSize,
+                                      size_t &chunkRows, size_t &chunkCols)
+{
+  const size_t targetBytes = 1048576;
+  if (nCols < 1) {
+    nCols = 1;
+  }
+  if (elemSize < 1) {
+    elemSize = 1;
+  }
+  chunkCols = nCols;
+  chunkRows = targetBytes / (nCols * elemSize);
+  if (chunkRows < 1) {
+    chunkRows = 1;
+  }
+  if (chunkRows > nRows) {
+    chunkRows = (nRows < 1 ? 1 : nRows);
+  }
+}
+
+//////////////////////////////////////////////////
+// free all data
+
+void NcfChunkWriter::clear()
+{
+  for (size_t ii = 0; ii < _vars.size(); ii++) {
+    delete _vars[ii];
+  }
+  _vars.clear();
+  _errStr.clear();
+}
+
+//////////////////////////////////////////////////
+// add a variable, splitting the data into chunks
+
+void NcfChunkWriter::addVar(const string &datasetPath,
+                            const void *data, size_t elemSize,
+                            size_t nRows, size_t nCols,
+                            size_t chunkRows, size_t chunkCols)
+{
+
+  Var *var = new Var;
+  var->datasetPath = datasetPath;
+  var->elemSize = elemSize;
+  var->rank = 2;
+  if (nCols == 0) {
+    // 1-D
+    var->rank = 1;
+    nCols = 1;
+    chunkCols = 1;
+  }
+  if (chunkRows < 1) {
+    chunkRows = 1;
+  }
+  if (chunkCols < 1) {
+    chunkCols = 1;
+  }
+
+  const unsigned char *src = (const unsigned char *) data;
+  size_t chunkBytes = chunkRows * chunkCols * elemSize;
+
+  for (size_t row0 = 0; row0 < nRows; row0 += chunkRows) {
+    for (size_t col0 = 0; col0 < nCols; col0 += chunkCols) {
+
+      Chunk chunk;
+      chunk.row0 = row0;
+      chunk.col0 = col0;
+      chunk.compressed = false;
+      var->chunks.push_back(chunk);
+      Chunk &ch = var->chunks.back();
+
+      // edge chunks are stored full size, padded with zeros
+      
+      ch.data.resize(chunkBytes, 0);
+      size_t nRowsCopy = chunkRows;
+      if (row0 + nRowsCopy > nRows) {
+        nRowsCopy = nRows - row0;
+      }
+      size_t nColsCopy = chunkCols;
+      if (col0 + nColsCopy > nCols) {
+        nColsCopy = nCols - col0;
+      }
+      for (size_t irow = 0; irow < nRowsCopy; irow++) {
+        memcpy(ch.data.data() + irow * chunkCols * elemSize,
+               src + ((row0 + irow) * nCols + col0) * elemSize,
+               nColsCopy * elemSize);
+      }
+
+    } // col0
+  } // row0
+
+  _vars.push_back(var);
+
+}
+
+//////////////////////////////////////////////////
+// compress all chunks
+
+void NcfChunkWriter::compress(int nThreads, int compressionLevel)
+{
+
+  _compressionLevel = compressionLevel;
+  if (_compressionLevel < 1) {
+    _compressionLevel = 1;
+  } else if (_compressionLevel > 9) {
+    _compressionLevel = 9;
+  }
+
+  size_t nChunksTotal = 0;
+  for (size_t ii = 0; ii < _vars.size(); ii++) {
+    nChunksTotal += _vars[ii]->chunks.size();
+  }
+
+  if (nThreads < 1) {
+    nThreads = 1;
+  }
+  if ((size_t) nThreads > nChunksTotal) {
+    nThreads = (int) nChunksTotal;
+  }
+
+  if (nThreads <= 1) {
+    _compressShare(0, 1);
+    return;
+  }
+
+  vector<Task> tasks(nThreads);
+  vector<pthread_t> threads(nThreads);
+  vector<bool> started(nThreads, false);
+  for (int ii = 0; ii < nThreads; ii++) {
+    tasks[ii].writer = this;
+    tasks[ii].threadNum = ii;
+    tasks[ii].nThreads = nThreads;
+  }
+  for (int ii = 1; ii < nThreads; ii++) {
+    if (pthread_create(&threads[ii], NULL,
+                       _compressThreadEntry, &tasks[ii]) == 0) {
+      started[ii] = true;
+    }
+  }
+  _compressShare(0, nThreads);
+  for (int ii = 1; ii < nThreads; ii++) {
+    if (started[ii]) {
+      pthread_join(threads[ii], NULL);
+    } else {
+      _compressShare(ii, nThreads);
+    }
+  }
+
+}
+
+//////////////////////////////////////////////////
+// thread entry point for compression
+
+void *NcfChunkWriter::_compressThreadEntry(void *args)
+{
+  Task *task = (Task *) args;
+  task->writer->_compressShare(task->threadNum, task->nThreads);
+  return NULL;
+}
+
+//////////////////////////////////////////////////
+// compress this thread's share of the chunks
+// chunks are numbered across all variables, and each thread
+// takes every nth chunk
+
+void NcfChunkWriter::_compressShare(int threadNum, int nThreads)
+{
+  size_t chunkNum = 0;
+  for (size_t ii = 0; ii < _vars.size(); ii++) {
+    Var &var = *_vars[ii];
+    for (size_t jj = 0; jj < var.chunks.size(); jj++, chunkNum++) {
+      if ((int) (chunkNum % nThreads) == threadNum) {
+        Chunk &chunk = var.chunks[jj];
+        chunk.compressed = _compressChunk(chunk);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+// compress a chunk in place, as for the HDF5 deflate filter
+// returns true on success - on failure the chunk is left
+// uncompressed
+
+bool NcfChunkWriter::_compressChunk(Chunk &chunk)
+{
+  uLongf destLen = compressBound(chunk.data.size());
+  vector<unsigned char> work(destLen);
+  if (compress2(work.data(), &destLen,
+                chunk.data.data(), chunk.data.size(),
+                _compressionLevel) != Z_OK) {
+    return false;
+  }
+  work.resize(destLen);
+  chunk.data.swap(work);
+  return true;
+}
+
+//////////////////////////////////////////////////
+// write the chunks to the file
+// returns 0 on success, -1 on failure
+
+int NcfChunkWriter::write(const string &path)
+{
+
+  _errStr.clear();
+
+#ifdef NCF_DIRECT_CHUNK_WRITE
+
+  hid_t fileId = -1;
+  H5E_BEGIN_TRY {
+    fileId = H5Fopen(path.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+  } H5E_END_TRY;
+  if (fileId < 0) {
+    _errStr = "Cannot open file for direct chunk write: " + path;
+    return -1;
+  }
+
+  int iret = 0;
+
+  H5E_BEGIN_TRY {
+
+    for (size_t ii = 0; ii < _vars.size() && iret == 0; ii++) {
+
+      Var &var = *_vars[ii];
+      hid_t dsetId = H5Dopen2(fileId, var.datasetPath.c_str(), H5P_DEFAULT);
+      if (dsetId < 0) {
+        _errStr = "Cannot open dataset: " + var.datasetPath;
+        iret = -1;
+        break;
+      }
+
+      for (size_t jj = 0; jj < var.chunks.size(); jj++) {
+        Chunk &chunk = var.chunks[jj];
+        hsize_t offset[2];
+        offset[0] = chunk.row0;
+        offset[1] = chunk.col0;
+        // a set bit in the filter mask means deflate was skipped
+        uint32_t filterMask = (chunk.compressed ? 0 : 1);
+        if (H5Dwrite_chunk(dsetId, H5P_DEFAULT, filterMask, offset,
+                           chunk.data.size(), chunk.data.data()) < 0) {
+          _errStr = "Cannot write chunk for dataset: " + var.datasetPath;
+          iret = -1;
+          break;
+        }
+        vector<unsigned char>().swap(chunk.data);
+      } // jj
+
+      H5Dclose(dsetId);
+
+    } // ii
+
+    if (H5Fclose(fileId) < 0 && iret == 0) {
+      _errStr = "Cannot close file after direct chunk write: " + path;
+      iret = -1;
+    }
+
+  } H5E_END_TRY;
+
+  return iret;
+
+#else
+
+  _errStr = "Direct chunk write not supported by HDF5 library";
+  return -1;
+
+#endif
+
+}
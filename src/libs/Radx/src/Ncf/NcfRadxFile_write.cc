@@ -480,6 +480,13 @@ int NcfRadxFile::writeToPath(const RadxVol &vol,
 
   _file.close();
 
+  // if fields were compressed in parallel, write the chunks
+
+  if (_writeCompressedChunks()) {
+    unlink(_tmpPath.c_str());
+    return -1;
+  }
+
   // rename the tmp to final output file path
   
   if (rename(_tmpPath.c_str(), _pathInUse.c_str())) {
@@ -3352,6 +3359,12 @@ int NcfRadxFile::_writeFieldVariables()
     cerr << "NcfRadxFile::_writeFieldVariables()" << endl;
   }
 
+  // if multi-threaded, the field data is compressed in parallel
+  // and written after the NetCDF file is closed
+
+  _chunkWriter.clear();
+  bool inParallel = _compressFieldsInParallel();
+  
   // loop through the list of unique fields names in this volume
 
   int iret = 0;
@@ -3375,7 +3388,11 @@ int NcfRadxFile::_writeFieldVariables()
     // create variable
     Nc3Var *var = _createFieldVar(*copy);
     if (var != NULL) {
-      if (_writeFieldVar(var, copy)) {
+      if (inParallel) {
+        if (_addFieldToChunkWriter(var, copy)) {
+          iret = -1;
+        }
+      } else if (_writeFieldVar(var, copy)) {
         iret = -1;
       }
     } else {
@@ -3394,11 +3411,18 @@ int NcfRadxFile::_writeFieldVariables()
 
   if (iret) {
     _addErrStr("ERROR - NcfRadxFile::_writeFieldVariables");
+    _chunkWriter.clear();
     return -1;
-  } else {
-    return 0;
   }
 
+  // compress the fields
+
+  if (inParallel) {
+    _chunkWriter.compress(_writeNThreads, _compressionLevel);
+  }
+
+  return 0;
+
 }
 
 ///////////////////////////////////////////////
@@ -3658,6 +3682,118 @@ int NcfRadxFile::_writeFieldVar(Nc3Var *var, RadxField *field)
 
 }
 
+///////////////////////////////////////////////////////////////////////////
+// Should the fields be compressed in parallel?
+// Requires NetCDF4, compression, multiple threads and
+// direct chunk write support in HDF5.
+
+bool NcfRadxFile::_compressFieldsInParallel()
+  
+{
+  
+  if (_writeNThreads < 2 || !_writeCompressed) {
+    return false;
+  }
+  if (_ncFormat != NETCDF4 && _ncFormat != NETCDF4_CLASSIC) {
+    return false;
+  }
+  return NcfChunkWriter::isSupported();
+
+}
+
+///////////////////////////////////////////////////////////////////////////
+// Set the chunking for a field variable, and add the data to
+// the chunk writer for parallel compression.
+// Returns 0 on success, -1 on failure
+
+int NcfRadxFile::_addFieldToChunkWriter(Nc3Var *var, RadxField *field)
+  
+{
+  
+  if (_verbose) {
+    cerr << "NcfRadxFile::_addFieldToChunkWriter()" << endl;
+    cerr << "  name: " << var->name() << endl;
+  }
+
+  // if deflate could not be set for the variable, write it
+  // through NetCDF in the normal way
+  
+  int fileId = _file.getNc3File()->id();
+  int varId = var->id();
+  int shuffle = 0, deflate = 0, deflateLevel = 0;
+  if (nc_inq_var_deflate(fileId, varId,
+                         &shuffle, &deflate, &deflateLevel) != NC_NOERR ||
+      !deflate || shuffle) {
+    return _writeFieldVar(var, field);
+  }
+
+  size_t elemSize = field->getByteWidth();
+  size_t nRows = 0, nCols = 0;
+  if (_nGatesVary) {
+    nRows = _writeVol->getNPoints();
+    nCols = 0;
+  } else {
+    _writeVol->computeMaxNGates();
+    nRows = _writeVol->getNRays();
+    nCols = _writeVol->getMaxNGates();
+  }
+
+  // set the chunking explicitly, so that the chunks
+  // we compress match those in the file
+
+  size_t chunkRows = 0, chunkCols = 0;
+  NcfChunkWriter::computeChunkDims(nRows, (nCols == 0 ? 1 : nCols),
+                                   elemSize, chunkRows, chunkCols);
+  size_t chunkSizes[2];
+  chunkSizes[0] = chunkRows;
+  chunkSizes[1] = chunkCols;
+  if (nc_def_var_chunking(fileId, varId, NC_CHUNKED, chunkSizes) != NC_NOERR) {
+    _addErrStr("ERROR - NcfRadxFile::_addFieldToChunkWriter");
+    _addErrStr("  Cannot set chunking for var, name: ", var->name());
+    return -1;
+  }
+
+  string datasetPath("/");
+  datasetPath += var->name();
+  _chunkWriter.addVar(datasetPath, field->getData(), elemSize,
+                      nRows, nCols, chunkRows, chunkCols);
+
+  return 0;
+
+}
+
+///////////////////////////////////////////////////////////////////////////
+// Write the compressed chunks for the fields, after the NetCDF file
+// has been closed. Does nothing if the fields were written through
+// NetCDF.
+// Returns 0 on success, -1 on failure
+
+int NcfRadxFile::_writeCompressedChunks()
+  
+{
+  
+  if (_chunkWriter.getNVars() == 0) {
+    return 0;
+  }
+
+  if (_debug) {
+    cerr << "DEBUG - NcfRadxFile::_writeCompressedChunks" << endl;
+    cerr << "  Writing n fields: " << _chunkWriter.getNVars() << endl;
+    cerr << "  Compressed with n threads: " << _writeNThreads << endl;
+  }
+
+  int iret = _chunkWriter.write(_tmpPath);
+  if (iret) {
+    _addErrStr("ERROR - NcfRadxFile::_writeCompressedChunks");
+    _addErrStr("  Tmp path: ", _tmpPath);
+    _addErrStr("  ", _chunkWriter.getErrStr());
+  }
+  _chunkWriter.clear();
+
+  return iret;
+
+}
+
 //////////////////
 // close on error
 
@@ -3666,6 +3802,7 @@ int NcfRadxFile::_closeOnError(const string &caller)
   _addErrStr("ERROR - NcfRadxFile::" + caller);
   _addErrStr(_file.getErrStr());
   _file.close();
+  _chunkWriter.clear();
   unlink(_tmpPath.c_str());
   return -1;
 }
@@ -0,0 +1,318 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+///////////////////////////////////////////////////////////////
+// time_test_cfradial_write.cc
+///////////////////////////////////////////////////////////////
+//
+// Benchmark for writing CfRadial files.
+//
+// Builds a synthetic dual-pol volume, and times:
+//
+//   (a) CfRadial write, single-threaded;
+//   (b) CfRadial write, with the fields compressed on nThreads;
+//   (c) CfRadial2 write of the whole volume;
+//   (d) CfRadial2 streaming write, one sweep at a time.
+//
+// The files from (a) and (b) are read back and the field data
+// compared, as are the files from (c) and (d).
+//
+// Usage: time_test_cfradial_write [outDir nSweeps nRays nGates nThreads]
+//
+///////////////////////////////////////////////////////////////
+
+#include <Radx/NcfRadxFile.hh>
+#include <Radx/Cf2RadxFile.hh>
+#include <Radx/RadxVol.hh>
+#include <Radx/RadxRay.hh>
+#include <Radx/RadxField.hh>
+#include <Radx/RadxSweep.hh>
+#include <sys/time.h>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+using namespace std;
+
+static double _now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1.0e6;
+}
+
+// dual-pol moments, with plausible ranges
+
+typedef struct {
+  const char *name;
+  const char *units;
+  double minVal;
+  double maxVal;
+} moment_t;
+
+static const moment_t _moments[] = {
+  { "DBZ", "dBZ", -30.0, 70.0 },
+  { "VEL", "m/s", -30.0, 30.0 },
+  { "WIDTH", "m/s", 0.0, 10.0 },
+  { "ZDR", "dB", -4.0, 8.0 },
+  { "PHIDP", "deg", -180.0, 180.0 },
+  { "RHOHV", "", 0.0, 1.05 },
+  { "KDP", "deg/km", -2.0, 10.0 },
+  { "SNR", "dB", -10.0, 80.0 },
+  { "NCP", "", 0.0, 1.0 },
+  { "LDR", "dB", -40.0, 0.0 }
+};
+static const int _nMoments = sizeof(_moments) / sizeof(moment_t);
+
+// fill with smoothly varying data, noisy, with some missing gates
+
+static void _fillData(Radx::fl32 *data, size_t nGates,
+                      int iray, int imoment)
+{
+  const moment_t &mom = _moments[imoment];
+  double range = mom.maxVal - mom.minVal;
+  for (size_t ii = 0; ii < nGates; ii++) {
+    int hash = (int) ((ii * 7919 + iray * 104729 + imoment * 13) % 1000);
+    if (hash < 250 || ii > nGates - nGates / 8) {
+      data[ii] = Radx::missingFl32;
+    } else {
+      double frac = 0.5 + 0.4 * sin(ii / 50.0 + iray / 20.0 + imoment);
+      data[ii] = mom.minVal + range * (frac + (hash % 10) * 0.002);
+    }
+  }
+}
+
+// create a volume
+
+static void _createVol(RadxVol &vol, int nSweeps, int nRays, int nGates)
+{
+  vol.clear();
+  vol.setInstrumentName("TEST");
+  vol.setLatitudeDeg(40.0);
+  vol.setLongitudeDeg(-105.0);
+  vol.setAltitudeKm(1.6);
+  time_t startTime = 1500000000;
+  Radx::fl32 *data = new Radx::fl32[nGates];
+  for (int isweep = 0; isweep < nSweeps; isweep++) {
+    double elev = 0.5 + isweep * 1.2;
+    for (int iray = 0; iray < nRays; iray++) {
+      RadxRay *ray = new RadxRay;
+      ray->setTime(startTime + (isweep * nRays + iray) / 20.0);
+      ray->setRangeGeom(0.075, 0.150);
+      ray->setAzimuthDeg(iray * 360.0 / nRays);
+      ray->setElevationDeg(elev);
+      ray->setFixedAngleDeg(elev);
+      ray->setSweepNumber(isweep);
+      ray->setSweepMode(Radx::SWEEP_MODE_AZIMUTH_SURVEILLANCE);
+      for (int imom = 0; imom < _nMoments; imom++) {
+        _fillData(data, nGates, isweep * nRays + iray, imom);
+        ray->addField(_moments[imom].name, _moments[imom].units,
+                      nGates, Radx::missingFl32, data, true);
+      }
+      vol.addRay(ray);
+    }
+  }
+  delete[] data;
+  vol.loadVolumeInfoFromRays();
+  vol.loadSweepInfoFromRays();
+  vol.convertToSi16();
+}
+
+// read a file, returning the volume with fields loaded
+
+static int _readVol(RadxFile &file, const string &path, RadxVol &vol)
+{
+  if (file.readFromPath(path, vol)) {
+    cerr << "ERROR - cannot read file: " << path << endl;
+    cerr << file.getErrStr() << endl;
+    return -1;
+  }
+  vol.loadFieldsFromRays();
+  return 0;
+}
+
+// compare the packed data in two volumes
+
+static bool _sameData(const RadxVol &vol1, const RadxVol &vol2)
+{
+  const vector<RadxField *> &fields1 = vol1.getFields();
+  const vector<RadxField *> &fields2 = vol2.getFields();
+  if (fields1.size() != fields2.size()) {
+    return false;
+  }
+  for (size_t ii = 0; ii < fields1.size(); ii++) {
+    const RadxField *fld1 = fields1[ii];
+    const RadxField *fld2 = vol2.getField(fld1->getName());
+    if (fld2 == NULL ||
+        fld1->getDataType() != fld2->getDataType() ||
+        fld1->getNPoints() != fld2->getNPoints()) {
+      return false;
+    }
+    size_t nBytes = fld1->getNPoints() * fld1->getByteWidth();
+    if (memcmp(fld1->getData(), fld2->getData(), nBytes) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// time a CfRadial write
+
+static double _timeNcfWrite(const RadxVol &vol, const string &path,
+                            int nThreads)
+{
+  NcfRadxFile file;
+  file.setWriteNThreads(nThreads);
+  double start = _now();
+  if (file.writeToPath(vol, path)) {
+    cerr << "ERROR - cannot write file: " << path << endl;
+    cerr << file.getErrStr() << endl;
+    exit(1);
+  }
+  return _now() - start;
+}
+
+int main(int argc, char **argv)
+{
+
+  string outDir = "/tmp";
+  int nSweeps = 10;
+  int nRays = 720;
+  int nGates = 1000;
+  int nThreads = 4;
+  if (argc > 1) outDir = argv[1];
+  if (argc > 2) nSweeps = atoi(argv[2]);
+  if (argc > 3) nRays = atoi(argv[3]);
+  if (argc > 4) nGates = atoi(argv[4]);
+  if (argc > 5) nThreads = atoi(argv[5]);
+
+  cerr << "nSweeps, nRays, nGates, nFields, nThreads: "
+       << nSweeps << ", " << nRays << ", " << nGates << ", "
+       << _nMoments << ", " << nThreads << endl;
+
+  RadxVol vol;
+  _createVol(vol, nSweeps, nRays, nGates);
+
+  string serialPath = outDir + "/time_test_cfradial_serial.nc";
+  string threadedPath = outDir + "/time_test_cfradial_threaded.nc";
+  string cf2Path = outDir + "/time_test_cfradial2.nc";
+  string streamPath = outDir + "/time_test_cfradial2_stream.nc";
+
+  // CfRadial, serial and threaded compression
+
+  double serialSecs = _timeNcfWrite(vol, serialPath, 1);
+  double threadedSecs = _timeNcfWrite(vol, threadedPath, nThreads);
+
+  // CfRadial2, whole volume
+
+  double cf2Secs = 0.0;
+  {
+    Cf2RadxFile file;
+    double start = _now();
+    if (file.writeToPath(vol, cf2Path)) {
+      cerr << "ERROR - cannot write file: " << cf2Path << endl;
+      cerr << file.getErrStr() << endl;
+      return 1;
+    }
+    cf2Secs = _now() - start;
+  }
+
+  // CfRadial2, streaming one sweep at a time
+  // the sweep volumes are created outside the timed region
+
+  double streamSecs = 0.0;
+  {
+    Cf2RadxFile file;
+    RadxVol meta;
+    meta.copyMeta(vol);
+    double start = _now();
+    if (file.openStreamWrite(meta, streamPath)) {
+      cerr << "ERROR - cannot open stream: " << streamPath << endl;
+      cerr << file.getErrStr() << endl;
+      return 1;
+    }
+    streamSecs += _now() - start;
+    const vector<RadxSweep *> &sweeps = vol.getSweeps();
+    for (size_t isweep = 0; isweep < sweeps.size(); isweep++) {
+      RadxVol sweepVol(vol, sweeps[isweep]->getSweepNumber());
+      start = _now();
+      if (file.writeSweepsToStream(sweepVol)) {
+        cerr << "ERROR - cannot write sweep to stream" << endl;
+        cerr << file.getErrStr() << endl;
+        return 1;
+      }
+      streamSecs += _now() - start;
+    }
+    start = _now();
+    if (file.closeStreamWrite()) {
+      cerr << "ERROR - cannot close stream" << endl;
+      cerr << file.getErrStr() << endl;
+      return 1;
+    }
+    streamSecs += _now() - start;
+  }
+
+  double mgates = (double) nSweeps * nRays * nGates * _nMoments / 1.0e6;
+  fprintf(stderr, "  CfRadial,  1 thread:  %8.3f secs, %8.1f Mgates/s\n",
+          serialSecs, mgates / serialSecs);
+  fprintf(stderr, "  CfRadial, %2d threads: %8.3f secs, %8.1f Mgates/s\n",
+          nThreads, threadedSecs, mgates / threadedSecs);
+  fprintf(stderr, "  CfRadial2, volume:    %8.3f secs, %8.1f Mgates/s\n",
+          cf2Secs, mgates / cf2Secs);
+  fprintf(stderr, "  CfRadial2, streamed:  %8.3f secs, %8.1f Mgates/s\n",
+          streamSecs, mgates / streamSecs);
+
+  // read back and compare
+
+  int iret = 0;
+  {
+    NcfRadxFile file1, file2;
+    RadxVol vol1, vol2;
+    if (_readVol(file1, serialPath, vol1) ||
+        _readVol(file2, threadedPath, vol2)) {
+      return 1;
+    }
+    if (!_sameData(vol1, vol2)) {
+      cerr << "ERROR - CfRadial data differs, serial vs threaded" << endl;
+      iret = 1;
+    }
+  }
+  {
+    Cf2RadxFile file1, file2;
+    RadxVol vol1, vol2;
+    if (_readVol(file1, cf2Path, vol1) ||
+        _readVol(file2, streamPath, vol2)) {
+      return 1;
+    }
+    if (!_sameData(vol1, vol2)) {
+      cerr << "ERROR - CfRadial2 data differs, volume vs streamed" << endl;
+      iret = 1;
+    }
+  }
+  if (iret == 0) {
+    cerr << "  results identical" << endl;
+  }
+
+  return iret;
+
+}
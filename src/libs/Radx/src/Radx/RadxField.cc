@@ -34,6 +34,7 @@
 ///////////////////////////////////////////////////////////////
 
 #include <Radx/RadxField.hh>
+#include <Radx/RadxFieldKernels.hh>
 #include <Radx/RadxArray.hh>
 #include <Radx/RadxXml.hh>
 #include <Radx/ByteOrder.hh>
@@ -1470,13 +1471,8 @@ void RadxField::convertToFl32()
     case Radx::FL64: {
       Radx::fl64 *ddata = (Radx::fl64 *) _data;
       Radx::fl32 *fdata = new Radx::fl32[_nPoints];
-      for (size_t ii = 0; ii < _nPoints; ii++) {
-        if (ddata[ii] == _missingFl64) {
-          fdata[ii] = Radx::missingFl32;
-        } else {
-          fdata[ii] = ddata[ii];
-        }
-      }
+      RadxFieldKernels::fl64ToFl32(ddata, fdata, _nPoints,
+                                   _missingFl64, Radx::missingFl32);
       _buf.clear();
       _data = _buf.add(fdata, _nPoints * sizeof(Radx::fl32));
       delete[] fdata;
@@ -1485,13 +1481,9 @@ void RadxField::convertToFl32()
     case Radx::SI32: {
       Radx::si32 *idata = (Radx::si32 *) _data;
       Radx::fl32 *fdata = new Radx::fl32[_nPoints];
-      for (size_t ii = 0; ii < _nPoints; ii++) {
-        if (idata[ii] == _missingSi32) {
-          fdata[ii] = Radx::missingFl32;
-        } else {
-          fdata[ii] = idata[ii] * _scale + _offset;
-        }
-      }
+      RadxFieldKernels::si32ToFl32(idata, fdata, _nPoints,
+                                   _missingSi32, Radx::missingFl32,
+                                   _scale, _offset);
       _buf.clear();
       _data = _buf.add(fdata, _nPoints * sizeof(Radx::fl32));
       delete[] fdata;
@@ -1500,13 +1492,9 @@ void RadxField::convertToFl32()
     case Radx::SI16: {
       Radx::si16 *sdata = (Radx::si16 *) _data;
       Radx::fl32 *fdata = new Radx::fl32[_nPoints];
-      for (size_t ii = 0; ii < _nPoints; ii++) {
-        if (sdata[ii] == _missingSi16) {
-          fdata[ii] = Radx::missingFl32;
-        } else {
-          fdata[ii] = sdata[ii] * _scale + _offset;
-        }
-      }
+      RadxFieldKernels::si16ToFl32(sdata, fdata, _nPoints,
+                                   _missingSi16, Radx::missingFl32,
+                                   _scale, _offset);
       _buf.clear();
       _data = _buf.add(fdata, _nPoints * sizeof(Radx::fl32));
       delete[] fdata;
@@ -1515,13 +1503,9 @@ void RadxField::convertToFl32()
     case Radx::SI08: {
       Radx::si08 *bdata = (Radx::si08 *) _data;
       Radx::fl32 *fdata = new Radx::fl32[_nPoints];
-      for (size_t ii = 0; ii < _nPoints; ii++) {
-        if (bdata[ii] == _missingSi08) {
-          fdata[ii] = Radx::missingFl32;
-        } else {
-          fdata[ii] = bdata[ii] * _scale + _offset;
-        }
-      }
+      RadxFieldKernels::si08ToFl32(bdata, fdata, _nPoints,
+                                   _missingSi08, Radx::missingFl32,
+                                   _scale, _offset);
       _buf.clear();
       _data = _buf.add(fdata, _nPoints * sizeof(Radx::fl32));
       delete[] fdata;
@@ -1558,19 +1542,9 @@ void RadxField::convertToSi32(double scale,
   
   Radx::fl32 *fdata = (Radx::fl32 *) _data;
   Radx::si32 *idata = new Radx::si32[_nPoints];
-  for (size_t ii = 0; ii < _nPoints; ii++) {
-    if (fdata[ii] == _missingFl32) {
-      idata[ii] = Radx::missingSi32;
-    } else {
-      long long int ival =
-        (long long int) floor((fdata[ii] - offset) / scale + 0.5);
-      if (ival < -2147483647 || ival > 2147483647) {
-        idata[ii] = Radx::missingSi32;
-      } else {
-        idata[ii] = (Radx::si32) ival;
-      }
-    }
-  }
+  RadxFieldKernels::fl32ToSi32(fdata, idata, _nPoints,
+                               _missingFl32, Radx::missingSi32,
+                               scale, offset);
   _buf.clear();
   _data = _buf.add(idata, _nPoints * sizeof(Radx::si32));
   delete[] idata;
@@ -1601,18 +1575,9 @@ void RadxField::convertToSi16(double scale,
 
   Radx::fl32 *fdata = (Radx::fl32 *) _data;
   Radx::si16 *sdata = new Radx::si16[_nPoints];
-  for (size_t ii = 0; ii < _nPoints; ii++) {
-    if (fdata[ii] == _missingFl32) {
-      sdata[ii] = Radx::missingSi16;
-    } else {
-      int idata = (int) floor((fdata[ii] - offset) / scale + 0.5);
-      if (idata < -32767 || idata > 32767) {
-        sdata[ii] = Radx::missingSi16;
-      } else {
-        sdata[ii] = (Radx::si16) idata;
-      }
-    }
-  }
+  RadxFieldKernels::fl32ToSi16(fdata, sdata, _nPoints,
+                               _missingFl32, Radx::missingSi16,
+                               scale, offset);
   _buf.clear();
   _data = _buf.add(sdata, _nPoints * sizeof(Radx::si16));
   delete[] sdata;
@@ -1642,18 +1607,9 @@ void RadxField::convertToSi08(double scale,
   
   Radx::fl32 *fdata = (Radx::fl32 *) _data;
   Radx::si08 *bdata = new Radx::si08[_nPoints];
-  for (size_t ii = 0; ii < _nPoints; ii++) {
-    if (fdata[ii] == _missingFl32) {
-      bdata[ii] = Radx::missingSi08;
-    } else {
-      int ival = (int) floor((fdata[ii] - offset) / scale + 0.5);
-      if (ival < -127 || ival > 127) {
-        bdata[ii] = Radx::missingSi08;
-      } else {
-        bdata[ii] = (Radx::si08) ival;
-      }
-    }
-  }
+  RadxFieldKernels::fl32ToSi08(fdata, bdata, _nPoints,
+                               _missingFl32, Radx::missingSi08,
+                               scale, offset);
   _buf.clear();
   _data = _buf.add(bdata, _nPoints * sizeof(Radx::si08));
   delete[] bdata;
@@ -2060,52 +2016,52 @@ int RadxField::computeMinAndMax() const
   _minVal = 1.0e99;
   _maxVal = -1.0e99;
   
-  // use floats as they are
-  
-  if (_dataType == Radx::FL64) {
+  switch (_dataType) {
 
-    const Radx::fl64 *data = (Radx::fl64*) _data;
-    for (size_t ii = 0; ii < _nPoints; ii++, data++) {
-      Radx::fl64 val = *data;
-      if (val != _missingFl64) {
-        if (val < _minVal) {
-          _minVal = val;
-        }
-        if (val > _maxVal) {
-          _maxVal = val;
-        }
-      }
+    case Radx::FL64: {
+      // use floats as they are
+      RadxFieldKernels::minMaxFl64((const Radx::fl64 *) _data, _nPoints,
+                                   _missingFl64, _minVal, _maxVal);
+      break;
     }
 
-  } else if (_dataType == Radx::FL32) {
+    case Radx::FL32: {
+      // use floats as they are
+      RadxFieldKernels::minMaxFl32((const Radx::fl32 *) _data, _nPoints,
+                                   _missingFl32, _minVal, _maxVal);
+      break;
+    }
 
-    const Radx::fl32 *data = (Radx::fl32*) _data;
-    for (size_t ii = 0; ii < _nPoints; ii++, data++) {
-      Radx::fl32 val = *data;
-      if (val != _missingFl32) {
-        if (val < _minVal) {
-          _minVal = val;
-        }
-        if (val > _maxVal) {
-          _maxVal = val;
-        }
+    case Radx::SI32: {
+      // find the packed limits, then apply scale and offset
+      Radx::si32 minInt, maxInt;
+      if (RadxFieldKernels::minMaxSi32((const Radx::si32 *) _data, _nPoints,
+                                       _missingSi32, minInt, maxInt) > 0) {
+        _setMinMaxFromPacked(minInt, maxInt);
       }
+      break;
     }
 
-  } else {
+    case Radx::SI16: {
+      Radx::si16 minInt, maxInt;
+      if (RadxFieldKernels::minMaxSi16((const Radx::si16 *) _data, _nPoints,
+                                       _missingSi16, minInt, maxInt) > 0) {
+        _setMinMaxFromPacked(minInt, maxInt);
+      }
+      break;
+    }
 
-    for (size_t ii = 0; ii < _nPoints; ii++) {
-      double val = getDoubleValue(ii);
-      if (val != _missingFl64) {
-        if (val < _minVal) {
-          _minVal = val;
-        }
-        if (val > _maxVal) {
-          _maxVal = val;
-        }
+    case Radx::SI08: {
+      Radx::si08 minInt, maxInt;
+      if (RadxFieldKernels::minMaxSi08((const Radx::si08 *) _data, _nPoints,
+                                       _missingSi08, minInt, maxInt) > 0) {
+        _setMinMaxFromPacked(minInt, maxInt);
       }
+      break;
     }
 
+    default: {}
+
   }
 
   // all missing?
@@ -2141,6 +2097,19 @@ int RadxField::computeMinAndMax() const
 
 }
 
+/////////////////////////////////////////////////////////
+// set min and max from packed integer limits
+// the scale may be negative, in which case the limits swap
+
+void RadxField::_setMinMaxFromPacked(double minInt, double maxInt) const
+  
+{
+  double val0 = minInt * _scale + _offset;
+  double val1 = maxInt * _scale + _offset;
+  _minVal = (val0 < val1 ? val0 : val1);
+  _maxVal = (val0 < val1 ? val1 : val0);
+}
+
 /////////////////////////////////////////////////////////////
 /// Apply a linear transformation to the data values.
 /// Transforms x to y as follows:
@@ -2161,14 +2130,8 @@ void RadxField::applyLinearTransform(double scale, double offset)
 
   // apply transformation
   
-  Radx::fl32 *data = (Radx::fl32*) _data;
-  for (size_t ii = 0; ii < _nPoints; ii++, data++) {
-    Radx::fl32 val = *data;
-    if (val != _missingFl32) {
-      Radx::fl32 newVal = val * scale + offset;
-      *data = newVal;
-    }
-  } // ii
+  RadxFieldKernels::linearTransformFl32((Radx::fl32 *) _data, _nPoints,
+                                        _missingFl32, scale, offset);
 
   // convert back to original type
 
@@ -2185,13 +2148,8 @@ void RadxField::transformDbToLinear()
 {
 
   convertToFl32();
-  Radx::fl32 *fdat = (Radx::fl32 *) _data;
-  for (size_t ii = 0; ii < _nPoints; ii++) {
-    Radx::fl32 val = fdat[ii];
-    if (val != Radx::missingFl32) {
-      fdat[ii] = pow(10.0, val / 10.0);
-    }
-  }
+  RadxFieldKernels::dbToLinearFl32((Radx::fl32 *) _data, _nPoints,
+                                   Radx::missingFl32);
 
 }
 
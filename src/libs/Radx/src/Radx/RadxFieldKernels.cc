@@ -0,0 +1,537 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+///////////////////////////////////////////////////////////////
+// RadxFieldKernels.cc
+///////////////////////////////////////////////////////////////
+//
+// Inner-loop kernels for converting and scanning field data.
+// See RadxFieldKernels.hh.
+//
+///////////////////////////////////////////////////////////////
+
+#include <Radx/RadxFieldKernels.hh>
+#include <cmath>
+#include <limits>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define RADX_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+bool RadxFieldKernels::_useSimd = true;
+bool RadxFieldKernels::_hasAvx2 = RadxFieldKernels::_checkAvx2();
+
+/////////////////////////////////////////////////////////
+// check if the CPU supports AVX2
+
+bool RadxFieldKernels::_checkAvx2()
+{
+#ifdef RADX_KERNELS_X86
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+#ifdef RADX_KERNELS_X86
+
+/////////////////////////////////////////////////////////
+// AVX2 implementations.
+//
+// Each function processes the data in blocks of 8 gates and
+// returns the number of gates processed. The caller handles
+// the remaining gates with the scalar code.
+
+namespace {
+
+#define RADX_AVX2 __attribute__((target("avx2")))
+
+// scale 8 int32 values into 8 fl32 values: val * scale + offset
+// computed in double precision
+
+RADX_AVX2 inline __m256 _scaleToFl32(__m256i ival,
+                                     __m256d vscale, __m256d voffset)
+{
+  __m256d lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(ival));
+  __m256d hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(ival, 1));
+  lo = _mm256_add_pd(_mm256_mul_pd(lo, vscale), voffset);
+  hi = _mm256_add_pd(_mm256_mul_pd(hi, vscale), voffset);
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)),
+                              _mm256_cvtpd_ps(hi), 1);
+}
+
+// pack 4 fl32 values into 4 int32 values:
+//   floor((val - offset) / scale + 0.5)
+// missing or out-of-range values are set to outMiss
+
+RADX_AVX2 inline __m128i _packFromFl32(__m128 fval,
+                                       __m256d vinMiss, __m256d voutMiss,
+                                       __m256d vscale, __m256d voffset,
+                                       __m256d vminInt, __m256d vmaxInt)
+{
+  __m256d dval = _mm256_cvtps_pd(fval);
+  __m256d isMiss = _mm256_cmp_pd(dval, vinMiss, _CMP_EQ_OQ);
+  __m256d packed =
+    _mm256_floor_pd(_mm256_add_pd(_mm256_div_pd(_mm256_sub_pd(dval, voffset),
+                                                vscale),
+                                  _mm256_set1_pd(0.5)));
+  // comparisons are ordered, so NaNs are out of range
+  __m256d inRange = _mm256_and_pd(_mm256_cmp_pd(packed, vminInt, _CMP_GE_OQ),
+                                  _mm256_cmp_pd(packed, vmaxInt, _CMP_LE_OQ));
+  __m256d valid = _mm256_andnot_pd(isMiss, inRange);
+  packed = _mm256_blendv_pd(voutMiss, packed, valid);
+  return _mm256_cvttpd_epi32(packed);
+}
+
+RADX_AVX2 size_t _si32ToFl32Avx2(const Radx::si32 *in, Radx::fl32 *out,
+                                 size_t nn,
+                                 Radx::si32 inMiss, Radx::fl32 outMiss,
+                                 double scale, double offset)
+{
+  __m256i vinMiss = _mm256_set1_epi32(inMiss);
+  __m256 voutMiss = _mm256_set1_ps(outMiss);
+  __m256d vscale = _mm256_set1_pd(scale);
+  __m256d voffset = _mm256_set1_pd(offset);
+  size_t ii = 0;
+  for (; ii + 8 <= nn; ii += 8) {
+    __m256i ival = _mm256_loadu_si256((const __m256i *) (in + ii));
+    __m256i isMiss = _mm256_cmpeq_epi32(ival, vinMiss);
+    __m256 fval = _scaleToFl32(ival, vscale, voffset);
+    fval = _mm256_blendv_ps(fval, voutMiss, _mm256_castsi256_ps(isMiss));
+    _mm256_storeu_ps(out + ii, fval);
+  }
+  return ii;
+}
+
+RADX_AVX2 size_t _si16ToFl32Avx2(const Radx::si16 *in, Radx::fl32 *out,
+                                 size_t nn,
+                                 Radx::si16 inMiss, Radx::fl32 outMiss,
+                                 double scale, double offset)
+{
+  __m128i vinMiss = _mm_set1_epi16(inMiss);
+  __m256 voutMiss = _mm256_set1_ps(outMiss);
+  __m256d vscale = _mm256_set1_pd(scale);
+  __m256d voffset = _mm256_set1_pd(offset);
+  size_t ii = 0;
+  for (; ii + 8 <= nn; ii += 8) {
+    __m128i raw = _mm_loadu_si128((const __m128i *) (in + ii));
+    __m256i isMiss = _mm256_cvtepi16_epi32(_mm_cmpeq_epi16(raw, vinMiss));
+    __m256 fval = _scaleToFl32(_mm256_cvtepi16_epi32(raw), vscale, voffset);
+    fval = _mm256_blendv_ps(fval, voutMiss, _mm256_castsi256_ps(isMiss));
+    _mm256_storeu_ps(out + ii, fval);
+  }
+  return ii;
+}
+
+RADX_AVX2 size_t _si08ToFl32Avx2(const Radx::si08 *in, Radx::fl32 *out,
+                                 size_t nn,
+                                 Radx::si08 inMiss, Radx::fl32 outMiss,
+                                 double scale, double offset)
+{
+  __m128i vinMiss = _mm_set1_epi8(inMiss);
+  __m256 voutMiss = _mm256_set1_ps(outMiss);
+  __m256d vscale = _mm256_set1_pd(scale);
+  __m256d voffset = _mm256_set1_pd(offset);
+  size_t ii = 0;
+  for (; ii + 8 <= nn; ii += 8) {
+    __m128i raw = _mm_loadl_epi64((const __m128i *) (in + ii));
+    __m256i isMiss = _mm256_cvtepi8_epi32(_mm_cmpeq_epi8(raw, vinMiss));
+    __m256 fval = _scaleToFl32(_mm256_cvtepi8_epi32(raw), vscale, voffset);
+    fval = _mm256_blendv_ps(fval, voutMiss, _mm256_castsi256_ps(isMiss));
+    _mm256_storeu_ps(out + ii, fval);
+  }
+  return ii;
+}
+
+RADX_AVX2 size_t _fl32ToIntAvx2(const Radx::fl32 *in, size_t nn,
+                                Radx::fl32 inMiss, int outMiss,
+                                double scale, double offset,
+                                double minInt, double maxInt,
+                                Radx::si32 *out32,
+                                Radx::si16 *out16,
+                                Radx::si08 *out08)
+{
+  __m256d vinMiss = _mm256_set1_pd(inMiss);
+  __m256d voutMiss = _mm256_set1_pd(outMiss);
+  __m256d vscale = _mm256_set1_pd(scale);
+  __m256d voffset = _mm256_set1_pd(offset);
+  __m256d vminInt = _mm256_set1_pd(minInt);
+  __m256d vmaxInt = _mm256_set1_pd(maxInt);
+  size_t ii = 0;
+  for (; ii + 8 <= nn; ii += 8) {
+    __m256 fval = _mm256_loadu_ps(in + ii);
+    __m128i lo = _packFromFl32(_mm256_castps256_ps128(fval),
+                               vinMiss, voutMiss, vscale, voffset,
+                               vminInt, vmaxInt);
+    __m128i hi = _packFromFl32(_mm256_extractf128_ps(fval, 1),
+                               vinMiss, voutMiss, vscale, voffset,
+                               vminInt, vmaxInt);
+    if (out32 != NULL) {
+      _mm_storeu_si128((__m128i *) (out32 + ii), lo);
+      _mm_storeu_si128((__m128i *) (out32 + ii + 4), hi);
+    } else {
+      // values are already in range, so saturation has no effect
+      __m128i packed16 = _mm_packs_epi32(lo, hi);
+      if (out16 != NULL) {
+        _mm_storeu_si128((__m128i *) (out16 + ii), packed16);
+      } else {
+        _mm_storel_epi64((__m128i *) (out08 + ii),
+                         _mm_packs_epi16(packed16, packed16));
+      }
+    }
+  }
+  return ii;
+}
+
+RADX_AVX2 size_t _minMaxFl32Avx2(const Radx::fl32 *in, size_t nn,
+                                 Radx::fl32 miss,
+                                 size_t &nValid,
+                                 double &minVal, double &maxVal)
+{
+  const float posInf = numeric_limits<float>::infinity();
+  __m256 vmiss = _mm256_set1_ps(miss);
+  __m256 vposInf = _mm256_set1_ps(posInf);
+  __m256 vnegInf = _mm256_set1_ps(-posInf);
+  __m256 vmin = vposInf;
+  __m256 vmax = vnegInf;
+  size_t count = 0;
+  size_t ii = 0;
+  for (; ii + 8 <= nn; ii += 8) {
+    __m256 val = _mm256_loadu_ps(in + ii);
+    __m256 notMiss = _mm256_cmp_ps(val, vmiss, _CMP_NEQ_UQ);
+    count += __builtin_popcount(_mm256_movemask_ps(notMiss));
+    // min/max return the second operand if either is NaN,
+    // so NaNs do not affect the result
+    vmin = _mm256_min_ps(_mm256_blendv_ps(vposInf, val, notMiss), vmin);
+    vmax = _mm256_max_ps(_mm256_blendv_ps(vnegInf, val, notMiss), vmax);
+  }
+  float mins[8], maxs[8];
+  _mm256_storeu_ps(mins, vmin);
+  _mm256_storeu_ps(maxs, vmax);
+  for (int jj = 0; jj < 8; jj++) {
+    if (mins[jj] < minVal) {
+      minVal = mins[jj];
+    }
+    if (maxs[jj] > maxVal) {
+      maxVal = maxs[jj];
+    }
+  }
+  nValid += count;
+  return ii;
+}
+
+RADX_AVX2 size_t _linearTransformFl32Avx2(Radx::fl32 *data, size_t nn,
+                                          Radx::fl32 miss,
+                                          double scale, double offset)
+{
+  __m256 vmiss = _mm256_set1_ps(miss);
+  __m256d vscale = _mm256_set1_pd(scale);
+  __m256d voffset = _mm256_set1_pd(offset);
+  size_t ii = 0;
+  for (; ii + 8 <= nn; ii += 8) {
+    __m256 val = _mm256_loadu_ps(data + ii);
+    __m256 notMiss = _mm256_cmp_ps(val, vmiss, _CMP_NEQ_UQ);
+    __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(val));
+    __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(val, 1));
+    lo = _mm256_add_pd(_mm256_mul_pd(lo, vscale), voffset);
+    hi = _mm256_add_pd(_mm256_mul_pd(hi, vscale), voffset);
+    __m256 trans =
+      _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)),
+                           _mm256_cvtpd_ps(hi), 1);
+    _mm256_storeu_ps(data + ii, _mm256_blendv_ps(val, trans, notMiss));
+  }
+  return ii;
+}
+
+#undef RADX_AVX2
+
+} // namespace
+
+#endif // RADX_KERNELS_X86
+
+/////////////////////////////////////////////////////////
+// scalar packing of a single value - shared by the
+// fl32 to integer conversions
+
+template <class T>
+static inline T _packValue(Radx::fl32 val, Radx::fl32 inMiss, T outMiss,
+                           double scale, double offset,
+                           double minInt, double maxInt)
+{
+  if (val == inMiss) {
+    return outMiss;
+  }
+  double packed = floor((val - offset) / scale + 0.5);
+  if (!(packed >= minInt && packed <= maxInt)) {
+    return outMiss;
+  }
+  return (T) packed;
+}
+
+/////////////////////////////////////////////////////////
+// conversion to fl32
+
+void RadxFieldKernels::fl64ToFl32(const Radx::fl64 *in, Radx::fl32 *out,
+                                  size_t nn,
+                                  Radx::fl64 inMiss, Radx::fl32 outMiss)
+{
+  for (size_t ii = 0; ii < nn; ii++) {
+    if (in[ii] == inMiss) {
+      out[ii] = outMiss;
+    } else {
+      out[ii] = in[ii];
+    }
+  }
+}
+
+void RadxFieldKernels::si32ToFl32(const Radx::si32 *in, Radx::fl32 *out,
+                                  size_t nn,
+                                  Radx::si32 inMiss, Radx::fl32 outMiss,
+                                  double scale, double offset)
+{
+  size_t start = 0;
+#ifdef RADX_KERNELS_X86
+  if (simdActive()) {
+    start = _si32ToFl32Avx2(in, out, nn, inMiss, outMiss, scale, offset);
+  }
+#endif
+  for (size_t ii = start; ii < nn; ii++) {
+    if (in[ii] == inMiss) {
+      out[ii] = outMiss;
+    } else {
+      out[ii] = in[ii] * scale + offset;
+    }
+  }
+}
+
+void RadxFieldKernels::si16ToFl32(const Radx::si16 *in, Radx::fl32 *out,
+                                  size_t nn,
+                                  Radx::si16 inMiss, Radx::fl32 outMiss,
+                                  double scale, double offset)
+{
+  size_t start = 0;
+#ifdef RADX_KERNELS_X86
+  if (simdActive()) {
+    start = _si16ToFl32Avx2(in, out, nn, inMiss, outMiss, scale, offset);
+  }
+#endif
+  for (size_t ii = start; ii < nn; ii++) {
+    if (in[ii] == inMiss) {
+      out[ii] = outMiss;
+    } else {
+      out[ii] = in[ii] * scale + offset;
+    }
+  }
+}
+
+void RadxFieldKernels::si08ToFl32(const Radx::si08 *in, Radx::fl32 *out,
+                                  size_t nn,
+                                  Radx::si08 inMiss, Radx::fl32 outMiss,
+                                  double scale, double offset)
+{
+  size_t start = 0;
+#ifdef RADX_KERNELS_X86
+  if (simdActive()) {
+    start = _si08ToFl32Avx2(in, out, nn, inMiss, outMiss, scale, offset);
+  }
+#endif
+  for (size_t ii = start; ii < nn; ii++) {
+    if (in[ii] == inMiss) {
+      out[ii] = outMiss;
+    } else {
+      out[ii] = in[ii] * scale + offset;
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////
+// conversion from fl32 to scaled integers
+
+void RadxFieldKernels::fl32ToSi32(const Radx::fl32 *in, Radx::si32 *out,
+                                  size_t nn,
+                                  Radx::fl32 inMiss, Radx::si32 outMiss,
+                                  double scale, double offset)
+{
+  size_t start = 0;
+#ifdef RADX_KERNELS_X86
+  if (simdActive()) {
+    start = _fl32ToIntAvx2(in, nn, inMiss, outMiss, scale, offset,
+                           -2147483647.0, 2147483647.0,
+                           out, NULL, NULL);
+  }
+#endif
+  for (size_t ii = start; ii < nn; ii++) {
+    out[ii] = _packValue<Radx::si32>(in[ii], inMiss, outMiss, scale, offset,
+                                     -2147483647.0, 2147483647.0);
+  }
+}
+
+void RadxFieldKernels::fl32ToSi16(const Radx::fl32 *in, Radx::si16 *out,
+                                  size_t nn,
+                                  Radx::fl32 inMiss, Radx::si16 outMiss,
+                                  double scale, double offset)
+{
+  size_t start = 0;
+#ifdef RADX_KERNELS_X86
+  if (simdActive()) {
+    start = _fl32ToIntAvx2(in, nn, inMiss, outMiss, scale, offset,
+                           -32767.0, 32767.0,
+                           NULL, out, NULL);
+  }
+#endif
+  for (size_t ii = start; ii < nn; ii++) {
+    out[ii] = _packValue<Radx::si16>(in[ii], inMiss, outMiss, scale, offset,
+                                     -32767.0, 32767.0);
+  }
+}
+
+void RadxFieldKernels::fl32ToSi08(const Radx::fl32 *in, Radx::si08 *out,
+                                  size_t nn,
+                                  Radx::fl32 inMiss, Radx::si08 outMiss,
+                                  double scale, double offset)
+{
+  size_t start = 0;
+#ifdef RADX_KERNELS_X86
+  if (simdActive()) {
+    start = _fl32ToIntAvx2(in, nn, inMiss, outMiss, scale, offset,
+                           -127.0, 127.0,
+                           NULL, NULL, out);
+  }
+#endif
+  for (size_t ii = start; ii < nn; ii++) {
+    out[ii] = _packValue<Radx::si08>(in[ii], inMiss, outMiss, scale, offset,
+                                     -127.0, 127.0);
+  }
+}
+
+/////////////////////////////////////////////////////////
+// min and max
+
+template <class T, class U>
+static inline size_t _minMax(const T *in, size_t nn, T miss,
+                             U &minVal, U &maxVal)
+{
+  size_t nValid = 0;
+  for (size_t ii = 0; ii < nn; ii++) {
+    T val = in[ii];
+    if (val != miss) {
+      nValid++;
+      if (val < minVal) {
+        minVal = val;
+      }
+      if (val > maxVal) {
+        maxVal = val;
+      }
+    }
+  }
+  return nValid;
+}
+
+size_t RadxFieldKernels::minMaxFl64(const Radx::fl64 *in, size_t nn,
+                                    Radx::fl64 miss,
+                                    double &minVal, double &maxVal)
+{
+  minVal = numeric_limits<double>::infinity();
+  maxVal = -numeric_limits<double>::infinity();
+  return _minMax(in, nn, miss, minVal, maxVal);
+}
+
+size_t RadxFieldKernels::minMaxFl32(const Radx::fl32 *in, size_t nn,
+                                    Radx::fl32 miss,
+                                    double &minVal, double &maxVal)
+{
+  minVal = numeric_limits<double>::infinity();
+  maxVal = -numeric_limits<double>::infinity();
+  size_t start = 0;
+  size_t nValid = 0;
+#ifdef RADX_KERNELS_X86
+  if (simdActive()) {
+    start = _minMaxFl32Avx2(in, nn, miss, nValid, minVal, maxVal);
+  }
+#endif
+  nValid += _minMax(in + start, nn - start, miss, minVal, maxVal);
+  return nValid;
+}
+
+size_t RadxFieldKernels::minMaxSi32(const Radx::si32 *in, size_t nn,
+                                    Radx::si32 miss,
+                                    Radx::si32 &minVal, Radx::si32 &maxVal)
+{
+  minVal = numeric_limits<Radx::si32>::max();
+  maxVal = numeric_limits<Radx::si32>::min();
+  return _minMax(in, nn, miss, minVal, maxVal);
+}
+
+size_t RadxFieldKernels::minMaxSi16(const Radx::si16 *in, size_t nn,
+                                    Radx::si16 miss,
+                                    Radx::si16 &minVal, Radx::si16 &maxVal)
+{
+  minVal = numeric_limits<Radx::si16>::max();
+  maxVal = numeric_limits<Radx::si16>::min();
+  return _minMax(in, nn, miss, minVal, maxVal);
+}
+
+size_t RadxFieldKernels::minMaxSi08(const Radx::si08 *in, size_t nn,
+                                    Radx::si08 miss,
+                                    Radx::si08 &minVal, Radx::si08 &maxVal)
+{
+  minVal = numeric_limits<Radx::si08>::max();
+  maxVal = numeric_limits<Radx::si08>::min();
+  return _minMax(in, nn, miss, minVal, maxVal);
+}
+
+/////////////////////////////////////////////////////////
+// in-place transforms
+
+void RadxFieldKernels::linearTransformFl32(Radx::fl32 *data, size_t nn,
+                                           Radx::fl32 miss,
+                                           double scale, double offset)
+{
+  size_t start = 0;
+#ifdef RADX_KERNELS_X86
+  if (simdActive()) {
+    start = _linearTransformFl32Avx2(data, nn, miss, scale, offset);
+  }
+#endif
+  for (size_t ii = start; ii < nn; ii++) {
+    Radx::fl32 val = data[ii];
+    if (val != miss) {
+      data[ii] = val * scale + offset;
+    }
+  }
+}
+
+void RadxFieldKernels::dbToLinearFl32(Radx::fl32 *data, size_t nn,
+                                      Radx::fl32 miss)
+{
+  // dominated by pow(), so no vector version
+  for (size_t ii = 0; ii < nn; ii++) {
+    Radx::fl32 val = data[ii];
+    if (val != miss) {
+      data[ii] = pow(10.0, val / 10.0);
+    }
+  }
+}
@@ -430,6 +430,7 @@ void RadxFile::clearWrite()
 {
   _writeCompressed = true;
   _compressionLevel = 5;
+  _writeNThreads = 1;
   _writeLdataInfo = false;
   _writeFileNameMode = FILENAME_WITH_START_AND_END_TIMES;
   _writeFileNamePrefix.clear();
@@ -467,6 +468,7 @@ void RadxFile::copyWriteDirectives(const RadxFile &other)
   _writeHyphenInDateTime = other._writeHyphenInDateTime; 
   _writeCompressed = other._writeCompressed;
   _compressionLevel = other._compressionLevel;
+  _writeNThreads = other._writeNThreads;
   _writeLdataInfo = other._writeLdataInfo;
   _writeProposedStdNameInNcf = other._writeProposedStdNameInNcf;
   _ncFormat = other._ncFormat;
@@ -503,6 +505,7 @@ void RadxFile::copyReadDirectives(const RadxFile &other)
   _readRemoveShortRange = other._readRemoveShortRange;
   _readMetadataOnly = other._readMetadataOnly;
   _readTimesOnly = other._readTimesOnly;
+  _readNThreads = other._readNThreads;
   _readSetRadarNum = other._readSetRadarNum;
   _readRadarNum = other._readRadarNum;
   _readChangeLatitudeSign = other._readChangeLatitudeSign;
@@ -2124,6 +2127,7 @@ void RadxFile::clearRead()
   _readRemoveShortRange = false;
   _readMetadataOnly = false;
   _readTimesOnly = false;
+  _readNThreads = 1;
   _readSetRadarNum = -1;
   _readRadarNum = -1;
   _readChangeLatitudeSign = false;
@@ -2391,6 +2395,17 @@ void RadxFile::setReadTimesOnly(bool val)
   }
 }
 
+/////////////////////////////////////////////////////////////////
+/// Set the number of threads to use for reading and decoding
+/// field data.
+/// Defaults to 1.
+
+void RadxFile::setReadNThreads(int val)
+
+{
+  _readNThreads = (val < 1 ? 1 : val);
+}
+
 /////////////////////////////////////////////////////////////////
 /// Set radar number to be read in.
 /// Only applies to file formats with data from more than 1 radar
@@ -2559,6 +2574,7 @@ void RadxFile::printWriteRequest(ostream &out) const
   out << "  writeCompressed: "
       << (_writeCompressed?"Y":"N") << endl;
   out << "  compressionLevel: " << _compressionLevel << endl;
+  out << "  writeNThreads: " << _writeNThreads << endl;
   out << "  writeLdataInfo: "
       << (_writeLdataInfo?"Y":"N") << endl;
 
@@ -55,6 +55,7 @@
 #include <map>
 #include <iostream>
 #include <sys/stat.h>
+#include <pthread.h>
 using namespace std;
 
 const double RadxVol::_searchAngleRes = 360.0 / _searchAngleN;
@@ -163,6 +164,7 @@ void RadxVol::_init()
 {
 
   _debug = false;
+  _nThreadsConvert = 1;
   _cfactors = NULL;
   _searchRays.resize(_searchAngleN);
 
@@ -240,6 +242,7 @@ void RadxVol::copyMeta(const RadxVol &rhs)
   // copy the base class metadata
 
   _debug = rhs._debug;
+  _nThreadsConvert = rhs._nThreadsConvert;
 
   _version = rhs._version;
   _title = rhs._title;
@@ -4571,146 +4574,185 @@ void RadxVol::_checkForIndexedRays(const RadxSweep *sweep) const
 
 void RadxVol::convertToFl64()
 {
-  // check if fields are managed by the vol or the rays
-  if (_fields.size() > 0) {
-    // managed by vol
-    for (size_t ii = 0; ii < _fields.size(); ii++) {
-      _fields[ii]->convertToFl64();
-    }
-    setRayFieldPointers();
-  } else {
-    // managed by rays
-    for (size_t ii = 0; ii < _rays.size(); ii++) {
-      _rays[ii]->convertToFl64();
-    }
-  }
+  _convertFields(CONVERT_FL64);
 }
 
 void RadxVol::convertToFl32()
 {
-  // check if fields are managed by the vol or the rays
-  if (_fields.size() > 0) {
-    // managed by vol
-    for (size_t ii = 0; ii < _fields.size(); ii++) {
-      _fields[ii]->convertToFl32();
-    }
-    setRayFieldPointers();
-  } else {
-    // managed by rays
-    for (size_t ii = 0; ii < _rays.size(); ii++) {
-      _rays[ii]->convertToFl32();
-    }
-  }
+  _convertFields(CONVERT_FL32);
 }
 
 void RadxVol::convertToSi32()
 {
-  // check if fields are managed by the vol or the rays
-  if (_fields.size() > 0) {
-    // managed by vol
-    for (size_t ii = 0; ii < _fields.size(); ii++) {
-      _fields[ii]->convertToSi32();
-    }
-    setRayFieldPointers();
-  } else {
-    // managed by rays
-    for (size_t ii = 0; ii < _rays.size(); ii++) {
-      _rays[ii]->convertToSi32();
-    }
-  }
+  _convertFields(CONVERT_SI32);
 }
 
 void RadxVol::convertToSi32(double scale, double offset)
 {
-  // check if fields are managed by the vol or the rays
-  if (_fields.size() > 0) {
-    // managed by vol
-    for (size_t ii = 0; ii < _fields.size(); ii++) {
-      _fields[ii]->convertToSi32(scale, offset);
-    }
-    setRayFieldPointers();
-  } else {
-    // managed by rays
-    for (size_t ii = 0; ii < _rays.size(); ii++) {
-      _rays[ii]->convertToSi32(scale, offset);
-    }
-  }
+  _convertFields(CONVERT_SI32_SCALED, scale, offset);
 }
 
 void RadxVol::convertToSi16()
 {
-  // check if fields are managed by the vol or the rays
-  if (_fields.size() > 0) {
-    // managed by vol
-    for (size_t ii = 0; ii < _fields.size(); ii++) {
-      _fields[ii]->convertToSi16();
-    }
-    setRayFieldPointers();
-  } else {
-    // managed by rays
-    for (size_t ii = 0; ii < _rays.size(); ii++) {
-      _rays[ii]->convertToSi16();
-    }
-  }
+  _convertFields(CONVERT_SI16);
 }
 
 void RadxVol::convertToSi16(double scale, double offset)
 {
-  // check if fields are managed by the vol or the rays
-  if (_fields.size() > 0) {
-    // managed by vol
-    for (size_t ii = 0; ii < _fields.size(); ii++) {
-      _fields[ii]->convertToSi16(scale, offset);
-    }
-    setRayFieldPointers();
-  } else {
-    // managed by rays
-    for (size_t ii = 0; ii < _rays.size(); ii++) {
-      _rays[ii]->convertToSi16(scale, offset);
-    }
-  }
+  _convertFields(CONVERT_SI16_SCALED, scale, offset);
 }
 
 void RadxVol::convertToSi08()
 {
-  // check if fields are managed by the vol or the rays
-  if (_fields.size() > 0) {
-    // managed by vol
-    for (size_t ii = 0; ii < _fields.size(); ii++) {
-      _fields[ii]->convertToSi08();
-    }
-    setRayFieldPointers();
-  } else {
-    // managed by rays
-    for (size_t ii = 0; ii < _rays.size(); ii++) {
-      _rays[ii]->convertToSi08();
-    }
-  }
+  _convertFields(CONVERT_SI08);
 }
 
 void RadxVol::convertToSi08(double scale, double offset)
 {
-  // check if fields are managed by the vol or the rays
+  _convertFields(CONVERT_SI08_SCALED, scale, offset);
+}
+
+void RadxVol::convertToType(Radx::DataType_t targetType)
+{
+  // only applies to fields managed by the vol
   if (_fields.size() > 0) {
-    // managed by vol
-    for (size_t ii = 0; ii < _fields.size(); ii++) {
-      _fields[ii]->convertToSi08(scale, offset);
-    }
+    _convertFields(CONVERT_TYPE, 1.0, 0.0, targetType);
+  } else {
     setRayFieldPointers();
+  }
+}
+
+/////////////////////////////////////////////////
+// convert the data type for all fields
+//
+// If the fields are managed by the vol, each field is converted.
+// Otherwise the fields are managed by the rays, and each ray is
+// converted.
+//
+// The items are independent, so if _nThreadsConvert > 1 they
+// are divided among threads, each thread taking every nth item.
+
+void RadxVol::_convertFields(convert_op_t op,
+                             double scale, double offset,
+                             Radx::DataType_t dataType)
+{
+
+  ConvertJob job;
+  job.vol = this;
+  job.op = op;
+  job.scale = scale;
+  job.offset = offset;
+  job.dataType = dataType;
+  job.useRays = (_fields.size() == 0);
+  job.nItems = (job.useRays ? _rays.size() : _fields.size());
+  job.threadNum = 0;
+  job.nThreads = 1;
+
+  int nThreads = _nThreadsConvert;
+  if ((size_t) nThreads > job.nItems) {
+    nThreads = (int) job.nItems;
+  }
+
+  if (nThreads <= 1) {
+    
+    _convertItems(job);
+
   } else {
-    // managed by rays
-    for (size_t ii = 0; ii < _rays.size(); ii++) {
-      _rays[ii]->convertToSi08(scale, offset);
+
+    // start threads, this thread does the first share
+
+    vector<ConvertJob> jobs(nThreads, job);
+    vector<pthread_t> threads(nThreads);
+    vector<bool> started(nThreads, false);
+    for (int ii = 0; ii < nThreads; ii++) {
+      jobs[ii].threadNum = ii;
+      jobs[ii].nThreads = nThreads;
+    }
+    for (int ii = 1; ii < nThreads; ii++) {
+      if (pthread_create(&threads[ii], NULL,
+                         _convertThreadEntry, &jobs[ii]) == 0) {
+        started[ii] = true;
+      }
+    }
+    _convertItems(jobs[0]);
+
+    // wait for threads, doing the work here for any that
+    // could not be started
+    
+    for (int ii = 1; ii < nThreads; ii++) {
+      if (started[ii]) {
+        pthread_join(threads[ii], NULL);
+      } else {
+        _convertItems(jobs[ii]);
+      }
     }
+
+  }
+
+  if (!job.useRays) {
+    setRayFieldPointers();
   }
+
 }
 
-void RadxVol::convertToType(Radx::DataType_t targetType)
+/////////////////////////////////////////////////
+// thread entry point for conversions
+
+void *RadxVol::_convertThreadEntry(void *args)
 {
-  for (size_t ii = 0; ii < _fields.size(); ii++) {
-    _fields[ii]->convertToType(targetType);
-  }
-  setRayFieldPointers();
+  ConvertJob *job = (ConvertJob *) args;
+  job->vol->_convertItems(*job);
+  return NULL;
+}
+
+/////////////////////////////////////////////////
+// convert this thread's share of the fields or rays
+
+void RadxVol::_convertItems(const ConvertJob &job)
+{
+
+  for (size_t ii = job.threadNum; ii < job.nItems; ii += job.nThreads) {
+
+    if (job.useRays) {
+
+      RadxRay *ray = _rays[ii];
+      switch (job.op) {
+        case CONVERT_FL64: ray->convertToFl64(); break;
+        case CONVERT_FL32: ray->convertToFl32(); break;
+        case CONVERT_SI32: ray->convertToSi32(); break;
+        case CONVERT_SI16: ray->convertToSi16(); break;
+        case CONVERT_SI08: ray->convertToSi08(); break;
+        case CONVERT_SI32_SCALED:
+          ray->convertToSi32(job.scale, job.offset); break;
+        case CONVERT_SI16_SCALED:
+          ray->convertToSi16(job.scale, job.offset); break;
+        case CONVERT_SI08_SCALED:
+          ray->convertToSi08(job.scale, job.offset); break;
+        case CONVERT_TYPE: ray->convertToType(job.dataType); break;
+      }
+
+    } else {
+
+      RadxField *field = _fields[ii];
+      switch (job.op) {
+        case CONVERT_FL64: field->convertToFl64(); break;
+        case CONVERT_FL32: field->convertToFl32(); break;
+        case CONVERT_SI32: field->convertToSi32(); break;
+        case CONVERT_SI16: field->convertToSi16(); break;
+        case CONVERT_SI08: field->convertToSi08(); break;
+        case CONVERT_SI32_SCALED:
+          field->convertToSi32(job.scale, job.offset); break;
+        case CONVERT_SI16_SCALED:
+          field->convertToSi16(job.scale, job.offset); break;
+        case CONVERT_SI08_SCALED:
+          field->convertToSi08(job.scale, job.offset); break;
+        case CONVERT_TYPE: field->convertToType(job.dataType); break;
+      }
+
+    }
+
+  } // ii
+
 }
 
 ////////////////////////////////////////////////////////////////
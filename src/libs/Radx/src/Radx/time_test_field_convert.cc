@@ -0,0 +1,195 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+///////////////////////////////////////////////////////////////
+// time_test_field_convert.cc
+///////////////////////////////////////////////////////////////
+//
+// Benchmark for the RadxField conversion kernels, and for
+// multi-threaded conversion of RadxVol fields.
+//
+// Builds a synthetic volume, times the field conversions with
+// the scalar and SIMD kernels, and checks that both produce
+// identical results.
+//
+// Usage: time_test_field_convert [nRays nGates nFields nThreads]
+//
+///////////////////////////////////////////////////////////////
+
+#include <Radx/RadxVol.hh>
+#include <Radx/RadxRay.hh>
+#include <Radx/RadxField.hh>
+#include <Radx/RadxFieldKernels.hh>
+#include <sys/time.h>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+using namespace std;
+
+static double _now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1.0e6;
+}
+
+// fill field with reflectivity-like data, with some missing gates
+
+static void _fillData(Radx::fl32 *data, size_t nGates, int iray, int ifield)
+{
+  for (size_t ii = 0; ii < nGates; ii++) {
+    int hash = (int) ((ii * 7919 + iray * 104729 + ifield * 13) % 1000);
+    if (hash < 300) {
+      data[ii] = Radx::missingFl32;
+    } else {
+      data[ii] = -30.0 + 0.09 * hash + ifield;
+    }
+  }
+}
+
+// create a volume with nFields fl32 fields
+
+static void _createVol(RadxVol &vol, int nRays, int nGates, int nFields)
+{
+  vol.clear();
+  Radx::fl32 *data = new Radx::fl32[nGates];
+  for (int iray = 0; iray < nRays; iray++) {
+    RadxRay *ray = new RadxRay;
+    ray->setRangeGeom(0.075, 0.150);
+    ray->setAzimuthDeg(iray % 360);
+    ray->setElevationDeg(0.5);
+    ray->setSweepNumber(0);
+    for (int ifield = 0; ifield < nFields; ifield++) {
+      char name[32];
+      snprintf(name, sizeof(name), "FIELD%d", ifield);
+      _fillData(data, nGates, iray, ifield);
+      ray->addField(name, "dBZ", nGates, Radx::missingFl32, data, true);
+    }
+    vol.addRay(ray);
+  }
+  delete[] data;
+  vol.loadFieldsFromRays();
+}
+
+// compare the packed data in two volumes
+
+static bool _sameData(const RadxVol &vol1, const RadxVol &vol2)
+{
+  const vector<RadxField *> &fields1 = vol1.getFields();
+  const vector<RadxField *> &fields2 = vol2.getFields();
+  if (fields1.size() != fields2.size()) {
+    return false;
+  }
+  for (size_t ii = 0; ii < fields1.size(); ii++) {
+    const RadxField *fld1 = fields1[ii];
+    const RadxField *fld2 = fields2[ii];
+    if (fld1->getDataType() != fld2->getDataType() ||
+        fld1->getNPoints() != fld2->getNPoints() ||
+        fld1->getScale() != fld2->getScale() ||
+        fld1->getOffset() != fld2->getOffset()) {
+      return false;
+    }
+    size_t nBytes = fld1->getNPoints() * fld1->getByteWidth();
+    if (memcmp(fld1->getData(), fld2->getData(), nBytes) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// time a round trip fl32 -> si16 -> fl32 -> si08 -> fl32,
+// with min/max computation for the dynamic scaling
+
+static double _timeRoundTrip(RadxVol &vol, bool useSimd, int nThreads,
+                             RadxVol &si16Copy)
+{
+  RadxFieldKernels::setUseSimd(useSimd);
+  vol.setNThreadsConvert(nThreads);
+  double start = _now();
+  vol.convertToSi16();
+  double secs = _now() - start;
+  si16Copy = vol; // not timed
+  start = _now();
+  vol.convertToFl32();
+  vol.convertToSi08();
+  vol.convertToFl32();
+  secs += _now() - start;
+  return secs;
+}
+
+int main(int argc, char **argv)
+{
+
+  int nRays = 3600;
+  int nGates = 1000;
+  int nFields = 12;
+  int nThreads = 4;
+  if (argc > 1) nRays = atoi(argv[1]);
+  if (argc > 2) nGates = atoi(argv[2]);
+  if (argc > 3) nFields = atoi(argv[3]);
+  if (argc > 4) nThreads = atoi(argv[4]);
+
+  cerr << "nRays, nGates, nFields, nThreads: "
+       << nRays << ", " << nGates << ", "
+       << nFields << ", " << nThreads << endl;
+  cerr << "AVX2 kernels available: "
+       << (RadxFieldKernels::simdActive() ? "yes" : "no") << endl;
+
+  RadxVol scalarVol, simdVol, threadedVol;
+  _createVol(scalarVol, nRays, nGates, nFields);
+  simdVol = scalarVol;
+  threadedVol = scalarVol;
+
+  RadxVol scalarSi16, simdSi16, threadedSi16;
+  double scalarSecs = _timeRoundTrip(scalarVol, false, 1, scalarSi16);
+  double simdSecs = _timeRoundTrip(simdVol, true, 1, simdSi16);
+  double threadedSecs = _timeRoundTrip(threadedVol, true, nThreads,
+                                       threadedSi16);
+
+  double mgates = (double) nRays * nGates * nFields / 1.0e6;
+  fprintf(stderr, "  scalar, 1 thread:    %8.3f secs, %8.1f Mgates/s\n",
+          scalarSecs, mgates / scalarSecs);
+  fprintf(stderr, "  simd, 1 thread:      %8.3f secs, %8.1f Mgates/s\n",
+          simdSecs, mgates / simdSecs);
+  fprintf(stderr, "  simd, %2d threads:    %8.3f secs, %8.1f Mgates/s\n",
+          nThreads, threadedSecs, mgates / threadedSecs);
+
+  int iret = 0;
+  if (!_sameData(scalarSi16, simdSi16) ||
+      !_sameData(scalarSi16, threadedSi16)) {
+    cerr << "ERROR - si16 data differs between scalar and simd" << endl;
+    iret = -1;
+  }
+  if (!_sameData(scalarVol, simdVol) ||
+      !_sameData(scalarVol, threadedVol)) {
+    cerr << "ERROR - fl32 data differs between scalar and simd" << endl;
+    iret = -1;
+  }
+  if (iret == 0) {
+    cerr << "  results identical" << endl;
+  }
+
+  return iret;
+
+}
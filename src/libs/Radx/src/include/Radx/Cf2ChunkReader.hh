@@ -0,0 +1,156 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+/////////////////////////////////////////////////////////////
+// Cf2ChunkReader.hh
+///////////////////////////////////////////////////////////////
+//
+// Multi-threaded reading of compressed 2-D field variables from
+// a NetCDF4/HDF5 file.
+//
+// For compressed variables, most of the read time is spent in
+// decompression. The NetCDF and HDF5 libraries are not safe for
+// concurrent use, so this class splits the read into two phases:
+//
+//   (a) the raw compressed chunks for each variable are read
+//       serially, using HDF5 direct chunk reads;
+//   (b) the chunks are decompressed (deflate, shuffle) and
+//       assembled into the output arrays on multiple threads,
+//       using zlib directly.
+//
+// Variables which use filters other than deflate and shuffle,
+// are not chunked, have unallocated chunks or non-native byte
+// order are not handled. For those, readRawVar() returns -1 and
+// the caller should read the variable through NetCDF in the
+// normal way.
+//
+///////////////////////////////////////////////////////////////
+
+#ifndef Cf2ChunkReader_HH
+#define Cf2ChunkReader_HH
+
+#include <string>
+#include <vector>
+#include <map>
+using namespace std;
+
+class Cf2ChunkReader {
+
+public:
+
+  Cf2ChunkReader();
+  ~Cf2ChunkReader();
+
+  /// Open file for raw chunk reads, using HDF5.
+  /// The file may also be open through NetCDF.
+  /// Returns 0 on success, -1 on failure.
+
+  int open(const string &path);
+
+  /// Close the file. Decoded data is retained until clear().
+
+  void close();
+
+  /// Read the raw chunks for a 2-D variable, for later decoding.
+  ///
+  ///   name: name used to retrieve the data
+  ///   datasetPath: full path in the file, e.g. /sweep_0001/DBZ
+  ///   elemSize: expected size of each element, in bytes
+  ///   nRows, nCols: expected dimensions
+  ///
+  /// Returns 0 on success, -1 if the variable cannot be handled.
+
+  int readRawVar(const string &name,
+                 const string &datasetPath,
+                 size_t elemSize, size_t nRows, size_t nCols);
+
+  /// Decode all variables read so far, using nThreads.
+  /// The raw chunks are freed after decoding.
+
+  void decode(int nThreads);
+
+  /// Copy decoded data for variable into the supplied buffer.
+  /// nBytes must match the size of the decoded data.
+  /// Returns 0 on success, -1 if the data is not available.
+
+  int copyData(const string &name, void *buf, size_t nBytes) const;
+
+  /// Free all data
+
+  void clear();
+
+  /// Get number of variables successfully decoded
+
+  size_t getNDecoded() const;
+
+private:
+
+  // a raw chunk, as stored in the file
+
+  class Chunk {
+  public:
+    size_t row0;
+    size_t col0;
+    unsigned int filterMask;
+    vector<unsigned char> raw;
+    bool ok;
+  };
+
+  // a variable with its chunks
+
+  class Var {
+  public:
+    string name;
+    size_t elemSize;
+    size_t nRows, nCols;
+    size_t chunkRows, chunkCols;
+    vector<int> filters; // in the order applied on write
+    vector<Chunk> chunks;
+    vector<unsigned char> data;
+    bool decoded;
+  };
+
+  // decoding task for a thread
+
+  class Task {
+  public:
+    Cf2ChunkReader *reader;
+    int threadNum;
+    int nThreads;
+  };
+
+  long long _fileId;
+  vector<Var *> _vars;
+  map<string, Var *> _varMap;
+
+  static void *_decodeThreadEntry(void *args);
+  void _decodeShare(int threadNum, int nThreads);
+  bool _decodeChunk(Var &var, Chunk &chunk);
+
+  // the vars are owned, so no copying
+
+  Cf2ChunkReader(const Cf2ChunkReader &);
+  Cf2ChunkReader &operator=(const Cf2ChunkReader &);
+
+};
+
+#endif
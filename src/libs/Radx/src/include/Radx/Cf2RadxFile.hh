@@ -49,6 +49,7 @@
 #include <Radx/RadxRemap.hh>
 #include <Radx/RadxTime.hh>
 #include <Radx/RadxGeoref.hh>
+#include <Radx/Cf2ChunkReader.hh>
 #include <Ncxx/Ncxx.hh>
 
 class RadxField;
@@ -131,6 +132,45 @@ public:
 
   //@}
 
+  //////////////////////////////////////////////////////////////
+  /// \name Streaming write:
+  //@{
+  
+  /// Open a file for streaming write. This allows sweeps to be
+  /// appended as they are completed, so that the whole volume
+  /// need not be held in memory.
+  ///
+  /// The volume-level metadata - radar parameters, calibrations,
+  /// location, global attributes etc. - is copied from vol, which
+  /// need not contain any rays.
+  ///
+  /// Returns 0 on success, -1 on failure
+  
+  int openStreamWrite(const RadxVol &vol, const string &path);
+
+  /// Append the sweeps in vol to the open stream, as sweep groups.
+  /// Normally vol will contain a single completed sweep.
+  ///
+  /// Returns 0 on success, -1 on failure.
+  /// On failure the stream is closed and the file removed.
+  
+  int writeSweepsToStream(const RadxVol &vol);
+
+  /// Complete the streaming write. The root-level metadata is
+  /// added, and the file is closed and renamed to the path
+  /// given in openStreamWrite().
+  ///
+  /// Returns 0 on success, -1 on failure
+  /// Use getPathInUse() for path to which the data was written.
+
+  int closeStreamWrite();
+
+  /// Check if a streaming write is in progress
+
+  bool isStreamOpen() const { return _streamVol != NULL; }
+
+  //@}
+
   //////////////////////////////////////////////////////////////
   /// \name Perform the read:
   //@{
@@ -179,6 +219,8 @@ private:
   // volume for writing
   
   const RadxVol *_writeVol; ///< volume from which data is written
+  time_t _writeStartTimeSecs; ///< reference for ray times on write
+  RadxVol *_streamVol; ///< metadata and sweeps for streaming write
   
   // format version
 
@@ -276,6 +318,7 @@ private:
   // storing sweep information
 
   vector<string> _sweepGroupNames;
+  vector<double> _sweepGroupFixedAngles;
   vector<NcxxGroup> _sweepGroups;
   NcxxGroup _sweepGroup;
   vector<RadxSweep *> _sweeps;
@@ -293,6 +336,10 @@ private:
   vector<SweepInfo> _sweepsToRead;
   vector<RadxRay *> _sweepRays;
 
+  // multi-threaded field reads
+
+  Cf2ChunkReader _chunkReader;
+
   // ray meta data arrays
 
   vector<double> _rayAzimuths;
@@ -415,6 +462,7 @@ private:
   void _createSweepRays(const RadxSweep *sweep);
 
   void _readFieldVariables(bool metaOnly);
+  void _prefetchFieldData();
   
   NcxxVar _readRayVar(NcxxGroup &group, NcxxDim &dim, const string &name, 
                       vector<double> &vals, bool required = true);
@@ -490,7 +538,11 @@ private:
 
   // writing
 
+  int _addRootGroup();
   void _addSweeps();
+  void _addSweepGroup(const RadxSweep *sweep, size_t groupIndex);
+  void _addSweepGroupIndex();
+  void _abortStreamWrite();
 
   void _addSweepAttributes(const RadxSweep *sweep,
                            NcxxGroup &sweepGroup);
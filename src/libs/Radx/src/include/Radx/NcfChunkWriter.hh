@@ -0,0 +1,155 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+/////////////////////////////////////////////////////////////
+// NcfChunkWriter.hh
+///////////////////////////////////////////////////////////////
+//
+// Multi-threaded compression of field variables for NetCDF4
+// files.
+//
+// For compressed output, most of the write time is spent in
+// deflate. The NetCDF and HDF5 libraries are not safe for
+// concurrent use, so the write is split into three phases:
+//
+//   (a) the variables are defined in the file through NetCDF in
+//       the normal way, with deflate and explicit chunking, but
+//       the data is not written; instead it is added to this
+//       object, which splits it into chunks;
+//   (b) the chunks are compressed on multiple threads, using
+//       zlib directly;
+//   (c) after the NetCDF file is closed, it is opened through
+//       HDF5 and the compressed chunks are written serially,
+//       using HDF5 direct chunk writes.
+//
+// The resulting file is identical in structure to one written
+// through NetCDF with the same chunking and deflate level.
+//
+///////////////////////////////////////////////////////////////
+
+#ifndef NcfChunkWriter_HH
+#define NcfChunkWriter_HH
+
+#include <string>
+#include <vector>
+using namespace std;
+
+class NcfChunkWriter {
+
+public:
+
+  NcfChunkWriter();
+  ~NcfChunkWriter();
+
+  /// Is direct chunk writing supported by the HDF5 library
+  /// we are built against? If not, data must be written
+  /// through NetCDF.
+
+  static bool isSupported();
+
+  /// Compute suitable chunk dimensions for a variable.
+  /// Chunks span all columns, and as many rows as will fit
+  /// in about 1 MByte. For 1-D variables, set nCols to 1.
+
+  static void computeChunkDims(size_t nRows, size_t nCols,
+                               size_t elemSize,
+                               size_t &chunkRows, size_t &chunkCols);
+
+  /// Add a variable to be written.
+  ///
+  ///   datasetPath: full path in the file, e.g. /DBZ
+  ///   data: row-major data, copied into the chunks
+  ///   elemSize: size of each element, in bytes
+  ///   nRows, nCols: dimensions - for 1-D variables, set nCols to 0
+  ///   chunkRows, chunkCols: chunk dimensions, as defined for the
+  ///     variable in the file - for 1-D, chunkCols is ignored
+
+  void addVar(const string &datasetPath,
+              const void *data, size_t elemSize,
+              size_t nRows, size_t nCols,
+              size_t chunkRows, size_t chunkCols);
+
+  /// Compress the chunks for all variables, using nThreads.
+  /// Compression level is 1 through 9, as for deflate.
+
+  void compress(int nThreads, int compressionLevel);
+
+  /// Write the compressed chunks to the file, which must
+  /// already contain the variables, and must be closed by NetCDF.
+  /// Returns 0 on success, -1 on failure.
+
+  int write(const string &path);
+
+  /// Free all data
+
+  void clear();
+
+  /// Get number of variables added
+
+  size_t getNVars() const { return _vars.size(); }
+
+  /// Get error string, set on write failure
+
+  const string &getErrStr() const { return _errStr; }
+
+private:
+
+  // a chunk - full size, padded at the edges
+
+  class Chunk {
+  public:
+    size_t row0;
+    size_t col0;
+    vector<unsigned char> data;
+    bool compressed;
+  };
+
+  // a variable with its chunks
+
+  class Var {
+  public:
+    string datasetPath;
+    int rank;
+    size_t elemSize;
+    vector<Chunk> chunks;
+  };
+
+  // compression task for a thread
+
+  class Task {
+  public:
+    NcfChunkWriter *writer;
+    int threadNum;
+    int nThreads;
+  };
+
+  vector<Var *> _vars;
+  int _compressionLevel;
+  string _errStr;
+
+  static void *_compressThreadEntry(void *args);
+  void _compressShare(int threadNum, int nThreads);
+  bool _compressChunk(Chunk &chunk);
+
+};
+
+#endif
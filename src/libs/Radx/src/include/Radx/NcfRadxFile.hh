@@ -49,6 +49,7 @@
 #include <Radx/RadxRemap.hh>
 #include <Radx/RadxTime.hh>
 #include <Radx/RadxGeoref.hh>
+#include <Radx/NcfChunkWriter.hh>
 #include <Ncxx/Nc3xFile.hh>
 
 class RadxField;
@@ -404,6 +405,10 @@ private:
 
   vector<string> _uniqueFieldNames;
 
+  // multi-threaded compression of fields on write
+
+  NcfChunkWriter _chunkWriter;
+
   // objects to be set on read
 
   string _title;
@@ -692,6 +697,9 @@ private:
   int _writeFieldVariables();
   Nc3Var *_createFieldVar(const RadxField &field);
   int _writeFieldVar(Nc3Var *var, RadxField *field);
+  bool _compressFieldsInParallel();
+  int _addFieldToChunkWriter(Nc3Var *var, RadxField *field);
+  int _writeCompressedChunks();
   int _closeOnError(const string &caller);
 
   int _setCompression(Nc3Var *var);
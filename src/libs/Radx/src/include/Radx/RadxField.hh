@@ -1095,6 +1095,7 @@ private:
   void _init();
   RadxField & _copy(const RadxField &rhs);
   void _setMissingToDefaults();
+  void _setMinMaxFromPacked(double minInt, double maxInt) const;
   void _remapDataNearest(const RadxRemap &remap);
   void _remapDataInterp(const RadxRemap &remap);
   void _printPacked(ostream &out, int count, double val) const;
@@ -0,0 +1,159 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+/////////////////////////////////////////////////////////////
+// RadxFieldKernels.hh
+///////////////////////////////////////////////////////////////
+//
+// Inner-loop kernels for converting and scanning field data.
+//
+// These are the gate loops used by RadxField for type conversion,
+// linear transforms and min/max computation. Each kernel has a
+// plain C++ implementation and, on x86 builds, an AVX2
+// implementation. The AVX2 path is selected at run time if the
+// CPU supports it, so a single binary runs on older hardware.
+//
+// The vector paths produce results identical to the scalar
+// paths: arithmetic is carried out in double precision, in the
+// same order, without fused multiply-add.
+//
+///////////////////////////////////////////////////////////////
+
+#ifndef RadxFieldKernels_HH
+#define RadxFieldKernels_HH
+
+#include <Radx/Radx.hh>
+#include <cstddef>
+
+class RadxFieldKernels {
+
+public:
+
+  /// Check whether the AVX2 kernels are in use.
+  /// True if the CPU supports AVX2 and SIMD has not been disabled.
+
+  static bool simdActive() { return _useSimd && _hasAvx2; }
+
+  /// Enable or disable the SIMD kernels.
+  /// Enabled by default. Disabling is mainly useful for testing
+  /// and benchmarking against the scalar code.
+
+  static void setUseSimd(bool state) { _useSimd = state; }
+
+  /// \name Conversion to fl32.
+  /// Missing input values are set to outMiss.
+  /// Other values are converted as (val * scale + offset).
+  //@{
+
+  static void fl64ToFl32(const Radx::fl64 *in, Radx::fl32 *out, size_t nn,
+                         Radx::fl64 inMiss, Radx::fl32 outMiss);
+
+  static void si32ToFl32(const Radx::si32 *in, Radx::fl32 *out, size_t nn,
+                         Radx::si32 inMiss, Radx::fl32 outMiss,
+                         double scale, double offset);
+
+  static void si16ToFl32(const Radx::si16 *in, Radx::fl32 *out, size_t nn,
+                         Radx::si16 inMiss, Radx::fl32 outMiss,
+                         double scale, double offset);
+
+  static void si08ToFl32(const Radx::si08 *in, Radx::fl32 *out, size_t nn,
+                         Radx::si08 inMiss, Radx::fl32 outMiss,
+                         double scale, double offset);
+
+  //@}
+
+  /// \name Conversion from fl32 to scaled integers.
+  /// Values are packed as floor((val - offset) / scale + 0.5).
+  /// Missing input values, and values outside the valid range
+  /// for the output type, are set to outMiss.
+  //@{
+
+  static void fl32ToSi32(const Radx::fl32 *in, Radx::si32 *out, size_t nn,
+                         Radx::fl32 inMiss, Radx::si32 outMiss,
+                         double scale, double offset);
+
+  static void fl32ToSi16(const Radx::fl32 *in, Radx::si16 *out, size_t nn,
+                         Radx::fl32 inMiss, Radx::si16 outMiss,
+                         double scale, double offset);
+
+  static void fl32ToSi08(const Radx::fl32 *in, Radx::si08 *out, size_t nn,
+                         Radx::fl32 inMiss, Radx::si08 outMiss,
+                         double scale, double offset);
+
+  //@}
+
+  /// \name Min and max of non-missing values.
+  /// NaNs are ignored. If no values are found, minVal is set to
+  /// +infinity and maxVal to -infinity.
+  /// Returns the number of non-missing values examined.
+  //@{
+
+  static size_t minMaxFl64(const Radx::fl64 *in, size_t nn,
+                           Radx::fl64 miss,
+                           double &minVal, double &maxVal);
+
+  static size_t minMaxFl32(const Radx::fl32 *in, size_t nn,
+                           Radx::fl32 miss,
+                           double &minVal, double &maxVal);
+
+  /// For integer types the min and max are returned unscaled.
+
+  static size_t minMaxSi32(const Radx::si32 *in, size_t nn,
+                           Radx::si32 miss,
+                           Radx::si32 &minVal, Radx::si32 &maxVal);
+
+  static size_t minMaxSi16(const Radx::si16 *in, size_t nn,
+                           Radx::si16 miss,
+                           Radx::si16 &minVal, Radx::si16 &maxVal);
+
+  static size_t minMaxSi08(const Radx::si08 *in, size_t nn,
+                           Radx::si08 miss,
+                           Radx::si08 &minVal, Radx::si08 &maxVal);
+
+  //@}
+
+  /// \name In-place transforms on fl32 data, skipping missing values.
+  //@{
+
+  /// Transform val to (val * scale + offset).
+
+  static void linearTransformFl32(Radx::fl32 *data, size_t nn,
+                                  Radx::fl32 miss,
+                                  double scale, double offset);
+  
+  /// Transform from dB to linear: val to 10^(val/10).
+
+  static void dbToLinearFl32(Radx::fl32 *data, size_t nn,
+                             Radx::fl32 miss);
+
+  //@}
+
+private:
+
+  static bool _useSimd;
+  static bool _hasAvx2; // set once at load time
+
+  static bool _checkAvx2();
+
+};
+
+#endif
@@ -260,6 +260,19 @@ public:
   void setCompressionLevel(int level) {
     _compressionLevel = level;
   }
+
+  /// Set the number of threads to use for compressing field data
+  /// on write.
+  ///
+  /// Currently applies to CfRadial files in NetCDF4 format. The
+  /// fields are compressed concurrently, and the compressed chunks
+  /// are then written to the file serially.
+  ///
+  /// Defaults to 1.
+
+  void setWriteNThreads(int val) {
+    _writeNThreads = (val < 1 ? 1 : val);
+  }
   
   /// Set to write latest_data_info on write
   
@@ -596,6 +609,13 @@ public:
 
   void setReadTimesOnly(bool val);
 
+  /// Set the number of threads to use for reading and decoding
+  /// field data. Currently used by the CfRadial2 reader, which
+  /// decompresses the fields in each sweep concurrently.
+  /// Defaults to 1.
+
+  void setReadNThreads(int val);
+
   /// Set radar number to be read in.
   /// Only applies to file formats with data from more than 1 radar
   /// in a file.
@@ -896,6 +916,7 @@ protected:
   bool _readRemoveShortRange; ///< remove short range scans on read
   bool _readMetadataOnly; ///< only read sweep metadata, not rays
   bool _readTimesOnly; ///< only read start and end times
+  int _readNThreads; ///< number of threads for reading field data
   int _readSetRadarNum; ///< set the radar number, for files with more
                         ///< than 1 radar, e.g. HRD files
   int _readRadarNum; ///< radar number - see setRadarNum
@@ -926,6 +947,7 @@ protected:
   bool _writeIndividualSweeps; ///< write individual sweeps, if applicable
   bool _writeCompressed; ///< write out compressed? CfRadial only
   int _compressionLevel; ///< write compression level
+  int _writeNThreads; ///< number of threads for compression on write
   bool _writeLdataInfo; ///< write latest_data_info on write
   
   ///< Use 'proposed_standard_name' instead of 'standard_name' in CfRadial files
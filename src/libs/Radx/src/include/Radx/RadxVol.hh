@@ -150,6 +150,13 @@ public:
 
   void setDebug(bool val);
 
+  /// Set the number of threads used for data type conversions.
+  /// Fields are independent, so convertToFl32(), convertToSi16() etc.
+  /// can convert several fields concurrently.
+  /// Default is 1, i.e. single threaded.
+
+  void setNThreadsConvert(int val) { _nThreadsConvert = (val < 1 ? 1 : val); }
+
   /// Set the volume version, if available. Use this for the project name.
 
   void setVersion(const string &val) { _version = val; }
@@ -1693,6 +1700,35 @@ private:
 
   bool _debug;
 
+  // threading for data type conversions
+
+  int _nThreadsConvert;
+
+  typedef enum {
+    CONVERT_FL64,
+    CONVERT_FL32,
+    CONVERT_SI32,
+    CONVERT_SI16,
+    CONVERT_SI08,
+    CONVERT_SI32_SCALED,
+    CONVERT_SI16_SCALED,
+    CONVERT_SI08_SCALED,
+    CONVERT_TYPE
+  } convert_op_t;
+
+  class ConvertJob {
+  public:
+    RadxVol *vol;
+    convert_op_t op;
+    double scale;
+    double offset;
+    Radx::DataType_t dataType;
+    bool useRays;
+    size_t nItems;
+    int threadNum;
+    int nThreads;
+  };
+
   // class for keeping track of the geometry of the rays and
   // remapping data onto a common geometry
 
@@ -1856,6 +1892,12 @@ private:
   void _init();
   RadxVol & _copy(const RadxVol &rhs);
 
+  void _convertFields(convert_op_t op,
+                      double scale = 1.0, double offset = 0.0,
+                      Radx::DataType_t dataType = Radx::FL32);
+  void _convertItems(const ConvertJob &job);
+  static void *_convertThreadEntry(void *args);
+
   void _adjustSweepLimitsPpi();
   void _adjustSweepLimitsRhi();
 
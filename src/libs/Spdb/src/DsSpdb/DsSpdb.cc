@@ -178,6 +178,9 @@ void DsSpdb::setLimitsInMsg(DsSpdbMsg &msg)
   if (_vertLimitsSet) {
     msg.setVertLimits(_minHt, _maxHt);
   }
+  if (_getBboxSet) {
+    msg.setBboxFilter(_getMinLat, _getMinLon, _getMaxLat, _getMaxLon);
+  }
 
 }  
 
@@ -1210,6 +1213,14 @@ int DsSpdb::doMsgGet(const DsSpdbMsg &inMsg, DsSpdbMsg::info_t &getInfo)
     clearVertLimits();
   }
 
+  if (inMsg.bboxFilterSet()) {
+    const DsSpdbMsg::horiz_limits_t &bbox = inMsg.getBboxFilter();
+    setGetBoundingBox(bbox.min_lat, bbox.min_lon,
+                      bbox.max_lat, bbox.max_lon);
+  } else {
+    clearGetBoundingBox();
+  }
+
   // perform the get specified by the mode
 
   switch (inMsg.getMode()) {
@@ -59,8 +59,10 @@ DsSpdbMsg::DsSpdbMsg(memModel_t mem_model /* = CopyMem */ ) :
   MEM_zero(_info2);
   MEM_zero(_horizLimits);
   MEM_zero(_vertLimits);
+  MEM_zero(_bboxFilter);
   _horizLimitsSet = false;
   _vertLimitsSet = false;
+  _bboxFilterSet = false;
   clearData();
 }
 
@@ -930,6 +932,12 @@ int DsSpdbMsg::disassemble(const void *in_msg, ssize_t msg_len,
     BE_to_array_32(&_vertLimits, sizeof(_vertLimits));
     _vertLimitsSet = true;
   }
+  if (partExists(DS_SPDB_BBOX_FILTER_PART)) {
+    memcpy(&_bboxFilter, getPartByType(DS_SPDB_BBOX_FILTER_PART)->getBuf(),
+	   sizeof(horiz_limits_t));
+    BE_to_array_32(&_bboxFilter, sizeof(_bboxFilter));
+    _bboxFilterSet = true;
+  }
   if (partExists(DS_SPDB_CHUNK_REF_PART)) {
     DsMsgPart *part = getPartByType(DS_SPDB_CHUNK_REF_PART);
     const void *buf = part->getBuf();
@@ -1214,6 +1222,13 @@ void DsSpdbMsg::print(ostream &out, const char *spacer) const
         out << spacer << "    Min ht: " << _vertLimits.min_ht << endl;
         out << spacer << "    Max ht: " << _vertLimits.max_ht << endl;
       }
+      if (_bboxFilterSet) {
+        out << spacer << "  Bbox filter:" << endl;
+        out << spacer << "    Min lat: " << _bboxFilter.min_lat << endl;
+        out << spacer << "    Min lon: " << _bboxFilter.min_lon << endl;
+        out << spacer << "    Max lat: " << _bboxFilter.max_lat << endl;
+        out << spacer << "    Max lon: " << _bboxFilter.max_lon << endl;
+      }
       break;
       
     case DS_SPDB_GET_RETURN:
@@ -1338,6 +1353,14 @@ void *DsSpdbMsg::_assembleGet(const mode_enum_t request_mode)
     addPart(DS_SPDB_VERT_LIMITS_PART, sizeof(vlimits), &vlimits);
   }
 
+  // bounding box filter
+
+  if (_bboxFilterSet) {
+    horiz_limits_t bbox = _bboxFilter;
+    BE_from_array_32(&bbox, sizeof(bbox));
+    addPart(DS_SPDB_BBOX_FILTER_PART, sizeof(bbox), &bbox);
+  }
+
   // assemble
   
   void *msg = DsMessage::assemble();
@@ -1462,6 +1485,31 @@ void DsSpdbMsg::clearHorizLimits()
   _horizLimitsSet = false;
 }
 
+/////////////////////////////////////
+// set or clear bounding box filter
+//
+// If set, the server only returns chunks whose stored
+// bounding box overlaps this box.
+  
+void DsSpdbMsg::setBboxFilter(double min_lat,
+                              double min_lon,
+                              double max_lat,
+                              double max_lon)
+  
+{
+  _bboxFilter.min_lat = min_lat;
+  _bboxFilter.min_lon = min_lon;
+  _bboxFilter.max_lat = max_lat;
+  _bboxFilter.max_lon = max_lon;
+  _bboxFilterSet = true;
+}
+
+void DsSpdbMsg::clearBboxFilter()
+  
+{
+  _bboxFilterSet = false;
+}
+
 ///////////////////////////////
 // set or clear vertical limits
 //
@@ -1601,6 +1649,8 @@ string DsSpdbMsg::part2Str(int part)
       return "DS_SPDB_AUX_REF_PART";
     case DS_SPDB_AUX_XML_PART:
       return "DS_SPDB_AUX_XML_PART";
+    case DS_SPDB_BBOX_FILTER_PART:
+      return "DS_SPDB_BBOX_FILTER_PART";
     default:
       return "UNKNOWN"; 
   }
@@ -1634,6 +1684,8 @@ DsSpdbMsg &DsSpdbMsg::_copy(const DsSpdbMsg &rhs)
   _vertLimits = rhs._vertLimits;
   _horizLimitsSet = rhs._horizLimitsSet;
   _vertLimitsSet = rhs._vertLimitsSet;
+  _bboxFilter = rhs._bboxFilter;
+  _bboxFilterSet = rhs._bboxFilterSet;
   _refBuf = rhs._refBuf;
   _auxBuf = rhs._auxBuf;
   _dataBuf = rhs._dataBuf;
@@ -53,6 +53,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <cerrno>
+#include <cmath>
 #include <sys/stat.h>
 #include <set>
 using namespace std;
@@ -64,6 +65,18 @@ int Spdb::_fileMinorVersion = 1;
 const char *Spdb::_indxExt = "indx";
 const char *Spdb::_dataExt = "data";
 
+// compact the index log once it reaches this number of entries,
+// or a quarter of the number of chunks if that is larger
+
+const int Spdb::_indxLogMinCompact = 1000;
+
+// on get, reads of chunks in the data file are merged if the gap
+// between them is at most _readCoalesceGap, up to a total read
+// of _readCoalesceMax bytes
+
+const int Spdb::_readCoalesceGap = 65536;
+const int Spdb::_readCoalesceMax = 4194304;
+
 ////////////////////////////////////////////////////////////
 // Constructor
 
@@ -76,9 +89,24 @@ Spdb::Spdb() :
         _respectZeroTypes(false),
         _enableDefrag(false),
         _getUnique(UniqueOff),
+
+        _indxLog(false),
+        _indxLogOnDisk(false),
+        _indxFullWrite(false),
+        _refsLoaded(false),
+        _nIndxLog(0),
+        _indxLogEnd(0),
+        _readCacheStart(0),
+        _readCacheEnd(0),
+
         _nGetChunks(0),
         _checkWriteTimeOnGet(false),
         _latestValidWriteTime(0),
+        _getBboxSet(false),
+        _getMinLat(0),
+        _getMinLon(0),
+        _getMaxLat(0),
+        _getMaxLon(0),
 
         _putMode(putModeOver),
         _nPutChunks(0),
@@ -111,6 +139,11 @@ Spdb::Spdb() :
   MEM_zero(_lockPath);
   MEM_zero(_hdr);
 
+  char *log_str = getenv("SPDB_INDEX_LOG");
+  if (log_str && STRequal(log_str, "true")) {
+    _indxLog = true;
+  }
+
 }
 
 ////////////////////////////////////////////////////////////
@@ -292,6 +325,106 @@ void Spdb::addPutChunk(int data_type,
 
 }
 
+//////////////////////////////////////////////
+// Set the lat/lon bounding box of the chunk most
+// recently added with addPutChunk().
+// The box is stored in the aux ref, rounded outwards to
+// 0.01 deg, and is used to filter gets.
+
+void Spdb::setPutChunkBoundingBox(double min_lat, double min_lon,
+                                  double max_lat, double max_lon)
+
+{
+
+  if (_nPutChunks < 1) {
+    return;
+  }
+
+  // lats are constrained to -90 to 90
+
+  int minLat = (int) floor(MAX(min_lat, -90.0) * SPDB_AUX_BBOX_SCALE);
+  int maxLat = (int) ceil(MIN(max_lat, 90.0) * SPDB_AUX_BBOX_SCALE);
+
+  // min lon is stored in the range -180 to 180, along with
+  // the width, so that boxes may cross the date line
+
+  double width = max_lon - min_lon;
+  if (width < 0) {
+    width += 360.0;
+  }
+  width = MIN(width, 360.0);
+  while (min_lon >= 180.0) {
+    min_lon -= 360.0;
+  }
+  while (min_lon < -180.0) {
+    min_lon += 360.0;
+  }
+  int minLon = (int) floor(min_lon * SPDB_AUX_BBOX_SCALE);
+  int lonWidth = (int) ceil(width * SPDB_AUX_BBOX_SCALE) + 1;
+  lonWidth = MIN(lonWidth, (int) (360 * SPDB_AUX_BBOX_SCALE));
+
+  aux_ref_t *aux = (aux_ref_t *) _putAuxBuf.getPtr() + _nPutChunks - 1;
+  aux->spares[0] = SPDB_AUX_BBOX_FLAG;
+  aux->spares[1] = ((ui32) (ui16) minLat << 16) | (ui16) maxLat;
+  aux->spares[2] = ((ui32) (ui16) minLon << 16) | (ui16) lonWidth;
+
+}
+
+//////////////////////////////////////////////
+// Get the bounding box stored in an aux ref.
+// Returns true if the chunk has a bounding box,
+// false otherwise.
+
+bool Spdb::getChunkBoundingBox(const aux_ref_t &aux,
+                               double &min_lat, double &min_lon,
+                               double &max_lat, double &max_lon)
+
+{
+
+  if (aux.spares[0] != SPDB_AUX_BBOX_FLAG) {
+    return false;
+  }
+
+  min_lat = (si16) (aux.spares[1] >> 16) / SPDB_AUX_BBOX_SCALE;
+  max_lat = (si16) (aux.spares[1] & 0xffff) / SPDB_AUX_BBOX_SCALE;
+  min_lon = (si16) (aux.spares[2] >> 16) / SPDB_AUX_BBOX_SCALE;
+  max_lon = min_lon + (ui16) (aux.spares[2] & 0xffff) / SPDB_AUX_BBOX_SCALE;
+
+  return true;
+
+}
+
+//////////////////////////////////////////////
+// Set the bounding box for filtering on get.
+
+void Spdb::setGetBoundingBox(double min_lat, double min_lon,
+                             double max_lat, double max_lon)
+
+{
+
+  // store max_lon >= min_lon, with min_lon in the range
+  // -180 to 180 - wrapping is handled in _acceptBbox()
+
+  if (max_lon < min_lon) {
+    max_lon += 360.0;
+  }
+  while (min_lon >= 180.0) {
+    min_lon -= 360.0;
+    max_lon -= 360.0;
+  }
+  while (min_lon < -180.0) {
+    min_lon += 360.0;
+    max_lon += 360.0;
+  }
+
+  _getMinLat = min_lat;
+  _getMinLon = min_lon;
+  _getMaxLat = max_lat;
+  _getMaxLon = max_lon;
+  _getBboxSet = true;
+
+}
+
 //////////////////////////////////////////////
 // Add an array of chunks to the chunk buffers
 // Note - it is preferable to use addPutChunk
@@ -975,22 +1108,35 @@ int Spdb::_put(int prod_id,
   chunk_ref_t *ref = (chunk_ref_t *) _putRefBuf.getPtr();
   aux_ref_t *aux = (aux_ref_t *) _putAuxBuf.getPtr();
   
+  // in index log mode, adding chunks does not need the existing refs
+
+  bool readRefs = !(_indxLog && _putMode == putModeAdd);
+
   for (int i = 0; i < _nPutChunks; i++, ref++, aux++) {
-    
+
     // check files are open for correct day
-    
+
     validTime = ref->valid_time;
     latestValidTime = MAX(validTime, latestValidTime);
     maxDataType = MAX(maxDataType, ref->data_type);
     maxDataType2 = MAX(maxDataType2, ref->data_type2);
 
-    if (_checkOpen(prod_id, prod_label, validTime, WriteMode)) {
+    if (_checkOpen(prod_id, prod_label, validTime, WriteMode, readRefs)) {
       _errStr += "ERROR - Spdb::put\n";
       _addStrErr("  Cannot open files for chunk in dir: ", _dir);
       _addStrErr("  Valid Time: ", utimstr(validTime));
       return -1;
     }
 
+    // an index without a log must be rewritten, so needs the refs
+
+    if (!_refsLoaded && !_indxLogOnDisk && _loadChunkRefs()) {
+      _errStr += "ERROR - Spdb::put\n";
+      _addStrErr("  Cannot read chunk refs in dir: ", _dir);
+      _closeFiles(false);
+      return -1;
+    }
+
     void *chunk = (char *) chunkData + ref->offset;
 
     if (_storeChunk(ref, aux, chunk)) {
@@ -1633,15 +1779,16 @@ int Spdb::_getInterval(time_t start_time,
 
     if (posn >= 0) {
       
+      // find the chunks required, so that the reads can be coalesced
+
+      vector<int> posns;
       for (int i = posn; i < _hdr.n_chunks; i++) {
 	
 	if ((time_t) fileRefs[i].valid_time <= time2) {
 	  
-          if (_checkTypeThenReadChunk(data_type, data_type2,
-                                      fileRefs[i], fileAuxs[i],
-                                      readBuf)) {
-            _closeFiles();
-            return -1;
+          if (_acceptRef(data_type, data_type2, fileRefs[i], fileAuxs[i]) &&
+              _acceptBbox(fileAuxs[i])) {
+            posns.push_back(i);
           }
 
 	} else {
@@ -1652,6 +1799,11 @@ int Spdb::_getInterval(time_t start_time,
 	
       } // i
 
+      if (_readChunksCoalesced(posns, readBuf)) {
+        _closeFiles();
+        return -1;
+      }
+
     } // if (posn >= 0)
     _closeFiles();
 
@@ -1729,22 +1881,28 @@ int Spdb::_getValid(time_t request_time,
 
     if (posn >= 0) {
       
+      // find the chunks required, so that the reads can be coalesced
+
+      vector<int> posns;
       for (int i = posn; i < _hdr.n_chunks; i++) {
 	
 	if ((time_t) fileRefs[i].valid_time <= request_time &&
 	    (time_t) fileRefs[i].expire_time >= request_time) {
 
-          if (_checkTypeThenReadChunk(data_type, data_type2,
-                                      fileRefs[i], fileAuxs[i],
-                                      readBuf)) {
-            _closeFiles();
-            return -1;
+          if (_acceptRef(data_type, data_type2, fileRefs[i], fileAuxs[i]) &&
+              _acceptBbox(fileAuxs[i])) {
+            posns.push_back(i);
           }
 
 	} // if (fileRefs[i].valid_time <= request_time ...
 	
       } // i
 
+      if (_readChunksCoalesced(posns, readBuf)) {
+        _closeFiles();
+        return -1;
+      }
+
     } // if (posn >= 0)
     
     _closeFiles();
@@ -2074,9 +2232,18 @@ int Spdb::_openFiles(int prod_id,
   RapDataDir.fillPath(_dir, _path);
 
   // close files if open
-  
+
   _closeFiles();
 
+  // reset index log state
+
+  _refsLoaded = false;
+  _indxLogOnDisk = false;
+  _indxFullWrite = false;
+  _nIndxLog = 0;
+  _indxLogEnd = 0;
+  _indxLogBuf.free();
+
   // make directory if needed
   
   if (mode == WriteMode) {
@@ -2286,8 +2453,33 @@ int Spdb::_openReadWrite(int prod_id,
     _leadTimeStorage = (lead_time_storage_t) _hdr.lead_time_storage;
   }
   
+  // the index may have a log following the aux refs
+
+  _indxLogOnDisk = (_hdr.spares[0] == SPDB_INDX_LOG_MAGIC);
+  _indxLogEnd = sizeof(header_t) +
+    _hdr.n_chunks * (sizeof(chunk_ref_t) + sizeof(aux_ref_t));
+
   if (read_chunk_refs) {
-    _readChunkRefs();
+
+    if (_loadChunkRefs()) {
+      _closeFiles(false);
+      return -1;
+    }
+
+  } else if (_indxLogOnDisk) {
+
+    // log not read, count the entries for compaction.
+    // If the file size does not fit the header and whole entries,
+    // or the last entry is not valid, read the refs and log instead,
+    // so that the next append follows the last good entry.
+
+    if (_countIndxLog()) {
+      if (_loadChunkRefs()) {
+        _closeFiles(false);
+        return -1;
+      }
+    }
+
   }
 
   return 0;
@@ -2338,6 +2530,7 @@ int Spdb::_openCreate(int prod_id,
   // initialize header
   
   _initHdr(prod_id, prod_label, valid_time);
+  _refsLoaded = true;
 
   if (_writeIndxFile()) {
     _closeFiles(false);
@@ -2438,22 +2631,44 @@ void Spdb::_closeFiles(bool sync /* = true*/ )
     return;
   }
 
+  _clearReadCache();
+
   if (sync && _openMode == WriteMode) {
-    
-    // defrag if necessary
 
-    if (_enableDefrag && _defrag()) {
-      _errStr += "ERROR - Spdb::_closeFiles\n";
+    // in index log mode, append the new refs to the log, unless
+    // the index must be rewritten or the log is due for compaction
+
+    bool appendLog = (_indxLog && _indxLogOnDisk && !_indxFullWrite);
+    if (appendLog && _compactIndxLog()) {
+      appendLog = false;
     }
-    
-    // write index file
-    
-    if (_indxFile != NULL) {
-      if (_writeIndxFile()) {
-	_errStr += "ERROR - Spdb::_closeFiles\n";
-	_errStr += "  Cannot write indx file.\n";
-	_addStrErr("  Product label: ", _hdr.prod_label);
+
+    if (appendLog) {
+
+      if (_indxFile != NULL && _appendIndxLog()) {
+        _errStr += "ERROR - Spdb::_closeFiles\n";
+        _errStr += "  Cannot append to indx log.\n";
+        _addStrErr("  Product label: ", _hdr.prod_label);
+      }
+
+    } else {
+
+      // defrag if necessary
+
+      if (_enableDefrag && _defrag()) {
+        _errStr += "ERROR - Spdb::_closeFiles\n";
+      }
+
+      // write index file
+
+      if (_indxFile != NULL) {
+        if (_writeIndxFile()) {
+          _errStr += "ERROR - Spdb::_closeFiles\n";
+          _errStr += "  Cannot write indx file.\n";
+          _addStrErr("  Product label: ", _hdr.prod_label);
+        }
       }
+
     }
 
   } // if (sync && _openMode == WriteMode)
@@ -2483,6 +2698,13 @@ void Spdb::_closeFiles(bool sync /* = true*/ )
 int Spdb::_writeIndxFile(bool write_refs /* = true*/ )
 {
 
+  // a full write compacts any index log - flag whether
+  // a log may follow
+
+  if (write_refs) {
+    _hdr.spares[0] = (_indxLog ? SPDB_INDX_LOG_MAGIC : 0);
+  }
+
   // copy header and put into BE order
   
   header_t tmp_hdr = _hdr;
@@ -2535,7 +2757,27 @@ int Spdb::_writeIndxFile(bool write_refs /* = true*/ )
   // Flush the index file stream to make sure the data is written.
 
   fflush(_indxFile);
-  
+
+  // remove any previous log
+
+  if (write_refs) {
+    long indxLen = sizeof(header_t) +
+      _hdr.n_chunks * (sizeof(chunk_ref_t) + sizeof(aux_ref_t));
+    if (ftruncate(_indxFd, indxLen)) {
+      int errNum = errno;
+      _errStr += "ERROR - Spdb::_writeIndxFile\n";
+      _addStrErr("  Product: ", _hdr.prod_label);
+      _errStr += "  Cannot truncate indx file.\n";
+      _addStrErr("  _indxPath: ", strerror(errNum));
+      return -1;
+    }
+    _indxLogOnDisk = _indxLog;
+    _indxFullWrite = false;
+    _nIndxLog = 0;
+    _indxLogEnd = indxLen;
+    _indxLogBuf.free();
+  }
+
   return 0;
 
 }
@@ -3118,7 +3360,8 @@ int Spdb::_getFirstTimeAfter(time_t request_time,
       for (int i = posn; i < _hdr.n_chunks; i++, ref++) {
 	if ((time_t) ref->valid_time >= search_time &&
 	    (time_t) ref->valid_time <= end_time &&
-	    _acceptRef(data_type, data_type2, *ref, *aux)) {
+	    _acceptRef(data_type, data_type2, *ref, *aux) &&
+            _acceptBbox(*aux)) {
 	  data_time = ref->valid_time;
 	  return 0;
 	} else if ((time_t) ref->valid_time > end_time) {
@@ -3213,7 +3456,8 @@ int Spdb::_getFirstTimeBefore(time_t request_time,
       for (int i = posn_ahead; i >= 0; i--, ref--) {
 	if ((time_t) ref->valid_time <= search_time &&
 	    (time_t) ref->valid_time >= start_time &&
-	    _acceptRef(data_type, data_type2, *ref, *aux)) {
+	    _acceptRef(data_type, data_type2, *ref, *aux) &&
+            _acceptBbox(*aux)) {
 	  data_time = ref->valid_time;
 	  return 0;
 	} else if ((time_t) ref->valid_time < start_time) {
@@ -3438,6 +3682,330 @@ void Spdb::_readChunkRefs()
   
 }
 
+////////////////////////////////////////////////////
+// _loadChunkRefs()
+//
+// Read in the chunk refs, and merge any index log.
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_loadChunkRefs()
+
+{
+
+  if (fseek(_indxFile, sizeof(header_t), SEEK_SET)) {
+    int errNum = errno;
+    _errStr += "ERROR - Spdb::_loadChunkRefs\n";
+    _addStrErr("  Product: ", _hdr.prod_label);
+    _errStr += "  Cannot seek to chunk refs.\n";
+    _addStrErr("  _indxPath: ", strerror(errNum));
+    return -1;
+  }
+
+  _readChunkRefs();
+
+  _nIndxLog = 0;
+  _indxLogEnd = sizeof(header_t) +
+    _hdr.n_chunks * (sizeof(chunk_ref_t) + sizeof(aux_ref_t));
+  if (_indxLogOnDisk) {
+    _readIndxLog();
+  }
+
+  _refsLoaded = true;
+  return 0;
+
+}
+
+////////////////////////////////////////////////////
+// _readIndxLog()
+//
+// Read the index log following the aux refs, and merge the
+// entries into the chunk refs. Reading stops at the first
+// incomplete or corrupt entry - this is overwritten by the
+// next append.
+//
+// Returns the number of entries merged.
+
+int Spdb::_readIndxLog()
+
+{
+
+  if (fseek(_indxFile, _indxLogEnd, SEEK_SET)) {
+    return 0;
+  }
+
+  indx_log_entry_t entry;
+  while (ta_fread(&entry, sizeof(entry), 1, _indxFile) == 1) {
+    BE_to_array_32(&entry, 4 * sizeof(si32));
+    chunk_refs_from_BE(&entry.ref, 1);
+    aux_refs_from_BE(&entry.aux, 1);
+    if (entry.magic != SPDB_INDX_LOG_MAGIC ||
+        entry.check != _indxLogCheck(entry)) {
+      break;
+    }
+    if (_applyIndxLogEntry(entry)) {
+      break;
+    }
+    _nIndxLog++;
+    _indxLogEnd += sizeof(entry);
+  }
+
+  return _nIndxLog;
+
+}
+
+////////////////////////////////////////////////////
+// _countIndxLog()
+//
+// Count the index log entries from the index file size,
+// without reading the log.
+//
+// Returns 0 on success, -1 if the size is not consistent with
+// the header chunk count and a whole number of entries, or the
+// last entry is not valid.
+
+int Spdb::_countIndxLog()
+
+{
+
+  struct stat indxStat;
+  if (fstat(_indxFd, &indxStat)) {
+    return -1;
+  }
+
+  if (indxStat.st_size < _indxLogEnd) {
+    return -1;
+  }
+  off_t logLen = indxStat.st_size - _indxLogEnd;
+  if (logLen % sizeof(indx_log_entry_t) != 0) {
+    return -1;
+  }
+  int nEntries = logLen / sizeof(indx_log_entry_t);
+  if (nEntries == 0) {
+    return 0;
+  }
+
+  // check the last entry, in case it was not completely written
+
+  indx_log_entry_t entry;
+  off_t lastOffset = indxStat.st_size - sizeof(entry);
+  if (pread(_indxFd, &entry, sizeof(entry), lastOffset) !=
+      (ssize_t) sizeof(entry)) {
+    return -1;
+  }
+  BE_to_array_32(&entry, 4 * sizeof(si32));
+  chunk_refs_from_BE(&entry.ref, 1);
+  aux_refs_from_BE(&entry.aux, 1);
+  if (entry.magic != SPDB_INDX_LOG_MAGIC ||
+      entry.check != _indxLogCheck(entry)) {
+    return -1;
+  }
+
+  _nIndxLog = nEntries;
+  _indxLogEnd += logLen;
+  return 0;
+
+}
+
+////////////////////////////////////////////////////
+// _addIndxLogEntry()
+//
+// Add an entry to the index log buffer, for writing
+// when the files are closed.
+
+void Spdb::_addIndxLogEntry(indx_log_op_t op, int posn,
+                            const chunk_ref_t &ref,
+                            const aux_ref_t &aux)
+
+{
+
+  indx_log_entry_t entry;
+  MEM_zero(entry);
+  entry.magic = SPDB_INDX_LOG_MAGIC;
+  entry.op = op;
+  entry.posn = posn;
+  entry.ref = ref;
+  entry.aux = aux;
+  entry.check = _indxLogCheck(entry);
+
+  BE_from_array_32(&entry, 4 * sizeof(si32));
+  chunk_refs_to_BE(&entry.ref, 1);
+  aux_refs_to_BE(&entry.aux, 1);
+  _indxLogBuf.add(&entry, sizeof(entry));
+
+}
+
+////////////////////////////////////////////////////
+// _applyIndxLogEntry()
+//
+// Apply an index log entry to the chunk refs and header,
+// in the same way as _storeChunk().
+//
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_applyIndxLogEntry(const indx_log_entry_t &entry)
+
+{
+
+  const chunk_ref_t &inref = entry.ref;
+
+  if (entry.op == INDX_LOG_ADD) {
+
+    _addChunkRef(inref, entry.aux);
+
+  } else if (entry.op == INDX_LOG_OVER) {
+
+    if (entry.posn < 0 || entry.posn >= _hdr.n_chunks) {
+      return -1;
+    }
+
+    chunk_ref_t *existRef = (chunk_ref_t *) _hdrRefBuf.getPtr() + entry.posn;
+    if (existRef->len >= inref.len) {
+      int nfrag = existRef->len - inref.len;
+      _hdr.nbytes_frag += nfrag;
+      _hdr.nbytes_data -= nfrag;
+    } else {
+      _hdr.nbytes_frag += existRef->len;
+      _hdr.nbytes_data -= existRef->len;
+    }
+
+    *existRef = inref;
+    aux_ref_t *aux = (aux_ref_t *) _hdrAuxBuf.getPtr() + entry.posn;
+    *aux = entry.aux;
+
+  } else {
+
+    return -1;
+
+  }
+
+  _updateHdrTimes(inref);
+  return 0;
+
+}
+
+////////////////////////////////////////////////////
+// _appendIndxLog()
+//
+// Append the pending entries to the index log.
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_appendIndxLog()
+
+{
+
+  size_t nbytes = _indxLogBuf.getLen();
+  if (nbytes == 0) {
+    return 0;
+  }
+
+  fseek(_indxFile, _indxLogEnd, SEEK_SET);
+
+  if (ta_fwrite(_indxLogBuf.getPtr(), 1, nbytes, _indxFile) != nbytes) {
+    int errNum = errno;
+    _errStr += "ERROR - Spdb::_appendIndxLog\n";
+    _addStrErr("  Product: ", _hdr.prod_label);
+    _errStr += "  Cannot write indx log.\n";
+    _addStrErr("  _indxPath: ", strerror(errNum));
+    return -1;
+  }
+  fflush(_indxFile);
+
+  _nIndxLog += nbytes / sizeof(indx_log_entry_t);
+  _indxLogEnd += nbytes;
+  _indxLogBuf.free();
+
+  return 0;
+
+}
+
+////////////////////////////////////////////////////
+// _compactIndxLog()
+//
+// Check whether the index log is due for compaction.
+// If so, and the refs have not been read in, read them
+// and merge the pending log entries, ready for the index
+// file to be rewritten.
+//
+// Returns true if the index should be rewritten.
+
+bool Spdb::_compactIndxLog()
+
+{
+
+  int nPending = _indxLogBuf.getLen() / sizeof(indx_log_entry_t);
+  int nCompact = MAX(_indxLogMinCompact, _hdr.n_chunks / 4);
+  if (_nIndxLog + nPending < nCompact) {
+    return false;
+  }
+
+  if (_refsLoaded) {
+    return true;
+  }
+
+  if (_loadChunkRefs()) {
+    return false;
+  }
+
+  const indx_log_entry_t *pending =
+    (const indx_log_entry_t *) _indxLogBuf.getPtr();
+  for (int ii = 0; ii < nPending; ii++) {
+    indx_log_entry_t entry = pending[ii];
+    BE_to_array_32(&entry, 4 * sizeof(si32));
+    chunk_refs_from_BE(&entry.ref, 1);
+    aux_refs_from_BE(&entry.aux, 1);
+    _applyIndxLogEntry(entry);
+  }
+
+  return true;
+
+}
+
+////////////////////////////////////////////////////
+// _indxLogCheck()
+//
+// Compute the check value for an index log entry.
+// The aux tag is not included.
+
+si32 Spdb::_indxLogCheck(const indx_log_entry_t &entry)
+
+{
+
+  ui32 sum = entry.op + entry.posn;
+  const ui32 *word = (const ui32 *) &entry.ref;
+  for (size_t ii = 0; ii < sizeof(chunk_ref_t) / sizeof(ui32); ii++) {
+    sum += word[ii];
+  }
+  word = (const ui32 *) &entry.aux;
+  for (size_t ii = 0; ii < (sizeof(aux_ref_t) - TAG_LEN) / sizeof(ui32); ii++) {
+    sum += word[ii];
+  }
+  return (si32) sum;
+
+}
+
+////////////////////////////////////////////////////
+// _updateHdrTimes()
+//
+// Keep the header stats up to date for a stored chunk.
+
+void Spdb::_updateHdrTimes(const chunk_ref_t &ref)
+
+{
+
+  _hdr.max_duration =
+    MAX(_hdr.max_duration,
+        ((time_t) ref.expire_time - (time_t) ref.valid_time));
+  _hdr.start_valid =
+    MIN(((time_t) _hdr.start_valid), ((time_t) ref.valid_time));
+  _hdr.end_valid =
+    MAX(((time_t) _hdr.end_valid), ((time_t) ref.valid_time));
+  _hdr.latest_expire =
+    MAX(((time_t) _hdr.latest_expire), ((time_t) ref.expire_time));
+  _hdr.earliest_valid =
+    MIN(((time_t) _hdr.earliest_valid), ((time_t) ref.valid_time));
+
+}
+
 /////////////////////////////////////////////////
 // do the chunk read if the data type is correct
 // Appends to the ref, aux and data buffers, and
@@ -3454,10 +4022,28 @@ int Spdb::_checkTypeThenReadChunk(int data_type,
 
   // check the data types are acceptable
 
-  if (!_acceptRef(data_type, data_type2, ref, aux)) {
+  if (!_acceptRef(data_type, data_type2, ref, aux) ||
+      !_acceptBbox(aux)) {
     return 0;
   }
-    
+
+  return _addGetChunk(ref, aux, readBuf);
+
+}
+
+/////////////////////////////////////////////////
+// add a chunk to the get buffers, reading the
+// data if required
+// Appends to the ref, aux and data buffers, and
+// updates the _nGetChunks counter
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_addGetChunk(const chunk_ref_t &ref,
+                       const aux_ref_t &aux,
+                       MemBuf &readBuf)
+  
+{
+
   // copy the references
   
   chunk_ref_t refCopy(ref);
@@ -3505,6 +4091,109 @@ int Spdb::_checkTypeThenReadChunk(int data_type,
   
 }
       
+/////////////////////////////////////////////////
+// _readChunksCoalesced()
+//
+// Add the chunks at the given index posns to the get
+// buffers, in order. The data types have already been
+// checked.
+//
+// Chunks which are close together in the data file are
+// read in a single block, so that a long interval does
+// not need a seek and read for every chunk.
+//
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_readChunksCoalesced(const vector<int> &posns,
+                               MemBuf &readBuf)
+  
+{
+
+  const chunk_ref_t *fileRefs = (chunk_ref_t *) _hdrRefBuf.getPtr();
+  const aux_ref_t *fileAuxs = (aux_ref_t *) _hdrAuxBuf.getPtr();
+
+  for (size_t ii = 0; ii < posns.size(); ii++) {
+
+    const chunk_ref_t &ref = fileRefs[posns[ii]];
+    if (!_getRefsOnly &&
+        ((long) ref.offset < _readCacheStart ||
+         (long) ref.offset + (long) ref.len > _readCacheEnd)) {
+      _fillReadCache(posns, ii);
+    }
+
+    if (_addGetChunk(ref, fileAuxs[posns[ii]], readBuf)) {
+      _clearReadCache();
+      return -1;
+    }
+
+  } // ii
+
+  _clearReadCache();
+  return 0;
+  
+}
+
+/////////////////////////////////////////////////
+// _fillReadCache()
+//
+// Read the block of the data file starting at the chunk
+// for posns[index], and extending over the following chunks
+// while they are stored close together in the file.
+//
+// If the block would only hold the one chunk, or the read
+// fails, the cache is left empty and _readChunk() reads
+// the chunk directly.
+
+void Spdb::_fillReadCache(const vector<int> &posns, size_t index)
+  
+{
+
+  _readCache.reset();
+  _readCacheStart = 0;
+  _readCacheEnd = 0;
+
+  const chunk_ref_t *fileRefs = (chunk_ref_t *) _hdrRefBuf.getPtr();
+  const chunk_ref_t &first = fileRefs[posns[index]];
+  long start = first.offset;
+  long end = start + first.len;
+
+  for (size_t ii = index + 1; ii < posns.size(); ii++) {
+    const chunk_ref_t &ref = fileRefs[posns[ii]];
+    long refEnd = (long) ref.offset + (long) ref.len;
+    if ((long) ref.offset < start ||
+        (long) ref.offset > end + _readCoalesceGap ||
+        refEnd - start > _readCoalesceMax) {
+      break;
+    }
+    end = MAX(end, refEnd);
+  }
+
+  if (end - start <= (long) first.len) {
+    return;
+  }
+
+  void *block = _readCache.reserve(end - start);
+  if (fseek(_dataFile, start, SEEK_SET) < 0 ||
+      (long) ta_fread(block, 1, end - start, _dataFile) != end - start) {
+    return;
+  }
+
+  _readCacheStart = start;
+  _readCacheEnd = end;
+
+}
+
+/////////////////////////////////////////////////
+// _clearReadCache()
+
+void Spdb::_clearReadCache()
+  
+{
+  _readCache.free();
+  _readCacheStart = 0;
+  _readCacheEnd = 0;
+}
+
 //////////////////////////////////////////
 // _readChunk()
 //
@@ -3525,27 +4214,41 @@ int Spdb::_readChunk(chunk_ref_t &ref,
   
   void *chunk = readBuf.reserve(ref.len);
   
-  // seek to offset
+  if (_readCacheEnd > _readCacheStart &&
+      (long) ref.offset >= _readCacheStart &&
+      (long) ref.offset + (long) ref.len <= _readCacheEnd) {
+
+    // chunk is in the block already read
+
+    memcpy(chunk,
+           (char *) _readCache.getPtr() + (ref.offset - _readCacheStart),
+           ref.len);
+
+  } else {
+
+    // seek to offset
   
-  if (fseek(_dataFile, ref.offset, SEEK_SET) < 0) {
-    int errNum = errno;
-    _errStr += "ERROR - Spdb::_readChunk\n";
-    _addStrErr(" Prod label: ", _hdr.prod_label);
-    _addIntErr(" Cannot seek to data offset: ", ref.offset);
-    _addStrErr(_dataPath, strerror(errNum));
-    return -1;
-  }
+    if (fseek(_dataFile, ref.offset, SEEK_SET) < 0) {
+      int errNum = errno;
+      _errStr += "ERROR - Spdb::_readChunk\n";
+      _addStrErr(" Prod label: ", _hdr.prod_label);
+      _addIntErr(" Cannot seek to data offset: ", ref.offset);
+      _addStrErr(_dataPath, strerror(errNum));
+      return -1;
+    }
   
-  // read data
+    // read data
   
-  if ((ui32) ta_fread(chunk, 1, ref.len, _dataFile) != ref.len) {
-    int errNum = errno;
-    _errStr += "ERROR - Spdb::_readChunk\n";
-    _addStrErr(" Prod label: ", _hdr.prod_label);
-    _addIntErr(" Cannot read chunk of len: ", ref.len);
-    _addIntErr(" Data offset: ", ref.offset);
-    _addStrErr(_dataPath, strerror(errNum));
-    return -1;
+    if ((ui32) ta_fread(chunk, 1, ref.len, _dataFile) != ref.len) {
+      int errNum = errno;
+      _errStr += "ERROR - Spdb::_readChunk\n";
+      _addStrErr(" Prod label: ", _hdr.prod_label);
+      _addIntErr(" Cannot read chunk of len: ", ref.len);
+      _addIntErr(" Data offset: ", ref.offset);
+      _addStrErr(_dataPath, strerror(errNum));
+      return -1;
+    }
+
   }
 
   // uncompress chunk if it is compressed
@@ -3741,8 +4444,13 @@ int Spdb::_storeChunk(const chunk_ref_t *input_ref,
     return -1;
   }
   
-  if (new_ref) {
-    
+  if (!_refsLoaded) {
+
+    // index log mode, refs not read in - the chunk ref is
+    // merged from the log when the index is next read
+
+  } else if (new_ref) {
+
     // add chunk reference to list
 
     _addChunkRef(inref, inaux);
@@ -3759,19 +4467,19 @@ int Spdb::_storeChunk(const chunk_ref_t *input_ref,
 
   }
 
-  // keep stats up to date
-  
-  _hdr.max_duration =
-    MAX(_hdr.max_duration,
-	((time_t) inref.expire_time - (time_t) inref.valid_time));
-  _hdr.start_valid =
-    MIN(((time_t) _hdr.start_valid), ((time_t) inref.valid_time));
-  _hdr.end_valid = 
-    MAX(((time_t) _hdr.end_valid), ((time_t) inref.valid_time));
-  _hdr.latest_expire =
-    MAX(((time_t) _hdr.latest_expire), ((time_t) inref.expire_time));
-  _hdr.earliest_valid =
-    MIN(((time_t) _hdr.earliest_valid), ((time_t) inref.valid_time));
+  // index log mode - record the change in the log
+
+  if (_indxLog) {
+    _addIndxLogEntry(new_ref ? INDX_LOG_ADD : INDX_LOG_OVER,
+                     posn, inref, inaux);
+  }
+
+  // keep stats up to date - if the refs have not been read in,
+  // this is done when the log is merged
+
+  if (_refsLoaded) {
+    _updateHdrTimes(inref);
+  }
 
   _setEarliestValid(inref.valid_time,
 		    inref.expire_time);
@@ -3898,6 +4606,10 @@ int Spdb::_eraseChunks(time_t valid_time, int data_type, int data_type2)
     return -1;
   }
 
+  // erasures are not logged, so the index must be rewritten
+
+  _indxFullWrite = true;
+
   while (posn < _hdr.n_chunks) {
 
     chunk_ref_t *ref = (chunk_ref_t *) _hdrRefBuf.getPtr() + posn;
@@ -4207,6 +4919,7 @@ int Spdb::_defrag()
 
   // set the headers and ref and aux buffers
 
+  _indxFullWrite = true;
   _hdr.nbytes_frag = 0;
   _hdrRefBuf = refBuf;
   _hdrAuxBuf = auxBuf;
@@ -4254,6 +4967,45 @@ bool Spdb::_acceptRef(int data_type,
 
 }
 
+///////////////////////////////////////////////////
+// _acceptBbox()
+//
+// Check the chunk bounding box, if any, against the
+// bounding box for gets.
+//
+// Returns true if the chunk is acceptable, false otherwise.
+
+bool Spdb::_acceptBbox(const aux_ref_t &aux) const
+
+{
+
+  if (!_getBboxSet) {
+    return true;
+  }
+
+  double minLat, minLon, maxLat, maxLon;
+  if (!getChunkBoundingBox(aux, minLat, minLon, maxLat, maxLon)) {
+    return true;
+  }
+
+  if (maxLat < _getMinLat || minLat > _getMaxLat) {
+    return false;
+  }
+
+  // both boxes have min lon in the range -180 to 180,
+  // so check for overlap allowing for wrapping
+
+  for (int ii = -1; ii <= 1; ii++) {
+    double offset = ii * 360.0;
+    if (maxLon + offset >= _getMinLon && minLon + offset <= _getMaxLon) {
+      return true;
+    }
+  }
+
+  return false;
+
+}
+
 ////////////////////
 // clear error string
 
@@ -78,6 +78,8 @@ public:
   //
   // Only relevant for get requests to servers which can interpret
   // the SPDB data spatially, e.g. the Symprod servers.
+  // To filter on the bounding boxes stored with the chunks, for
+  // local or served gets, see Spdb::setGetBoundingBox().
   
   void setHorizLimits(double min_lat,
 		      double min_lon,
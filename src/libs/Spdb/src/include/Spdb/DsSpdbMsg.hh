@@ -244,7 +244,8 @@ public:
     DS_SPDB_TIME_LIST_PART = 77508,
     DS_SPDB_APP_NAME_PART = 77509,
     DS_SPDB_AUX_REF_PART = 77510,
-    DS_SPDB_AUX_XML_PART = 77511
+    DS_SPDB_AUX_XML_PART = 77511,
+    DS_SPDB_BBOX_FILTER_PART = 77512
   } part_enum_t;
 
   ///////////////////
@@ -544,6 +545,21 @@ public:
 
   void clearHorizLimits();
 
+  /////////////////////////////////////
+  // set or clear bounding box filter
+  //
+  // If set, the server only returns chunks whose stored
+  // bounding box overlaps this box - see
+  // Spdb::setGetBoundingBox(). Servers which do not support
+  // this ignore it and return all chunks.
+  
+  void setBboxFilter(double min_lat,
+                     double min_lon,
+                     double max_lat,
+                     double max_lon);
+
+  void clearBboxFilter();
+
   ///////////////////////////////
   // set or clear vertical limits
   //
@@ -627,6 +643,11 @@ public:
   bool vertLimitsSet() const { return _vertLimitsSet; }
   const vert_limits_t &getVertLimits() const { return _vertLimits; }
 
+  // bounding box filter
+
+  bool bboxFilterSet() const { return _bboxFilterSet; }
+  const horiz_limits_t &getBboxFilter() const { return _bboxFilter; }
+
   // chunk references
 
   const Spdb::chunk_ref_t *getChunkRefs() const {
@@ -698,6 +719,9 @@ private:
   bool _horizLimitsSet;
   bool _vertLimitsSet;
 
+  horiz_limits_t _bboxFilter;
+  bool _bboxFilterSet;
+
   // chunk refs and data
 
   MemBuf _refBuf;
@@ -64,6 +64,19 @@
 // chunk data is stored as it is passed to the library. The calling
 // program must make sure the chunks are in BE format.
 //
+// Index log mode.
+//
+// Normally the whole index file is rewritten on every put, so
+// for products with many chunks per day the cost of each put
+// grows with the number of chunks already stored. In index log
+// mode, refs for new chunks are appended to the index file as
+// log entries following the aux refs, and the index is compacted
+// (rewritten) once the log grows past a fraction of the stored
+// refs. When reading, the log is merged into the refs.
+// Files without a log are read as before. Readers built before
+// index log mode was added ignore the log, and so only see the
+// chunks stored up to the last compaction.
+//
 ////////////////////////////////////////////////////////////////
 
 #ifndef Spdb_HH
@@ -228,6 +241,25 @@ public:
 		    const chunk_ref_t *chunk_refs,
 		    const void *chunk_data);
 
+  //////////////////////////////////////////////
+  // Set the lat/lon bounding box of the chunk most
+  // recently added with addPutChunk().
+  // The box is stored in the aux ref, rounded outwards to
+  // 0.01 deg, and is used to filter gets - see
+  // setGetBoundingBox().
+
+  void setPutChunkBoundingBox(double min_lat, double min_lon,
+                              double max_lat, double max_lon);
+
+  //////////////////////////////////////////////
+  // Get the bounding box stored in an aux ref.
+  // Returns true if the chunk has a bounding box,
+  // false otherwise.
+
+  static bool getChunkBoundingBox(const aux_ref_t &aux,
+                                  double &min_lat, double &min_lon,
+                                  double &max_lat, double &max_lon);
+
   
   //////////////////////////////////////////////
   // Set respect_zero_types on put.
@@ -255,6 +287,21 @@ public:
     _enableDefrag = state;
   }
 
+  //////////////////////////////////////////////
+  // Enable index log mode on put.
+  // Off by default, unless the environment variable
+  // SPDB_INDEX_LOG is set to "true".
+  // If true, refs for new chunks are appended to the index
+  // file, and the index is only rewritten periodically.
+  // In putModeAdd the existing refs are not read either, so
+  // the cost of a put does not depend on the number of chunks
+  // already stored for the day.
+  // See the notes at the top of this file.
+
+  void setIndexLog(bool state = true) {
+    _indxLog = state;
+  }
+
   ///////////////////////
   // number of put chunks
 
@@ -517,6 +564,23 @@ public:
     _latestValidWriteTime = 0;
   }
 
+  /////////////////////////////////////////////////////////
+  // Option to filter on bounding box on get.
+  // If set, chunks stored with a bounding box (see
+  // setPutChunkBoundingBox()) are only returned if their box
+  // overlaps the requested box - the data for other chunks
+  // is not read. Chunks stored without a bounding box are
+  // always returned.
+  // Longitudes may be in the range -180 to 180 or 0 to 360.
+  // If max_lon < min_lon, the box crosses the date line.
+
+  void setGetBoundingBox(double min_lat, double min_lon,
+                         double max_lat, double max_lon);
+
+  void clearGetBoundingBox() {
+    _getBboxSet = false;
+  }
+
   ////////////////////////////////////////////////////////////
   // get the first, last and last_valid_time in the data base
   // Use getFirstTime(), getLastTime() and getLastValidTime()
@@ -736,6 +800,9 @@ public:
   static int _fileMinorVersion;
   static const char *_indxExt;
   static const char *_dataExt;
+  static const int _indxLogMinCompact;
+  static const int _readCoalesceGap;
+  static const int _readCoalesceMax;
   
   // name of application
   
@@ -766,6 +833,24 @@ public:
   bool _respectZeroTypes;
   bool _enableDefrag;
   get_unique_t _getUnique;
+
+  // index log mode
+
+  bool _indxLog;         // append refs to the index log on put
+  bool _indxLogOnDisk;   // index file on disk may contain a log
+  bool _indxFullWrite;   // change not in the log, rewrite index
+  bool _refsLoaded;      // refs read in and log merged
+  int _nIndxLog;         // number of log entries on disk
+  long _indxLogEnd;      // offset of end of log in index file
+  MemBuf _indxLogBuf;    // log entries pending write, BE order
+
+  // coalesced reads - block of the data file read in a single
+  // read, covering a run of chunks to be returned by a get
+
+  MemBuf _readCache;
+  long _readCacheStart;  // offset of the block in the data file
+  long _readCacheEnd;
+
   int _nGetChunks;
   MemBuf _getRefBuf;  // buffer for chunk refs for gets
   MemBuf _getAuxBuf;  // buffer for aux refs for gets
@@ -780,6 +865,11 @@ public:
   
   bool _checkWriteTimeOnGet;
   time_t _latestValidWriteTime;
+
+  // Option to filter on bounding box on get.
+
+  bool _getBboxSet;
+  double _getMinLat, _getMinLon, _getMaxLat, _getMaxLon;
   
   // put attributes
   
@@ -970,11 +1060,44 @@ public:
 
   void _readChunkRefs();
 
+  int _loadChunkRefs();
+
+  int _readIndxLog();
+
+  int _countIndxLog();
+
+  void _addIndxLogEntry(indx_log_op_t op, int posn,
+                        const chunk_ref_t &ref,
+                        const aux_ref_t &aux);
+
+  int _applyIndxLogEntry(const indx_log_entry_t &entry);
+
+  int _appendIndxLog();
+
+  bool _compactIndxLog();
+
+  static si32 _indxLogCheck(const indx_log_entry_t &entry);
+
+  void _updateHdrTimes(const chunk_ref_t &ref);
+
+  bool _acceptBbox(const aux_ref_t &aux) const;
+
   int _checkTypeThenReadChunk(int data_type,
                               int data_type2,
                               const chunk_ref_t &ref,
                               const aux_ref_t &aux,
                               MemBuf &readBuf);
+
+  int _addGetChunk(const chunk_ref_t &ref,
+                   const aux_ref_t &aux,
+                   MemBuf &readBuf);
+
+  int _readChunksCoalesced(const vector<int> &posns,
+                           MemBuf &readBuf);
+
+  void _fillReadCache(const vector<int> &posns, size_t index);
+
+  void _clearReadCache();
  
   int _readChunk(chunk_ref_t &ref, aux_ref_t &aux,
                  MemBuf &buf, bool doUncompress);
@@ -153,9 +153,50 @@ typedef struct {
   ui32 compression;
   ui32 spares[4];
   char tag[TAG_LEN];
-  
+
 } aux_ref_t;
 
+// index log
+//
+// In index log mode (see Spdb::setIndexLog()), refs for chunks
+// stored since the index was last compacted are appended to the
+// index file as log entries, following the aux refs, instead of
+// rewriting the whole index on every put.
+//
+// header.spares[0] is set to SPDB_INDX_LOG_MAGIC if the index
+// file may contain log entries.
+
+#define SPDB_INDX_LOG_MAGIC 0x53504c47 // "SPLG"
+
+typedef enum {
+  INDX_LOG_ADD = 1,  // new chunk ref
+  INDX_LOG_OVER = 2  // replaces the ref at posn
+} indx_log_op_t;
+
+typedef struct {
+
+  si32 magic;        // SPDB_INDX_LOG_MAGIC
+  si32 op;           // indx_log_op_t
+  si32 posn;         // ref posn, for INDX_LOG_OVER
+  si32 check;        // sum of ref and aux words, host byte order
+  chunk_ref_t ref;
+  aux_ref_t aux;
+
+} indx_log_entry_t;
+
+// chunk bounding box
+//
+// A chunk may have a lat/lon bounding box stored in the aux ref
+// spares - see Spdb::setPutChunkBoundingBox(). If so:
+//   spares[0] is SPDB_AUX_BBOX_FLAG
+//   spares[1] holds min_lat (upper 16 bits) and max_lat (lower 16 bits)
+//   spares[2] holds min_lon (upper 16 bits) and the lon width (lower 16 bits)
+// Lats and min_lon are si16, the lon width ui16, all in units
+// of 1 / SPDB_AUX_BBOX_SCALE deg. min_lon is in the range -180 to 180.
+
+#define SPDB_AUX_BBOX_FLAG 0x53504242 // "SPBB"
+#define SPDB_AUX_BBOX_SCALE 100.0
+
 // chunk class
 
 class chunk_t {
@@ -54,6 +54,8 @@
 //                      Default is true.
 //  LDATA_FMQ_NSLOTS -  number of slots in fmq.
 //                      Default is 256.
+//  LDATA_NOTIFY -      if 'false', readBlocking() polls instead of
+//                      waiting on inotify events. Default is true.
 //
 /////////////////////////////////////////////////////////////////////
 
@@ -62,6 +64,13 @@
 #include <ctime>
 #include <cstdarg>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <sys/time.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#include <poll.h>
+#endif
 #include <didss/RapDataDir.hh>
 #include <didss/LdataInfo.hh>
 #include <didss/DataFileNames.hh>
@@ -165,6 +174,7 @@ LdataInfo &LdataInfo::copy(const LdataInfo &other)
   if (this == &other) {
     return *this;
   }
+  _closeNotify();
   _init(false, LDATA_INFO_FILE_NAME);
 
   _debug = other._debug;
@@ -186,6 +196,7 @@ LdataInfo &LdataInfo::copy(const LdataInfo &other)
   _notExistPrint = other._notExistPrint;
   _tooOldPrint = other._tooOldPrint;
   _notModifiedPrint = other._notModifiedPrint;
+  _useNotify = other._useNotify;
 
   _rapDataDir = other._rapDataDir;
   _dataDirPath = other._dataDirPath;
@@ -232,6 +243,7 @@ LdataInfo::~LdataInfo()
 {
   _closeReadFmq();
   _closeLockFile();
+  _closeNotify();
   if (_latestReadInfo != NULL) {
     delete _latestReadInfo;
   }
@@ -652,6 +664,9 @@ int LdataInfo::read(int max_valid_age /* = -1*/ )
 // sleep_msecs (millisecs):
 //   While in the polling state, the program sleeps for sleep_msecs
 //   millisecs at a time before checking again.
+//   If inotify is in use (see setUseNotify()), the program instead
+//   waits for up to sleep_msecs for the latest data info files
+//   to change, so it still checks every sleep_msecs.
 //
 //  heartbeat_func(): heartbeat function
 //    Just before sleeping each time, heartbeat_func() is called
@@ -670,11 +685,16 @@ void LdataInfo::readBlocking(int max_valid_age,
 
 {
 
+  // set up the watch before the first read, so that no
+  // change is missed
+
+  _openNotify();
+
   while (read(max_valid_age)) {
     if (heartbeat_func != NULL) {
       heartbeat_func("LdataInfo::readBlocking");
     }
-    umsleep(sleep_msecs);
+    _waitForChange(sleep_msecs);
   }
   return;
 
@@ -1296,6 +1316,9 @@ void LdataInfo::_init(bool debug, const char *file_name)
 
   _useFmq = true;
   _fmqReadOpen = false;
+  _useNotify = true;
+  _notifyFd = -1;
+  _notifyDirPath.clear();
   _readFmqFromStart = false;
   _bufFileSize = 0;
   _statFileSize = 0;
@@ -1304,6 +1327,11 @@ void LdataInfo::_init(bool debug, const char *file_name)
   if (fmq_str && STRequal(fmq_str, "false")) {
     _useFmq = false;
   }
+
+  char *notify_str = getenv("LDATA_NOTIFY");
+  if (notify_str && STRequal(notify_str, "false")) {
+    _useNotify = false;
+  }
   
   // get number of slots from environment variable if set
   // otherwise use default of LDATA_NSLOTS_DEFAULT
@@ -2002,6 +2030,199 @@ void LdataInfo::_closeReadFmq()
   }
 }
 
+////////////////////////////////////////////////////////////
+// _openNotify()
+//
+// Set up an inotify watch on the data directory, so that
+// readBlocking() can wait for the latest data info to change.
+// If the directory has changed, the watch is moved.
+//
+// Returns 0 on success, -1 if notification is not available.
+
+int LdataInfo::_openNotify()
+
+{
+
+#ifdef __linux__
+
+  if (!_useNotify) {
+    return -1;
+  }
+
+  if (_notifyFd >= 0) {
+    if (_notifyDirPath == _dataDirPath) {
+      return 0;
+    }
+    _closeNotify();
+  }
+
+  // directory may not exist yet - try again next time
+
+  struct statfs fsStat;
+  if (statfs(_dataDirPath.c_str(), &fsStat)) {
+    return -1;
+  }
+
+  // changes made on other hosts are not notified on
+  // network file systems, so poll instead
+
+  unsigned int fsType = (unsigned int) fsStat.f_type;
+  if (fsType == 0x6969 ||        // NFS
+      fsType == 0xFF534D42 ||    // CIFS
+      fsType == 0xFE534D42) {    // SMB2
+    if (_debug) {
+      cerr << "LdataInfo - network file system, polling dir: "
+           << _dataDirPath << endl;
+    }
+    _useNotify = false;
+    return -1;
+  }
+
+  int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0) {
+    _useNotify = false;
+    return -1;
+  }
+
+  if (inotify_add_watch(fd, _dataDirPath.c_str(),
+                        IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY |
+                        IN_CREATE | IN_DELETE_SELF | IN_MOVE_SELF) < 0) {
+    close(fd);
+    return -1;
+  }
+
+  _notifyFd = fd;
+  _notifyDirPath = _dataDirPath;
+  if (_debug) {
+    cerr << "LdataInfo - watching dir: " << _dataDirPath << endl;
+  }
+  return 0;
+
+#else
+
+  return -1;
+
+#endif
+
+}
+
+////////////////////////////////////////////////////////////
+// _closeNotify()
+
+void LdataInfo::_closeNotify()
+
+{
+  if (_notifyFd >= 0) {
+    close(_notifyFd);
+    _notifyFd = -1;
+  }
+  _notifyDirPath.clear();
+}
+
+////////////////////////////////////////////////////////////
+// _waitForChange()
+//
+// Wait for the latest data info files to change.
+// If inotify is not available, sleeps for sleep_msecs.
+// Otherwise waits for a change to the files, for up to
+// sleep_msecs, so that the caller's heartbeat is kept up.
+//
+// The writer updates several files in turn, so after a change
+// we wait until the files have been quiet for
+// LDATA_NOTIFY_QUIET_MSECS before returning, so that the
+// reader does not see a partial update. A busy writer is
+// waited for no longer than LDATA_NOTIFY_BUSY_MSECS.
+
+void LdataInfo::_waitForChange(int sleep_msecs)
+
+{
+
+#ifdef __linux__
+
+  if (_openNotify() == 0) {
+
+    int waitMsecs = sleep_msecs;
+    struct timeval start;
+    gettimeofday(&start, NULL);
+    bool infoChanged = false;
+    int changeMsecs = 0;
+
+    while (_notifyFd >= 0) {
+
+      struct timeval now;
+      gettimeofday(&now, NULL);
+      int elapsedMsecs = (now.tv_sec - start.tv_sec) * 1000 +
+        (now.tv_usec - start.tv_usec) / 1000;
+
+      int timeoutMsecs = waitMsecs - elapsedMsecs;
+      if (infoChanged) {
+        // do not wait indefinitely for a busy writer
+        if (elapsedMsecs - changeMsecs >= LDATA_NOTIFY_BUSY_MSECS) {
+          return;
+        }
+        timeoutMsecs = LDATA_NOTIFY_QUIET_MSECS;
+      } else if (timeoutMsecs <= 0) {
+        return;
+      }
+
+      struct pollfd pfd;
+      pfd.fd = _notifyFd;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+      if (poll(&pfd, 1, timeoutMsecs) <= 0) {
+        return;
+      }
+
+      // the change time is measured from when poll() returned,
+      // not from before the wait
+
+      gettimeofday(&now, NULL);
+      elapsedMsecs = (now.tv_sec - start.tv_sec) * 1000 +
+        (now.tv_usec - start.tv_usec) / 1000;
+
+      // drain the events, checking for changes to the
+      // latest data info files - other files may be written
+      // to the same directory
+
+      bool watchGone = false;
+      char buf[4096]
+        __attribute__ ((aligned(__alignof__(struct inotify_event))));
+      ssize_t len;
+      while ((len = ::read(_notifyFd, buf, sizeof(buf))) > 0) {
+        for (char *ptr = buf; ptr < buf + len; ) {
+          const struct inotify_event *event =
+            (const struct inotify_event *) ptr;
+          if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) {
+            // directory has gone, set up the watch again later
+            watchGone = true;
+          } else if (event->len > 0 &&
+                     strstr(event->name, _fileName.c_str()) != NULL) {
+            if (!infoChanged) {
+              infoChanged = true;
+              changeMsecs = elapsedMsecs;
+            }
+          }
+          ptr += sizeof(struct inotify_event) + event->len;
+        }
+      }
+
+      if (watchGone) {
+        _closeNotify();
+        return;
+      }
+
+    } // while
+
+    return;
+
+  }
+
+#endif
+
+  umsleep(sleep_msecs);
+
+}
+
 ////////////////////////////////
 // check files for reading
 //
@@ -57,6 +57,8 @@
 //                      Default is true.
 //  LDATA_FMQ_NSLOTS -  number of slots in fmq.
 //                      Default is 2500.
+//  LDATA_NOTIFY -      if 'false', readBlocking() polls instead of
+//                      waiting on inotify events. Default is true.
 //
 /////////////////////////////////////////////////////////////////////
 
@@ -82,6 +84,8 @@ using namespace std;
 
 #define LDATA_NSLOTS_DEFAULT 2500
 #define LDATA_BUFSIZE_PER_SLOT 500
+#define LDATA_NOTIFY_BUSY_MSECS 1000
+#define LDATA_NOTIFY_QUIET_MSECS 20
 
 class LdataInfo {
 
@@ -383,6 +387,27 @@ public:
   virtual void setUseXml(bool use_xml = true) { _useXml = use_xml; }
   virtual void setUseAscii(bool use_ascii = true) { _useAscii = use_ascii; }
 
+  //////////////////////////////////////
+  // Notify control
+  //
+  // On Linux, readBlocking() waits for inotify events on the
+  // latest data info files in the data directory, rather than
+  // sleeping for sleep_msecs between reads. It still checks,
+  // and calls the heartbeat function, every sleep_msecs, in case
+  // an event is missed. Once a change is seen, the read waits until
+  // the files have been quiet for LDATA_NOTIFY_QUIET_MSECS, so that
+  // a partial update by the writer is not read, but for no longer
+  // than LDATA_NOTIFY_BUSY_MSECS.
+  // Polling is used if inotify is not available, or if the
+  // directory is on a network file system, since changes
+  // made on other hosts are not notified.
+  //
+  // On by default.
+
+  virtual void setUseNotify(bool use_notify = true) {
+    _useNotify = use_notify;
+  }
+
   //////////////
   // print as XML
   //
@@ -712,6 +737,13 @@ protected:
   bool _fmqReadOpen;
   FMQ_handle_t _fmqReadHandle;
 
+  ////////////////////////////////////////////
+  // inotify state, for readBlocking()
+
+  bool _useNotify;
+  int _notifyFd;
+  string _notifyDirPath; // directory being watched
+
   ////////////////////
   // latest read state
 
@@ -793,6 +825,9 @@ protected:
   int _readFmq(int max_valid_age, bool &newData);
   int _openReadFmq(int max_valid_age);
   void _closeReadFmq();
+  int _openNotify();
+  void _closeNotify();
+  void _waitForChange(int sleep_msecs);
   void _checkFilesForReading(int max_valid_age,
 			     bool &useFmq, bool &useXml, bool &useAscii);
   int _makeDir() const;
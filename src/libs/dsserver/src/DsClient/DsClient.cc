@@ -37,8 +37,57 @@
 #include <dsserver/DsLocator.hh>
 #include <dsserver/DsServerMsg.hh>
 #include <toolsa/TaStr.hh>
+#include <toolsa/str.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <map>
+#include <set>
+#include <vector>
 using namespace std;
 
+// Cache of idle persistent connections, shared by all DsClient
+// objects in the process, keyed on host:port.
+// Also the servers which have refused persistent connections.
+
+typedef struct {
+  ThreadSocket *sock;
+  double idleSince;
+} idle_conn_t;
+
+static pthread_mutex_t _idleMutex = PTHREAD_MUTEX_INITIALIZER;
+static map<string, vector<idle_conn_t> > _idleConns;
+static set<string> _refusedKeys;
+static pid_t _idlePid = 0;
+static const size_t _maxIdlePerServer = 4;
+
+static double _timeNow()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1.0e6;
+}
+
+// check the cache belongs to this process - connections
+// inherited across a fork are not shared with the parent.
+// Must be called with the mutex locked.
+
+static void _checkIdlePid()
+{
+  pid_t pid = getpid();
+  if (pid == _idlePid) {
+    return;
+  }
+  map<string, vector<idle_conn_t> >::iterator ii;
+  for (ii = _idleConns.begin(); ii != _idleConns.end(); ii++) {
+    for (size_t jj = 0; jj < ii->second.size(); jj++) {
+      delete ii->second[jj].sock;
+    }
+  }
+  _idleConns.clear();
+  _idlePid = pid;
+}
+
 // constructor
 
 DsClient::DsClient()
@@ -47,6 +96,14 @@ DsClient::DsClient()
   _debug = false;
   _mergeDebugWithErrStr = false;
   _openTimeoutMsecs = -1;
+  _usePersistent = true;
+  _connSock = NULL;
+  _replySock = &_sock;
+  char *DS_PERSISTENT_CONNECTIONS = getenv("DS_PERSISTENT_CONNECTIONS");
+  if (DS_PERSISTENT_CONNECTIONS != NULL &&
+      STRequal(DS_PERSISTENT_CONNECTIONS, "false")) {
+    _usePersistent = false;
+  }
 }
 
 // destructor
@@ -54,7 +111,7 @@ DsClient::DsClient()
 DsClient::~DsClient()
 
 {
-
+  _releaseConnection();
 }
 
 // free up data which the socket object manages
@@ -62,6 +119,9 @@ DsClient::~DsClient()
 void DsClient::freeData()
 {
   _sock.freeData();
+  if (_connSock != NULL) {
+    _connSock->freeData();
+  }
 }
 
 ////////////////////////////////////////////////////
@@ -94,6 +154,10 @@ int DsClient::communicateAutoFwd(const DsURL &url,
     cerr << "-------------------------" << endl;
   }
 
+  // hand back any connection from a previous call
+  
+  _releaseConnection();
+
   // check for forwarding
   
   if (url.prepareForwarding("DsClient::communicateAutoFwd", msgLen)) {
@@ -233,6 +297,7 @@ void DsClient::_closeSocket()
 //
 // Open the server's socket, write the
 // request message, receive and disassemble the reply.
+// Uses a persistent connection if possible.
 //
 // Returns 0 on success, -1 on error
 
@@ -244,6 +309,15 @@ int DsClient::_communicateNoFwd(const DsURL &url,
   
 {
   
+  if (_usePersistent) {
+    int iret = _communicatePersistent(url, msgType, msgBuf, msgLen,
+                                      commTimeoutMsecs);
+    if (iret != -2) {
+      return iret;
+    }
+    // server does not support persistent connections
+  }
+
   if (_debug) {
     _writeDebug("------> _communicateNoFwd() opening socket");
   }
@@ -261,47 +335,165 @@ int DsClient::_communicateNoFwd(const DsURL &url,
     return -1;
   }
 
-  // write the message
+  // write the message and read the reply
+  
+  if (_writeAndRead(&_sock, url, msgType, msgBuf, msgLen,
+                    commTimeoutMsecs)) {
+    return -1;
+  }
   
+  _closeSocket();
+  return 0;
+
+}
+
+////////////////////////////////////////////
+// Communicate with server on a persistent
+// connection, reusing an idle one if available.
+//
+// Returns 0 on success, -1 on error,
+//        -2 if the server does not support persistent connections.
+
+int DsClient::_communicatePersistent(const DsURL &url,
+                                     int msgType,
+                                     const void *msgBuf,
+                                     ssize_t msgLen,
+                                     int commTimeoutMsecs)
+  
+{
+
+  char portStr[32];
+  sprintf(portStr, ":%d", url.getPort());
+  string key = url.getHost() + portStr;
+
+  // reuse an idle connection if there is one
+
+  ThreadSocket *sock = _takeIdleConnection(key);
+  if (sock != NULL) {
+    if (_debug) {
+      _writeDebug("------> _communicatePersistent() reusing connection");
+    }
+    string errStr = _errStr;
+    bool canRetry = false;
+    if (_writeAndRead(sock, url, msgType, msgBuf, msgLen,
+                      commTimeoutMsecs, &canRetry) == 0) {
+      _connSock = sock;
+      _connKey = key;
+      _replySock = sock;
+      return 0;
+    }
+    delete sock;
+    if (!canRetry) {
+      // the server may have acted on the request, so it
+      // must not be sent again
+      return -1;
+    }
+    // the server closed the idle connection without reading
+    // the request, try a new one
+    if (_debug) {
+      _writeDebug("------> _communicatePersistent() reuse failed");
+    }
+    _errStr = errStr;
+  }
+
+  if (_persistentRefused(key)) {
+    return -2;
+  }
+
+  // open a new connection, and ask the server to keep it open
+
   if (_debug) {
-    _writeDebug("------> _communicateNoFwd() writing message");
+    _writeDebug("------> _communicatePersistent() opening socket");
   }
   
-  if (_sock.writeMessage(msgType,
-			 msgBuf, msgLen, commTimeoutMsecs)) {
-    _errStr +=
-      "ERROR - COMM - DsClient::_communicateNoFwd _sock.writeMessage\n";
-    _errStr += "  Errors writing message to server.\n";
+  sock = new ThreadSocket;
+  if (sock->open(url.getHost().c_str(),
+                 url.getPort(),
+                 _openTimeoutMsecs)) {
+    _errStr += "ERROR - COMM - DsClient::_communicatePersistent open\n";
+    _errStr += "  Cannot connect to server\n";
     TaStr::AddStr(_errStr, "  host: ", url.getHost());
     TaStr::AddInt(_errStr, "  port: ", url.getPort());
     TaStr::AddStr(_errStr, "  url: ", url.getURLStr());
-    _errStr += _sock.getErrStr();
-    _closeSocket();
-    freeData();
+    _errStr += sock->getErrStr();
+    delete sock;
     return -1;
   }
+
+  sock->setNoDelay();
+  int iret = _requestPersistent(sock, key, commTimeoutMsecs);
+  if (iret) {
+    if (iret == -1) {
+      TaStr::AddStr(_errStr, "  url: ", url.getURLStr());
+    }
+    delete sock;
+    return iret;
+  }
   
-  // read the reply
+  if (_writeAndRead(sock, url, msgType, msgBuf, msgLen,
+                    commTimeoutMsecs)) {
+    delete sock;
+    return -1;
+  }
+
+  _connSock = sock;
+  _connKey = key;
+  _replySock = sock;
+  return 0;
+
+}
+
+////////////////////////////////////////////
+// Ask the server to keep the connection open.
+//
+// Returns 0 on success, -1 on error,
+//        -2 if the server did not accept.
+
+int DsClient::_requestPersistent(ThreadSocket *sock,
+                                 const string &key,
+                                 int commTimeoutMsecs)
   
+{
+
   if (_debug) {
-    _writeDebug("------> _communicateNoFwd() reading reply");
+    _writeDebug("------> _requestPersistent() writing request");
   }
 
-  if (_sock.readMessage(commTimeoutMsecs)) {
-    _errStr +=
-      "ERROR - COMM - DsClient::_communicateNoFwd _sock.readMessage\n";
-    _errStr += "  Cannot read reply from server.\n";
-    TaStr::AddStr(_errStr, "  host: ", url.getHost());
-    TaStr::AddInt(_errStr, "  port: ", url.getPort());
-    TaStr::AddStr(_errStr, "  url: ", url.getURLStr());
-    _errStr += _sock.getErrStr();
-    _closeSocket();
-    freeData();
+  DsServerMsg msg;
+  msg.setCategory(DsServerMsg::ServerStatus);
+  msg.setType(DsServerMsg::PERSISTENT_CONNECTION);
+  void *msgToSend = msg.assemble();
+  ssize_t msgLen = msg.lengthAssembled();
+
+  if (sock->writeMessage(0, msgToSend, msgLen, commTimeoutMsecs) ||
+      sock->readMessage(commTimeoutMsecs)) {
+    _errStr += "ERROR - COMM - DsClient::_requestPersistent\n";
+    _errStr += "  Cannot request persistent connection.\n";
+    _errStr += sock->getErrStr();
     return -1;
   }
-  
-  _closeSocket();
-  return 0;
+
+  DsServerMsg reply;
+  if (reply.decodeHeader(sock->getData(), sock->getNumBytes()) == 0 &&
+      reply.getMessageErr() == 0 &&
+      reply.getMessageCat() == DsServerMsg::ServerStatus &&
+      reply.getType() == DsServerMsg::PERSISTENT_CONNECTION) {
+    return 0;
+  }
+
+  // older servers do not know the command, and close the connection,
+  // so do not ask again. Other errors, e.g. SERVICE_DENIED, are
+  // left to the normal request.
+
+  int err = reply.getMessageErr();
+  if (err == (int) DsServerMsg::UNKNOWN_COMMAND ||
+      err == (int) DsServerMsg::NOT_SUPPORTED) {
+    _setPersistentRefused(key);
+  }
+  if (_debug) {
+    _writeDebug("------> _requestPersistent() not accepted");
+  }
+  return -2;
 
 }
 
@@ -452,6 +644,198 @@ int DsClient::_communicateFwd(const DsURL &url,
 
 }
 
+////////////////////////////////////////////
+// Write the request message and read the reply.
+// The socket is closed on error.
+//
+// If canRetry is not NULL, it is set on error to show whether
+// the request may safely be sent again on another connection:
+// true if the write failed, or the server closed the connection
+// before sending any of the reply.
+//
+// Returns 0 on success, -1 on error
+
+int DsClient::_writeAndRead(ThreadSocket *sock,
+                            const DsURL &url,
+                            int msgType,
+                            const void *msgBuf,
+                            ssize_t msgLen,
+                            int commTimeoutMsecs,
+                            bool *canRetry /* = NULL */)
+  
+{
+  
+  if (canRetry != NULL) {
+    *canRetry = false;
+  }
+  
+  // write the message
+  
+  if (_debug) {
+    _writeDebug("------> _communicateNoFwd() writing message");
+  }
+  
+  if (sock->writeMessage(msgType,
+                         msgBuf, msgLen, commTimeoutMsecs)) {
+    _errStr +=
+      "ERROR - COMM - DsClient::_communicateNoFwd _sock.writeMessage\n";
+    _errStr += "  Errors writing message to server.\n";
+    TaStr::AddStr(_errStr, "  host: ", url.getHost());
+    TaStr::AddInt(_errStr, "  port: ", url.getPort());
+    TaStr::AddStr(_errStr, "  url: ", url.getURLStr());
+    _errStr += sock->getErrStr();
+    sock->close();
+    sock->freeData();
+    if (canRetry != NULL) {
+      *canRetry = true;
+    }
+    return -1;
+  }
+  
+  // read the reply
+  
+  if (_debug) {
+    _writeDebug("------> _communicateNoFwd() reading reply");
+  }
+
+  // if the caller can retry, first check whether the server
+  // closed the connection without sending any of the reply
+
+  if (canRetry != NULL) {
+    char byte;
+    if (sock->peek(&byte, 1, commTimeoutMsecs)) {
+      _errStr +=
+        "ERROR - COMM - DsClient::_communicateNoFwd _sock.peek\n";
+      _errStr += "  No reply from server.\n";
+      TaStr::AddStr(_errStr, "  host: ", url.getHost());
+      TaStr::AddInt(_errStr, "  port: ", url.getPort());
+      TaStr::AddStr(_errStr, "  url: ", url.getURLStr());
+      _errStr += sock->getErrStr();
+      *canRetry = (sock->getErrNum() != SockUtil::TIMED_OUT &&
+                   sock->getNumBytes() == 0);
+      sock->close();
+      sock->freeData();
+      return -1;
+    }
+  }
+
+  if (sock->readMessage(commTimeoutMsecs)) {
+    _errStr +=
+      "ERROR - COMM - DsClient::_communicateNoFwd _sock.readMessage\n";
+    _errStr += "  Cannot read reply from server.\n";
+    TaStr::AddStr(_errStr, "  host: ", url.getHost());
+    TaStr::AddInt(_errStr, "  port: ", url.getPort());
+    TaStr::AddStr(_errStr, "  url: ", url.getURLStr());
+    _errStr += sock->getErrStr();
+    sock->close();
+    sock->freeData();
+    return -1;
+  }
+  
+  return 0;
+
+}
+
+////////////////////////////////////////////
+// Hand back the persistent connection in use,
+// for reuse by later requests.
+
+void DsClient::_releaseConnection()
+  
+{
+  
+  _replySock = &_sock;
+  if (_connSock == NULL) {
+    return;
+  }
+  _connSock->freeData();
+  _addIdleConnection(_connKey, _connSock);
+  _connSock = NULL;
+
+}
+
+////////////////////////////////////////////
+// Take an idle connection to the server from the cache.
+// Connections which have been idle too long, or which the
+// server has closed, are discarded.
+//
+// Returns NULL if none available.
+
+ThreadSocket *DsClient::_takeIdleConnection(const string &key)
+  
+{
+
+  ThreadSocket *sock = NULL;
+  double now = _timeNow();
+
+  pthread_mutex_lock(&_idleMutex);
+  _checkIdlePid();
+  vector<idle_conn_t> &conns = _idleConns[key];
+  while (conns.size() > 0) {
+    // most recently used first
+    idle_conn_t conn = conns.back();
+    conns.pop_back();
+    if ((now - conn.idleSince) * 1000.0 < DS_DEFAULT_CLIENT_IDLE_MSECS &&
+        conn.sock->readSelect(0) != 0 &&
+        conn.sock->getErrNum() == SockUtil::TIMED_OUT) {
+      // nothing to read, so the server has not closed it
+      conn.sock->removeState(SockUtil::STATE_ERROR);
+      sock = conn.sock;
+      break;
+    }
+    delete conn.sock;
+  }
+  pthread_mutex_unlock(&_idleMutex);
+
+  return sock;
+
+}
+
+////////////////////////////////////////////
+// Add an idle connection to the cache.
+
+void DsClient::_addIdleConnection(const string &key,
+                                  ThreadSocket *sock)
+  
+{
+
+  idle_conn_t conn;
+  conn.sock = sock;
+  conn.idleSince = _timeNow();
+
+  pthread_mutex_lock(&_idleMutex);
+  _checkIdlePid();
+  vector<idle_conn_t> &conns = _idleConns[key];
+  conns.push_back(conn);
+  if (conns.size() > _maxIdlePerServer) {
+    // close the oldest
+    delete conns.front().sock;
+    conns.erase(conns.begin());
+  }
+  pthread_mutex_unlock(&_idleMutex);
+
+}
+
+////////////////////////////////////////////
+// Has the server refused persistent connections?
+
+bool DsClient::_persistentRefused(const string &key)
+  
+{
+  pthread_mutex_lock(&_idleMutex);
+  bool refused = (_refusedKeys.find(key) != _refusedKeys.end());
+  pthread_mutex_unlock(&_idleMutex);
+  return refused;
+}
+
+void DsClient::_setPersistentRefused(const string &key)
+  
+{
+  pthread_mutex_lock(&_idleMutex);
+  _refusedKeys.insert(key);
+  pthread_mutex_unlock(&_idleMutex);
+}
+
 ///////////////////////////////////////////////////////////
 // Request the DsServerMgr to start the server for this URL
 //
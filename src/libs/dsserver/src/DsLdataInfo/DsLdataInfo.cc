@@ -555,6 +555,8 @@ int DsLdataInfo::read(int max_valid_age /* = -1*/ )
 //   sleep_msecs (millisecs):
 //     While in the blocked state, the program sleeps for sleep_msecs
 //     millisecs at a time before checking again.
+//     For local access, LdataInfo::readBlocking() is used, which
+//     waits for the files to change if inotify is available.
 //
 //   heartbeat_func(): heartbeat function
 //     Just before sleeping each time, heartbeat_func() is called
@@ -572,6 +574,14 @@ void DsLdataInfo::readBlocking(int max_valid_age,
 			       heartbeat_t heartbeat_func)
 
 {
+
+  // for local access, use LdataInfo object
+
+  if (!_useServer) {
+    LdataInfo::readBlocking(max_valid_age, sleep_msecs, heartbeat_func);
+    return;
+  }
+
   while (read(max_valid_age)) {
     if (heartbeat_func != NULL) {
       heartbeat_func("DsLdataInfo::readBlocking");
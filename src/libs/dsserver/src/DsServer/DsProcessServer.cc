@@ -37,9 +37,17 @@
 
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/mman.h>
 #include <signal.h>
+#include <cstring>
+#include <algorithm>
 using namespace std;
 
+// number of recent requests used for the latency stats
+
+const int DsProcessServer::_nLatencySamples;
+
 //////////////////////////////////////////////////////////////////////////
 // Constructor:
 //   o Registers with procmap
@@ -77,7 +85,12 @@ DsProcessServer::DsProcessServer(const string & executableName,
   _isSecure(isSecure),
   _isReadOnly(isReadOnly),
   _allowHttp(allowHttp),
-  _lastPrint(0)
+  _lastPrint(0),
+  _allowPersistent(true),
+  _keepAliveMsecs(DS_DEFAULT_KEEPALIVE_MSECS),
+  _shared(NULL),
+  _sharedMapped(false),
+  _lastStatsPrint(0)
 
 {
 
@@ -128,6 +141,39 @@ DsProcessServer::DsProcessServer(const string & executableName,
     }
   }
   
+  // persistent connections - see DsServerMsg.hh
+  
+  char *DS_SERVER_PERSISTENT = getenv("DS_SERVER_PERSISTENT");
+  if (DS_SERVER_PERSISTENT != NULL &&
+      STRequal(DS_SERVER_PERSISTENT, "false")) {
+    _allowPersistent = false;
+  }
+  char *DS_SERVER_KEEPALIVE_MSECS = getenv("DS_SERVER_KEEPALIVE_MSECS");
+  if (DS_SERVER_KEEPALIVE_MSECS != NULL) {
+    int keepalive;
+    if (sscanf(DS_SERVER_KEEPALIVE_MSECS, "%d", &keepalive) == 1) {
+      _keepAliveMsecs = keepalive;
+    }
+  }
+  
+  // state shared with the children - if shared memory is not
+  // available, the stats only cover this process
+
+  void *shared = mmap(NULL, sizeof(shared_state_t),
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared != MAP_FAILED) {
+    _shared = (shared_state_t *) shared;
+    _sharedMapped = true;
+  } else {
+    _shared = new shared_state_t;
+  }
+  memset(_shared, 0, sizeof(shared_state_t));
+  for (int ii = 0; ii < _nLatencySamples; ii++) {
+    // mark as not yet written
+    _shared->latencyMsecs[ii] = -1.0;
+  }
+
   // Open socket on the port.
   _serverSocket = new ServerSocket();
   if (_serverSocket->openServer(_port) < 0) {
@@ -165,6 +211,11 @@ DsProcessServer::~DsProcessServer()
   if (_serverSocket != NULL) {
     delete (_serverSocket);
   }
+  if (_sharedMapped) {
+    munmap(_shared, sizeof(shared_state_t));
+  } else {
+    delete _shared;
+  }
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -287,7 +338,13 @@ int DsProcessServer::waitForClients(int timeoutMSecs /* = 1000*/ )
     _lastActionTime = time(NULL);
 
     // Check the client count - can we accept?
+    // If not, first try to free up children holding idle
+    // persistent connections.
     
+    if (_maxClients >= 0 && _numClients >= _maxClients) {
+      _closeIdleClients();
+    }
+
     if (_maxClients >= 0 && _numClients >= _maxClients) {
       
       string errMsg;
@@ -343,6 +400,10 @@ int DsProcessServer::waitForClients(int timeoutMSecs /* = 1000*/ )
 
       spawn(sss, socket);
 
+      // at the limit, children should not hold idle connections
+
+      _setCloseIdle();
+
     } // if (_isNoThreadDebug)
 
     // Call the post-handler method.
@@ -517,6 +578,11 @@ int DsProcessServer::handleServerCommand(Socket * socket,
     isShutdown = true;
     break;
 
+  case DsServerMsg::GET_SERVER_STATS:
+    // Send back the request latency stats.
+    msg.addString(getLatencyReport());
+    break;
+
   default:
     // Not handled -- this is an error.
     msg.setErr(DsServerMsg::UNKNOWN_COMMAND);
@@ -583,6 +649,7 @@ bool DsProcessServer::checkQuiescence()
   // purge completed threads
 
   purgeCompletedThreads();
+  _setCloseIdle();
   
   // if _maxQuiescentSecs is -1, we are never quiescent
 
@@ -652,6 +719,8 @@ bool DsProcessServer::timeoutMethod()
   PMU_auto_register((char *) pmuStr.c_str());
 #endif
 
+  printLatencyStats();
+
   if (_doShutdown) {
     if (_isDebug) {
       cerr << "DsProcessServer::timeoutMethod" << endl;
@@ -788,6 +857,69 @@ void DsProcessServer::clientDone()
   
 }
 
+////////////////////////////////////////////////////////////////
+// clientsWaiting()
+//
+// Are there clients waiting to be served?
+// In this class each connection has its own child, so this is
+// true if the Boss is at the max number of clients and has
+// asked for idle connections to be closed.
+//
+// Virtual
+
+bool DsProcessServer::clientsWaiting()
+{
+  return __atomic_load_n(&_shared->closeIdle, __ATOMIC_RELAXED) != 0;
+}
+
+////////////////////////////////////////////////////////////////
+// _setCloseIdle()
+//
+// Ask children to close idle persistent connections if the
+// server is at the max number of clients.
+//
+// Threads: Called by Boss thread.
+
+void DsProcessServer::_setCloseIdle()
+{
+  int closeIdle = (_maxClients >= 0 && _numClients >= _maxClients);
+  __atomic_store_n(&_shared->closeIdle, closeIdle, __ATOMIC_RELAXED);
+}
+
+////////////////////////////////////////////////////////////////
+// _closeIdleClients()
+//
+// Called when the server is at the max number of clients.
+// If children are holding idle persistent connections, ask them
+// to close, and wait briefly for them to exit.
+//
+// Threads: Called by Boss thread.
+
+void DsProcessServer::_closeIdleClients()
+{
+
+  if (_isNoThreadDebug) {
+    return;
+  }
+
+  purgeCompletedThreads();
+  _setCloseIdle();
+
+  // idle children check the flag every 100 msecs
+
+  for (int ii = 0; ii < 50; ii++) {
+    if (_numClients < _maxClients ||
+        __atomic_load_n(&_shared->nIdle, __ATOMIC_RELAXED) <= 0) {
+      break;
+    }
+    umsleep(10);
+    purgeCompletedThreads();
+  }
+
+  _setCloseIdle();
+
+}
+
 ////////////////////////////////////////////////////////////////
 // Purge completed threads
 //
@@ -932,10 +1064,6 @@ void * DsProcessServer::__serveClient(void * svrsockstruct)
     return NULL;
   }
 
-  if (server->_isVerbose) {
-    cerr << "Client handler thread reading from socket..." << endl;
-  }
-
   // get comm timeout
   
   ssize_t commTimeoutMsecs = DS_DEFAULT_COMM_TIMEOUT_MSECS;
@@ -946,11 +1074,117 @@ void * DsProcessServer::__serveClient(void * svrsockstruct)
       commTimeoutMsecs = timeout;
     }
   }
-  
+
+  // serve requests on the connection - just one, unless the
+  // client has asked for a persistent connection
+
+  bool persistent = false;
+  int nRequests = 0;
+  int success = 0;
+
+  while (true) {
+
+    if (nRequests > 0) {
+      if (!persistent || !server->_waitForNextRequest(socket)) {
+        break;
+      }
+    }
+
+    success = server->_serveRequest(socket, commTimeoutMsecs,
+                                    nRequests == 0, persistent);
+    nRequests++;
+    if (success != 0) {
+      break;
+    }
+
+  } // while
+
+  if (server->_isChild && server->_isDebug && nRequests > 1) {
+    cerr << "DsProcessServer - closing persistent connection" << endl;
+    cerr << "  nRequests: " << nRequests << endl;
+  }
+
+  // Deal with failures to handle the message.
+  //   Note that if the subclass returns an error code, it is
+  //     considered failure to handle an error, which is fatal.
+  // 
+  if (success == -2) {
+
+    // Server (subclass) takes care of all error handling and reporting.
+    //   Just output generic message here.
+    // 
+    // Note that the subclass is not intended to ever return an error.
+    // 
+    string newError  = "Error in DsProcessServer::__serveClient: ";
+    newError += "Could not handle message.\n";
+    newError += DateTime::str();
+    cerr << newError << endl;
+ 
+    // Remove this thread from the client count.
+    server->clientDone();
+
+    // Exit if this is a debug server.
+    // 
+    if (server->_isDebug) {
+      // Todo: Wait for all the threads to end?
+      //       To make this work, need to block new clients.
+
+      server->exitMethod();
+      cerr << " DsProcessServer::__serveClient" << endl;
+      cerr << "  " << DateTime::str() << endl;
+      cerr << "  Exiting because debug server" << endl;
+      exit(1);
+    }
+
+    return NULL;
+  }
+    
+  // Notify the server this thread is finished.
+  server->clientDone();
+
+  // Done with the thread. Exit cleanly.
+  return NULL;
+
+}
+
+///////////////////////////////////////////////////////////////////////
+// _serveRequest()
+// 
+// Read a request from the client, and call the appropriate handler.
+//
+// If first is true, this is the first request on the connection.
+// If the client asks for a persistent connection, persistent is
+// set to true.
+//
+// Returns 0 on success,
+//        -1 on error reading or decoding the request,
+//           or if the client has closed the connection,
+//        -2 if the handler failed.
+
+int DsProcessServer::_serveRequest(Socket *socket,
+                                   ssize_t commTimeoutMsecs,
+                                   bool first,
+                                   bool &persistent)
+
+{
+
+  if (_isVerbose) {
+    cerr << "Client handler thread reading from socket..." << endl;
+  }
+
   // Read from the socket.
   int status = socket->readMessage(commTimeoutMsecs);
 
   if (status != 0) {
+
+    if (!first) {
+      // client closed the persistent connection - no reply needed
+      if (_isVerbose) {
+        cerr << "Client closed persistent connection." << endl;
+      }
+      return -1;
+    }
+
     char buf[10];
     sprintf(buf, "%d", status);
     string errMsg  = "Error: Server could not read. Got status: ";
@@ -960,26 +1194,24 @@ void * DsProcessServer::__serveClient(void * svrsockstruct)
     errMsg += buf;
     errMsg += ". Error String: ";
     errMsg += socket->getErrString();
-    if (server->_isDebug) {
+    if (_isDebug) {
       cerr << errMsg << endl;
     }
 
     // Send error reply to client
     string statusString;
-    server->sendReply(socket, DsServerMsg::SERVER_ERROR,
-		      errMsg, statusString, commTimeoutMsecs);
+    sendReply(socket, DsServerMsg::SERVER_ERROR,
+              errMsg, statusString, commTimeoutMsecs);
 
     // wait up to 10 secs for client to close socket
     // Disabled because it breaks the operation of the tunnel - Mike
     // socket->readSelect(commTimeoutMsecs);
 
-    // Indicate that the client is done
-    server->clientDone();
-    return NULL;
+    return -1;
 
   }
   
-  if (server->_isVerbose) {
+  if (_isVerbose) {
     cerr << "Client handler thread performed successful read." << endl;
   }
 
@@ -987,7 +1219,7 @@ void * DsProcessServer::__serveClient(void * svrsockstruct)
   const void * data = socket->getData();
   size_t dataSize = socket->getNumBytes();
   
-  if (server->_isVerbose) {
+  if (_isVerbose) {
     cerr << "  Client handler thread Read " << dataSize << " Bytes." << endl;
     cerr << "  Client handler thread decoding message..." << endl;
   }
@@ -999,33 +1231,43 @@ void * DsProcessServer::__serveClient(void * svrsockstruct)
     string errMsg  = "Error: Message from client could not be decoded. ";
     errMsg += "Either the message is too small, or it has an ";
     errMsg += "invalid category.";
-    if (server->_isDebug) {
+    if (_isDebug) {
       cerr << errMsg << endl;
     }
     // Send error reply to client.
     string statusString;
-    server->sendReply(socket, DsServerMsg::BAD_MESSAGE,
-		      errMsg, statusString, commTimeoutMsecs);
+    sendReply(socket, DsServerMsg::BAD_MESSAGE,
+              errMsg, statusString, commTimeoutMsecs);
 
     // wait up to 10 secs for client to close socket
     // Disabled because it breaks the operation of the tunnel - Mike
     // socket->readSelect(10000);
 
-    // Indicate that the client is done
-    server->clientDone();
-    return NULL;
+    return -1;
   }
 
   // Determine if this is a server command or a task request.
-  int success = 0;
   DsServerMsg::category_t category = msg.getMessageCat();
+
+  // Request for a persistent connection is handled here, since
+  // it concerns the connection rather than the server.
+
+  if (category == DsServerMsg::ServerStatus &&
+      msg.getType() == DsServerMsg::PERSISTENT_CONNECTION) {
+    return _acceptPersistent(socket, commTimeoutMsecs, first, persistent);
+  }
+
+  struct timeval startTime;
+  gettimeofday(&startTime, NULL);
+
+  int success = 0;
   if (category == DsServerMsg::ServerStatus) {
 
-    success = server->handleServerCommand(socket, data, dataSize);
+    success = handleServerCommand(socket, data, dataSize);
 
   } else {
     
-    success = server->handleDataCommand(socket, data, dataSize);
+    success = handleDataCommand(socket, data, dataSize);
 
   }
  
@@ -1033,45 +1275,197 @@ void * DsProcessServer::__serveClient(void * svrsockstruct)
   // Disabled because it breaks the operation of the tunnel - Mike
   // socket->readSelect(10000);
 
-  // Deal with failures to handle the message.
-  //   Note that if the subclass returns an error code, it is
-  //     considered failure to handle an error, which is fatal.
-  // 
   if (success == -1) {
+    return -2;
+  }
 
-    // Server (subclass) takes care of all error handling and reporting.
-    //   Just output generic message here.
-    // 
-    // Note that the subclass is not intended to ever return an error.
-    // 
-    string newError  = "Error in DsProcessServer::__serveClient: ";
-    newError += "Could not handle message.\n";
-    newError += DateTime::str();
-    cerr << newError << endl;
- 
-    // Remove this thread from the client count.
-    server->clientDone();
+  struct timeval endTime;
+  gettimeofday(&endTime, NULL);
+  recordLatency((endTime.tv_sec - startTime.tv_sec) * 1000.0 +
+                (endTime.tv_usec - startTime.tv_usec) / 1000.0);
 
-    // Exit if this is a debug server.
-    // 
-    if (server->_isDebug) {
-      // Todo: Wait for all the threads to end?
-      //       To make this work, need to block new clients.
+  return 0;
 
-      server->exitMethod();
-      cerr << " DsProcessServer::__serveClient" << endl;
+}
+
+///////////////////////////////////////////////////////////////////////
+// _acceptPersistent()
+// 
+// Reply to a request for a persistent connection.
+// This is only accepted as the first request on the connection.
+//
+// Returns 0 if accepted, -1 otherwise.
+
+int DsProcessServer::_acceptPersistent(Socket *socket,
+                                       ssize_t commTimeoutMsecs,
+                                       bool first,
+                                       bool &persistent)
+
+{
+
+  if (!_allowPersistent || !first) {
+    string errMsg = "Persistent connection not supported";
+    string statusString;
+    sendReply(socket, DsServerMsg::NOT_SUPPORTED,
+              errMsg, statusString, commTimeoutMsecs);
+    return -1;
+  }
+
+  DsServerMsg msg;
+  msg.setCategory(DsServerMsg::ServerStatus);
+  msg.setType(DsServerMsg::PERSISTENT_CONNECTION);
+  void * msgToSend = msg.assemble();
+  ssize_t msgLen = msg.lengthAssembled();
+  
+  if (socket->writeMessage(0, msgToSend, msgLen, commTimeoutMsecs)) {
+    if (_isDebug) {
+      cerr << "Error in DsProcessServer::_acceptPersistent(): "
+           << "Could not send reply message: "
+           << socket->getErrString() << endl;
       cerr << "  " << DateTime::str() << endl;
-      cerr << "  Exiting because debug server" << endl;
-      exit(1);
     }
+    return -1;
+  }
 
-    return NULL;
+  if (_isVerbose) {
+    cerr << "Client handler accepted persistent connection." << endl;
   }
-    
-  // Notify the server this thread is finished.
-  server->clientDone();
 
-  // Done with the thread. Exit cleanly.
-  return NULL;
+  // several exchanges on the connection, so do not delay
+  // small writes waiting for acks
+
+  socket->setNoDelay();
+
+  persistent = true;
+  return 0;
+
+}
+
+///////////////////////////////////////////////////////////////////////
+// _waitForNextRequest()
+// 
+// Wait for the next request on a persistent connection.
+//
+// Returns true if a request is ready to be read, false if the
+// connection has been idle for _keepAliveMsecs, or there are
+// other clients waiting to be served.
+
+bool DsProcessServer::_waitForNextRequest(Socket *socket)
+
+{
+
+  // wait in short slices, so that we can give up the connection
+  // if other clients are waiting
+
+  const int sliceMsecs = 100;
+  int waitedMsecs = 0;
+  bool ready = false;
+  
+  __atomic_add_fetch(&_shared->nIdle, 1, __ATOMIC_RELAXED);
+
+  while (waitedMsecs < _keepAliveMsecs) {
+    if (socket->readSelect(sliceMsecs) == 0) {
+      // request ready, or client closed the connection
+      ready = true;
+      break;
+    }
+    if (socket->getErrNum() != SockUtil::TIMED_OUT) {
+      break;
+    }
+    socket->removeState(SockUtil::STATE_ERROR);
+    if (clientsWaiting()) {
+      break;
+    }
+    waitedMsecs += sliceMsecs;
+  }
+
+  __atomic_sub_fetch(&_shared->nIdle, 1, __ATOMIC_RELAXED);
+
+  return ready;
+
+}
+
+///////////////////////////////////////////////////////////////////////
+// recordLatency()
+//
+// Record the time taken to handle a request.
+// The slot is claimed before the sample is stored, so the
+// sample is published with a release store, and the report
+// skips slots which have not yet been written.
+
+void DsProcessServer::recordLatency(double msecs)
+
+{
+
+  si64 nn = __atomic_fetch_add(&_shared->nRequests, 1, __ATOMIC_RELAXED);
+  __atomic_store(&_shared->latencyMsecs[nn % _nLatencySamples],
+                 &msecs, __ATOMIC_RELEASE);
+
+}
+
+///////////////////////////////////////////////////////////////////////
+// getLatencyReport()
+//
+// Get a report of the request latency percentiles,
+// over the most recent requests.
+
+string DsProcessServer::getLatencyReport()
+
+{
+
+  si64 nRequests = __atomic_load_n(&_shared->nRequests, __ATOMIC_RELAXED);
+  si64 nSamples = min(nRequests, (si64) _nLatencySamples);
+  vector<double> latency;
+  latency.reserve(nSamples);
+  for (si64 ii = 0; ii < nSamples; ii++) {
+    double msecs;
+    __atomic_load(&_shared->latencyMsecs[ii], &msecs, __ATOMIC_ACQUIRE);
+    if (msecs >= 0.0) {
+      latency.push_back(msecs);
+    }
+  }
+
+  char text[1024];
+  if (latency.size() == 0) {
+    snprintf(text, sizeof(text),
+             "  Port %d: no requests handled\n", _port);
+    return text;
+  }
+  
+  sort(latency.begin(), latency.end());
+  size_t nn = latency.size();
+  snprintf(text, sizeof(text),
+           "  Port %d: %lld requests, latency msecs over last %d:\n"
+           "    p50 %.2f, p90 %.2f, p99 %.2f, max %.2f\n",
+           _port, (long long) nRequests, (int) nn,
+           latency[(nn - 1) * 50 / 100],
+           latency[(nn - 1) * 90 / 100],
+           latency[(nn - 1) * 99 / 100],
+           latency[nn - 1]);
+
+  return text;
+
+}
+
+///////////////////////////////////////////////////////////////////////
+// printLatencyStats()
+//
+// Print the latency report in debug mode, at most once a minute.
+
+void DsProcessServer::printLatencyStats()
+
+{
+
+  if (!_isDebug) {
+    return;
+  }
+  time_t now = time(NULL);
+  if (now - _lastStatsPrint < 60) {
+    return;
+  }
+  _lastStatsPrint = now;
+  cerr << "DsProcessServer - request latency, "
+       << DateTime::str() << endl;
+  cerr << getLatencyReport();
 
 }
@@ -38,6 +38,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <cerrno>
 using namespace std;
 
 //////////////////////////////////////////////////////////////////////////
@@ -60,29 +61,62 @@ DsThreadedServer::DsThreadedServer(const string & executableName,
 				   bool isRdOnly /* = false */) :
   DsProcessServer(executableName, instanceName, port,
 		  maxQuiescentSecs, maxClients,
-		  isDebug, isVerbose, isSecure, isRdOnly)
+		  isDebug, isVerbose, isSecure, isRdOnly),
+  _nThreads(DS_SERVER_N_THREADS_DEFAULT),
+  _nClientsDone(0),
+  _stopWorkers(false)
 
 {
 
-  if (!_isNoThreadDebug) {
-    pthread_mutex_init(&_threadStatusMutex, NULL);
-    pthread_mutex_init(&_procmapInfoMutex, NULL);
+  pthread_mutex_init(&_clientQueueMutex, NULL);
+  pthread_cond_init(&_clientQueueCond, NULL);
+  pthread_mutex_init(&_procmapInfoMutex, NULL);
+
+  // override number of threads from environment?
+  
+  char *DS_SERVER_N_THREADS = getenv("DS_SERVER_N_THREADS");
+  if (DS_SERVER_N_THREADS != NULL) {
+    int n_threads;
+    if (sscanf(DS_SERVER_N_THREADS, "%d", &n_threads) == 1) {
+      _nThreads = n_threads;
+    }
   }
 
 }
 
 // Destructor.
-//   Uses the base class
+//   Stops the Worker threads, after they finish with their
+//   current clients. Clients still queued are dropped.
 //
 DsThreadedServer::~DsThreadedServer()
 {
 
+  pthread_mutex_lock(&_clientQueueMutex);
+  _stopWorkers = true;
+  pthread_cond_broadcast(&_clientQueueCond);
+  pthread_mutex_unlock(&_clientQueueMutex);
+
+  for (size_t ii = 0; ii < _workers.size(); ii++) {
+    pthread_join(_workers[ii], NULL);
+  }
+
+  while (!_clientQueue.empty()) {
+    ServerSocketStruct *sss = _clientQueue.front();
+    _clientQueue.pop_front();
+    delete sss->socket;
+    delete sss;
+  }
+
+  pthread_cond_destroy(&_clientQueueCond);
+  pthread_mutex_destroy(&_clientQueueMutex);
+
 }
 
 ///////////////////////////////////////////////////
 // spawn()
 //
-// Spawn a thread for handling the client
+// Queue the client for handling by the Worker thread pool.
+// The pool is started on the first call.
 // 
 // virtual
 
@@ -90,21 +124,13 @@ void DsThreadedServer::spawn(ServerSocketStruct * sss, Socket * socket)
 
 {
   
-  // Start a thread.
-  
-  pthread_mutex_lock(&_threadStatusMutex);
-  pthread_t thread;
-  int err = pthread_create(&thread, NULL, __serveClient, sss);
-  
-  if (err != 0) {
-  
+  if (_workers.size() == 0 && _startWorkers()) {
+
     // thread creation error
     
-    pthread_mutex_unlock(&_threadStatusMutex);
-    
     string errMsg  = "Error in DsThreadedServer::spawn(): ";
-    errMsg += "Could not create thread to handle client: ";
-    errMsg += strerror(err);
+    errMsg += "Could not create threads to handle clients: ";
+    errMsg += strerror(errno);
     if (_isDebug) { 
       cerr << errMsg << endl;
     }
@@ -122,23 +148,105 @@ void DsThreadedServer::spawn(ServerSocketStruct * sss, Socket * socket)
     
   }
   
-  // thread created successfully
+  // queue the client, and wake up a Worker
+  // the Worker deletes the socket when it is done
+  
+  pthread_mutex_lock(&_clientQueueMutex);
+  _clientQueue.push_back(sss);
+  size_t queueSize = _clientQueue.size();
+  pthread_cond_signal(&_clientQueueCond);
+  pthread_mutex_unlock(&_clientQueueMutex);
+  _numClients++;
 
   if (_isVerbose) {
-    cerr << "---> created client thread, id: " << thread << endl;
+    cerr << "---> queued client, queue size: " << queueSize << endl;
   }
   
-  // add a status object to the list
-  // this is used by the worker thread to indicate that it is done, and by the
-  // boss thread to join the thread when it is done
-  
-  ThreadStatus status;
-  status.threadId = thread;
-  status.socket = socket;
-  status.done = false;
-  _threadStatus.push_back(status);
-  pthread_mutex_unlock(&_threadStatusMutex);
-  
+}
+
+///////////////////////////////////////////////////
+// _startWorkers()
+//
+// Start the pool of Worker threads.
+// The number of threads is limited to _maxClients.
+//
+// Returns 0 on success, -1 on failure.
+
+int DsThreadedServer::_startWorkers()
+
+{
+
+  int nThreads = _nThreads;
+  if (_maxClients > 0 && nThreads > _maxClients) {
+    nThreads = _maxClients;
+  }
+  if (nThreads < 1) {
+    nThreads = 1;
+  }
+
+  for (int ii = 0; ii < nThreads; ii++) {
+    pthread_t thread;
+    int err = pthread_create(&thread, NULL, __workerMain, this);
+    if (err != 0) {
+      if (_workers.size() > 0) {
+        // make do with the threads we have
+        break;
+      }
+      errno = err;
+      return -1;
+    }
+    _workers.push_back(thread);
+  }
+
+  if (_isDebug) {
+    cerr << "DsThreadedServer - started Worker threads: "
+         << _workers.size() << endl;
+  }
+
+  return 0;
+
+}
+
+///////////////////////////////////////////////////
+// __workerMain()
+//
+// Start function for the Worker threads.
+// Takes clients off the queue and serves them, until the
+// server is destroyed.
+
+void *DsThreadedServer::__workerMain(void *svr)
+
+{
+
+  DsThreadedServer *server = (DsThreadedServer *) svr;
+
+  while (true) {
+
+    // wait for a client
+    
+    pthread_mutex_lock(&server->_clientQueueMutex);
+    while (server->_clientQueue.empty() && !server->_stopWorkers) {
+      pthread_cond_wait(&server->_clientQueueCond,
+                        &server->_clientQueueMutex);
+    }
+    if (server->_stopWorkers) {
+      pthread_mutex_unlock(&server->_clientQueueMutex);
+      return NULL;
+    }
+    ServerSocketStruct *sss = server->_clientQueue.front();
+    server->_clientQueue.pop_front();
+    pthread_mutex_unlock(&server->_clientQueueMutex);
+
+    // serve the client - this deletes the sss struct
+
+    Socket *socket = sss->socket;
+    __serveClient(sss);
+    delete socket;
+
+  }
+
+  return NULL;
+
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -189,6 +297,8 @@ bool DsThreadedServer::timeoutMethod()
   pthread_mutex_unlock(&_procmapInfoMutex);
 #endif
 
+  printLatencyStats();
+
   if (_doShutdown) {
     if (_isDebug) {
       cerr << "DsThreadedServer::timeoutMethod" << endl;
@@ -321,6 +431,8 @@ bool DsThreadedServer::exitMethod()
 // clientDone()
 //
 // Update the server to reflect that a client is finished.
+// The client count is updated by the Boss thread, in
+// purgeCompletedThreads().
 //
 // Threads: called by worked thread.
 //
@@ -334,29 +446,18 @@ void DsThreadedServer::clientDone()
   if (_isNoThreadDebug) {
     return;
   }
-  pthread_mutex_lock(&_threadStatusMutex);
-  bool found = false;
-  list<ThreadStatus>::iterator ii;
-  for (ii = _threadStatus.begin(); ii != _threadStatus.end(); ii++) {
-    ThreadStatus &status = *ii;
-    if (pthread_equal(status.threadId, pthread_self())) {
-      status.done = true;
-      found = true;
-      break;
-    }
-  }
-  if (!found) {
-    cerr << "ERROR - DsThreadedServer::clientDone" << endl;
-    cerr << "  " << DateTime::str() << endl;
-    cerr << "  Cannot find thread id in list: " << pthread_self() << endl;
-  }
-  pthread_mutex_unlock(&_threadStatusMutex);
+  pthread_mutex_lock(&_clientQueueMutex);
+  _nClientsDone++;
+  pthread_mutex_unlock(&_clientQueueMutex);
 
 }
 
 ////////////////////////////////////////////////////////////////
 // Purge completed threads
 //
+// With the Worker pool, the threads are not joined here, this
+// just updates the client count for clients which are done.
+//
 // virtual
 
 void DsThreadedServer::purgeCompletedThreads()
@@ -366,35 +467,31 @@ void DsThreadedServer::purgeCompletedThreads()
   if (_isNoThreadDebug) {
     return;
   }
-  pthread_mutex_lock(&_threadStatusMutex);
-  
-  bool done = false;
-  
-  while (!done) {
-    
-    done = true;
-    
-    list<ThreadStatus>::iterator ii;
-    for (ii = _threadStatus.begin(); ii != _threadStatus.end(); ii++) {
-      ThreadStatus &status = *ii;
-      if (status.done) {
-	pthread_join(status.threadId, NULL);
-	delete status.socket;
-	if (_isVerbose) {
-	  cerr << "******** Joined thread: " << status.threadId << endl;
-	}
-	_threadStatus.erase(ii);
-	done = false;
-	_numClients--;
-	_lastActionTime = time(NULL);
-	break;
-      }
+  pthread_mutex_lock(&_clientQueueMutex);
+  if (_nClientsDone > 0) {
+    _numClients -= _nClientsDone;
+    _nClientsDone = 0;
+    _lastActionTime = time(NULL);
+  }
+  pthread_mutex_unlock(&_clientQueueMutex);
 
-    } // ii
+}
 
-  } // while
+////////////////////////////////////////////////////////////////
+// clientsWaiting()
+//
+// Are there clients queued waiting for a Worker, or has the
+// Boss reached the max number of clients?
+//
+// virtual
 
-  pthread_mutex_unlock(&_threadStatusMutex);
+bool DsThreadedServer::clientsWaiting()
 
-}
+{
 
+  pthread_mutex_lock(&_clientQueueMutex);
+  bool waiting = !_clientQueue.empty();
+  pthread_mutex_unlock(&_clientQueueMutex);
+  return waiting || DsProcessServer::clientsWaiting();
+
+}
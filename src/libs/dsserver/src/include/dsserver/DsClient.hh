@@ -61,6 +61,13 @@ public:
   //
   // Forwarding via a proxy and/or tunnel is handled.
   //
+  // Without forwarding, the connection is kept open after the
+  // reply if the server supports persistent connections, and is
+  // reused by later requests to the same host and port from this
+  // process, by this or any other DsClient object. A connection
+  // is handed back for reuse when this object is destroyed, or
+  // on the next call. See setUsePersistent().
+  //
   // After success, retrieve the returned message
   // using getReplyBuf() and getReplyLen().
   //
@@ -71,8 +78,8 @@ public:
   
   // get data after successful comm call
 
-  const void *getReplyBuf() { return _sock.getData(); }
-  ssize_t getReplyLen() { return _sock.getNumBytes(); }
+  const void *getReplyBuf() { return _replySock->getData(); }
+  ssize_t getReplyLen() { return _replySock->getNumBytes(); }
 
   // Request the DsServerMgr to start the server for this URL
   //
@@ -97,6 +104,13 @@ public:
 
   void setOpenTimeoutMsecs(int msecs) { _openTimeoutMsecs = msecs; }
 
+  // Use persistent connections where the server supports them.
+  // Defaults to true, unless the environment variable
+  // DS_PERSISTENT_CONNECTIONS is set to "false".
+  // Connections through a proxy or tunnel are never persistent.
+
+  void setUsePersistent(bool state) { _usePersistent = state; }
+
   // clear/set/get the Error String.
   // This has contents when an error is returned.
   
@@ -111,9 +125,34 @@ protected:
   ThreadSocket _sock;
   mutable string _errStr;
   int _openTimeoutMsecs;
+
+  // persistent connections
+
+  bool _usePersistent;
+  ThreadSocket *_connSock;  // persistent connection in use, or NULL
+  ThreadSocket *_replySock; // socket holding the reply
+  string _connKey;          // host:port for _connSock
   
   void _closeSocket();
 
+  int _communicatePersistent(const DsURL &url, int msgType,
+                             const void *msgBuf, ssize_t msgLen,
+                             int commTimeoutMsecs);
+
+  int _requestPersistent(ThreadSocket *sock, const string &key,
+                         int commTimeoutMsecs);
+
+  int _writeAndRead(ThreadSocket *sock, const DsURL &url,
+                    int msgType, const void *msgBuf, ssize_t msgLen,
+                    int commTimeoutMsecs, bool *canRetry = NULL);
+
+  void _releaseConnection();
+
+  static ThreadSocket *_takeIdleConnection(const string &key);
+  static void _addIdleConnection(const string &key, ThreadSocket *sock);
+  static bool _persistentRefused(const string &key);
+  static void _setPersistentRefused(const string &key);
+
   int _communicateNoFwd(const DsURL &url, int msgType,
 			const void *msgBuf, ssize_t msgLen,
 			int commTimeoutMsecs);
@@ -247,6 +247,8 @@ public:
   //   sleep_msecs (millisecs):
   //     While in the blocked state, the program sleeps for sleep_msecs
   //     millisecs at a time before checking again.
+  //     For local access, LdataInfo::readBlocking() is used, which
+  //     waits for the files to change if inotify is available.
   //
   //   heartbeat_func(): heartbeat function
   //     Just before sleeping each time, heartbeat_func() is called
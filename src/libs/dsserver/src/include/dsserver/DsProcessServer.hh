@@ -28,6 +28,8 @@
 #include <toolsa/umisc.h>
 
 #include <string>
+#include <vector>
+#include <pthread.h>
 using namespace std;
 
 class Socket;
@@ -97,6 +99,35 @@ class ServerSocket;
 //    The handleDataCommand() and handleServerCommand() methods are run
 //    in the child process.
 //
+// Persistent connections:
+// -----------------------
+//
+// By default a connection carries a single request and reply.
+// A client may send a PERSISTENT_CONNECTION server command as the
+// first message on a connection. If the server accepts, it keeps
+// the connection open after each reply, and waits for further
+// requests, until the client closes it or it has been idle for
+// DS_DEFAULT_KEEPALIVE_MSECS. Older servers reply UNKNOWN_COMMAND
+// and close the connection, and older clients never ask, so
+// either side may be upgraded first. See DsClient.
+//
+// Set the environment variable DS_SERVER_PERSISTENT to "false"
+// to refuse persistent connections, and DS_SERVER_KEEPALIVE_MSECS
+// to override the idle time.
+//
+// Request latency:
+// ----------------
+//
+// The time taken to handle each request is recorded, and the
+// percentiles over the most recent requests are returned by the
+// GET_SERVER_STATS server command, and printed in debug mode.
+// The stats are kept in memory shared with the children, so they
+// cover the requests handled by all the connections.
+//
+// Idle persistent connections hold a child, and so count towards
+// the max number of clients. When the server reaches the limit,
+// the children holding idle connections are asked to close them.
+//
 // Maintenance Issues:
 // -------------------
 // 
@@ -181,6 +212,21 @@ public:
   // 
   int waitForClients(int timeoutMSecs = 1000);
 
+  // Allow clients to request persistent connections.
+  // Defaults to true, unless DS_SERVER_PERSISTENT is "false".
+  // Should only be set before calling waitForClients().
+
+  void setAllowPersistent(bool state) { _allowPersistent = state; }
+  bool allowPersistent() const { return _allowPersistent; }
+
+  // Get a report of the request latency percentiles,
+  // over the most recent requests.
+  //
+  // Threads: Called by Worker threads.
+  //          Called by Boss thread.
+
+  string getLatencyReport();
+
 protected:
 
   // struct for passing args to thread
@@ -317,6 +363,36 @@ protected:
   // Threads: should only be set in main thread
   time_t _lastPrint;
 
+  // Accept persistent connections, and how long to keep an
+  // idle one open.
+  // 
+  // Threads: Should only be set before calling waitForClients().
+  // 
+  bool _allowPersistent;
+  int _keepAliveMsecs;
+
+  // State shared with the child processes:
+  //   request latency stats - a ring buffer of the most recent
+  //     request times, -1 in slots not yet written,
+  //   the number of idle persistent connections, and a flag
+  //     set by the Boss to ask for them to be closed.
+  // This is in shared memory, so that the children can update it.
+  // 
+  // Threads: Modified by Worker threads and children.
+  //          Modified by Boss thread.
+  //          Use atomic access!
+  // 
+  static const int _nLatencySamples = 1000;
+  typedef struct {
+    si64 nRequests;
+    int nIdle;
+    int closeIdle;
+    double latencyMsecs[_nLatencySamples];
+  } shared_state_t;
+  shared_state_t *_shared;
+  bool _sharedMapped;
+  time_t _lastStatsPrint;
+
   ////////////////////////////////////////////////////////////
   // ACCESS FUNCTIONS FOR DATA MEMBERS
 
@@ -382,6 +458,7 @@ protected:
   //       IS_ALIVE,              Returns empty message.      
   //       GET_NUM_CLIENTS,       Returns integer.
   //       SHUTDOWN,              Returns empty message, then calls exit(0).
+  //       GET_SERVER_STATS,      Returns string, latency percentiles.
   // 
   // Threads: Called by Worker threads.
   // 
@@ -486,6 +563,20 @@ protected:
   
   virtual void purgeCompletedThreads();
 
+  // clientsWaiting()
+  //
+  // Are there clients waiting to be served?
+  // If so, idle persistent connections are closed rather than
+  // kept open, to free up the handler.
+  //
+  // Threads: called by worker thread.
+  //
+  // In the DsProcessServer class, true if the Boss has reached
+  // the max number of clients and asked for idle connections
+  // to be closed.
+
+  virtual bool clientsWaiting();
+
   // 
   // END OF VIRTUAL METHODS.
   /////////////////////////////////////////////////////////
@@ -503,6 +594,18 @@ protected:
   int sendReply(Socket * socket,
 		DsServerMsg::msgErr errCode, const string & errMsg,
 		string & errString, int wait_msecs = 10000);
+
+  // Record the time taken to handle a request.
+  // 
+  // Threads: Called by Worker threads.
+
+  void recordLatency(double msecs);
+
+  // Print the latency report in debug mode, at most once a minute.
+  // 
+  // Threads: Called by Boss thread.
+
+  void printLatencyStats();
   
   // Static function for servicing request.
   // This is called by the child or thread created for servicing the request.
@@ -511,6 +614,15 @@ protected:
 
 private:
 
+  void _setCloseIdle();
+  void _closeIdleClients();
+
+  int _serveRequest(Socket *socket, ssize_t commTimeoutMsecs,
+                    bool first, bool &persistent);
+  int _acceptPersistent(Socket *socket, ssize_t commTimeoutMsecs,
+                        bool first, bool &persistent);
+  bool _waitForNextRequest(Socket *socket);
+
   // Private methods with no bodies. DO NOT USE!
   // 
   DsProcessServer();
@@ -42,6 +42,15 @@ using namespace std;
 #define DS_DEFAULT_PING_TIMEOUT_MSECS 10000
 #define DS_DEFAULT_COMM_TIMEOUT_MSECS 30000
 
+// persistent connections - see DsClient and DsProcessServer.
+// The server closes an idle persistent connection after
+// DS_DEFAULT_KEEPALIVE_MSECS. Clients do not reuse a connection
+// which has been idle for more than DS_DEFAULT_CLIENT_IDLE_MSECS,
+// which must be shorter.
+
+#define DS_DEFAULT_KEEPALIVE_MSECS 10000
+#define DS_DEFAULT_CLIENT_IDLE_MSECS 5000
+
 //////////////////////////////
 // forward class declarations
 //
@@ -132,7 +141,13 @@ public:
     GET_NUM_SERVERS,       // Returns integer.
     GET_SERVER_INFO,       // Returns int and formatted string, list of servers.
     GET_FAILURE_INFO,      // Returns int and formatted string, failure list.
-    GET_DENIED_SERVICES    // Returns int and formatted string, executable list.
+    GET_DENIED_SERVICES,   // Returns int and formatted string, executable list.
+
+    // DsServer commands, added later.
+    PERSISTENT_CONNECTION, // Returns empty message, and keeps the connection
+                           // open for further requests. Older servers
+                           // return UNKNOWN_COMMAND and close it.
+    GET_SERVER_STATS       // Returns string, request latency percentiles.
   };
 
   //////////////
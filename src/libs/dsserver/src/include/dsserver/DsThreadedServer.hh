@@ -29,7 +29,8 @@
 
 #include <string>
 #include <pthread.h>
-#include <list>
+#include <deque>
+#include <vector>
 
 class Socket;
 class ServerSocket;
@@ -56,10 +57,18 @@ using namespace std;
 // 
 // This threaded server uses a Boss and Worker thread model. 
 //   o A Boss thread is initiated by an external call to waitForClients().
-//   o Worker threads are spawned by the Boss to handle individual clients.
-//   o The Boss does no management of Worker threads after they are
-//       spawned. However, the number of clients at any time may be 
-//       obtained through the _numClients data member.
+//   o A fixed pool of Worker threads is started by the Boss when the
+//       first client connects. The Boss places accepted connections on
+//       a queue, and the next free Worker handles the client.
+//   o The number of clients at any time, queued or being handled,
+//       may be obtained through the _numClients data member.
+//   o A Worker handling a persistent connection (see DsProcessServer)
+//       closes it when idle if other clients are queued, or the
+//       server is at the max number of clients.
+// 
+// The number of Worker threads defaults to DS_SERVER_N_THREADS_DEFAULT,
+//   and may be set with setNThreads() or the DS_SERVER_N_THREADS
+//   environment variable. It is limited to _maxClients.
 // 
 // The DsThreadedServer class is abstract (cannot be instantiated), because it
 //   does not contain definitions of all the methods it needs to be a
@@ -156,19 +165,12 @@ using namespace std;
 // *     _isVerbose;
 // *     _isSecure
 
+#define DS_SERVER_N_THREADS_DEFAULT 16
+
 class DsThreadedServer : public DsProcessServer {
 
 public:
 
-  // class for keeping status of threads
-
-  class ThreadStatus {
-  public:
-    pthread_t threadId;
-    Socket * socket;
-    bool done;
-  };
-
   // Constructor:
   //   o Registers with procmap
   //   o Opens socket on specified port
@@ -192,6 +194,12 @@ public:
   // 
   virtual ~DsThreadedServer();
     
+  // Set the number of Worker threads.
+  // Should only be set before calling waitForClients().
+
+  void setNThreads(int n_threads) { _nThreads = n_threads; }
+  int getNThreads() const { return _nThreads; }
+
 protected:
 
   /////////////////////////////////////////////////////////
@@ -280,6 +288,13 @@ protected:
   
   virtual void purgeCompletedThreads();
 
+  // clientsWaiting()
+  //
+  // Are there clients queued waiting for a Worker, or has the
+  // Boss reached the max number of clients?
+
+  virtual bool clientsWaiting();
+
   // 
   // END OF VIRTUAL METHODS.
   /////////////////////////////////////////////////////////
@@ -289,13 +304,24 @@ protected:
   string _rapDataDir;
   
   // Thread mutex variables and access methods.
-  pthread_mutex_t _threadStatusMutex;
   pthread_mutex_t _procmapInfoMutex;
 
-  // list of active threads - used for deciding when to join
-  list<ThreadStatus> _threadStatus;
+  // Worker thread pool, and queue of clients waiting for a Worker.
+  // 
+  // Threads: Use _clientQueueMutex!
+  pthread_mutex_t _clientQueueMutex;
+  pthread_cond_t _clientQueueCond;
+  deque<ServerSocketStruct *> _clientQueue;
+  vector<pthread_t> _workers;
+  int _nThreads;
+  int _nClientsDone; // since last purge
+  bool _stopWorkers;
   
 private:
+
+  int _startWorkers();
+  static void *__workerMain(void *svr);
+
   // Private methods with no bodies. DO NOT USE!
   // 
   DsThreadedServer();
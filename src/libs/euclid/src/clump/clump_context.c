@@ -0,0 +1,171 @@
+/* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
+/* ** Copyright UCAR (c) 1990 - 2016                                         */
+/* ** University Corporation for Atmospheric Research (UCAR)                 */
+/* ** National Center for Atmospheric Research (NCAR)                        */
+/* ** Boulder, Colorado, USA                                                 */
+/* ** BSD licence applies - redistribution and use in source and binary      */
+/* ** forms, with or without modification, are permitted provided that       */
+/* ** the following conditions are met:                                      */
+/* ** 1) If the software is modified to produce derivative works,            */
+/* ** such modified software should be clearly marked, so as not             */
+/* ** to confuse it with the version available from UCAR.                    */
+/* ** 2) Redistributions of source code must retain the above copyright      */
+/* ** notice, this list of conditions and the following disclaimer.          */
+/* ** 3) Redistributions in binary form must reproduce the above copyright   */
+/* ** notice, this list of conditions and the following disclaimer in the    */
+/* ** documentation and/or other materials provided with the distribution.   */
+/* ** 4) Neither the name of UCAR nor the names of its contributors,         */
+/* ** if any, may be used to endorse or promote products derived from        */
+/* ** this software without specific prior written permission.               */
+/* ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  */
+/* ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      */
+/* ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    */
+/* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
+/**************************************************
+ * clump_context.c
+ *
+ * Working storage for reentrant clumping - see Clump_context
+ * in clump.h.
+ */
+
+#include <string.h>
+#include <euclid/clump.h>
+#include <euclid/alloc.h>
+
+/*
+ * EG_init_clump_context()
+ *
+ * Initialize a context before first use.
+ */
+
+void EG_init_clump_context(Clump_context *context)
+
+{
+  memset(context, 0, sizeof(Clump_context));
+}
+
+/*
+ * EG_free_clump_context()
+ *
+ * Free the storage in a context. The context may be used again
+ * after this.
+ */
+
+void EG_free_clump_context(Clump_context *context)
+
+{
+
+  int i;
+
+  if (context->stack != NULL) {
+    EG_free(context->stack);
+  }
+  EG_free_rowh(&context->nrows_alloc, &context->row_hdr);
+  EG_free_intervals(&context->intervals, &context->n_intv_alloc);
+  EG_free_clumps(&context->n_order_alloc,
+		 &context->clump_order, &context->interval_order);
+
+  if (context->parent != NULL) {
+    EG_free(context->parent);
+  }
+  for (i = 0; i < context->n_thread_alloc; i++) {
+    if (context->thread_intervals[i] != NULL) {
+      EG_free(context->thread_intervals[i]);
+    }
+  }
+  if (context->thread_intervals != NULL) {
+    EG_free(context->thread_intervals);
+  }
+  if (context->thread_n_alloc != NULL) {
+    EG_free(context->thread_n_alloc);
+  }
+
+  memset(context, 0, sizeof(Clump_context));
+
+}
+
+/*
+ * EG_find_intervals_3d_r()
+ *
+ * Find the intervals >= threshold in a volume, storing the
+ * intervals and row headers in the context.
+ *
+ * Returns the number of intervals found, -1 on error.
+ */
+
+int EG_find_intervals_3d_r(Clump_context *context,
+			   int nplanes, int nrows_in_plane, int ncols,
+			   unsigned char array[], int threshold)
+
+{
+
+  int nrows_in_vol = nplanes * nrows_in_plane;
+
+  EG_alloc_rowh(nrows_in_vol, &context->nrows_alloc, &context->row_hdr);
+  if (context->row_hdr == NULL) {
+    return(-1);
+  }
+
+  return(EG_find_intervals_3d(nplanes, nrows_in_vol, nrows_in_plane,
+			      ncols, array,
+			      &context->intervals, &context->n_intv_alloc,
+			      context->row_hdr, threshold));
+
+}
+
+/*
+ * EG_find_intervals_3d_float_r()
+ *
+ * As EG_find_intervals_3d_r(), for float data.
+ */
+
+int EG_find_intervals_3d_float_r(Clump_context *context,
+				 int nplanes, int nrows_in_plane, int ncols,
+				 float array[], float threshold)
+
+{
+
+  int nrows_in_vol = nplanes * nrows_in_plane;
+
+  EG_alloc_rowh(nrows_in_vol, &context->nrows_alloc, &context->row_hdr);
+  if (context->row_hdr == NULL) {
+    return(-1);
+  }
+
+  return(EG_find_intervals_3d_float(nplanes, nrows_in_vol, nrows_in_plane,
+				    ncols, array,
+				    &context->intervals, &context->n_intv_alloc,
+				    context->row_hdr, threshold));
+
+}
+
+/*
+ * EG_clump_intervals_3d_r()
+ *
+ * Clump the intervals found by the last call to
+ * EG_find_intervals_3d_r() or EG_find_intervals_3d_float_r().
+ * The clumps are returned in context->clump_order.
+ *
+ * Returns the number of clumps, -1 on error.
+ */
+
+int EG_clump_intervals_3d_r(Clump_context *context,
+			    int nplanes, int nrows_in_plane,
+			    int num_intervals, int min_overlap)
+
+{
+
+  EG_alloc_clumps(num_intervals, &context->n_order_alloc,
+		  &context->clump_order, &context->interval_order);
+  if (context->clump_order == NULL || context->interval_order == NULL) {
+    return(-1);
+  }
+
+  EG_reset_clump_id(context->intervals, num_intervals);
+
+  return(EG_rclump_3d_r(context, context->row_hdr,
+			nrows_in_plane, nplanes, 1, min_overlap,
+			context->interval_order, context->clump_order));
+
+}
+
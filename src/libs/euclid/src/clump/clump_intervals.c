@@ -29,6 +29,89 @@
 #include <euclid/clump.h>
 #include <euclid/alloc.h>
 
+/*
+ * seed stack in the clump context, for the reentrant functions
+ */
+
+#define INIT_STACK_ALLOC 4096
+#define STACK_INCR 4096
+
+static int _init_stack(Clump_context *context)
+{
+  if (context->stack == NULL)
+    {
+      context->stack = (int *)EG_malloc(INIT_STACK_ALLOC*sizeof(int));
+      if (context->stack == NULL)
+	return(-1);
+      context->stack_alloc = INIT_STACK_ALLOC;
+    }
+  context->stack_top = 0;
+  return(0);
+}
+
+static int _grow_stack(Clump_context *context)
+{
+  int *stack;
+
+  stack = (int *)EG_realloc(context->stack,
+			    (context->stack_alloc + STACK_INCR) * sizeof(int));
+  if (stack == NULL)
+    {
+      printf("stack overflow -- out of memory\n");
+      context->stack_top = 0;
+      return(0);
+    }
+  context->stack = stack;
+  context->stack_alloc += STACK_INCR;
+  return(1);
+}
+
+static int _push_2d(Clump_context *context, int x, int y)
+{
+  if (context->stack_top + 2 > context->stack_alloc &&
+      _grow_stack(context) == 0)
+    return(0);
+  context->stack[context->stack_top++] = x;
+  context->stack[context->stack_top++] = y;
+  return(1);
+}
+
+static int _pop_2d(Clump_context *context, int *x, int *y)
+{
+  if (context->stack_top > 1)
+    {
+      *y = context->stack[--context->stack_top];
+      *x = context->stack[--context->stack_top];
+      return(1);
+    }
+  context->stack_top = 0;
+  return(0);
+}
+
+static int _push_3d(Clump_context *context, int x, int y, int z)
+{
+  if (context->stack_top + 3 > context->stack_alloc &&
+      _grow_stack(context) == 0)
+    return(0);
+  context->stack[context->stack_top++] = x;
+  context->stack[context->stack_top++] = y;
+  context->stack[context->stack_top++] = z;
+  return(1);
+}
+
+static int _pop_3d(Clump_context *context, int *x, int *y, int *z)
+{
+  if (context->stack_top > 2)
+    {
+      *z = context->stack[--context->stack_top];
+      *y = context->stack[--context->stack_top];
+      *x = context->stack[--context->stack_top];
+      return(1);
+    }
+  context->stack_top = 0;
+  return(0);
+}
+
 /*
  * DESCRIPTION:    
  *
@@ -102,6 +185,29 @@ int EG_iclump_2d(Interval *intervals, int num_intervals,
 		int ydim, int clear, int min_overlap,
 		Interval **interval_order, Clump_order *clump_order)
 
+{
+  Clump_context context;
+  int num_clumps;
+
+  EG_init_clump_context(&context);
+  num_clumps = EG_iclump_2d_r(&context, intervals, num_intervals,
+			      ydim, clear, min_overlap,
+			      interval_order, clump_order);
+  EG_free_clump_context(&context);
+
+  return(num_clumps);
+}
+
+/*
+ * Reentrant version of EG_iclump_2d(), using the stack and row
+ * headers in context - see Clump_context in clump.h.
+ */
+
+int EG_iclump_2d_r(Clump_context *context,
+		   Interval *intervals, int num_intervals,
+		   int ydim, int clear, int min_overlap,
+		   Interval **interval_order, Clump_order *clump_order)
+
 {
   int interval_index;	  
   int curr_row;
@@ -115,10 +221,13 @@ int EG_iclump_2d(Interval *intervals, int num_intervals,
   /* initialize interval_index */
   interval_index = 0;
 
-  /* initialize the stacks */
-  if (EG_init_stack_2d() == -1)
+  /* initialize the stack */
+  if (_init_stack(context) == -1)
     return(-1);
 
+  if (num_intervals <= 0)
+    return(0);
+
   /* clear interval id's if required */
   if (clear) {
     EG_reset_clump_id(intervals, num_intervals);
@@ -126,8 +235,9 @@ int EG_iclump_2d(Interval *intervals, int num_intervals,
   
   /* organize the intervals using a row_hdr array */
 
-  /* malloc an array of row_hdr */
-  row_hdr = EG_malloc(ydim*sizeof(Row_hdr)); 
+  /* use the row_hdr array in the context */
+  EG_alloc_rowh(ydim, &context->nrows_alloc, &context->row_hdr);
+  row_hdr = context->row_hdr;
 
   if (row_hdr == NULL)
     return(-1);
@@ -162,18 +272,12 @@ int EG_iclump_2d(Interval *intervals, int num_intervals,
 	  {
 	    old_index = interval_index;
 	    clump_order[value].ptr = &interval_order[interval_index];
-	    clump_order[value].pts = EG_seed_2d(i, j, ydim, row_hdr, value,  &interval_index, interval_order);
+	    clump_order[value].pts = EG_seed_2d_r(context, i, j, ydim, row_hdr, value,  &interval_index, interval_order);
 	    clump_order[value].size = interval_index - old_index;
 	    value++;
 	  }
       }
   
-  /* free row_hdr */
-  (void)EG_free(row_hdr);
-
-  /* free the stacks */
-  EG_free_stack_2d();
-
   return(value-1);
 }
 
@@ -253,6 +357,26 @@ int EG_iclump_2d(Interval *intervals, int num_intervals,
 int EG_rclump_2d(Row_hdr *row_hdr, int ydim, int clear, int min_overlap,
 	      Interval **interval_order, Clump_order *clump_order)
 
+{
+  Clump_context context;
+  int num_clumps;
+
+  EG_init_clump_context(&context);
+  num_clumps = EG_rclump_2d_r(&context, row_hdr, ydim, clear, min_overlap,
+			      interval_order, clump_order);
+  EG_free_clump_context(&context);
+
+  return(num_clumps);
+}
+
+/*
+ * Reentrant version of EG_rclump_2d(), using the stack in context.
+ */
+
+int EG_rclump_2d_r(Clump_context *context,
+		   Row_hdr *row_hdr, int ydim, int clear, int min_overlap,
+		   Interval **interval_order, Clump_order *clump_order)
+
 {
   int interval_index;
   int i;
@@ -264,7 +388,7 @@ int EG_rclump_2d(Row_hdr *row_hdr, int ydim, int clear, int min_overlap,
   interval_index = 0;
 
   /* initialize the stack */
-  if (EG_init_stack_2d() == -1)
+  if (_init_stack(context) == -1)
     return(-1); 
 
   /* clear interval id's */
@@ -287,15 +411,12 @@ int EG_rclump_2d(Row_hdr *row_hdr, int ydim, int clear, int min_overlap,
 	  {
 	    old_index = interval_index;
 	    clump_order[value].ptr = &interval_order[interval_index];
-	    clump_order[value].pts = EG_seed_2d(i, j, ydim, row_hdr, value,  &interval_index, interval_order);
+	    clump_order[value].pts = EG_seed_2d_r(context, i, j, ydim, row_hdr, value,  &interval_index, interval_order);
 	    clump_order[value].size = interval_index - old_index;
 	    value++;
 	  }
       }
   
-  /* free the stack */
-  EG_free_stack_2d();
-
   return(value-1);
 }
 
@@ -409,6 +530,85 @@ int EG_seed_2d(int i, int j, int ydim, Row_hdr row_hdr[], int value, int *interv
     }
   return(count);
 }
+
+/*
+ * Reentrant version of EG_seed_2d(), using the stack in context.
+ */
+
+int EG_seed_2d_r(Clump_context *context, int i, int j, int ydim, Row_hdr row_hdr[], int value, int *interval_index, Interval **interval_order)
+{
+  int k;
+  int y;
+  int x;
+  int overlap_begin;
+  int overlap_end;
+  int count = 0;
+  Row_hdr *rh_base;
+  Row_hdr *rh_ptr;
+
+  row_hdr[i].intervals[j].id = value;
+  if (_push_2d(context, i, j) == 0)
+    return(-1);
+  interval_order[(*interval_index)++] = &row_hdr[i].intervals[j];
+
+  while (1)
+    {
+      if (_pop_2d(context, &y, &x))
+	{
+	  rh_base = &row_hdr[y];
+	  count += rh_base->intervals[x].end - rh_base->intervals[x].begin + 1;
+	  
+	  if (y < ydim - 1)
+	    {
+	      overlap_begin = rh_base->intervals[x].overlaps[SOUTH_INTERVAL][OV_BEG_IN];
+	      overlap_end = rh_base->intervals[x].overlaps[SOUTH_INTERVAL][OV_END];
+	      rh_ptr = &row_hdr[y+1];
+	      for (k=overlap_begin; k<=overlap_end; k++)
+		{
+		  if (rh_ptr->intervals[k].id == NULL_ID)
+		    {
+		      rh_ptr->intervals[k].id = value;
+
+		      /*
+		       * store the offset of the interval which was just
+		       * clumped for easy retrieval of clump intervals by
+		       * calling functions
+		       */
+		      interval_order[(*interval_index)++] = &rh_ptr->intervals[k];
+		      if (_push_2d(context, y+1, k) == 0)
+			return(-1);
+		    }
+		}
+	    }
+	  if (y >= 1)
+	    {
+	      overlap_begin = rh_base->intervals[x].overlaps[NORTH_INTERVAL][OV_BEG_IN];
+	      overlap_end = rh_base->intervals[x].overlaps[NORTH_INTERVAL][OV_END];
+	      rh_ptr = &row_hdr[y-1];
+	      for (k=overlap_begin; k<=overlap_end; k++)
+		{
+		  if (rh_ptr->intervals[k].id == NULL_ID)
+		    {
+		      rh_ptr->intervals[k].id = value;
+
+		      /*
+		       * store the offset of the interval which was just
+		       * clumped for easy retrieval of clump intervals by
+		       * calling functions
+		       */
+		      interval_order[(*interval_index)++] = &rh_ptr->intervals[k];
+		      if (_push_2d(context, y-1, k) == 0)
+			return(-1);
+		    }
+		}
+
+	    }
+	}
+      else
+	break;
+    }
+  return(count);
+}
 
 /*
  * DESCRIPTION:    
@@ -485,6 +685,29 @@ int EG_iclump_3d(Interval *intervals, int num_intervals,
 	       int ydim, int zdim, int clear, int min_overlap,
 	       Interval **interval_order, Clump_order *clump_order)
 
+{
+  Clump_context context;
+  int num_clumps;
+
+  EG_init_clump_context(&context);
+  num_clumps = EG_iclump_3d_r(&context, intervals, num_intervals,
+			      ydim, zdim, clear, min_overlap,
+			      interval_order, clump_order);
+  EG_free_clump_context(&context);
+
+  return(num_clumps);
+}
+
+/*
+ * Reentrant version of EG_iclump_3d(), using the stack and row
+ * headers in context - see Clump_context in clump.h.
+ */
+
+int EG_iclump_3d_r(Clump_context *context,
+		   Interval *intervals, int num_intervals,
+		   int ydim, int zdim, int clear, int min_overlap,
+		   Interval **interval_order, Clump_order *clump_order)
+
 {
   int interval_index;	  
   int curr_row;
@@ -501,9 +724,12 @@ int EG_iclump_3d(Interval *intervals, int num_intervals,
   interval_index = 0;
 
   /* initialize the stack */
-  if (EG_init_stack_3d() == -1)
+  if (_init_stack(context) == -1)
     return(-1);
 
+  if (num_intervals <= 0)
+    return(0);
+
   /* clear interval id's if required */
 
   if (clear) {
@@ -512,8 +738,9 @@ int EG_iclump_3d(Interval *intervals, int num_intervals,
 
   /* organize the intervals using a row_hdr array */
 
-  /* malloc an array of row_hdr */
-  row_hdr = EG_malloc(zdim*ydim*sizeof(Row_hdr)); 
+  /* use the row_hdr array in the context */
+  EG_alloc_rowh(zdim*ydim, &context->nrows_alloc, &context->row_hdr);
+  row_hdr = context->row_hdr;
 
   if (row_hdr == NULL)
     return(-1);
@@ -554,19 +781,13 @@ int EG_iclump_3d(Interval *intervals, int num_intervals,
 	      {
 		old_index = interval_index;
 		clump_order[value].ptr = &interval_order[interval_index];
-		clump_order[value].pts = EG_seed_3d(i, j, k, zdim, ydim, row_hdr, value, &interval_index, interval_order);
+		clump_order[value].pts = EG_seed_3d_r(context, i, j, k, zdim, ydim, row_hdr, value, &interval_index, interval_order);
 		clump_order[value].size = interval_index - old_index;
 		value++;
 	      }
 	  }
       }
 
-  /* free row_hdr */
-  (void)EG_free(row_hdr);
-
-  /* free the stack */
-  EG_free_stack_3d();
-
   return(value-1);
 }
 
@@ -646,6 +867,27 @@ int EG_rclump_3d(Row_hdr *row_hdr, int ydim, int zdim,
 		int clear, int min_overlap,
 		Interval **interval_order, Clump_order *clump_order)
 {
+  Clump_context context;
+  int num_clumps;
+
+  EG_init_clump_context(&context);
+  num_clumps = EG_rclump_3d_r(&context, row_hdr, ydim, zdim,
+			      clear, min_overlap,
+			      interval_order, clump_order);
+  EG_free_clump_context(&context);
+
+  return(num_clumps);
+}
+
+/*
+ * Reentrant version of EG_rclump_3d(), using the stack in context.
+ */
+
+int EG_rclump_3d_r(Clump_context *context,
+		   Row_hdr *row_hdr, int ydim, int zdim,
+		   int clear, int min_overlap,
+		   Interval **interval_order, Clump_order *clump_order)
+{
 
   int interval_index;	  
   int i;
@@ -660,7 +902,7 @@ int EG_rclump_3d(Row_hdr *row_hdr, int ydim, int zdim,
   interval_index = 0;
 
   /* initialize the stack */
-  if (EG_init_stack_3d() == -1)
+  if (_init_stack(context) == -1)
     return(-1);
 
   /* clear the interval id's */
@@ -697,7 +939,7 @@ int EG_rclump_3d(Row_hdr *row_hdr, int ydim, int zdim,
 		{
 		  old_index = interval_index;
 		  clump_order[value].ptr = &interval_order[interval_index];
-		  clump_order[value].pts = EG_seed_3d(i, j, k, zdim, ydim, row_hdr, value, &interval_index, interval_order);
+		  clump_order[value].pts = EG_seed_3d_r(context, i, j, k, zdim, ydim, row_hdr, value, &interval_index, interval_order);
 		  clump_order[value].size = interval_index - old_index;
 		  value++;
 		}
@@ -705,9 +947,6 @@ int EG_rclump_3d(Row_hdr *row_hdr, int ydim, int zdim,
 	}
     }
 
-  /* free the stack */
-  EG_free_stack_3d(); 
-
   return(value-1);
 }
 
@@ -860,4 +1099,129 @@ int EG_seed_3d(int i, int j, int k, int zdim, int ydim, Row_hdr *row_hdr, int va
     }
   return(count);
 }
+
+/*
+ * Reentrant version of EG_seed_3d(), using the stack in context.
+ */
+
+int EG_seed_3d_r(Clump_context *context, int i, int j, int k, int zdim, int ydim, Row_hdr *row_hdr, int value, int *interval_index, Interval **interval_order)
+{
+  int z;
+  int y;
+  int x;
+  int overlap_begin;
+  int overlap_end;
+  int count;
+  Row_hdr *rh_base;
+  Row_hdr *rh_ptr;
+
+  count = 0;
+  rh_base = &row_hdr[i*ydim+j];
+  rh_base->intervals[k].id = value;
+  if (_push_3d(context, i, j, k) == 0)
+    return(-1);
+  interval_order[(*interval_index)++] = &rh_base->intervals[k];
+
+  while (1)
+    {
+      if (_pop_3d(context, &z, &y, &x))
+	{
+	  rh_base = &row_hdr[z * ydim + y];
+	  count += rh_base->intervals[x].end - rh_base->intervals[x].begin + 1;
+	  if (y+1 < ydim)
+	    {
+	      overlap_begin = rh_base->intervals[x].overlaps[SOUTH_INTERVAL][OV_BEG_IN];
+	      overlap_end = rh_base->intervals[x].overlaps[SOUTH_INTERVAL][OV_END];
+	      rh_ptr = rh_base + 1;
+	      for (k=overlap_begin; k<=overlap_end; k++)
+		{
+		  if (rh_ptr->intervals[k].id == NULL_ID)
+		    {
+		      rh_ptr->intervals[k].id = value;
+		      if (_push_3d(context, z, y+1, k) == 0)
+			return(-1);
+
+		      /*
+		       * store the offset of the interval which was just
+		       * clumped for easy retrieval of clump intervals by
+		       * calling functions
+		       */
+		      interval_order[(*interval_index)++] = &rh_ptr->intervals[k];
+		    }
+		}
+	    }
+	  if (y-1 >= 0)
+	    {
+	      overlap_begin = rh_base->intervals[x].overlaps[NORTH_INTERVAL][OV_BEG_IN];
+	      overlap_end = rh_base->intervals[x].overlaps[NORTH_INTERVAL][OV_END];
+	      rh_ptr = rh_base-1;
+	      for (k=overlap_begin; k<=overlap_end; k++)
+		{
+		  if (rh_ptr->intervals[k].id == NULL_ID)
+		    {
+		      rh_ptr->intervals[k].id = value;
+		      if (_push_3d(context, z, y-1, k) == 0)
+			return(-1);
+
+		      /*
+		       * store the offset of the interval which was just
+		       * clumped for easy retrieval of clump intervals by
+		       * calling functions
+		       */
+		      interval_order[(*interval_index)++] = &rh_ptr->intervals[k];
+		    }
+		}
+
+	    }
+	  if (z+1 < zdim)
+	    {
+	      overlap_begin = rh_base->intervals[x].overlaps[UP_INTERVAL][OV_BEG_IN];
+	      overlap_end = rh_base->intervals[x].overlaps[UP_INTERVAL][OV_END];
+	      rh_ptr = rh_base + ydim;
+	      for (k=overlap_begin; k<=overlap_end; k++)
+		{
+		  if (rh_ptr->intervals[k].id == NULL_ID)
+		    {
+		      rh_ptr->intervals[k].id = value;
+		      if (_push_3d(context, z+1, y, k) == 0)
+			return(-1);
+
+		      /*
+		       * store the offset of the interval which was just
+		       * clumped for easy retrieval of clump intervals by
+		       * calling functions
+		       */
+		      interval_order[(*interval_index)++] = &rh_ptr->intervals[k];
+		    }
+		}
+	    }
+	  if (z-1 >= 0)
+	    {
+	      overlap_begin = rh_base->intervals[x].overlaps[DOWN_INTERVAL][OV_BEG_IN];
+	      overlap_end = rh_base->intervals[x].overlaps[DOWN_INTERVAL][OV_END];
+	      rh_ptr = rh_base - ydim;
+	      for (k=overlap_begin; k<=overlap_end; k++)
+		{
+		  if (rh_ptr->intervals[k].id == NULL_ID)
+		    {
+		      rh_ptr->intervals[k].id = value;
+		      if (_push_3d(context, z-1, y, k) == 0)
+			return(-1);
+
+		      /*
+		       * store the offset of the interval which was just
+		       * clumped for easy retrieval of clump intervals by
+		       * calling functions
+		       */
+		      interval_order[(*interval_index)++] = &rh_ptr->intervals[k];
+		    }
+		}
+
+	    }
+	}
+      else
+	break;
+    }
+  return(count);
+}
 
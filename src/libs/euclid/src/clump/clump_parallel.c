@@ -0,0 +1,637 @@
+/* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
+/* ** Copyright UCAR (c) 1990 - 2016                                         */
+/* ** University Corporation for Atmospheric Research (UCAR)                 */
+/* ** National Center for Atmospheric Research (NCAR)                        */
+/* ** Boulder, Colorado, USA                                                 */
+/* ** BSD licence applies - redistribution and use in source and binary      */
+/* ** forms, with or without modification, are permitted provided that       */
+/* ** the following conditions are met:                                      */
+/* ** 1) If the software is modified to produce derivative works,            */
+/* ** such modified software should be clearly marked, so as not             */
+/* ** to confuse it with the version available from UCAR.                    */
+/* ** 2) Redistributions of source code must retain the above copyright      */
+/* ** notice, this list of conditions and the following disclaimer.          */
+/* ** 3) Redistributions in binary form must reproduce the above copyright   */
+/* ** notice, this list of conditions and the following disclaimer in the    */
+/* ** documentation and/or other materials provided with the distribution.   */
+/* ** 4) Neither the name of UCAR nor the names of its contributors,         */
+/* ** if any, may be used to endorse or promote products derived from        */
+/* ** this software without specific prior written permission.               */
+/* ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  */
+/* ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      */
+/* ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    */
+/* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
+/**************************************************
+ * clump_parallel.c
+ *
+ * Multi-threaded interval finding and clumping.
+ *
+ * The volume is split into blocks of rows (rows in the volume, so a
+ * block may span several planes, or part of one). Each thread finds
+ * the intervals in its block, and then the overlaps and a union-find
+ * labelling for the links within its block. The links which cross
+ * block boundaries are merged afterwards, and the clumps are then
+ * numbered in a single pass.
+ *
+ * In the union-find, the root of each set is always the interval
+ * with the lowest index, i.e. the first interval in the clump in
+ * plane, row, column order. The clumps are therefore numbered in
+ * the same order as EG_rclump_3d(), which starts a new clump
+ * at each unclumped interval in that order.
+ */
+
+#include <string.h>
+#include <pthread.h>
+#include <euclid/clump.h>
+#include <euclid/alloc.h>
+
+#define MIN_INTV_ALLOC 4096
+
+typedef struct {
+  Clump_context *context;
+  int ithread;
+  int start_row;		/* first row in block */
+  int end_row;			/* one past last row in block */
+  int nrows_in_plane;
+  int nplanes;
+  int ncols;
+  unsigned char *byte_array;	/* byte data, or NULL */
+  float *float_array;		/* float data, or NULL */
+  int byte_threshold;
+  float float_threshold;
+  int min_overlap;
+  int nintervals;		/* intervals found in block */
+  int status;			/* 0 on success, -1 on error */
+} block_t;
+
+/*
+ * set up the blocks of rows, one per thread
+ * returns the number of blocks
+ */
+
+static int _set_blocks(Clump_context *context, int n_threads,
+		       int nplanes, int nrows_in_plane,
+		       block_t *blocks)
+{
+  int nrows_in_vol = nplanes * nrows_in_plane;
+  int i;
+
+  if (n_threads > nrows_in_vol)
+    n_threads = nrows_in_vol;
+
+  memset(blocks, 0, n_threads * sizeof(block_t));
+  for (i = 0; i < n_threads; i++)
+    {
+      blocks[i].context = context;
+      blocks[i].ithread = i;
+      blocks[i].start_row = (int) (((long) nrows_in_vol * i) / n_threads);
+      blocks[i].end_row = (int) (((long) nrows_in_vol * (i + 1)) / n_threads);
+      blocks[i].nplanes = nplanes;
+      blocks[i].nrows_in_plane = nrows_in_plane;
+    }
+
+  return(n_threads);
+}
+
+/*
+ * run func on each block, in its own thread except for the
+ * first, which is done in the calling thread. If the thread
+ * arrays cannot be allocated, the blocks are all done in the
+ * calling thread.
+ * returns 0 on success, -1 on failure
+ */
+
+static int _run_blocks(void *(*func)(void *), block_t *blocks, int nblocks)
+{
+  pthread_t *threads;
+  int *started;
+  int iret = 0;
+  int i;
+
+  threads = (pthread_t *) EG_malloc(nblocks * sizeof(pthread_t));
+  started = (int *) EG_calloc(nblocks, sizeof(int));
+  if (threads == NULL || started == NULL)
+    {
+      EG_free(started);
+      EG_free(threads);
+      for (i = 0; i < nblocks; i++)
+	{
+	  func(&blocks[i]);
+	  if (blocks[i].status)
+	    iret = -1;
+	}
+      return(iret);
+    }
+
+  for (i = 1; i < nblocks; i++)
+    {
+      if (pthread_create(&threads[i], NULL, func, &blocks[i]) == 0)
+	started[i] = 1;
+    }
+
+  func(&blocks[0]);
+
+  for (i = 1; i < nblocks; i++)
+    {
+      if (started[i])
+	pthread_join(threads[i], NULL);
+      else
+	func(&blocks[i]); /* could not start thread, do it here */
+      if (blocks[i].status)
+	iret = -1;
+    }
+  if (blocks[0].status)
+    iret = -1;
+
+  EG_free(started);
+  EG_free(threads);
+  return(iret);
+}
+
+/*
+ * make sure there is an interval buffer for each thread
+ */
+
+static int _alloc_thread_bufs(Clump_context *context, int n_threads)
+{
+  int i;
+
+  if (context->n_thread_alloc >= n_threads)
+    return(0);
+
+  context->thread_intervals = (Interval **)
+    EG_realloc(context->thread_intervals, n_threads * sizeof(Interval *));
+  context->thread_n_alloc = (int *)
+    EG_realloc(context->thread_n_alloc, n_threads * sizeof(int));
+  if (context->thread_intervals == NULL || context->thread_n_alloc == NULL)
+    return(-1);
+
+  for (i = context->n_thread_alloc; i < n_threads; i++)
+    {
+      context->thread_intervals[i] = NULL;
+      context->thread_n_alloc[i] = 0;
+    }
+  context->n_thread_alloc = n_threads;
+
+  return(0);
+}
+
+/*
+ * find the intervals in a block of rows, storing them in the
+ * thread interval buffer, and the sizes in the row headers
+ */
+
+static void *_find_block(void *arg)
+{
+  block_t *block = (block_t *) arg;
+  Clump_context *context = block->context;
+  int ncols = block->ncols;
+  int nalloc = MAX(ncols, MIN_INTV_ALLOC);
+  int n_intv_alloc = context->thread_n_alloc[block->ithread];
+  Interval *intervals = context->thread_intervals[block->ithread];
+  Interval *intvl;
+  Row_hdr *rhdr;
+  int nintvls = 0;
+  int count;
+  int irow, j;
+
+  for (irow = block->start_row; irow < block->end_row; irow++)
+    {
+      /* adjust the size of array intervals if necessary */
+      if (n_intv_alloc < nintvls + ncols)
+	{
+	  n_intv_alloc += nalloc;
+	  if ((intervals = EG_realloc((void *)intervals,
+				      n_intv_alloc*sizeof(Interval))) == NULL)
+	    {
+	      block->status = -1;
+	      break;
+	    }
+	}
+
+      /* determine the intervals in the row */
+      if (block->byte_array != NULL)
+	count = EG_get_intervals(block->byte_array + (long) ncols * irow,
+				 0, ncols-1, intervals+nintvls,
+				 block->byte_threshold);
+      else
+	count = EG_get_intervals_float(block->float_array + (long) ncols * irow,
+				       0, ncols-1, intervals+nintvls,
+				       block->float_threshold);
+
+      rhdr = &context->row_hdr[irow];
+      rhdr->size = count;
+      intvl = intervals + nintvls;
+      for (j=0; j<count; j++, intvl++)
+	{
+	  intvl->row_in_vol = irow;
+	  intvl->row_in_plane = irow % block->nrows_in_plane;
+	  intvl->plane = irow / block->nrows_in_plane;
+	  intvl->len = intvl->end - intvl->begin + 1;
+	}
+      nintvls += count;
+    }
+
+  context->thread_intervals[block->ithread] = intervals;
+  context->thread_n_alloc[block->ithread] = n_intv_alloc;
+  block->nintervals = nintvls;
+  return(NULL);
+}
+
+/*
+ * find the intervals in all blocks, and gather them into the
+ * context intervals array
+ */
+
+static int _find_intervals_mt(Clump_context *context, int n_threads,
+			      int nplanes, int nrows_in_plane, int ncols,
+			      unsigned char *byte_array, int byte_threshold,
+			      float *float_array, float float_threshold)
+{
+  int nrows_in_vol = nplanes * nrows_in_plane;
+  block_t *blocks;
+  Row_hdr *rhdr;
+  int nblocks;
+  int nintvls;
+  int i;
+
+  if (nrows_in_vol < 1)
+    return(0);
+
+  EG_alloc_rowh(nrows_in_vol, &context->nrows_alloc, &context->row_hdr);
+  if (context->row_hdr == NULL)
+    return(-1);
+
+  blocks = (block_t *) EG_malloc(n_threads * sizeof(block_t));
+  if (blocks == NULL)
+    return(-1);
+  nblocks = _set_blocks(context, n_threads, nplanes, nrows_in_plane, blocks);
+  if (_alloc_thread_bufs(context, nblocks))
+    {
+      EG_free(blocks);
+      return(-1);
+    }
+  for (i = 0; i < nblocks; i++)
+    {
+      blocks[i].ncols = ncols;
+      blocks[i].byte_array = byte_array;
+      blocks[i].byte_threshold = byte_threshold;
+      blocks[i].float_array = float_array;
+      blocks[i].float_threshold = float_threshold;
+    }
+
+  if (_run_blocks(_find_block, blocks, nblocks))
+    {
+      EG_free(blocks);
+      return(-1);
+    }
+
+  /* gather the blocks into the context intervals array */
+
+  nintvls = 0;
+  for (i = 0; i < nblocks; i++)
+    nintvls += blocks[i].nintervals;
+
+  if (context->n_intv_alloc < nintvls || context->intervals == NULL)
+    {
+      int nalloc = MAX(nintvls, MIN_INTV_ALLOC);
+      context->intervals = (Interval *)
+	EG_realloc(context->intervals, nalloc * sizeof(Interval));
+      if (context->intervals == NULL)
+	{
+	  context->n_intv_alloc = 0;
+	  EG_free(blocks);
+	  return(-1);
+	}
+      context->n_intv_alloc = nalloc;
+    }
+
+  nintvls = 0;
+  for (i = 0; i < nblocks; i++)
+    {
+      memcpy(context->intervals + nintvls, context->thread_intervals[i],
+	     blocks[i].nintervals * sizeof(Interval));
+      nintvls += blocks[i].nintervals;
+    }
+  EG_free(blocks);
+
+  /* set row_hdr interval pointers */
+
+  nintvls = 0;
+  rhdr = context->row_hdr;
+  for (i = 0; i < nrows_in_vol; i++, rhdr++)
+    {
+      if (rhdr->size > 0)
+	rhdr->intervals = context->intervals + nintvls;
+      else
+	rhdr->intervals = NULL;
+      nintvls += rhdr->size;
+    }
+
+  return(nintvls);
+}
+
+/*
+ * EG_find_intervals_3d_mt()
+ *
+ * Multi-threaded version of EG_find_intervals_3d_r().
+ * See clump.h.
+ */
+
+int EG_find_intervals_3d_mt(Clump_context *context, int n_threads,
+			    int nplanes, int nrows_in_plane, int ncols,
+			    unsigned char array[], int threshold)
+{
+  if (n_threads <= 1)
+    return(EG_find_intervals_3d_r(context, nplanes, nrows_in_plane,
+				  ncols, array, threshold));
+
+  return(_find_intervals_mt(context, n_threads,
+			    nplanes, nrows_in_plane, ncols,
+			    array, threshold, NULL, 0.0));
+}
+
+/*
+ * EG_find_intervals_3d_float_mt()
+ *
+ * Multi-threaded version of EG_find_intervals_3d_float_r().
+ * See clump.h.
+ */
+
+int EG_find_intervals_3d_float_mt(Clump_context *context, int n_threads,
+				  int nplanes, int nrows_in_plane, int ncols,
+				  float array[], float threshold)
+{
+  if (n_threads <= 1)
+    return(EG_find_intervals_3d_float_r(context, nplanes, nrows_in_plane,
+					ncols, array, threshold));
+
+  return(_find_intervals_mt(context, n_threads,
+			    nplanes, nrows_in_plane, ncols,
+			    NULL, 0, array, threshold));
+}
+
+/*
+ * union-find on interval indices
+ *
+ * The parent of an interval always has a lower index, so the root
+ * of a set is its first interval.
+ */
+
+static int _find_root(int *parent, int i)
+{
+  while (parent[i] != i)
+    {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+  return(i);
+}
+
+static void _union(int *parent, int i, int j)
+{
+  i = _find_root(parent, i);
+  j = _find_root(parent, j);
+  if (i < j)
+    parent[j] = i;
+  else if (j < i)
+    parent[i] = j;
+}
+
+/*
+ * union the intervals in row irow with the intervals they overlap
+ * in the given direction, which are in row irow + drow
+ */
+
+static void _union_row(Clump_context *context, int irow, int drow,
+		       int direction)
+{
+  Row_hdr *rhdr = &context->row_hdr[irow];
+  Row_hdr *rhdr2 = rhdr + drow;
+  Interval *intvl;
+  int index, index2;
+  int j, k;
+
+  if (rhdr2->size == 0)
+    return;
+
+  intvl = rhdr->intervals;
+  index = (int) (intvl - context->intervals);
+  for (j = 0; j < rhdr->size; j++, intvl++, index++)
+    {
+      index2 = (int) (rhdr2->intervals - context->intervals);
+      for (k = intvl->overlaps[direction][OV_BEG_IN];
+	   k <= intvl->overlaps[direction][OV_END]; k++)
+	_union(context->parent, index, index2 + k);
+    }
+}
+
+/*
+ * set the overlaps in a row, as for EG_overlap_volume()
+ */
+
+static void _overlap_row(Row_hdr *row_hdr, int irow, int nplanes,
+			 int nrows_in_plane, int min_overlap)
+{
+  Row_hdr *rhdr = &row_hdr[irow];
+  int iplane = irow / nrows_in_plane;
+  int irow_in_plane = irow % nrows_in_plane;
+  int j;
+
+  for (j = 0; j < rhdr->size; j++)
+    {
+      rhdr->intervals[j].overlaps[NORTH_INTERVAL][0] = 1;
+      rhdr->intervals[j].overlaps[NORTH_INTERVAL][1] = 0;
+      rhdr->intervals[j].overlaps[SOUTH_INTERVAL][0] = 1;
+      rhdr->intervals[j].overlaps[SOUTH_INTERVAL][1] = 0;
+      rhdr->intervals[j].overlaps[UP_INTERVAL][0] = 1;
+      rhdr->intervals[j].overlaps[UP_INTERVAL][1] = 0;
+      rhdr->intervals[j].overlaps[DOWN_INTERVAL][0] = 1;
+      rhdr->intervals[j].overlaps[DOWN_INTERVAL][1] = 0;
+    }
+
+  if (irow_in_plane + 1 < nrows_in_plane)
+    EG_overlap_rows(rhdr, rhdr + 1, SOUTH_INTERVAL, min_overlap);
+  if (irow_in_plane > 0)
+    EG_overlap_rows(rhdr, rhdr - 1, NORTH_INTERVAL, min_overlap);
+  if (iplane + 1 < nplanes)
+    EG_overlap_rows(rhdr, rhdr + nrows_in_plane, UP_INTERVAL, min_overlap);
+  if (iplane > 0)
+    EG_overlap_rows(rhdr, rhdr - nrows_in_plane, DOWN_INTERVAL, min_overlap);
+}
+
+/*
+ * set the overlaps in a block of rows, and union the intervals
+ * linked within the block
+ */
+
+static void *_label_block(void *arg)
+{
+  block_t *block = (block_t *) arg;
+  Clump_context *context = block->context;
+  int nrows_in_plane = block->nrows_in_plane;
+  int start, end;
+  int irow, i;
+
+  /* the intervals in the block are contiguous */
+
+  start = -1;
+  end = -1;
+  for (irow = block->start_row; irow < block->end_row; irow++)
+    {
+      Row_hdr *rhdr = &context->row_hdr[irow];
+      if (rhdr->size > 0)
+	{
+	  if (start < 0)
+	    start = (int) (rhdr->intervals - context->intervals);
+	  end = (int) (rhdr->intervals - context->intervals) + rhdr->size;
+	}
+    }
+  for (i = start; i < end; i++)
+    context->parent[i] = i;
+
+  for (irow = block->start_row; irow < block->end_row; irow++)
+    {
+      _overlap_row(context->row_hdr, irow, block->nplanes,
+		   nrows_in_plane, block->min_overlap);
+    }
+
+  for (irow = block->start_row; irow < block->end_row; irow++)
+    {
+      if (context->row_hdr[irow].size == 0)
+	continue;
+      if ((irow + 1) % nrows_in_plane != 0 && irow + 1 < block->end_row)
+	_union_row(context, irow, 1, SOUTH_INTERVAL);
+      if (irow + nrows_in_plane < block->end_row)
+	_union_row(context, irow, nrows_in_plane, UP_INTERVAL);
+    }
+
+  return(NULL);
+}
+
+/*
+ * EG_clump_intervals_3d_mt()
+ *
+ * Multi-threaded version of EG_clump_intervals_3d_r().
+ * See clump.h.
+ */
+
+int EG_clump_intervals_3d_mt(Clump_context *context, int n_threads,
+			     int nplanes, int nrows_in_plane,
+			     int num_intervals, int min_overlap)
+{
+  int nrows_in_vol = nplanes * nrows_in_plane;
+  Clump_order *clump;
+  Interval *intvl;
+  block_t *blocks;
+  int *parent;
+  int nblocks;
+  int nclumps;
+  int offset;
+  int irow, i, root;
+
+  if (n_threads <= 1)
+    return(EG_clump_intervals_3d_r(context, nplanes, nrows_in_plane,
+				   num_intervals, min_overlap));
+
+  if (num_intervals <= 0)
+    return(0);
+
+  EG_alloc_clumps(num_intervals, &context->n_order_alloc,
+		  &context->clump_order, &context->interval_order);
+  if (context->clump_order == NULL || context->interval_order == NULL)
+    return(-1);
+
+  if (context->n_parent_alloc < num_intervals)
+    {
+      context->parent = (int *)
+	EG_realloc(context->parent, num_intervals * sizeof(int));
+      if (context->parent == NULL)
+	{
+	  context->n_parent_alloc = 0;
+	  return(-1);
+	}
+      context->n_parent_alloc = num_intervals;
+    }
+  parent = context->parent;
+
+  /* overlaps and links within each block */
+
+  blocks = (block_t *) EG_malloc(n_threads * sizeof(block_t));
+  if (blocks == NULL)
+    return(-1);
+  nblocks = _set_blocks(context, n_threads, nplanes, nrows_in_plane, blocks);
+  for (i = 0; i < nblocks; i++)
+    blocks[i].min_overlap = min_overlap;
+  if (_run_blocks(_label_block, blocks, nblocks))
+    {
+      EG_free(blocks);
+      return(-1);
+    }
+
+  /* links across the block boundaries */
+
+  for (i = 0; i < nblocks - 1; i++)
+    {
+      int end_row = blocks[i].end_row;
+      irow = MAX(blocks[i].start_row, end_row - nrows_in_plane);
+      for (; irow < end_row; irow++)
+	{
+	  if (context->row_hdr[irow].size == 0)
+	    continue;
+	  if (irow + 1 == end_row && end_row % nrows_in_plane != 0)
+	    _union_row(context, irow, 1, SOUTH_INTERVAL);
+	  if (irow + nrows_in_plane < nrows_in_vol)
+	    _union_row(context, irow, nrows_in_plane, UP_INTERVAL);
+	}
+    }
+  EG_free(blocks);
+
+  /*
+   * number the clumps - since the parent of an interval has a
+   * lower index, one pass in index order sets all parents to roots
+   */
+
+  nclumps = 0;
+  intvl = context->intervals;
+  for (i = 0; i < num_intervals; i++, intvl++)
+    {
+      root = parent[parent[i]];
+      parent[i] = root;
+      if (root == i)
+	{
+	  nclumps++;
+	  intvl->id = nclumps;
+	  clump = &context->clump_order[nclumps];
+	  clump->size = 0;
+	  clump->pts = 0;
+	}
+      else
+	{
+	  intvl->id = context->intervals[root].id;
+	  clump = &context->clump_order[intvl->id];
+	}
+      clump->size++;
+      clump->pts += intvl->len;
+    }
+
+  /* set the interval order, in plane, row, column order in each clump */
+
+  offset = 0;
+  for (i = 1; i <= nclumps; i++)
+    {
+      clump = &context->clump_order[i];
+      clump->ptr = context->interval_order + offset;
+      offset += clump->size;
+      clump->size = 0;
+    }
+
+  intvl = context->intervals;
+  for (i = 0; i < num_intervals; i++, intvl++)
+    {
+      clump = &context->clump_order[intvl->id];
+      clump->ptr[clump->size++] = intvl;
+    }
+
+  return(nclumps);
+}
@@ -23,6 +23,13 @@
 /* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
 /* stack_interval.c - functions to manipulate a stack for seed.c */
 
+/*
+ * These stacks are global, so are not thread safe. The clumping
+ * functions use the stack in a Clump_context instead - see
+ * clump_intervals.c. These are kept for EG_seed_2d() and
+ * EG_seed_3d().
+ */
+
 #include <stdio.h>
 #include <sys/types.h>
 #include <stdlib.h>
@@ -36,14 +43,16 @@ static int top_2d = 0;
 static int *stack_2d = NULL;
 static int top_3d = 0;
 static int *stack_3d = NULL;
-static int max_stack = INIT_MAX_STACK;
+static int max_stack_2d = INIT_MAX_STACK;
+static int max_stack_3d = INIT_MAX_STACK;
 
 int
 EG_init_stack_2d()
 {
   if (stack_2d == NULL)
     {
-      stack_2d = (int *)EG_malloc(max_stack*sizeof(int));
+      max_stack_2d = INIT_MAX_STACK;
+      stack_2d = (int *)EG_malloc(max_stack_2d*sizeof(int));
       if (stack_2d == NULL)
 	return(-1);
     }
@@ -69,7 +78,7 @@ int EG_push_2d(int x, int y)
 {
   void *ptr;
 
-  if (top_2d < max_stack - 1)
+  if (top_2d < max_stack_2d - 1)
     {
       stack_2d[top_2d++] = x;
       stack_2d[top_2d++] = y;
@@ -78,8 +87,8 @@ int EG_push_2d(int x, int y)
   else
     {
       /* try to realloc */
-      max_stack += STACK_INCR;
-      ptr = EG_realloc(stack_2d, max_stack * sizeof(int));
+      max_stack_2d += STACK_INCR;
+      ptr = EG_realloc(stack_2d, max_stack_2d * sizeof(int));
       stack_2d = ptr;
       if (ptr == NULL)
 	{
@@ -116,7 +125,8 @@ EG_init_stack_3d()
 {
   if (stack_3d == NULL)
     {
-      stack_3d = (int *)EG_malloc(max_stack*sizeof(int));
+      max_stack_3d = INIT_MAX_STACK;
+      stack_3d = (int *)EG_malloc(max_stack_3d*sizeof(int));
       if (stack_3d == NULL)
 	return(-1);
     }
@@ -142,7 +152,7 @@ int EG_push_3d(int x, int y, int z)
 {
   void *ptr;
 
-  if (top_3d < max_stack - 2)
+  if (top_3d < max_stack_3d - 2)
     {
       stack_3d[top_3d++] = x;
       stack_3d[top_3d++] = y;
@@ -152,8 +162,8 @@ int EG_push_3d(int x, int y, int z)
   else
     {
       /* try to realloc */
-      max_stack += STACK_INCR;
-      ptr = EG_realloc(stack_3d, max_stack * sizeof(int));
+      max_stack_3d += STACK_INCR;
+      ptr = EG_realloc(stack_3d, max_stack_3d * sizeof(int));
       stack_3d = ptr;
       if (ptr == NULL)
 	{
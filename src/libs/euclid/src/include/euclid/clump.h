@@ -208,6 +208,35 @@ typedef struct oclump_info
   OClump_order *clump_order;	/* organizes interval_order array */
 } OClump_info;
 
+/*
+ * clump context - working storage for the reentrant clumping
+ * functions, EG_rclump_3d_r() etc. These functions use no global
+ * state, so clumping may be done in several threads at once,
+ * provided each thread has its own context.
+ * The storage is grown as needed and kept between calls, so a
+ * context should be reused rather than set up for each call.
+ * Initialize with EG_init_clump_context() before first use, and
+ * free with EG_free_clump_context().
+ */
+typedef struct clump_context
+{
+  int *stack;			/* seed stack */
+  int stack_top;		/* number of entries in use */
+  int stack_alloc;		/* size of stack array */
+  int nrows_alloc;		/* size of row_hdr array */
+  Row_hdr *row_hdr;		/* organizes intervals array */
+  int n_intv_alloc;		/* size of intervals array */
+  Interval *intervals;		/* array of intervals in volume */
+  int n_order_alloc;		/* intervals catered for in the order arrays */
+  Interval **interval_order;	/* orders intervals according to clump */
+  Clump_order *clump_order;	/* organizes interval_order array */
+  int n_parent_alloc;		/* size of parent array */
+  int *parent;			/* union-find parents, for the _mt functions */
+  int n_thread_alloc;		/* number of thread interval buffers */
+  int *thread_n_alloc;		/* size of each thread interval buffer */
+  Interval **thread_intervals;	/* thread interval buffers */
+} Clump_context;
+
 /*
  * clump offset structure (See clump_order structure above.  This
  * structure is used for files
@@ -2789,6 +2818,118 @@ extern void EG_clear_stack_3d();
 extern int EG_push_3d(int x, int y, int z);
 extern int EG_pop_3d(int *x, int *y, int *z);
 
+/*
+ * Reentrant clumping, using a caller-owned Clump_context in place
+ * of the global seed stack - see Clump_context above.
+ *
+ * EG_iclump_2d_r(), EG_rclump_2d_r(), EG_iclump_3d_r(),
+ * EG_rclump_3d_r(), EG_seed_2d_r() and EG_seed_3d_r() take the
+ * same arguments and return the same values as the functions
+ * without the _r suffix. EG_iclump_2d_r() and EG_iclump_3d_r()
+ * also use the row headers in the context.
+ *
+ * The non-reentrant EG_iclump_2d(), EG_rclump_2d() etc. are
+ * wrappers for these, using a temporary context.
+ */
+
+extern void EG_init_clump_context(Clump_context *context);
+extern void EG_free_clump_context(Clump_context *context);
+
+extern int EG_iclump_2d_r(Clump_context *context,
+			  Interval *intervals, int num_intervals,
+			  int ydim, int clear, int min_overlap,
+			  Interval **interval_order, Clump_order *clump_order);
+
+extern int EG_rclump_2d_r(Clump_context *context,
+			  Row_hdr *row_hdr, int ydim,
+			  int clear, int min_overlap,
+			  Interval **interval_order, Clump_order *clump_order);
+
+extern int EG_seed_2d_r(Clump_context *context,
+			int i, int j, int ydim, Row_hdr row_hdr[],
+			int value, int *interval_index,
+			Interval **interval_order);
+
+extern int EG_iclump_3d_r(Clump_context *context,
+			  Interval *intervals, int num_intervals,
+			  int ydim, int zdim, int clear, int min_overlap,
+			  Interval **interval_order, Clump_order *clump_order);
+
+extern int EG_rclump_3d_r(Clump_context *context,
+			  Row_hdr *row_hdr, int ydim, int zdim,
+			  int clear, int min_overlap,
+			  Interval **interval_order, Clump_order *clump_order);
+
+extern int EG_seed_3d_r(Clump_context *context,
+			int i, int j, int k, int zdim, int ydim,
+			Row_hdr *row_hdr, int value, int *interval_index,
+			Interval **interval_order);
+
+/*
+ * EG_find_intervals_3d_r(), EG_find_intervals_3d_float_r()
+ *
+ * Find the intervals >= threshold in a volume, as for
+ * EG_find_intervals_3d(), storing the intervals and row headers
+ * in the context.
+ *
+ * Returns the number of intervals found, -1 on error.
+ */
+
+extern int EG_find_intervals_3d_r(Clump_context *context,
+				  int nplanes, int nrows_in_plane, int ncols,
+				  unsigned char array[], int threshold);
+
+extern int EG_find_intervals_3d_float_r(Clump_context *context,
+					int nplanes, int nrows_in_plane,
+					int ncols, float array[],
+					float threshold);
+
+/*
+ * EG_clump_intervals_3d_r()
+ *
+ * Clump the intervals found by the last call to
+ * EG_find_intervals_3d_r() or EG_find_intervals_3d_float_r()
+ * on this context. The clumps are returned in context->clump_order,
+ * as for EG_rclump_3d().
+ *
+ * Returns the number of clumps, -1 on error.
+ */
+
+extern int EG_clump_intervals_3d_r(Clump_context *context,
+				   int nplanes, int nrows_in_plane,
+				   int num_intervals, int min_overlap);
+
+/*
+ * Multi-threaded versions of EG_find_intervals_3d_r(),
+ * EG_find_intervals_3d_float_r() and EG_clump_intervals_3d_r().
+ *
+ * The volume is split into blocks of rows, one per thread.
+ * The intervals and overlaps are found for each block concurrently,
+ * and the intervals are labelled within each block by union-find.
+ * The labels are then merged across the block boundaries.
+ *
+ * The results are the same as for the _r functions - the same
+ * intervals, overlaps and clump ids, and the same clumps in
+ * context->clump_order - except that the intervals in each clump
+ * are in plane, row, column order rather than seed-fill order.
+ *
+ * If n_threads is 1 or less, the _r functions are called.
+ */
+
+extern int EG_find_intervals_3d_mt(Clump_context *context, int n_threads,
+				   int nplanes, int nrows_in_plane, int ncols,
+				   unsigned char array[], int threshold);
+
+extern int EG_find_intervals_3d_float_mt(Clump_context *context,
+					 int n_threads,
+					 int nplanes, int nrows_in_plane,
+					 int ncols, float array[],
+					 float threshold);
+
+extern int EG_clump_intervals_3d_mt(Clump_context *context, int n_threads,
+				    int nplanes, int nrows_in_plane,
+				    int num_intervals, int min_overlap);
+
 #ifdef __cplusplus
 }
 #endif
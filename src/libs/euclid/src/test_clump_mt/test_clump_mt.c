@@ -0,0 +1,444 @@
+/* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
+/* ** Copyright UCAR (c) 1990 - 2016                                         */
+/* ** University Corporation for Atmospheric Research (UCAR)                 */
+/* ** National Center for Atmospheric Research (NCAR)                        */
+/* ** Boulder, Colorado, USA                                                 */
+/* ** BSD licence applies - redistribution and use in source and binary      */
+/* ** forms, with or without modification, are permitted provided that       */
+/* ** the following conditions are met:                                      */
+/* ** 1) If the software is modified to produce derivative works,            */
+/* ** such modified software should be clearly marked, so as not             */
+/* ** to confuse it with the version available from UCAR.                    */
+/* ** 2) Redistributions of source code must retain the above copyright      */
+/* ** notice, this list of conditions and the following disclaimer.          */
+/* ** 3) Redistributions in binary form must reproduce the above copyright   */
+/* ** notice, this list of conditions and the following disclaimer in the    */
+/* ** documentation and/or other materials provided with the distribution.   */
+/* ** 4) Neither the name of UCAR nor the names of its contributors,         */
+/* ** if any, may be used to endorse or promote products derived from        */
+/* ** this software without specific prior written permission.               */
+/* ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  */
+/* ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      */
+/* ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    */
+/* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
+/**************************************************
+ * test_clump_mt.c
+ *
+ * Test and benchmark for the multi-threaded clumping functions.
+ *
+ * A volume of random storm-like blobs is clumped with the serial
+ * functions, EG_find_intervals_3d_r() and EG_clump_intervals_3d_r(),
+ * and then with the _mt functions for 1 to N threads. The intervals,
+ * clump ids and clumps in Clump_order must be the same for every
+ * thread count - the intervals within each clump are compared as
+ * sets, since the _mt functions order them differently. The float
+ * version of interval finding is checked in the same way.
+ *
+ * The time for interval finding plus clumping is reported for each
+ * thread count, as the best of several repeats.
+ *
+ * Usage: test_clump_mt [max_threads nplanes nrows ncols]
+ *
+ * Returns 0 if all results match, 1 otherwise.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <euclid/clump.h>
+
+#define THRESHOLD 30
+#define MIN_OVERLAP 1
+#define N_REPEATS 5
+#define N_BLOBS_PER_PLANE 40
+
+/*
+ * results of a clumping run, for comparison
+ */
+
+typedef struct {
+  int nintervals;
+  int nclumps;
+  Interval *intervals;		/* copy of the context intervals */
+  int *clump_size;		/* intervals in each clump, 1-based */
+  int *clump_pts;		/* points in each clump, 1-based */
+  int *members;			/* interval indices, sorted, by clump */
+} result_t;
+
+static double _now(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+static unsigned int _rand_state = 12345;
+
+static int _rand_int(int n)
+{
+  _rand_state = _rand_state * 1103515245 + 12345;
+  return (int) ((_rand_state >> 8) % (unsigned int) n);
+}
+
+/*
+ * fill the volume with elliptical blobs, which are offset and
+ * resized from plane to plane, plus sparse noise
+ */
+
+static void _make_volume(unsigned char *vol, int nplanes,
+			 int nrows, int ncols)
+{
+  int iplane, iblob, irow, icol, i;
+
+  memset(vol, 0, (size_t) nplanes * nrows * ncols);
+
+  for (iblob = 0; iblob < N_BLOBS_PER_PLANE; iblob++)
+    {
+      int crow = _rand_int(nrows);
+      int ccol = _rand_int(ncols);
+      int rrad = 2 + _rand_int(nrows / 10 + 1);
+      int crad = 2 + _rand_int(ncols / 10 + 1);
+      int top = _rand_int(nplanes) + 1;
+      for (iplane = 0; iplane < top; iplane++)
+	{
+	  int rr = rrad - (rrad * iplane) / (top + 1);
+	  int cr = crad - (crad * iplane) / (top + 1);
+	  int r0 = crow + iplane, c0 = ccol + iplane;
+	  unsigned char *plane = vol + (size_t) iplane * nrows * ncols;
+	  for (irow = r0 - rr; irow <= r0 + rr; irow++)
+	    {
+	      if (irow < 0 || irow >= nrows)
+		continue;
+	      for (icol = c0 - cr; icol <= c0 + cr; icol++)
+		{
+		  double dr = (double) (irow - r0) / (rr + 1);
+		  double dc = (double) (icol - c0) / (cr + 1);
+		  if (icol < 0 || icol >= ncols)
+		    continue;
+		  if (dr * dr + dc * dc <= 1.0)
+		    plane[(size_t) irow * ncols + icol] =
+		      (unsigned char) (THRESHOLD + _rand_int(30));
+		}
+	    }
+	}
+    }
+
+  for (i = 0; i < nplanes * nrows * ncols / 2000; i++)
+    vol[_rand_int(nplanes * nrows * ncols)] =
+      (unsigned char) (THRESHOLD + _rand_int(10));
+}
+
+static int _compare_int(const void *a, const void *b)
+{
+  int ia = *(const int *) a;
+  int ib = *(const int *) b;
+  return (ia > ib) - (ia < ib);
+}
+
+/*
+ * save the results from the context
+ */
+
+static int _save_result(Clump_context *context, int nintervals,
+			int nclumps, result_t *result)
+{
+  int i, j, offset;
+
+  result->nintervals = nintervals;
+  result->nclumps = nclumps;
+  result->intervals = (Interval *) malloc((nintervals + 1) * sizeof(Interval));
+  result->clump_size = (int *) malloc((nclumps + 1) * sizeof(int));
+  result->clump_pts = (int *) malloc((nclumps + 1) * sizeof(int));
+  result->members = (int *) malloc((nintervals + 1) * sizeof(int));
+  if (result->intervals == NULL || result->clump_size == NULL ||
+      result->clump_pts == NULL || result->members == NULL)
+    {
+      fprintf(stderr, "ERROR - test_clump_mt: out of memory\n");
+      return(-1);
+    }
+
+  memcpy(result->intervals, context->intervals,
+	 nintervals * sizeof(Interval));
+
+  offset = 0;
+  for (i = 1; i <= nclumps; i++)
+    {
+      Clump_order *clump = &context->clump_order[i];
+      result->clump_size[i] = clump->size;
+      result->clump_pts[i] = clump->pts;
+      for (j = 0; j < clump->size; j++)
+	result->members[offset + j] =
+	  (int) (clump->ptr[j] - context->intervals);
+      qsort(result->members + offset, clump->size, sizeof(int),
+	    _compare_int);
+      offset += clump->size;
+    }
+
+  return(0);
+}
+
+static void _free_result(result_t *result)
+{
+  free(result->intervals);
+  free(result->clump_size);
+  free(result->clump_pts);
+  free(result->members);
+  memset(result, 0, sizeof(result_t));
+}
+
+/*
+ * compare results, printing the first difference
+ * returns 0 if the same, -1 if not
+ */
+
+static int _compare_results(const result_t *ref, const result_t *res,
+			    const char *label)
+{
+  int i, j;
+
+  if (ref->nintervals != res->nintervals)
+    {
+      fprintf(stderr, "  %s: nintervals %d, should be %d\n",
+	      label, res->nintervals, ref->nintervals);
+      return(-1);
+    }
+  if (ref->nclumps != res->nclumps)
+    {
+      fprintf(stderr, "  %s: nclumps %d, should be %d\n",
+	      label, res->nclumps, ref->nclumps);
+      return(-1);
+    }
+
+  for (i = 0; i < ref->nintervals; i++)
+    {
+      const Interval *a = &ref->intervals[i];
+      const Interval *b = &res->intervals[i];
+      if (a->row_in_vol != b->row_in_vol || a->begin != b->begin ||
+	  a->end != b->end || a->id != b->id)
+	{
+	  fprintf(stderr, "  %s: interval %d differs, "
+		  "row %d cols %d-%d id %d, should be "
+		  "row %d cols %d-%d id %d\n",
+		  label, i, b->row_in_vol, b->begin, b->end, b->id,
+		  a->row_in_vol, a->begin, a->end, a->id);
+	  return(-1);
+	}
+      for (j = 0; j < 4; j++)
+	{
+	  if (a->overlaps[j][0] != b->overlaps[j][0] ||
+	      a->overlaps[j][1] != b->overlaps[j][1])
+	    {
+	      fprintf(stderr, "  %s: interval %d overlaps differ\n",
+		      label, i);
+	      return(-1);
+	    }
+	}
+    }
+
+  for (i = 1; i <= ref->nclumps; i++)
+    {
+      if (ref->clump_size[i] != res->clump_size[i] ||
+	  ref->clump_pts[i] != res->clump_pts[i])
+	{
+	  fprintf(stderr, "  %s: clump %d has %d intervals %d pts, "
+		  "should be %d intervals %d pts\n",
+		  label, i, res->clump_size[i], res->clump_pts[i],
+		  ref->clump_size[i], ref->clump_pts[i]);
+	  return(-1);
+	}
+    }
+
+  for (i = 0; i < ref->nintervals; i++)
+    {
+      if (ref->members[i] != res->members[i])
+	{
+	  fprintf(stderr, "  %s: clump members differ\n", label);
+	  return(-1);
+	}
+    }
+
+  return(0);
+}
+
+/*
+ * clump the volume, with the _r functions if n_threads is 0,
+ * otherwise with the _mt functions
+ * returns the number of clumps, -1 on error
+ */
+
+static int _clump(Clump_context *context, int n_threads,
+		  int nplanes, int nrows, int ncols,
+		  unsigned char *vol, float *fvol, int *nintervals)
+{
+  if (n_threads == 0)
+    {
+      if (fvol != NULL)
+	*nintervals = EG_find_intervals_3d_float_r(context, nplanes, nrows,
+						   ncols, fvol, THRESHOLD);
+      else
+	*nintervals = EG_find_intervals_3d_r(context, nplanes, nrows,
+					     ncols, vol, THRESHOLD);
+      if (*nintervals < 0)
+	return(-1);
+      return(EG_clump_intervals_3d_r(context, nplanes, nrows,
+				     *nintervals, MIN_OVERLAP));
+    }
+
+  if (fvol != NULL)
+    *nintervals = EG_find_intervals_3d_float_mt(context, n_threads,
+						nplanes, nrows, ncols,
+						fvol, THRESHOLD);
+  else
+    *nintervals = EG_find_intervals_3d_mt(context, n_threads,
+					  nplanes, nrows, ncols,
+					  vol, THRESHOLD);
+  if (*nintervals < 0)
+    return(-1);
+  return(EG_clump_intervals_3d_mt(context, n_threads, nplanes, nrows,
+				  *nintervals, MIN_OVERLAP));
+}
+
+/*
+ * clump, timing the best of N_REPEATS, and save the results
+ * returns the time in secs, -1 on error
+ */
+
+static double _run(Clump_context *context, int n_threads,
+		   int nplanes, int nrows, int ncols,
+		   unsigned char *vol, float *fvol, result_t *result)
+{
+  double best = -1.0;
+  int nintervals = 0;
+  int nclumps = 0;
+  int irep;
+
+  for (irep = 0; irep < N_REPEATS; irep++)
+    {
+      double start = _now();
+      double secs;
+      nclumps = _clump(context, n_threads, nplanes, nrows, ncols,
+		       vol, fvol, &nintervals);
+      secs = _now() - start;
+      if (nclumps < 0)
+	{
+	  fprintf(stderr, "ERROR - test_clump_mt: clumping failed, "
+		  "n_threads %d\n", n_threads);
+	  return(-1.0);
+	}
+      if (best < 0 || secs < best)
+	best = secs;
+    }
+
+  if (_save_result(context, nintervals, nclumps, result))
+    return(-1.0);
+
+  return(best);
+}
+
+int main(int argc, char **argv)
+{
+  Clump_context serial_context, mt_context;
+  result_t ref, res;
+  unsigned char *vol;
+  float *fvol;
+  double serial_secs, secs;
+  char label[64];
+  int max_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  int nplanes = 20, nrows = 600, ncols = 600;
+  int npoints, n_threads, i;
+  int match;
+  int iret = 0;
+
+  if (argc > 1)
+    max_threads = atoi(argv[1]);
+  if (argc > 4)
+    {
+      nplanes = atoi(argv[2]);
+      nrows = atoi(argv[3]);
+      ncols = atoi(argv[4]);
+    }
+  if (max_threads < 1)
+    max_threads = 1;
+  if (nplanes < 1 || nrows < 1 || ncols < 1 ||
+      nplanes * nrows > 32767 || ncols > 32767)
+    {
+      fprintf(stderr, "Usage: %s [max_threads nplanes nrows ncols]\n",
+	      argv[0]);
+      fprintf(stderr, "  nplanes * nrows and ncols must be < 32768\n");
+      return(1);
+    }
+
+  npoints = nplanes * nrows * ncols;
+  vol = (unsigned char *) malloc(npoints);
+  fvol = (float *) malloc(npoints * sizeof(float));
+  if (vol == NULL || fvol == NULL)
+    {
+      fprintf(stderr, "ERROR - test_clump_mt: out of memory\n");
+      return(1);
+    }
+  _make_volume(vol, nplanes, nrows, ncols);
+  for (i = 0; i < npoints; i++)
+    fvol[i] = (float) vol[i];
+
+  EG_init_clump_context(&serial_context);
+  EG_init_clump_context(&mt_context);
+  memset(&ref, 0, sizeof(ref));
+  memset(&res, 0, sizeof(res));
+
+  /* byte data */
+
+  serial_secs = _run(&serial_context, 0, nplanes, nrows, ncols,
+		     vol, NULL, &ref);
+  if (serial_secs < 0)
+    return(1);
+
+  fprintf(stdout, "test_clump_mt: %d x %d x %d, %d intervals, %d clumps\n",
+	  nplanes, nrows, ncols, ref.nintervals, ref.nclumps);
+  fprintf(stdout, "  serial      %8.2f ms\n", serial_secs * 1000.0);
+
+  for (n_threads = 1; n_threads <= max_threads; n_threads++)
+    {
+      secs = _run(&mt_context, n_threads, nplanes, nrows, ncols,
+		  vol, NULL, &res);
+      if (secs < 0)
+	return(1);
+      sprintf(label, "%d threads", n_threads);
+      match = (_compare_results(&ref, &res, label) == 0);
+      if (!match)
+	iret = 1;
+      fprintf(stdout, "  %2d threads  %8.2f ms  speedup %5.2f  %s\n",
+	      n_threads, secs * 1000.0, serial_secs / secs,
+	      match ? "OK" : "MISMATCH");
+      _free_result(&res);
+    }
+
+  /* float data, checked with the max number of threads */
+
+  _free_result(&ref);
+  if (_run(&serial_context, 0, nplanes, nrows, ncols,
+	   NULL, fvol, &ref) < 0 ||
+      _run(&mt_context, max_threads, nplanes, nrows, ncols,
+	   NULL, fvol, &res) < 0)
+    return(1);
+  sprintf(label, "float, %d threads", max_threads);
+  if (_compare_results(&ref, &res, label))
+    {
+      iret = 1;
+      fprintf(stdout, "  float       MISMATCH\n");
+    }
+  else
+    {
+      fprintf(stdout, "  float       OK\n");
+    }
+
+  _free_result(&ref);
+  _free_result(&res);
+  EG_free_clump_context(&serial_context);
+  EG_free_clump_context(&mt_context);
+  free(vol);
+  free(fvol);
+
+  return(iret);
+}
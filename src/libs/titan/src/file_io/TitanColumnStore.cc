@@ -0,0 +1,880 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+//////////////////////////////////////////////////////////
+// TitanColumnStore.cc
+//
+// Columnar store of TITAN storm properties.
+//
+// See <titan/TitanColumnStore.hh> for details.
+//
+//////////////////////////////////////////////////////////
+
+#include <titan/TitanColumnStore.hh>
+#include <dataport/bigend.h>
+#include <toolsa/compress.h>
+#include <toolsa/file_io.h>
+#include <toolsa/MemBuf.hh>
+#include <toolsa/Path.hh>
+#include <toolsa/str.h>
+#include <toolsa/TaArray.hh>
+#include <toolsa/TaStr.hh>
+#include <toolsa/DateTime.hh>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <dirent.h>
+#include <set>
+using namespace std;
+
+////////////////////////////////////////////////////////////
+// Constructor
+
+TitanColumnStore::TitanColumnStore()
+
+{
+  _debug = false;
+  _startTime = 0;
+  _endTime = 0x7fffffff;
+  _checkLatLon = false;
+  _minLat = -90.0;
+  _minLon = -180.0;
+  _maxLat = 90.0;
+  _maxLon = 180.0;
+  _nRows = 0;
+}
+
+////////////////////////////////////////////////////////////
+// destructor
+
+TitanColumnStore::~TitanColumnStore()
+
+{
+}
+
+////////////////////////////////////////////////////////////
+// set query limits
+
+void TitanColumnStore::setTimeLimits(time_t start_time, time_t end_time)
+
+{
+  _startTime = start_time;
+  _endTime = end_time;
+}
+
+void TitanColumnStore::setLatLonLimits(double min_lat, double min_lon,
+                                       double max_lat, double max_lon)
+
+{
+  _checkLatLon = true;
+  _minLat = min_lat;
+  _minLon = min_lon;
+  _maxLat = max_lat;
+  _maxLon = max_lon;
+}
+
+////////////////////////////////////////////////////////////
+// get column from last query
+
+const vector<double> &TitanColumnStore::getColumn(const string &name) const
+
+{
+  map<string, vector<double> >::const_iterator it = _results.find(name);
+  if (it == _results.end()) {
+    return _empty;
+  }
+  return it->second;
+}
+
+////////////////////////////////////////////////////////////
+// get names of stored columns
+
+vector<string> TitanColumnStore::getColumnNames()
+
+{
+  vector<string> names;
+  const vector<column_t> &columns = _columns();
+  for (size_t ii = 0; ii < columns.size(); ii++) {
+    names.push_back(columns[ii].name);
+  }
+  return names;
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Write the segment for a storm and track file pair.
+//
+// Returns 0 on success, -1 on failure.
+//
+//////////////////////////////////////////////////////////////
+
+int TitanColumnStore::writeSegment(TitanStormFile &sfile,
+                                   TitanTrackFile &tfile)
+
+{
+
+  _errStr = "ERROR - TitanColumnStore::writeSegment\n";
+  TaStr::AddStr(_errStr, "  Storm file: ", sfile.header_file_path());
+
+  const vector<column_t> &columns = _columns();
+  size_t nCols = columns.size();
+
+  // load up the column data, in host byte order
+
+  vector< vector<ui32> > colData(nCols);
+  vector<titan_col_scan_t> scans;
+  set<int> cells;
+
+  titan_col_header_t hdr;
+  MEM_zero(hdr);
+  hdr.magic = TITAN_COL_MAGIC;
+  hdr.version = TITAN_COL_VERSION;
+  hdr.cell_size = TITAN_COL_CELL_SIZE;
+  hdr.min_lat = 90.0;
+  hdr.min_lon = 180.0;
+  hdr.max_lat = -90.0;
+  hdr.max_lon = -180.0;
+
+  int nScans = sfile.header().n_scans;
+  int nTrackScans = tfile.header().n_scans;
+  int nRows = 0;
+
+  for (int iscan = 0; iscan < nScans; iscan++) {
+
+    if (sfile.ReadScan(iscan)) {
+      _errStr += sfile.getErrStr();
+      return -1;
+    }
+    const storm_file_scan_header_t &scan = sfile.scan();
+    int nStorms = scan.nstorms;
+
+    // track entries for the storms in this scan -
+    // tracking may be behind the storm file
+
+    track_file_entry_t noEntry;
+    MEM_zero(noEntry);
+    noEntry.simple_track_num = -1;
+    noEntry.complex_track_num = -1;
+    vector<track_file_entry_t> entries(nStorms, noEntry);
+
+    if (iscan < nTrackScans) {
+      if (tfile.ReadScanEntries(iscan)) {
+        _errStr += tfile.getErrStr();
+        return -1;
+      }
+      int nEntries = tfile.scan_index()[iscan].n_entries;
+      for (int ientry = 0; ientry < nEntries; ientry++) {
+        const track_file_entry_t &entry = tfile.scan_entries()[ientry];
+        if (entry.storm_num >= 0 && entry.storm_num < nStorms) {
+          entries[entry.storm_num] = entry;
+        }
+      }
+    }
+
+    titan_col_scan_t scanIndex;
+    scanIndex.time = scan.time;
+    scanIndex.scan_num = iscan;
+    scanIndex.first_row = nRows;
+    scanIndex.n_rows = nStorms;
+    scans.push_back(scanIndex);
+
+    if (iscan == 0) {
+      hdr.start_time = scan.time;
+    }
+    hdr.end_time = scan.time;
+
+    for (int istorm = 0; istorm < nStorms; istorm++) {
+
+      const storm_file_global_props_t &gprops = sfile.gprops()[istorm];
+      const track_file_entry_t &entry = entries[istorm];
+
+      // storm location
+
+      storm_file_global_props_t llProps = gprops;
+      sfile.GpropsXY2LatLon(scan, llProps);
+      fl32 lat = llProps.vol_centroid_y;
+      fl32 lon = llProps.vol_centroid_x;
+      hdr.min_lat = MIN(hdr.min_lat, lat);
+      hdr.min_lon = MIN(hdr.min_lon, lon);
+      hdr.max_lat = MAX(hdr.max_lat, lat);
+      hdr.max_lon = MAX(hdr.max_lon, lon);
+      cells.insert(_cellNum(lat, lon));
+
+      // columns
+
+      for (size_t icol = 0; icol < nCols; icol++) {
+        const column_t &col = columns[icol];
+        ui32 word = 0;
+        switch (col.source) {
+          case SOURCE_SCAN_TIME: {
+            si32 val = scan.time;
+            memcpy(&word, &val, sizeof(word));
+            break;
+          }
+          case SOURCE_SCAN_NUM: {
+            si32 val = iscan;
+            memcpy(&word, &val, sizeof(word));
+            break;
+          }
+          case SOURCE_LAT:
+            memcpy(&word, &lat, sizeof(word));
+            break;
+          case SOURCE_LON:
+            memcpy(&word, &lon, sizeof(word));
+            break;
+          case SOURCE_GPROPS:
+            memcpy(&word, (const char *) &gprops + col.offset, sizeof(word));
+            break;
+          case SOURCE_ENTRY:
+            memcpy(&word, (const char *) &entry + col.offset, sizeof(word));
+            break;
+        }
+        colData[icol].push_back(word);
+      } // icol
+
+      nRows++;
+
+    } // istorm
+
+  } // iscan
+
+  hdr.n_rows = nRows;
+  hdr.n_columns = nCols;
+  hdr.n_scans = scans.size();
+  hdr.n_cells = cells.size();
+
+  // compress the columns
+
+  size_t dataOffset = sizeof(titan_col_header_t) +
+    scans.size() * sizeof(titan_col_scan_t) +
+    cells.size() * sizeof(si32) +
+    nCols * sizeof(titan_col_entry_t);
+
+  vector<titan_col_entry_t> colEntries(nCols);
+  MemBuf dataBuf;
+
+  for (size_t icol = 0; icol < nCols; icol++) {
+
+    titan_col_entry_t &colEntry = colEntries[icol];
+    MEM_zero(colEntry);
+    colEntry.type = columns[icol].type;
+    colEntry.offset = dataOffset + dataBuf.getLen();
+    STRncopy(colEntry.name, columns[icol].name.c_str(), TITAN_COL_NAME_LEN);
+
+    if (nRows == 0) {
+      continue;
+    }
+
+    vector<ui32> &words = colData[icol];
+    BE_from_array_32(&words[0], words.size() * sizeof(ui32));
+    ui64 nbytesCompressed;
+    void *compressed = ta_compress(TA_COMPRESSION_ZLIB, &words[0],
+                                   words.size() * sizeof(ui32),
+                                   &nbytesCompressed);
+    if (compressed == NULL) {
+      TaStr::AddStr(_errStr, "  Cannot compress column: ",
+                    columns[icol].name);
+      return -1;
+    }
+    dataBuf.add(compressed, nbytesCompressed);
+    colEntry.nbytes = nbytesCompressed;
+    ta_compress_free(compressed);
+
+  } // icol
+
+  // assemble the segment, in BE order
+
+  MemBuf segBuf;
+  BE_from_array_32(&hdr, sizeof(hdr));
+  segBuf.add(&hdr, sizeof(hdr));
+  if (scans.size() > 0) {
+    BE_from_array_32(&scans[0], scans.size() * sizeof(titan_col_scan_t));
+    segBuf.add(&scans[0], scans.size() * sizeof(titan_col_scan_t));
+  }
+  for (set<int>::iterator it = cells.begin(); it != cells.end(); it++) {
+    si32 cell = *it;
+    BE_from_array_32(&cell, sizeof(cell));
+    segBuf.add(&cell, sizeof(cell));
+  }
+  for (size_t icol = 0; icol < nCols; icol++) {
+    BE_from_array_32(&colEntries[icol], 4 * sizeof(si32));
+    segBuf.add(&colEntries[icol], sizeof(titan_col_entry_t));
+  }
+  segBuf.add(dataBuf.getPtr(), dataBuf.getLen());
+
+  // write to a tmp file, and rename, so that queries
+  // never see a partial segment
+
+  if (ta_makedir_recurse(_dir.c_str())) {
+    int errNum = errno;
+    TaStr::AddStr(_errStr, "  Cannot make dir: ", _dir);
+    TaStr::AddStr(_errStr, "  ", strerror(errNum));
+    return -1;
+  }
+
+  Path stormPath(sfile.header_file_path());
+  string segPath = _dir + PATH_DELIM + stormPath.getBase() +
+    "." + TITAN_COL_FILE_EXT;
+  string tmpPath = segPath + ".tmp";
+
+  FILE *out;
+  if ((out = fopen(tmpPath.c_str(), "w")) == NULL) {
+    int errNum = errno;
+    TaStr::AddStr(_errStr, "  Cannot open file for writing: ", tmpPath);
+    TaStr::AddStr(_errStr, "  ", strerror(errNum));
+    return -1;
+  }
+  if (fwrite(segBuf.getPtr(), 1, segBuf.getLen(), out) != segBuf.getLen()) {
+    int errNum = errno;
+    TaStr::AddStr(_errStr, "  Cannot write file: ", tmpPath);
+    TaStr::AddStr(_errStr, "  ", strerror(errNum));
+    fclose(out);
+    unlink(tmpPath.c_str());
+    return -1;
+  }
+  fclose(out);
+
+  if (rename(tmpPath.c_str(), segPath.c_str())) {
+    int errNum = errno;
+    TaStr::AddStr(_errStr, "  Cannot rename file: ", tmpPath);
+    TaStr::AddStr(_errStr, "  ", strerror(errNum));
+    unlink(tmpPath.c_str());
+    return -1;
+  }
+
+  if (_debug) {
+    cerr << "TitanColumnStore - wrote segment: " << segPath << endl;
+    cerr << "  n_rows: " << nRows << ", nbytes: " << segBuf.getLen() << endl;
+  }
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Read the named columns for the rows within the limits,
+// from all segments in the directory.
+//
+// Returns 0 on success, -1 on failure.
+//
+//////////////////////////////////////////////////////////////
+
+int TitanColumnStore::query(const vector<string> &column_names)
+
+{
+
+  _errStr = "ERROR - TitanColumnStore::query\n";
+  TaStr::AddStr(_errStr, "  Dir: ", _dir);
+  _nRows = 0;
+  _results.clear();
+
+  // check the column names
+
+  const vector<column_t> &columns = _columns();
+  for (size_t ii = 0; ii < column_names.size(); ii++) {
+    bool found = false;
+    for (size_t icol = 0; icol < columns.size(); icol++) {
+      if (columns[icol].name == column_names[ii]) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      TaStr::AddStr(_errStr, "  Unknown column: ", column_names[ii]);
+      return -1;
+    }
+    _results[column_names[ii]].clear();
+  }
+
+  // find the segments - file names start with the day of the
+  // TITAN file, so those well outside the time limits are not
+  // opened
+
+  DIR *dirp;
+  if ((dirp = opendir(_dir.c_str())) == NULL) {
+    int errNum = errno;
+    TaStr::AddStr(_errStr, "  Cannot open dir: ", strerror(errNum));
+    return -1;
+  }
+
+  string ext = string(".") + TITAN_COL_FILE_EXT;
+  vector<string> segNames;
+  struct dirent *dp;
+  for (dp = readdir(dirp); dp != NULL; dp = readdir(dirp)) {
+    string name = dp->d_name;
+    if (name.size() <= ext.size() ||
+        name.compare(name.size() - ext.size(), ext.size(), ext)) {
+      continue;
+    }
+    int year, month, day;
+    if (sscanf(name.c_str(), "%4d%2d%2d", &year, &month, &day) == 3) {
+      time_t dayStart = DateTime(year, month, day).utime();
+      if (dayStart > _endTime || dayStart + 2 * SECS_IN_DAY < _startTime) {
+        continue;
+      }
+    }
+    segNames.push_back(name);
+  }
+  closedir(dirp);
+  sort(segNames.begin(), segNames.end());
+
+  for (size_t ii = 0; ii < segNames.size(); ii++) {
+    string path = _dir + PATH_DELIM + segNames[ii];
+    if (_querySegment(path, column_names)) {
+      return -1;
+    }
+  }
+
+  if (_debug) {
+    cerr << "TitanColumnStore - n segments: " << segNames.size()
+         << ", n rows: " << _nRows << endl;
+  }
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Add the rows within the limits from a segment to the results
+//
+// Returns 0 on success, -1 on failure.
+//
+//////////////////////////////////////////////////////////////
+
+int TitanColumnStore::_querySegment(const string &path,
+                                    const vector<string> &column_names)
+
+{
+
+  FILE *in;
+  if ((in = fopen(path.c_str(), "r")) == NULL) {
+    int errNum = errno;
+    TaStr::AddStr(_errStr, "  Cannot open segment: ", path);
+    TaStr::AddStr(_errStr, "  ", strerror(errNum));
+    return -1;
+  }
+
+  // header
+
+  titan_col_header_t hdr;
+  if (fread(&hdr, sizeof(hdr), 1, in) != 1) {
+    TaStr::AddStr(_errStr, "  Cannot read header: ", path);
+    fclose(in);
+    return -1;
+  }
+  BE_to_array_32(&hdr, sizeof(hdr));
+  if (hdr.magic != TITAN_COL_MAGIC || hdr.version != TITAN_COL_VERSION) {
+    TaStr::AddStr(_errStr, "  Not a column store segment: ", path);
+    fclose(in);
+    return -1;
+  }
+
+  // check limits
+
+  if (hdr.n_rows == 0 ||
+      hdr.end_time < _startTime || hdr.start_time > _endTime) {
+    fclose(in);
+    return 0;
+  }
+  if (_checkLatLon &&
+      (hdr.max_lat < _minLat || hdr.min_lat > _maxLat ||
+       hdr.max_lon < _minLon || hdr.min_lon > _maxLon)) {
+    fclose(in);
+    return 0;
+  }
+
+  // time index, cells and column directory
+
+  TaArray<titan_col_scan_t> scans_;
+  titan_col_scan_t *scans = scans_.alloc(hdr.n_scans);
+  TaArray<si32> cells_;
+  si32 *cells = cells_.alloc(hdr.n_cells);
+  TaArray<titan_col_entry_t> entries_;
+  titan_col_entry_t *entries = entries_.alloc(hdr.n_columns);
+
+  if ((int) fread(scans, sizeof(titan_col_scan_t), hdr.n_scans, in)
+      != hdr.n_scans ||
+      (int) fread(cells, sizeof(si32), hdr.n_cells, in) != hdr.n_cells ||
+      (int) fread(entries, sizeof(titan_col_entry_t), hdr.n_columns, in)
+      != hdr.n_columns) {
+    TaStr::AddStr(_errStr, "  Cannot read segment index: ", path);
+    fclose(in);
+    return -1;
+  }
+  BE_to_array_32(scans, hdr.n_scans * sizeof(titan_col_scan_t));
+  BE_to_array_32(cells, hdr.n_cells * sizeof(si32));
+  for (int icol = 0; icol < hdr.n_columns; icol++) {
+    BE_to_array_32(entries + icol, 4 * sizeof(si32));
+    entries[icol].name[TITAN_COL_NAME_LEN - 1] = '\0';
+  }
+
+  // check the lat/lon cells
+
+  if (_checkLatLon) {
+    int nx = (int) floor(360.0 / hdr.cell_size + 0.5);
+    bool overlaps = false;
+    for (int ii = 0; ii < hdr.n_cells; ii++) {
+      double cellLat = -90.0 + (cells[ii] / nx) * hdr.cell_size;
+      double cellLon = -180.0 + (cells[ii] % nx) * hdr.cell_size;
+      if (cellLat <= _maxLat && cellLat + hdr.cell_size >= _minLat &&
+          cellLon <= _maxLon && cellLon + hdr.cell_size >= _minLon) {
+        overlaps = true;
+        break;
+      }
+    }
+    if (!overlaps) {
+      fclose(in);
+      return 0;
+    }
+  }
+
+  // rows within the time limits - scans are in time order
+
+  int firstRow = -1;
+  int endRow = -1;
+  for (int iscan = 0; iscan < hdr.n_scans; iscan++) {
+    if (scans[iscan].time >= _startTime && scans[iscan].time <= _endTime) {
+      if (firstRow < 0) {
+        firstRow = scans[iscan].first_row;
+      }
+      endRow = scans[iscan].first_row + scans[iscan].n_rows;
+    }
+  }
+  if (firstRow < 0 || endRow <= firstRow) {
+    fclose(in);
+    return 0;
+  }
+  int nRows = endRow - firstRow;
+
+  // find the columns
+
+  vector<int> colIndex;
+  int latIndex = -1, lonIndex = -1;
+  for (size_t ii = 0; ii < column_names.size(); ii++) {
+    int index = -1;
+    for (int icol = 0; icol < hdr.n_columns; icol++) {
+      if (column_names[ii] == entries[icol].name) {
+        index = icol;
+        break;
+      }
+    }
+    if (index < 0) {
+      TaStr::AddStr(_errStr, "  Column not in segment: ", column_names[ii]);
+      TaStr::AddStr(_errStr, "  Segment: ", path);
+      fclose(in);
+      return -1;
+    }
+    colIndex.push_back(index);
+  }
+  for (int icol = 0; icol < hdr.n_columns; icol++) {
+    if (!strcmp(entries[icol].name, "vol_centroid_lat")) {
+      latIndex = icol;
+    } else if (!strcmp(entries[icol].name, "vol_centroid_lon")) {
+      lonIndex = icol;
+    }
+  }
+
+  // select the rows inside the lat/lon limits
+
+  vector<bool> keep(nRows, true);
+  int nKeep = nRows;
+  if (_checkLatLon) {
+    vector<double> lats, lons;
+    if (latIndex < 0 || lonIndex < 0 ||
+        _readColumn(in, path, entries[latIndex], hdr.n_rows,
+                    firstRow, nRows, lats) ||
+        _readColumn(in, path, entries[lonIndex], hdr.n_rows,
+                    firstRow, nRows, lons)) {
+      TaStr::AddStr(_errStr, "  Cannot read location columns: ", path);
+      fclose(in);
+      return -1;
+    }
+    nKeep = 0;
+    for (int irow = 0; irow < nRows; irow++) {
+      keep[irow] = (lats[irow] >= _minLat && lats[irow] <= _maxLat &&
+                    lons[irow] >= _minLon && lons[irow] <= _maxLon);
+      if (keep[irow]) {
+        nKeep++;
+      }
+    }
+  }
+
+  // add the requested columns to the results
+
+  if (nKeep > 0) {
+    for (size_t ii = 0; ii < column_names.size(); ii++) {
+      vector<double> vals;
+      if (_readColumn(in, path, entries[colIndex[ii]], hdr.n_rows,
+                      firstRow, nRows, vals)) {
+        fclose(in);
+        return -1;
+      }
+      vector<double> &result = _results[column_names[ii]];
+      for (int irow = 0; irow < nRows; irow++) {
+        if (keep[irow]) {
+          result.push_back(vals[irow]);
+        }
+      }
+    }
+    _nRows += nKeep;
+  }
+
+  fclose(in);
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Read and decompress a column, and load the values for the
+// rows requested.
+//
+// Returns 0 on success, -1 on failure.
+//
+//////////////////////////////////////////////////////////////
+
+int TitanColumnStore::_readColumn(FILE *in, const string &path,
+                                  const titan_col_entry_t &entry,
+                                  int n_rows_in_seg,
+                                  int first_row, int n_rows,
+                                  vector<double> &vals)
+
+{
+
+  TaArray<ui08> compressed_;
+  ui08 *compressed = compressed_.alloc(entry.nbytes);
+  if (fseek(in, entry.offset, SEEK_SET) ||
+      (int) fread(compressed, 1, entry.nbytes, in) != entry.nbytes) {
+    TaStr::AddStr(_errStr, "  Cannot read column: ", entry.name);
+    TaStr::AddStr(_errStr, "  Segment: ", path);
+    return -1;
+  }
+
+  ui64 nbytes;
+  void *data = ta_decompress(compressed, &nbytes);
+  if (data == NULL || nbytes != n_rows_in_seg * sizeof(ui32)) {
+    TaStr::AddStr(_errStr, "  Cannot decompress column: ", entry.name);
+    TaStr::AddStr(_errStr, "  Segment: ", path);
+    if (data != NULL) {
+      ta_compress_free(data);
+    }
+    return -1;
+  }
+  BE_to_array_32(data, nbytes);
+
+  vals.resize(n_rows);
+  if (entry.type == TITAN_COL_FL32) {
+    const fl32 *fdata = (const fl32 *) data + first_row;
+    for (int irow = 0; irow < n_rows; irow++) {
+      vals[irow] = fdata[irow];
+    }
+  } else {
+    const si32 *idata = (const si32 *) data + first_row;
+    for (int irow = 0; irow < n_rows; irow++) {
+      vals[irow] = idata[irow];
+    }
+  }
+  ta_compress_free(data);
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////////
+// compute lat/lon cell number
+
+int TitanColumnStore::_cellNum(double lat, double lon)
+
+{
+
+  int nx = (int) floor(360.0 / TITAN_COL_CELL_SIZE + 0.5);
+  int ny = (int) floor(180.0 / TITAN_COL_CELL_SIZE + 0.5);
+
+  while (lon < -180.0) {
+    lon += 360.0;
+  }
+  while (lon >= 180.0) {
+    lon -= 360.0;
+  }
+  
+  int ix = (int) floor((lon + 180.0) / TITAN_COL_CELL_SIZE);
+  int iy = (int) floor((lat + 90.0) / TITAN_COL_CELL_SIZE);
+  ix = MAX(0, MIN(nx - 1, ix));
+  iy = MAX(0, MIN(ny - 1, iy));
+
+  return iy * nx + ix;
+
+}
+
+//////////////////////////////////////////////////////////////
+// column table
+
+const vector<TitanColumnStore::column_t> &TitanColumnStore::_columns()
+
+{
+  static const vector<column_t> columns = _loadColumns();
+  return columns;
+}
+
+void TitanColumnStore::_addColumn(vector<column_t> &columns,
+                                  const string &name, source_t source,
+                                  titan_col_type_t type, size_t offset)
+
+{
+  column_t col;
+  col.name = name;
+  col.source = source;
+  col.type = type;
+  col.offset = offset;
+  columns.push_back(col);
+}
+
+#define GPROPS_COL(field, type) \
+  _addColumn(columns, #field, SOURCE_GPROPS, type, \
+             offsetof(storm_file_global_props_t, field))
+
+#define ENTRY_COL(field, type) \
+  _addColumn(columns, #field, SOURCE_ENTRY, type, \
+             offsetof(track_file_entry_t, field))
+
+#define DVAL_DT_COL(field) \
+  _addColumn(columns, "dval_dt_" #field, SOURCE_ENTRY, TITAN_COL_FL32, \
+             offsetof(track_file_entry_t, dval_dt) + \
+             offsetof(track_file_forecast_props_t, field))
+
+vector<TitanColumnStore::column_t> TitanColumnStore::_loadColumns()
+
+{
+
+  vector<column_t> columns;
+
+  _addColumn(columns, "time", SOURCE_SCAN_TIME, TITAN_COL_SI32, 0);
+  _addColumn(columns, "scan_num", SOURCE_SCAN_NUM, TITAN_COL_SI32, 0);
+  _addColumn(columns, "vol_centroid_lat", SOURCE_LAT, TITAN_COL_FL32, 0);
+  _addColumn(columns, "vol_centroid_lon", SOURCE_LON, TITAN_COL_FL32, 0);
+
+  // storm global props
+
+  GPROPS_COL(vol_centroid_x, TITAN_COL_FL32);
+  GPROPS_COL(vol_centroid_y, TITAN_COL_FL32);
+  GPROPS_COL(vol_centroid_z, TITAN_COL_FL32);
+  GPROPS_COL(refl_centroid_x, TITAN_COL_FL32);
+  GPROPS_COL(refl_centroid_y, TITAN_COL_FL32);
+  GPROPS_COL(refl_centroid_z, TITAN_COL_FL32);
+  GPROPS_COL(top, TITAN_COL_FL32);
+  GPROPS_COL(base, TITAN_COL_FL32);
+  GPROPS_COL(volume, TITAN_COL_FL32);
+  GPROPS_COL(area_mean, TITAN_COL_FL32);
+  GPROPS_COL(precip_flux, TITAN_COL_FL32);
+  GPROPS_COL(mass, TITAN_COL_FL32);
+  GPROPS_COL(tilt_angle, TITAN_COL_FL32);
+  GPROPS_COL(tilt_dirn, TITAN_COL_FL32);
+  GPROPS_COL(dbz_max, TITAN_COL_FL32);
+  GPROPS_COL(dbz_mean, TITAN_COL_FL32);
+  GPROPS_COL(dbz_max_gradient, TITAN_COL_FL32);
+  GPROPS_COL(dbz_mean_gradient, TITAN_COL_FL32);
+  GPROPS_COL(ht_of_dbz_max, TITAN_COL_FL32);
+  GPROPS_COL(rad_vel_mean, TITAN_COL_FL32);
+  GPROPS_COL(rad_vel_sd, TITAN_COL_FL32);
+  GPROPS_COL(vorticity, TITAN_COL_FL32);
+  GPROPS_COL(precip_area, TITAN_COL_FL32);
+  GPROPS_COL(precip_area_centroid_x, TITAN_COL_FL32);
+  GPROPS_COL(precip_area_centroid_y, TITAN_COL_FL32);
+  GPROPS_COL(precip_area_orientation, TITAN_COL_FL32);
+  GPROPS_COL(precip_area_minor_radius, TITAN_COL_FL32);
+  GPROPS_COL(precip_area_major_radius, TITAN_COL_FL32);
+  GPROPS_COL(proj_area, TITAN_COL_FL32);
+  GPROPS_COL(proj_area_centroid_x, TITAN_COL_FL32);
+  GPROPS_COL(proj_area_centroid_y, TITAN_COL_FL32);
+  GPROPS_COL(proj_area_orientation, TITAN_COL_FL32);
+  GPROPS_COL(proj_area_minor_radius, TITAN_COL_FL32);
+  GPROPS_COL(proj_area_major_radius, TITAN_COL_FL32);
+  for (int ii = 0; ii < N_POLY_SIDES; ii++) {
+    char name[TITAN_COL_NAME_LEN];
+    sprintf(name, "proj_area_polygon_%.2d", ii);
+    _addColumn(columns, name, SOURCE_GPROPS, TITAN_COL_FL32,
+               offsetof(storm_file_global_props_t, proj_area_polygon) +
+               ii * sizeof(fl32));
+  }
+  GPROPS_COL(storm_num, TITAN_COL_SI32);
+  GPROPS_COL(n_layers, TITAN_COL_SI32);
+  GPROPS_COL(base_layer, TITAN_COL_SI32);
+  GPROPS_COL(n_dbz_intervals, TITAN_COL_SI32);
+  GPROPS_COL(n_runs, TITAN_COL_SI32);
+  GPROPS_COL(n_proj_runs, TITAN_COL_SI32);
+  GPROPS_COL(top_missing, TITAN_COL_SI32);
+  GPROPS_COL(range_limited, TITAN_COL_SI32);
+  GPROPS_COL(second_trip, TITAN_COL_SI32);
+  GPROPS_COL(hail_present, TITAN_COL_SI32);
+  GPROPS_COL(anom_prop, TITAN_COL_SI32);
+  GPROPS_COL(bounding_min_ix, TITAN_COL_SI32);
+  GPROPS_COL(bounding_min_iy, TITAN_COL_SI32);
+  GPROPS_COL(bounding_max_ix, TITAN_COL_SI32);
+  GPROPS_COL(bounding_max_iy, TITAN_COL_SI32);
+  GPROPS_COL(vil_from_maxz, TITAN_COL_FL32);
+  GPROPS_COL(ltg_count, TITAN_COL_FL32);
+
+  // the add_on union - which of these apply depends on
+  // how Titan was configured
+
+  GPROPS_COL(add_on.hail_metrics.FOKRcategory, TITAN_COL_SI32);
+  GPROPS_COL(add_on.hail_metrics.waldvogelProbability, TITAN_COL_FL32);
+  GPROPS_COL(add_on.hail_metrics.hailMassAloft, TITAN_COL_FL32);
+  GPROPS_COL(add_on.hail_metrics.vihm, TITAN_COL_FL32);
+  GPROPS_COL(add_on.hda.poh, TITAN_COL_FL32);
+  GPROPS_COL(add_on.hda.shi, TITAN_COL_FL32);
+  GPROPS_COL(add_on.hda.posh, TITAN_COL_FL32);
+  GPROPS_COL(add_on.hda.mehs, TITAN_COL_FL32);
+
+  // track entry
+
+  ENTRY_COL(time_origin, TITAN_COL_SI32);
+  ENTRY_COL(simple_track_num, TITAN_COL_SI32);
+  ENTRY_COL(complex_track_num, TITAN_COL_SI32);
+  ENTRY_COL(history_in_scans, TITAN_COL_SI32);
+  ENTRY_COL(history_in_secs, TITAN_COL_SI32);
+  ENTRY_COL(duration_in_scans, TITAN_COL_SI32);
+  ENTRY_COL(duration_in_secs, TITAN_COL_SI32);
+  ENTRY_COL(forecast_valid, TITAN_COL_SI32);
+  DVAL_DT_COL(proj_area_centroid_x);
+  DVAL_DT_COL(proj_area_centroid_y);
+  DVAL_DT_COL(vol_centroid_z);
+  DVAL_DT_COL(refl_centroid_z);
+  DVAL_DT_COL(top);
+  DVAL_DT_COL(dbz_max);
+  DVAL_DT_COL(volume);
+  DVAL_DT_COL(precip_flux);
+  DVAL_DT_COL(mass);
+  DVAL_DT_COL(proj_area);
+  DVAL_DT_COL(smoothed_proj_area_centroid_x);
+  DVAL_DT_COL(smoothed_proj_area_centroid_y);
+  DVAL_DT_COL(smoothed_speed);
+  DVAL_DT_COL(smoothed_direction);
+
+  return columns;
+
+}
@@ -38,6 +38,9 @@
 
 #include <fcntl.h>
 #include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <dataport/bigend.h>
 #include <titan/TitanStormFile.hh>
 #include <toolsa/TaStr.hh>
@@ -70,6 +73,11 @@ TitanStormFile::TitanStormFile()
   _header_file = NULL;
   _data_file = NULL;
 
+  _useMmap = false;
+  _mapData = false;
+  _data_map = NULL;
+  _data_map_len = 0;
+
   _header_file_label = STORM_HEADER_FILE_TYPE;
   _data_file_label = STORM_DATA_FILE_TYPE;
 
@@ -460,6 +468,13 @@ int TitanStormFile::OpenFiles(const char *mode,
       TaStr::AddStr(_errStr, "  Should be: ", _data_file_label);
       return -1;
     }
+
+    // map the data file if requested - falls back on stdio
+    
+    _mapData = (_useMmap && !strcmp(mode, "r"));
+    if (_mapData) {
+      _mapDataFile();
+    }
     
   } // if (*mode == 'w') 
 
@@ -481,6 +496,11 @@ void TitanStormFile::CloseFiles()
 
   UnlockHeaderFile();
 
+  // unmap the data file
+
+  _unmapDataFile();
+  _mapData = false;
+
   // close the header file
   
   if (_header_file != NULL) {
@@ -536,6 +556,10 @@ int TitanStormFile::LockHeaderFile(const char *mode)
     return -1;
   }
 
+  // the data file may have changed while it was not locked
+
+  _checkDataMap();
+
   return 0;
 
 }
@@ -587,6 +611,10 @@ int TitanStormFile::ReadHeader(bool clear_error_str /* = true*/ )
   _errStr += "ERROR - TitanStormFile::ReadHeader\n";
   TaStr::AddStr(_errStr, "  Reading from file: ", _header_file_path);
 
+  // the data file may have changed since the last header read
+
+  _checkDataMap();
+
   // rewind file
   
   fseek(_header_file, 0L, SEEK_SET);
@@ -685,14 +713,10 @@ int TitanStormFile::ReadProjRuns(int storm_num)
 
   AllocProjRuns(n_proj_runs);
   
-  // move to proj_run data position in file
-  
-  fseek(_data_file, _gprops[storm_num].proj_runs_offset, SEEK_SET);
-  
   // read in proj_runs
   
-  if (ufread(_proj_runs, sizeof(storm_file_run_t), n_proj_runs,
-	     _data_file) != n_proj_runs) {
+  if (_readData(_proj_runs, sizeof(storm_file_run_t), n_proj_runs,
+		_gprops[storm_num].proj_runs_offset) != n_proj_runs) {
     int errNum = errno;
     TaStr::AddStr(_errStr, "  Reading proj runs, file: ", _data_file_path);
     TaStr::AddInt(_errStr, "  N runs: ", n_proj_runs);
@@ -750,14 +774,10 @@ int TitanStormFile::ReadProps(int storm_num)
     return 0;
   }
   
-  // move to layer data position in file
-  
-  fseek(_data_file, _gprops[storm_num].layer_props_offset, SEEK_SET);
-  
   // read in layer props
   
-  if (ufread(_lprops, sizeof(storm_file_layer_props_t),
-	     n_layers, _data_file) != n_layers) {
+  if (_readData(_lprops, sizeof(storm_file_layer_props_t),
+		n_layers, _gprops[storm_num].layer_props_offset) != n_layers) {
     int errNum = errno;
     TaStr::AddStr(_errStr, "  ", "Reading layer props");
     TaStr::AddInt(_errStr, "  N layers: ", n_layers);
@@ -769,14 +789,11 @@ int TitanStormFile::ReadProps(int storm_num)
   
   BE_to_array_32(_lprops, n_layers * sizeof(storm_file_layer_props_t));
   
-  // move to hist data position in file
-  
-  fseek(_data_file, _gprops[storm_num].dbz_hist_offset, SEEK_SET);
-  
   // read in histogram data
   
-  if (ufread(_hist, sizeof(storm_file_dbz_hist_t),
-	     n_dbz_intervals, _data_file) != n_dbz_intervals) {
+  if (_readData(_hist, sizeof(storm_file_dbz_hist_t),
+		n_dbz_intervals, _gprops[storm_num].dbz_hist_offset)
+      != n_dbz_intervals) {
     int errNum = errno;
     TaStr::AddStr(_errStr, "  ", "Reading dbz histogram");
     TaStr::AddInt(_errStr, "  N intervals: ", n_dbz_intervals);
@@ -788,14 +805,10 @@ int TitanStormFile::ReadProps(int storm_num)
   
   BE_to_array_32(_hist, n_dbz_intervals * sizeof(storm_file_dbz_hist_t));
   
-  // move to run data position in file
-  
-  fseek(_data_file, _gprops[storm_num].runs_offset, SEEK_SET);
-  
   // read in runs
   
-  if (ufread(_runs, sizeof(storm_file_run_t),
-	     n_runs, _data_file) != n_runs) {
+  if (_readData(_runs, sizeof(storm_file_run_t),
+		n_runs, _gprops[storm_num].runs_offset) != n_runs) {
     int errNum = errno;
     TaStr::AddStr(_errStr, "  ", "Reading runs");
     TaStr::AddInt(_errStr, "  N runs: ", n_runs);
@@ -807,14 +820,11 @@ int TitanStormFile::ReadProps(int storm_num)
   
   BE_to_array_16(_runs, n_runs * sizeof(storm_file_run_t));
   
-  // move to proj_run data position in file
-  
-  fseek(_data_file, _gprops[storm_num].proj_runs_offset, SEEK_SET);
-  
   // read in proj_runs
   
-  if (ufread(_proj_runs, sizeof(storm_file_run_t),
-	     n_proj_runs, _data_file) != n_proj_runs) {
+  if (_readData(_proj_runs, sizeof(storm_file_run_t),
+		n_proj_runs, _gprops[storm_num].proj_runs_offset)
+      != n_proj_runs) {
     int errNum = errno;
     TaStr::AddStr(_errStr, "  ", "Reading proj runs");
     TaStr::AddInt(_errStr, "  N proj runs: ", n_proj_runs);
@@ -850,19 +860,17 @@ int TitanStormFile::ReadScan(int scan_num, int storm_num /* = -1*/ )
   TaStr::AddStr(_errStr, "  Reading scan from file: ", _data_file_path);
   TaStr::AddInt(_errStr, "  Scan number: ", scan_num);
 
-  // move to scan position in file
+  // check scan position in file
   
-  if (_scan_offsets && scan_num < _max_scans) {
-    fseek(_data_file, _scan_offsets[scan_num], SEEK_SET);
-  } else {
+  if (!_scan_offsets || scan_num >= _max_scans) {
     return -1;
   }
   
   // read in scan struct
   
   storm_file_scan_header_t scan;
-  if (ufread(&scan, sizeof(storm_file_scan_header_t),
-	     1, _data_file) != 1) {
+  if (_readData(&scan, sizeof(storm_file_scan_header_t),
+		1, _scan_offsets[scan_num]) != 1) {
     int errNum = errno;
     TaStr::AddStr(_errStr, "  ", strerror(errNum));
     return -1;
@@ -889,14 +897,10 @@ int TitanStormFile::ReadScan(int scan_num, int storm_num /* = -1*/ )
     return 0;
   }
   
-  // move to gprops position in file
-  
-  fseek(_data_file, _scan.gprops_offset, SEEK_SET);
-  
   // read in global props
   
-  if (ufread(_gprops, sizeof(storm_file_global_props_t),
-	     nstorms, _data_file) != nstorms) {
+  if (_readData(_gprops, sizeof(storm_file_global_props_t),
+		nstorms, _scan.gprops_offset) != nstorms) {
     int errNum = errno;
     TaStr::AddStr(_errStr, "  ", "Reading gprops");
     TaStr::AddInt(_errStr, "  nstorms: ", nstorms);
@@ -1597,3 +1601,108 @@ int TitanStormFile::_truncate(FILE *&fd, const string &path, int length)
   return (0);
   
 }
+
+//////////////////////////////////////////////////////////////
+//
+// Map the data file into memory, read-only.
+//
+// Returns 0 on success, -1 on failure.
+//
+//////////////////////////////////////////////////////////////
+
+int TitanStormFile::_mapDataFile()
+  
+{
+
+  _unmapDataFile();
+
+  struct stat dataStat;
+  if (fstat(fileno(_data_file), &dataStat) || dataStat.st_size <= 0) {
+    return -1;
+  }
+
+  void *map = mmap(NULL, dataStat.st_size, PROT_READ, MAP_SHARED,
+		   fileno(_data_file), 0);
+  if (map == MAP_FAILED) {
+    return -1;
+  }
+  
+  _data_map = (char *) map;
+  _data_map_len = dataStat.st_size;
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Unmap the data file
+//
+//////////////////////////////////////////////////////////////
+
+void TitanStormFile::_unmapDataFile()
+  
+{
+  
+  if (_data_map != NULL) {
+    munmap(_data_map, _data_map_len);
+    _data_map = NULL;
+    _data_map_len = 0;
+  }
+
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Check the data file size, and remap the file if it has changed,
+// since the writer may have truncated or extended it while the
+// header file was not locked. Called when the header file is
+// locked or the header is read, rather than for every read.
+//
+//////////////////////////////////////////////////////////////
+
+void TitanStormFile::_checkDataMap()
+  
+{
+
+  if (!_mapData || _data_file == NULL) {
+    return;
+  }
+
+  struct stat dataStat;
+  if (fstat(fileno(_data_file), &dataStat)) {
+    _unmapDataFile();
+  } else if (dataStat.st_size != _data_map_len) {
+    _mapDataFile();
+  }
+
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Read items from the data file at the given offset, from the
+// memory map if it is in use, otherwise using stdio.
+//
+// Returns the number of items read, as for fread().
+//
+//////////////////////////////////////////////////////////////
+
+int TitanStormFile::_readData(void *buf, int size, int nitems, long offset)
+  
+{
+
+  if (_data_map == NULL) {
+    fseek(_data_file, offset, SEEK_SET);
+    return ufread(buf, size, nitems, _data_file);
+  }
+
+  if (offset < 0 || offset >= _data_map_len || size <= 0) {
+    return 0;
+  }
+  int navail = (int) ((_data_map_len - offset) / size);
+  int nread = MIN(nitems, navail);
+  memcpy(buf, _data_map + offset, (size_t) nread * size);
+
+  return nread;
+
+}
@@ -37,6 +37,9 @@
 
 
 #include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <dataport/bigend.h>
 #include <titan/TitanTrackFile.hh>
 #include <toolsa/TaStr.hh>
@@ -76,6 +79,11 @@ TitanTrackFile::TitanTrackFile()
   _header_file = NULL;
   _data_file = NULL;
 
+  _useMmap = false;
+  _mapData = false;
+  _data_map = NULL;
+  _data_map_len = 0;
+
   _first_entry = true;
 
   _n_scan_entries = 0;
@@ -644,6 +652,13 @@ int TitanTrackFile::OpenFiles(const char *mode,
       TaStr::AddStr(_errStr, "  Should be: ", _data_file_label);
       return -1;
     }
+
+    // map the data file if requested - falls back on stdio
+    
+    _mapData = (_useMmap && !strcmp(mode, "r"));
+    if (_mapData) {
+      _mapDataFile();
+    }
     
   } // if (*mode == 'w') 
 
@@ -665,6 +680,11 @@ void TitanTrackFile::CloseFiles()
 
   UnlockHeaderFile();
 
+  // unmap the data file
+
+  _unmapDataFile();
+  _mapData = false;
+
   // close the header file
   
   if (_header_file != NULL) {
@@ -722,6 +742,10 @@ int TitanTrackFile::LockHeaderFile(const char *mode)
     return -1;
   }
 
+  // the data file may have changed while it was not locked
+
+  _checkDataMap();
+
   return 0;
 
 }
@@ -775,6 +799,10 @@ int TitanTrackFile::ReadHeader(bool clear_error_str /* = true*/ )
   _errStr += "ERROR - TitanTrackFile::ReadHeader\n";
   TaStr::AddStr(_errStr, "  Reading from file: ", _header_file_path);
 
+  // the data file may have changed since the last header read
+
+  _checkDataMap();
+
   // rewind file
   
   fseek(_header_file, 0L, SEEK_SET);
@@ -1062,12 +1090,10 @@ int TitanTrackFile::ReadComplexParams(int track_num,
     return -1;
   }
   
-  fseek(_data_file, _complex_track_offsets[track_num], SEEK_SET);
-  
   // read in params
   
-  if (ufread(&_complex_params, sizeof(complex_track_params_t),
-	     1, _data_file) != 1) {
+  if (_readData(&_complex_params, sizeof(complex_track_params_t),
+		1, _complex_track_offsets[track_num]) != 1) {
     int errNum = errno;
     TaStr::AddStr(_errStr, "  ", "Reading complex_track_params");
     TaStr::AddStr(_errStr, "  ", strerror(errNum));
@@ -1132,14 +1158,10 @@ int TitanTrackFile::ReadSimpleParams(int track_num,
   TaStr::AddStr(_errStr, "  Reading from file: ", _data_file_path);
   TaStr::AddInt(_errStr, "  track_num", track_num);
 
-  // move to offset in file
-  
-  fseek(_data_file, _simple_track_offsets[track_num], SEEK_SET);
-  
   // read in params
   
-  if (ufread(&_simple_params, sizeof(simple_track_params_t),
-	     1, _data_file) != 1) {
+  if (_readData(&_simple_params, sizeof(simple_track_params_t),
+		1, _simple_track_offsets[track_num]) != 1) {
     int errNum = errno;
     TaStr::AddStr(_errStr, "  ", "Reading simple_track_params");
     TaStr::AddStr(_errStr, "  ", strerror(errNum));
@@ -1170,7 +1192,7 @@ int TitanTrackFile::ReadEntry()
   _errStr += "ERROR - TitanTrackFile::ReadEntry\n";
   TaStr::AddStr(_errStr, "  Reading from file: ", _data_file_path);
 
-  // move to the entry offset in the file
+  // get the entry offset in the file
   
   long offset;
   if (_first_entry) {
@@ -1180,12 +1202,9 @@ int TitanTrackFile::ReadEntry()
     offset = _entry.next_entry_offset;
   }
   
-  fseek(_data_file, offset, SEEK_SET);
-  
   // read in entry
   
-  if (ufread(&_entry, sizeof(track_file_entry_t),
-	     1, _data_file) != 1) {
+  if (_readData(&_entry, sizeof(track_file_entry_t), 1, offset) != 1) {
     int errNum = errno;
     TaStr::AddStr(_errStr, "  ", "Reading track entry");
     TaStr::AddInt(_errStr, "  Simple track num: ",
@@ -1273,14 +1292,10 @@ int TitanTrackFile::ReadScanEntries(int scan_num)
   
   for (int ientry = 0; ientry < _n_scan_entries; ientry++, entry++) {
     
-    // move to the next entry offset in the file
-    
-    fseek(_data_file, next_entry_offset, SEEK_SET);
+    // read in entry at the next entry offset
   
-    // read in entry
-  
-    if (ufread(entry, sizeof(track_file_entry_t),
-	       1, _data_file) != 1) {
+    if (_readData(entry, sizeof(track_file_entry_t),
+		  1, next_entry_offset) != 1) {
       int errNum = errno;
       TaStr::AddStr(_errStr, "  ", "Reading track entry");
       TaStr::AddInt(_errStr, "  ientry: ", ientry);
@@ -2099,3 +2114,108 @@ long TitanTrackFile::WriteEntry(int prev_in_track_offset,
   return (file_mark);
   
 }
+
+//////////////////////////////////////////////////////////////
+//
+// Map the data file into memory, read-only.
+//
+// Returns 0 on success, -1 on failure.
+//
+//////////////////////////////////////////////////////////////
+
+int TitanTrackFile::_mapDataFile()
+  
+{
+
+  _unmapDataFile();
+
+  struct stat dataStat;
+  if (fstat(fileno(_data_file), &dataStat) || dataStat.st_size <= 0) {
+    return -1;
+  }
+
+  void *map = mmap(NULL, dataStat.st_size, PROT_READ, MAP_SHARED,
+		   fileno(_data_file), 0);
+  if (map == MAP_FAILED) {
+    return -1;
+  }
+  
+  _data_map = (char *) map;
+  _data_map_len = dataStat.st_size;
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Unmap the data file
+//
+//////////////////////////////////////////////////////////////
+
+void TitanTrackFile::_unmapDataFile()
+  
+{
+  
+  if (_data_map != NULL) {
+    munmap(_data_map, _data_map_len);
+    _data_map = NULL;
+    _data_map_len = 0;
+  }
+
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Check the data file size, and remap the file if it has changed,
+// since the writer may have truncated or extended it while the
+// header file was not locked. Called when the header file is
+// locked or the header is read, rather than for every read.
+//
+//////////////////////////////////////////////////////////////
+
+void TitanTrackFile::_checkDataMap()
+  
+{
+
+  if (!_mapData || _data_file == NULL) {
+    return;
+  }
+
+  struct stat dataStat;
+  if (fstat(fileno(_data_file), &dataStat)) {
+    _unmapDataFile();
+  } else if (dataStat.st_size != _data_map_len) {
+    _mapDataFile();
+  }
+
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Read items from the data file at the given offset, from the
+// memory map if it is in use, otherwise using stdio.
+//
+// Returns the number of items read, as for fread().
+//
+//////////////////////////////////////////////////////////////
+
+int TitanTrackFile::_readData(void *buf, int size, int nitems, long offset)
+  
+{
+
+  if (_data_map == NULL) {
+    fseek(_data_file, offset, SEEK_SET);
+    return ufread(buf, size, nitems, _data_file);
+  }
+
+  if (offset < 0 || offset >= _data_map_len || size <= 0) {
+    return 0;
+  }
+  int navail = (int) ((_data_map_len - offset) / size);
+  int nread = MIN(nitems, navail);
+  memcpy(buf, _data_map + offset, (size_t) nread * size);
+
+  return nread;
+
+}
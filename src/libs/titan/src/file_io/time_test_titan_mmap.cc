@@ -0,0 +1,351 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// time_test_titan_mmap.cc
+//
+// Benchmark for the memory mapped read path of TitanStormFile
+// and TitanTrackFile, comparing it with stdio.
+//
+// Writes a day-sized storm file and track file, then reads every
+// storm and every track entry back, with the header files locked
+// as TitanServer does. The track entries are read both by scan
+// and by following the in-track links. The sums of the values
+// read must be the same for both paths.
+//
+// Usage: time_test_titan_mmap [dir nScans nStorms]
+//
+///////////////////////////////////////////////////////////////
+
+#include <titan/TitanStormFile.hh>
+#include <titan/TitanTrackFile.hh>
+#include <toolsa/file_io.h>
+#include <toolsa/mem.h>
+#include <toolsa/str.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+using namespace std;
+
+static const int N_LAYERS = 12;
+static const int N_HIST = 12;
+static const int N_RUNS = 80;
+static const int N_PROJ_RUNS = 60;
+static const int N_REPEATS = 3;
+
+static int nScans = 600;
+static int nStorms = 60;
+
+static double _now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+///////////////////////////////////////////////////////////////
+// storm file writer - uses the protected members, as Titan does
+
+class StormWriter : public TitanStormFile {
+
+public:
+
+  int write(const string &path)
+  {
+    if (OpenFiles("w+", path.c_str(), "sd5")) {
+      fprintf(stderr, "%s", getErrStr().c_str());
+      return -1;
+    }
+    MEM_zero(_header);
+    AllocGprops(nStorms);
+    AllocLayers(N_LAYERS);
+    AllocHist(N_HIST);
+    AllocRuns(N_RUNS);
+    AllocProjRuns(N_PROJ_RUNS);
+    for (int iscan = 0; iscan < nScans; iscan++) {
+      MEM_zero(_scan);
+      _scan.scan_num = iscan;
+      _scan.nstorms = nStorms;
+      _scan.time = 1000000 + iscan * 300;
+      for (int istorm = 0; istorm < nStorms; istorm++) {
+        storm_file_global_props_t &gprops = _gprops[istorm];
+        MEM_zero(gprops);
+        gprops.storm_num = istorm;
+        gprops.n_layers = N_LAYERS;
+        gprops.n_dbz_intervals = N_HIST;
+        gprops.n_runs = N_RUNS;
+        gprops.n_proj_runs = N_PROJ_RUNS;
+        gprops.volume = iscan * 1000 + istorm;
+        for (int ii = 0; ii < N_LAYERS; ii++) {
+          MEM_zero(_lprops[ii]);
+          _lprops[ii].area = iscan + istorm + ii;
+        }
+        for (int ii = 0; ii < N_HIST; ii++) {
+          _hist[ii].percent_volume = ii + istorm;
+          _hist[ii].percent_area = iscan;
+        }
+        for (int ii = 0; ii < N_RUNS; ii++) {
+          _runs[ii].ix = ii;
+          _runs[ii].iy = istorm;
+          _runs[ii].iz = iscan % 100;
+          _runs[ii].n = 3;
+        }
+        for (int ii = 0; ii < N_PROJ_RUNS; ii++) {
+          _proj_runs[ii].ix = ii + 1;
+          _proj_runs[ii].iy = istorm;
+          _proj_runs[ii].iz = 0;
+          _proj_runs[ii].n = 2;
+        }
+        if (WriteProps(istorm)) {
+          fprintf(stderr, "%s", getErrStr().c_str());
+          return -1;
+        }
+      }
+      if (WriteScan(iscan)) {
+        fprintf(stderr, "%s", getErrStr().c_str());
+        return -1;
+      }
+      _header.n_scans = iscan + 1;
+    }
+    if (WriteHeader()) {
+      fprintf(stderr, "%s", getErrStr().c_str());
+      return -1;
+    }
+    CloseFiles();
+    return 0;
+  }
+
+};
+
+///////////////////////////////////////////////////////////////
+// track file writer and reader - one simple track per storm
+
+class TrackFile : public TitanTrackFile {
+
+public:
+
+  vector<long> trackStart; // offset of first entry in each track
+  
+  int write(const string &path)
+  {
+    if (OpenFiles("w+", path.c_str(), "td5")) {
+      fprintf(stderr, "%s", getErrStr().c_str());
+      return -1;
+    }
+    _header.max_parents = MAX_PARENTS;
+    _header.max_children = MAX_CHILDREN;
+    _header.max_nweights_forecast = MAX_NWEIGHTS_FORECAST;
+    STRncopy(_header.header_file_name, "test.th5", R_LABEL_LEN);
+    STRncopy(_header.data_file_name, "test.td5", R_LABEL_LEN);
+    AllocScanIndex(nScans);
+    vector<long> prevInTrack(nStorms, 0);
+    for (int iscan = 0; iscan < nScans; iscan++) {
+      long prevInScan = 0;
+      for (int istorm = 0; istorm < nStorms; istorm++) {
+        MEM_zero(_entry);
+        _entry.scan_num = iscan;
+        _entry.storm_num = istorm;
+        _entry.simple_track_num = istorm;
+        _entry.time = 1000000 + iscan * 300;
+        _entry.history_in_scans = iscan;
+        long offset = WriteEntry(prevInTrack[istorm], prevInScan);
+        if (offset < 0) {
+          fprintf(stderr, "%s", getErrStr().c_str());
+          return -1;
+        }
+        if (istorm == 0) {
+          _scan_index[iscan].first_entry_offset = offset;
+          _scan_index[iscan].n_entries = nStorms;
+        }
+        if (iscan == 0) {
+          trackStart.push_back(offset);
+        }
+        prevInTrack[istorm] = offset;
+        prevInScan = offset;
+      }
+      _header.n_scans = iscan + 1;
+    }
+    if (WriteHeader()) {
+      fprintf(stderr, "%s", getErrStr().c_str());
+      return -1;
+    }
+    CloseFiles();
+    return 0;
+  }
+
+  int readAll(const string &path, bool useMmap, double &sum)
+  {
+    setUseMmap(useMmap);
+    if (OpenFiles("r", path.c_str()) ||
+        LockHeaderFile("r") || ReadHeader()) {
+      fprintf(stderr, "%s", getErrStr().c_str());
+      return -1;
+    }
+    sum = 0.0;
+    for (int iscan = 0; iscan < _header.n_scans; iscan++) {
+      if (ReadScanEntries(iscan)) {
+        fprintf(stderr, "%s", getErrStr().c_str());
+        return -1;
+      }
+      for (int ii = 0; ii < _n_scan_entries; ii++) {
+        sum += _scan_entries[ii].scan_num + _scan_entries[ii].storm_num;
+      }
+    }
+    for (size_t itrack = 0; itrack < trackStart.size(); itrack++) {
+      _simple_params.first_entry_offset = trackStart[itrack];
+      _first_entry = true;
+      for (int iscan = 0; iscan < _header.n_scans; iscan++) {
+        if (ReadEntry()) {
+          fprintf(stderr, "%s", getErrStr().c_str());
+          return -1;
+        }
+        sum += _entry.history_in_scans * 7 + _entry.simple_track_num;
+      }
+    }
+    UnlockHeaderFile();
+    CloseFiles();
+    return 0;
+  }
+
+};
+
+///////////////////////////////////////////////////////////////
+// read every storm from the storm file
+
+static int readStorms(const string &path, bool useMmap, double &sum)
+{
+  TitanStormFile sfile;
+  sfile.setUseMmap(useMmap);
+  if (sfile.OpenFiles("r", path.c_str()) ||
+      sfile.LockHeaderFile("r") || sfile.ReadHeader()) {
+    fprintf(stderr, "%s", sfile.getErrStr().c_str());
+    return -1;
+  }
+  sum = 0.0;
+  for (int iscan = 0; iscan < sfile.header().n_scans; iscan++) {
+    if (sfile.ReadScan(iscan)) {
+      fprintf(stderr, "%s", sfile.getErrStr().c_str());
+      return -1;
+    }
+    for (int istorm = 0; istorm < sfile.scan().nstorms; istorm++) {
+      if (sfile.ReadProps(istorm)) {
+        fprintf(stderr, "%s", sfile.getErrStr().c_str());
+        return -1;
+      }
+      sum += (sfile.gprops()[istorm].volume +
+              sfile.lprops()[N_LAYERS - 1].area +
+              sfile.hist()[3].percent_area +
+              sfile.runs()[N_RUNS - 1].ix +
+              sfile.runs()[5].iz +
+              sfile.proj_runs()[N_PROJ_RUNS - 1].ix);
+    }
+  }
+  sfile.UnlockHeaderFile();
+  sfile.CloseFiles();
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////
+
+int main(int argc, char **argv)
+
+{
+
+  string dir = "/tmp/time_test_titan_mmap";
+  if (argc > 1) {
+    dir = argv[1];
+  }
+  if (argc > 2) {
+    nScans = atoi(argv[2]);
+  }
+  if (argc > 3) {
+    nStorms = atoi(argv[3]);
+  }
+  if (nScans < 1 || nStorms < 1) {
+    fprintf(stderr, "Usage: time_test_titan_mmap [dir nScans nStorms]\n");
+    return 1;
+  }
+  if (ta_makedir_recurse(dir.c_str())) {
+    fprintf(stderr, "Cannot make dir: %s\n", dir.c_str());
+    return 1;
+  }
+
+  string stormPath = dir + "/test.sh5";
+  string trackPath = dir + "/test.th5";
+  
+  StormWriter swriter;
+  TrackFile twriter;
+  if (swriter.write(stormPath) || twriter.write(trackPath)) {
+    return 1;
+  }
+
+  fprintf(stdout, "time_test_titan_mmap: %d scans, %d storms per scan\n",
+          nScans, nStorms);
+
+  int iret = 0;
+  for (int irep = 0; irep < N_REPEATS; irep++) {
+
+    double sumStdio, sumMmap;
+    double start = _now();
+    if (readStorms(stormPath, false, sumStdio)) {
+      return 1;
+    }
+    double mid = _now();
+    if (readStorms(stormPath, true, sumMmap)) {
+      return 1;
+    }
+    double end = _now();
+    fprintf(stdout, "  storms  stdio %8.1f ms  mmap %8.1f ms  %s\n",
+            (mid - start) * 1000.0, (end - mid) * 1000.0,
+            sumStdio == sumMmap ? "OK" : "MISMATCH");
+    if (sumStdio != sumMmap) {
+      iret = 1;
+    }
+
+    TrackFile stdioReader, mmapReader;
+    stdioReader.trackStart = twriter.trackStart;
+    mmapReader.trackStart = twriter.trackStart;
+    start = _now();
+    if (stdioReader.readAll(trackPath, false, sumStdio)) {
+      return 1;
+    }
+    mid = _now();
+    if (mmapReader.readAll(trackPath, true, sumMmap)) {
+      return 1;
+    }
+    end = _now();
+    fprintf(stdout, "  tracks  stdio %8.1f ms  mmap %8.1f ms  %s\n",
+            (mid - start) * 1000.0, (end - mid) * 1000.0,
+            sumStdio == sumMmap ? "OK" : "MISMATCH");
+    if (sumStdio != sumMmap) {
+      iret = 1;
+    }
+
+  }
+
+  return iret;
+
+}
@@ -0,0 +1,251 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+////////////////////////////////////////////////////////////////////
+// <titan/TitanColumnStore.hh>
+//
+// Columnar store of TITAN storm properties, for climatologies
+// and verification over long periods.
+//
+// The storm and track data for each TITAN day file is converted
+// into a segment file, in which each property is stored as a
+// separate compressed column, one row per storm per scan.
+// Queries then only read and decompress the columns requested,
+// from the segments which overlap the requested time period and
+// lat/lon box, instead of reading every scan and entry from the
+// TITAN files.
+//
+// Directory layout: one segment file per TITAN day file, named
+// from the day file, e.g. 20240601.tcol. New days are added as
+// new files. Converting a day file again replaces its segment.
+//
+// Segment file layout, all values big-endian:
+//
+//   titan_col_header_t
+//   titan_col_scan_t[n_scans]     - time index, rows for each scan
+//   si32[n_cells]                 - lat/lon cells containing storms
+//   titan_col_entry_t[n_columns]  - column directory
+//   compressed column data        - see ta_compress()
+//
+// Columns:
+//
+//   time, scan_num: scan details
+//   vol_centroid_lat, vol_centroid_lon: storm location
+//   all of the storm_file_global_props_t fields, by field name,
+//     except the file offsets and spares. Array members are
+//     numbered, e.g. proj_area_polygon_00. The add_on union has
+//     a column for each member field, e.g. add_on.hda.poh - only
+//     those for the union type Titan was run with are valid.
+//   time_origin, simple_track_num, complex_track_num,
+//     history_in_scans, history_in_secs, duration_in_scans,
+//     duration_in_secs, forecast_valid: from the track entry.
+//     Track numbers are -1 if the storm has not been tracked.
+//   dval_dt_*: the track_file_forecast_props_t rates of change.
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef TitanColumnStore_HH
+#define TitanColumnStore_HH
+
+#include <titan/TitanStormFile.hh>
+#include <titan/TitanTrackFile.hh>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+#define TITAN_COL_MAGIC 0x54434f4c /* "TCOL" */
+#define TITAN_COL_VERSION 1
+#define TITAN_COL_FILE_EXT "tcol"
+#define TITAN_COL_NAME_LEN 48
+#define TITAN_COL_CELL_SIZE 1.0 /* deg */
+
+typedef enum {
+  TITAN_COL_SI32 = 0,
+  TITAN_COL_FL32 = 1
+} titan_col_type_t;
+
+typedef struct {
+  si32 magic;        /* TITAN_COL_MAGIC */
+  si32 version;
+  si32 n_rows;
+  si32 n_columns;
+  si32 n_scans;
+  si32 n_cells;
+  si32 start_time;
+  si32 end_time;
+  fl32 min_lat;      /* bounding box of storm locations */
+  fl32 min_lon;
+  fl32 max_lat;
+  fl32 max_lon;
+  fl32 cell_size;    /* deg */
+  si32 spare[3];
+} titan_col_header_t;
+
+typedef struct {
+  si32 time;
+  si32 scan_num;
+  si32 first_row;
+  si32 n_rows;
+} titan_col_scan_t;
+
+typedef struct {
+  si32 type;         /* titan_col_type_t */
+  si32 offset;       /* file offset of compressed data */
+  si32 nbytes;       /* length of compressed data */
+  si32 spare;
+  char name[TITAN_COL_NAME_LEN];
+} titan_col_entry_t;
+
+class TitanColumnStore
+{
+
+public:
+  
+  // constructor
+  
+  TitanColumnStore();
+  
+  // destructor
+  
+  virtual ~TitanColumnStore();
+
+  // set the store directory
+
+  void setDir(const string &dir) { _dir = dir; }
+  const string &getDir() const { return _dir; }
+
+  void setDebug(bool state = true) { _debug = state; }
+
+  ///////////////////////////////////////////////////////////////
+  // Writing
+
+  // Write the segment for a storm and track file pair.
+  // The files must be open, and should be locked for reading.
+  // The segment is named from the storm file, and replaces
+  // any previous segment for that file.
+  // Returns 0 on success, -1 on failure.
+
+  int writeSegment(TitanStormFile &sfile, TitanTrackFile &tfile);
+
+  ///////////////////////////////////////////////////////////////
+  // Querying
+  
+  // Limit the rows returned by query() to the time period,
+  // inclusive. Defaults to all times.
+
+  void setTimeLimits(time_t start_time, time_t end_time);
+
+  // Limit the rows returned by query() to storms with their
+  // volume centroid in the lat/lon box. min_lon must be less
+  // than max_lon. Defaults to no limits.
+
+  void setLatLonLimits(double min_lat, double min_lon,
+                       double max_lat, double max_lon);
+  void clearLatLonLimits() { _checkLatLon = false; }
+
+  // Read the named columns for the rows within the limits,
+  // from all segments in the directory. Only the requested
+  // columns are read. Rows are in time order.
+  // Returns 0 on success, -1 on failure.
+
+  int query(const vector<string> &column_names);
+
+  // query results
+
+  size_t getNRows() const { return _nRows; }
+  
+  // Get the values of a column from the last query.
+  // Returns an empty vector if the column was not requested.
+
+  const vector<double> &getColumn(const string &name) const;
+
+  // Names of all of the columns which are stored.
+
+  static vector<string> getColumnNames();
+
+  // error string
+  
+  const string &getErrStr() const { return _errStr; }
+
+protected:
+
+  typedef enum {
+    SOURCE_SCAN_TIME,
+    SOURCE_SCAN_NUM,
+    SOURCE_LAT,
+    SOURCE_LON,
+    SOURCE_GPROPS,
+    SOURCE_ENTRY
+  } source_t;
+
+  typedef struct {
+    string name;
+    source_t source;
+    titan_col_type_t type;
+    size_t offset;   // byte offset in gprops or entry struct
+  } column_t;
+
+  string _dir;
+  bool _debug;
+  string _errStr;
+
+  // query limits
+
+  time_t _startTime, _endTime;
+  bool _checkLatLon;
+  double _minLat, _minLon, _maxLat, _maxLon;
+
+  // query results
+
+  size_t _nRows;
+  map<string, vector<double> > _results;
+  vector<double> _empty;
+
+  static const vector<column_t> &_columns();
+  static vector<column_t> _loadColumns();
+  static void _addColumn(vector<column_t> &columns,
+                         const string &name, source_t source,
+                         titan_col_type_t type, size_t offset);
+
+  int _querySegment(const string &path,
+                    const vector<string> &column_names);
+
+  int _readColumn(FILE *in, const string &path,
+                  const titan_col_entry_t &entry,
+                  int n_rows_in_seg,
+                  int first_row, int n_rows,
+                  vector<double> &vals);
+
+  static int _cellNum(double lat, double lon);
+
+private:
+  
+  // Private methods with no bodies. Copy and assignment not implemented.
+
+  TitanColumnStore(const TitanColumnStore & orig);
+  TitanColumnStore & operator = (const TitanColumnStore & other);
+  
+};
+
+#endif
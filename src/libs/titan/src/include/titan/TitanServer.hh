@@ -273,6 +273,8 @@ protected:
   void _loadScanList(int iday, vector<_tserver_scan_t> &scanList);
   int _findLastDay(time_t &last_day);
   int _compileTrackSet(TitanTrackFile &tfile);
+  int _findTracksAtTime(TitanTrackFile &tfile,
+                        time_t start_time, time_t end_time);
 
   int _readLatestTime();
 
@@ -102,6 +102,18 @@ public:
 		const char *header_file_path,
 		const char *data_file_ext = NULL);
   
+  // Read the data file through a read-only memory map instead
+  // of stdio. This saves the seek and read calls per entry when
+  // reading whole files, e.g. for verification or reprocessing.
+  // Must be called before OpenFiles(), and only applies to files
+  // opened in "r" mode. If the map fails, stdio is used.
+  // The reads must be done with the header file locked, as for
+  // stdio - the file size is checked by LockHeaderFile() and
+  // ReadHeader(), and the file remapped if Titan has truncated
+  // or extended it.
+
+  void setUseMmap(bool state = true) { _useMmap = state; }
+
   // Close the storm header and data files
 
   void CloseFiles();
@@ -239,6 +251,13 @@ protected:
   FILE *_header_file;
   FILE *_data_file;
 
+  // memory mapped data file
+
+  bool _useMmap;
+  bool _mapData;      // map in use for this open
+  char *_data_map;
+  long _data_map_len;
+
   bool _first_entry;  // set to TRUE if first entry of a track
   
   // track data
@@ -279,6 +298,11 @@ protected:
 
   void _clearErrStr();
 
+  int _mapDataFile();
+  void _checkDataMap();
+  void _unmapDataFile();
+  int _readData(void *buf, int size, int nitems, long offset);
+
 public:
 
   // friends for Titan program which writes the storm and track files
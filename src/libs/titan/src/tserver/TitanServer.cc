@@ -43,7 +43,101 @@
 #include <toolsa/ReadDir.hh>
 #include <toolsa/DateTime.hh>
 #include <didss/LdataInfo.hh>
+#include <algorithm>
+#include <map>
+#include <pthread.h>
+#include <sys/stat.h>
 using namespace std;
+
+////////////////////////////////////////////////////////////
+// Caches shared by all TitanServer objects in the process.
+//
+// Servers create a TitanServer per request, so without these
+// every request would re-read the params for every track in the
+// file, and the scan indexes for several days of track files.
+//
+// Track time index: the start and end times of the complex
+// tracks in a track file, sorted by start time. Replaces the
+// ReadUtime() pass in _compileTrackSet(). Rebuilt whenever the
+// track file header changes, which it does on every write.
+//
+// Scan lists: the scan times in each day's track file, as loaded
+// by _loadScanList(). Checked against the track header file
+// inode, size and modify time before use.
+//
+// The caches are protected by a mutex, since servers may handle
+// requests in several threads.
+
+namespace {
+
+  const size_t _maxCachedFiles = 16;
+
+  typedef struct {
+    time_t start;
+    time_t end;
+    int pos;         // position in complex_track_nums
+    int complexNum;
+  } _track_time_t;
+
+  bool _trackStartLess(const _track_time_t &a, const _track_time_t &b)
+  {
+    return a.start < b.start;
+  }
+
+  class _TrackTimeIndex {
+  public:
+    track_file_header_t header;
+    vector<_track_time_t> tracks; // sorted by start time
+    time_t maxDuration;
+    long long lastUsed;
+  };
+
+  class _ScanList {
+  public:
+    ino_t ino;
+    off_t size;
+    time_t mtime;
+    long mtimeNsec;
+    vector<time_t> scanTimes;
+    long long lastUsed;
+  };
+
+  pthread_mutex_t _cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+  map<string, _TrackTimeIndex> _trackIndexCache;
+  map<string, _ScanList> _scanListCache;
+  long long _cacheUseCount = 0;
+
+  // remove least recently used entry if cache is full
+
+  template <class T>
+  void _trimCache(map<string, T> &cache)
+  {
+    if (cache.size() < _maxCachedFiles) {
+      return;
+    }
+    typename map<string, T>::iterator oldest = cache.begin();
+    for (typename map<string, T>::iterator it = cache.begin();
+         it != cache.end(); it++) {
+      if (it->second.lastUsed < oldest->second.lastUsed) {
+        oldest = it;
+      }
+    }
+    cache.erase(oldest);
+  }
+
+  void _setStatTimes(const struct stat &fileStat, _ScanList &slist)
+  {
+    slist.ino = fileStat.st_ino;
+    slist.size = fileStat.st_size;
+    slist.mtime = fileStat.st_mtime;
+#if defined(__linux__)
+    slist.mtimeNsec = fileStat.st_mtim.tv_nsec;
+#else
+    slist.mtimeNsec = 0;
+#endif
+  }
+
+}
  
 ////////////////////////////////////////////////////////////
 // Constructor
@@ -398,9 +492,11 @@ int TitanServer::read(const string &dir)
   _stormPathInUse = stormPath;
   _trackPathInUse = trackPath;
   
-  // open the files and lock
+  // open the files and lock. The data files are read through
+  // a memory map - the locks are held until the read is done.
   
   TitanStormFile sfile;
+  sfile.setUseMmap();
   if (sfile.OpenFiles("r", stormPath)) {
     TaStr::AddStr(_errStr, "Cannot open storm file: ", stormPath);
     _errStr += sfile.getErrStr();
@@ -415,6 +511,7 @@ int TitanServer::read(const string &dir)
 
   
   TitanTrackFile tfile;
+  tfile.setUseMmap();
   if (tfile.OpenFiles("r", trackPath)) {
     TaStr::AddStr(_errStr, "Cannot open track file: ", trackPath);
     _errStr += tfile.getErrStr();
@@ -919,27 +1016,76 @@ void TitanServer::_loadScanList(int iday,
 	  dtime.getYear(), dtime.getMonth(), dtime.getDay(),
 	  TRACK_HEADER_FILE_EXT);
   
-  // open the track file and lock
-  
-  TitanTrackFile tfile;
-  if (tfile.OpenFiles("r", trackPath)) {
+  // check the file is there
+
+  struct stat fileStat;
+  if (stat(trackPath, &fileStat)) {
     // no file available
     return;
   }
-  if (tfile.LockHeaderFile("r")) {
-    TaStr::AddStr(_errStr, "ERROR - ", "TitanServer::_loadScanList");
-    _errStr += tfile.getErrStr();
-    tfile.CloseFiles();
-    return;
+  _ScanList slist;
+  _setStatTimes(fileStat, slist);
+
+  // use the cached scan times if the file has not changed
+
+  bool cached = false;
+  pthread_mutex_lock(&_cacheMutex);
+  map<string, _ScanList>::iterator it = _scanListCache.find(trackPath);
+  if (it != _scanListCache.end() &&
+      it->second.ino == slist.ino &&
+      it->second.size == slist.size &&
+      it->second.mtime == slist.mtime &&
+      it->second.mtimeNsec == slist.mtimeNsec) {
+    it->second.lastUsed = ++_cacheUseCount;
+    slist.scanTimes = it->second.scanTimes;
+    cached = true;
   }
+  pthread_mutex_unlock(&_cacheMutex);
+
+  if (!cached) {
+
+    // open the track file and lock
+  
+    TitanTrackFile tfile;
+    if (tfile.OpenFiles("r", trackPath)) {
+      // no file available
+      return;
+    }
+    if (tfile.LockHeaderFile("r")) {
+      TaStr::AddStr(_errStr, "ERROR - ", "TitanServer::_loadScanList");
+      _errStr += tfile.getErrStr();
+      tfile.CloseFiles();
+      return;
+    }
   
-  // read in the scan index
+    // read in the scan index
   
-  if (tfile.ReadScanIndex()) {
-    TaStr::AddStr(_errStr, "ERROR - ", "TitanServer::_loadScanList");
-    _errStr += tfile.getErrStr();
+    if (tfile.ReadScanIndex()) {
+      TaStr::AddStr(_errStr, "ERROR - ", "TitanServer::_loadScanList");
+      _errStr += tfile.getErrStr();
+      tfile.CloseFiles();
+      return;
+    }
+
+    for (int iscan = 0; iscan < tfile.header().n_scans; iscan++) {
+      slist.scanTimes.push_back(tfile.scan_index()[iscan].utime);
+    }
+
+    // close track file
+
     tfile.CloseFiles();
-    return;
+
+    // save in the cache - the stat from before the read is
+    // stored, so a write during the read forces a reload
+
+    pthread_mutex_lock(&_cacheMutex);
+    if (_scanListCache.find(trackPath) == _scanListCache.end()) {
+      _trimCache(_scanListCache);
+    }
+    slist.lastUsed = ++_cacheUseCount;
+    _scanListCache[trackPath] = slist;
+    pthread_mutex_unlock(&_cacheMutex);
+
   }
 
   // add to scan list
@@ -949,22 +1095,18 @@ void TitanServer::_loadScanList(int iday,
     latestTime = scanList[scanList.size() - 1].time;
   }
 
-  for (int iscan = 0; iscan < tfile.header().n_scans; iscan++) {
-    const track_file_scan_index_t &sindex = tfile.scan_index()[iscan];
-    if (sindex.utime > latestTime) {
+  for (size_t iscan = 0; iscan < slist.scanTimes.size(); iscan++) {
+    time_t scanTime = slist.scanTimes[iscan];
+    if (scanTime > latestTime) {
       _tserver_scan_t scan;
       scan.iday = iday;
       scan.num = iscan;
-      scan.time = sindex.utime;
+      scan.time = scanTime;
       scanList.push_back(scan);
-      latestTime = sindex.utime;
+      latestTime = scanTime;
     }
   } // iscan
 
-  // close track file
-
-  tfile.CloseFiles();
-
 }
 
 /////////////////////////////////////////////////////
@@ -1114,12 +1256,6 @@ int TitanServer::_compileTrackSet(TitanTrackFile &tfile)
 
   _trackSetNums.clear();
 
-  if (tfile.ReadUtime()) {
-    _errStr += "ERROR - TitanServer::_compileTrackSet\n";
-    _errStr += tfile.getErrStr();
-    return -1;
-  }
-
   switch (_trackSet) {
 
   case TITAN_SERVER_ALL_AT_TIME:
@@ -1133,21 +1269,9 @@ int TitanServer::_compileTrackSet(TitanTrackFile &tfile)
       cerr << "startTimeInUse: " << utimstr(startTimeInUse) << endl;
       cerr << "_timeInUse: " << utimstr(_timeInUse) << endl;
 #endif
-      for (int icomplex = 0; icomplex < tfile.header().n_complex_tracks;
-	   icomplex++) {
-	int complexNum = tfile.complex_track_nums()[icomplex];
-	const track_utime_t &utime = tfile.track_utime()[complexNum];
-	if (utime.start_complex <= _timeInUse &&
-	    utime.end_complex >= startTimeInUse) {
-#ifdef DEBUG_PRINT
-	  cerr << "  Including complex num, start, end: "
-	       << complexNum << " "
-	       << utimstr(utime.start_complex) << " "
-	       << utimstr(utime.end_complex) << endl;
-#endif
-	  _trackSetNums.push_back(complexNum);
-	}
-      } // icomplex
+      if (_findTracksAtTime(tfile, startTimeInUse, _timeInUse)) {
+        return -1;
+      }
     }
     break;
 
@@ -1183,3 +1307,97 @@ int TitanServer::_compileTrackSet(TitanTrackFile &tfile)
 
 }
 
+/////////////////////////////////////////////////////
+// find the complex tracks active between the start
+// and end times, and add them to the track set in the
+// order they are listed in the file.
+//
+// Uses the cached track time index for the file, which
+// is rebuilt if the file header has changed.
+//
+// Returns 0 on success, -1 on failure.
+
+int TitanServer::_findTracksAtTime(TitanTrackFile &tfile,
+                                   time_t start_time,
+                                   time_t end_time)
+
+{
+
+  const track_file_header_t &header = tfile.header();
+  const string &path = _trackPathInUse;
+
+  pthread_mutex_lock(&_cacheMutex);
+
+  map<string, _TrackTimeIndex>::iterator it = _trackIndexCache.find(path);
+  if (it == _trackIndexCache.end() ||
+      memcmp(&it->second.header, &header, sizeof(header))) {
+
+    // build the index - this is done under the lock so that
+    // other threads do not build it too
+
+    if (tfile.ReadUtime()) {
+      pthread_mutex_unlock(&_cacheMutex);
+      _errStr += "ERROR - TitanServer::_compileTrackSet\n";
+      _errStr += tfile.getErrStr();
+      return -1;
+    }
+
+    if (it == _trackIndexCache.end()) {
+      _trimCache(_trackIndexCache);
+    }
+    _TrackTimeIndex &index = _trackIndexCache[path];
+    index.header = header;
+    index.tracks.clear();
+    index.maxDuration = 0;
+    for (int icomplex = 0; icomplex < header.n_complex_tracks; icomplex++) {
+      int complexNum = tfile.complex_track_nums()[icomplex];
+      const track_utime_t &utime = tfile.track_utime()[complexNum];
+      _track_time_t track;
+      track.start = utime.start_complex;
+      track.end = utime.end_complex;
+      track.pos = icomplex;
+      track.complexNum = complexNum;
+      index.tracks.push_back(track);
+      index.maxDuration = MAX(index.maxDuration, track.end - track.start);
+    }
+    stable_sort(index.tracks.begin(), index.tracks.end(), _trackStartLess);
+    it = _trackIndexCache.find(path);
+
+  }
+
+  _TrackTimeIndex &index = it->second;
+  index.lastUsed = ++_cacheUseCount;
+
+  // a track which started after end_time, or before
+  // start_time - maxDuration, cannot be active
+
+  _track_time_t key;
+  key.start = start_time - index.maxDuration;
+  vector<_track_time_t>::const_iterator track =
+    lower_bound(index.tracks.begin(), index.tracks.end(), key,
+                _trackStartLess);
+  vector<pair<int, int> > found;
+  for (; track != index.tracks.end() && track->start <= end_time; track++) {
+    if (track->end >= start_time) {
+#ifdef DEBUG_PRINT
+      cerr << "  Including complex num, start, end: "
+	   << track->complexNum << " "
+	   << utimstr(track->start) << " "
+	   << utimstr(track->end) << endl;
+#endif
+      found.push_back(pair<int, int>(track->pos, track->complexNum));
+    }
+  }
+
+  pthread_mutex_unlock(&_cacheMutex);
+
+  // restore the file order
+
+  sort(found.begin(), found.end());
+  for (size_t ii = 0; ii < found.size(); ii++) {
+    _trackSetNums.push_back(found[ii].second);
+  }
+
+  return 0;
+
+}
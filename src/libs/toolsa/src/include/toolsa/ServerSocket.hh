@@ -147,6 +147,16 @@ public:
   
   HttpSocket * getHttpClient(const ssize_t wait_msecs = -1);
     
+  ///////////////////////////////////////////////////////////////
+  // getSd()
+  //
+  // Get the listening socket descriptor, for servers which
+  // accept clients themselves from a poll or epoll loop.
+  // Returns -1 if not open.
+  //
+
+  int getSd() { return (hasState(STATE_OPENED) ? _protoSd : -1); }
+
   ///////////////
   // close()
   //
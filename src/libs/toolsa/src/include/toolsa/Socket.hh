@@ -137,6 +137,18 @@ public:
   //
   bool isOpen() const { return (_sd >= 0); }
 
+  //////////////////////
+  // setNoDelay()
+  //
+  // Disable the Nagle algorithm on the socket, so that small
+  // writes are sent immediately. Use on connections which carry
+  // several request/reply exchanges, since the header and body of
+  // a message are written separately.
+  //
+  // Returns 0 on success, -1 on failure.
+  //
+  int setNoDelay(bool state = true);
+
   /////////////////////////////////////////////
   // readSelect()
   //
@@ -45,6 +45,7 @@
 #include <cerrno>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -236,6 +237,25 @@ void Socket::close()
   }
 }
 
+////////////////////////
+// setNoDelay()
+//
+// Disable the Nagle algorithm on the socket.
+//
+// Returns 0 on success, -1 on failure.
+//
+int Socket::setNoDelay(bool state /* = true*/)
+{
+  if (_sd < 0) {
+    return -1;
+  }
+  int val = (state ? 1 : 0);
+  if (setsockopt(_sd, IPPROTO_TCP, TCP_NODELAY, (char *) &val, sizeof(val))) {
+    return -1;
+  }
+  return 0;
+}
+
 ////////////////////////////////////////////////////////
 // readSelect()
 //